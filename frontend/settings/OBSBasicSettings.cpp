@@ -552,6 +552,11 @@ OBSBasicSettings::OBSBasicSettings(QWidget *parent)
 	HookWidget(ui->resetOSXVSync,        CHECK_CHANGED,  ADV_CHANGED);
 	if (obs_audio_monitoring_available())
 		HookWidget(ui->monitoringDevice,     COMBO_CHANGED,  ADV_CHANGED);
+#if !defined(_WIN32) && !defined(__APPLE__)
+	if (obs_audio_monitoring_available())
+		HookWidget(ui->monitoringBus,        CHECK_CHANGED,  ADV_CHANGED);
+#endif
+	HookWidget(ui->polyphaseResampler,   CHECK_CHANGED,  ADV_RESTART);
 #ifdef _WIN32
 	HookWidget(ui->disableAudioDucking,  CHECK_CHANGED,  ADV_CHANGED);
 #endif
@@ -612,8 +617,16 @@ OBSBasicSettings::OBSBasicSettings(QWidget *parent)
 		ui->monitoringDeviceLabel = nullptr;
 		delete ui->monitoringDevice;
 		ui->monitoringDevice = nullptr;
+		delete ui->monitoringBus;
+		ui->monitoringBus = nullptr;
 	}
 
+	// Only the PulseAudio monitoring backend can mix monitored sources into a single stream
+#if defined(_WIN32) || defined(__APPLE__)
+	delete ui->monitoringBus;
+	ui->monitoringBus = nullptr;
+#endif
+
 #ifdef _WIN32
 	if (!SetDisplayAffinitySupported()) {
 		delete ui->hideOBSFromCapture;
@@ -2629,6 +2642,15 @@ void OBSBasicSettings::LoadAdvancedSettings()
 		SetInvalidValue(ui->monitoringDevice, monDevName, monDevId);
 	}
 
+#if !defined(_WIN32) && !defined(__APPLE__)
+	if (obs_audio_monitoring_available())
+		ui->monitoringBus->setChecked(config_get_bool(main->Config(), "Audio", "MonitoringBus"));
+#endif
+
+	bool polyphaseResampler = config_get_bool(App()->GetUserConfig(), "Audio", "PolyphaseResampler");
+	ui->polyphaseResampler->setChecked(polyphaseResampler);
+	prevPolyphaseResampler = polyphaseResampler;
+
 	ui->confirmOnExit->setChecked(confirmOnExit);
 
 	ui->filenameFormatting->setText(filename);
@@ -3317,6 +3339,19 @@ void OBSBasicSettings::SaveAdvancedSettings()
 		SaveComboData(ui->monitoringDevice, "Audio", "MonitoringDeviceId");
 	}
 
+#if !defined(_WIN32) && !defined(__APPLE__)
+	if (obs_audio_monitoring_available() && WidgetChanged(ui->monitoringBus)) {
+		bool monitoringBus = ui->monitoringBus->isChecked();
+		config_set_bool(main->Config(), "Audio", "MonitoringBus", monitoringBus);
+		obs_set_audio_monitoring_bus(monitoringBus);
+	}
+#endif
+
+	if (WidgetChanged(ui->polyphaseResampler)) {
+		bool polyphaseResampler = ui->polyphaseResampler->isChecked();
+		config_set_bool(App()->GetUserConfig(), "Audio", "PolyphaseResampler", polyphaseResampler);
+	}
+
 #ifdef _WIN32
 	if (WidgetChanged(ui->disableAudioDucking)) {
 		bool disable = ui->disableAudioDucking->isChecked();
@@ -3842,8 +3877,9 @@ void OBSBasicSettings::SaveSettings()
 	bool audioRestart =
 		(ui->channelSetup->currentIndex() != channelIndex || ui->sampleRate->currentIndex() != sampleRateIndex);
 	bool browserHWAccelChanged = (ui->browserHWAccel && ui->browserHWAccel->isChecked() != prevBrowserAccel);
+	bool polyphaseResamplerChanged = ui->polyphaseResampler->isChecked() != prevPolyphaseResampler;
 
-	if (langChanged || audioRestart || browserHWAccelChanged) {
+	if (langChanged || audioRestart || browserHWAccelChanged || polyphaseResamplerChanged) {
 		restart = true;
 	} else {
 		restart = false;
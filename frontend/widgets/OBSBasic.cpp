@@ -25,6 +25,7 @@
 #include "OBSBasicStats.hpp"
 #include "plugin-manager/PluginManager.hpp"
 
+#include <media-io/audio-resampler.h>
 #include <obs-module.h>
 
 #ifdef YOUTUBE_ENABLED
@@ -227,6 +228,29 @@ static void SetCoreModuleNames()
 #endif
 }
 
+/* Bundled modules that only register source/output/encoder types and do
+ * nothing else at load time.  These can be loaded on first use once their
+ * types are known from the module cache.  Modules whose registrations depend
+ * on the system (obs-filters with the NVIDIA effects, vlc-video with libvlc)
+ * must not be listed, since the cache only notices when the binary changes. */
+static const char *lazy_modules[] = {
+	"image-source", "obs-transitions", "text-freetype2", "obs-x264", "obs-libfdk",
+};
+
+static void SetLazyModuleNames()
+{
+	char cache_path[512];
+	if (GetAppConfigPath(cache_path, sizeof(cache_path), "obs-studio/plugin_manifest_cache.json") <= 0) {
+		return;
+	}
+
+	obs_set_module_cache_path(cache_path);
+
+	for (const char *module : lazy_modules) {
+		obs_add_lazy_module(module);
+	}
+}
+
 extern void setupDockAction(QDockWidget *dock);
 
 OBSBasic::OBSBasic(QWidget *parent) : OBSMainWindow(parent), undo_s(ui), ui(new Ui::OBSBasic)
@@ -868,6 +892,7 @@ bool OBSBasic::InitBasicConfigDefaults()
 	config_set_default_string(activeConfiguration, "Audio", "MonitoringDeviceName",
 				  Str("Basic.Settings.Advanced.Audio.MonitoringDevice"
 				      ".Default"));
+	config_set_default_bool(activeConfiguration, "Audio", "MonitoringBus", false);
 	config_set_default_uint(activeConfiguration, "Audio", "SampleRate", 48000);
 	config_set_default_string(activeConfiguration, "Audio", "ChannelSetup", "Stereo");
 	config_set_default_double(activeConfiguration, "Audio", "MeterDecayRate", VOLUME_METER_DECAY_FAST);
@@ -1022,6 +1047,7 @@ void OBSBasic::OBSInit()
 		const char *device_id = config_get_string(activeConfiguration, "Audio", "MonitoringDeviceId");
 
 		obs_set_audio_monitoring_device(device_name, device_id);
+		obs_set_audio_monitoring_bus(config_get_bool(activeConfiguration, "Audio", "MonitoringBus"));
 
 		blog(LOG_INFO, "Audio monitoring device:\n\tname: %s\n\tid: %s", device_name, device_id);
 	}
@@ -1047,6 +1073,10 @@ void OBSBasic::OBSInit()
 	// Core modules are not allowed to be disabled by the user via plugin manager.
 	SetCoreModuleNames();
 
+	if (!safe_mode) {
+		SetLazyModuleNames();
+	}
+
 	/* Modules can access frontend information (i.e. profile and scene collection data) during their initialization, and some modules (e.g. obs-websockets) are known to use the filesystem location of the current profile in their own code.
 
      Thus the profile and scene collection discovery needs to happen before any access to that information (but after initializing global settings) to ensure legacy code gets valid path information.
@@ -1693,6 +1723,10 @@ bool OBSBasic::ResetAudio()
 		ai.speakers = SPEAKERS_STEREO;
 	}
 
+	/* only resamplers created afterwards use it, so changing it requires a restart */
+	bool polyphaseResampler = config_get_bool(App()->GetUserConfig(), "Audio", "PolyphaseResampler");
+	audio_resampler_set_default_type(polyphaseResampler ? AUDIO_RESAMPLER_POLYPHASE : AUDIO_RESAMPLER_SWRESAMPLE);
+
 	bool lowLatencyAudioBuffering = config_get_bool(App()->GetUserConfig(), "Audio", "LowLatencyAudioBuffering");
 	if (lowLatencyAudioBuffering) {
 		ai.max_buffering_ms = 20;
@@ -754,6 +754,7 @@ void OBSBasic::ResetProfileData()
 		const char *device_id = config_get_string(activeConfiguration, "Audio", "MonitoringDeviceId");
 
 		obs_set_audio_monitoring_device(device_name, device_id);
+		obs_set_audio_monitoring_bus(config_get_bool(activeConfiguration, "Audio", "MonitoringBus"));
 
 		blog(LOG_INFO, "Audio monitoring device:\n\tname: %s\n\tid: %s", device_name, device_id);
 	}
@@ -1349,7 +1349,7 @@ void OBSBasic::LoadData(obs_data_t *data, SceneCollection &collection)
 	updateRemigrationMenuItem(collection.getCoordinateMode(), ui->actionRemigrateSceneCollection);
 
 	obs_missing_files_t *files = obs_missing_files_create();
-	obs_load_sources(sources, addMissingFiles, files);
+	obs_load_sources_parallel(sources, addMissingFiles, files);
 
 	if (resetVideo) {
 		ResetVideo();
@@ -0,0 +1,243 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <util/platform.h>
+#include <graphics/vec3.h>
+
+#include "sw-subsystem.h"
+
+/* ------------------------------------------------------------------------- */
+/* vertex buffers                                                            */
+
+gs_vertbuffer_t *device_vertexbuffer_create(gs_device_t *device, struct gs_vb_data *data, uint32_t flags)
+{
+	struct gs_vertex_buffer *vb = bzalloc(sizeof(struct gs_vertex_buffer));
+	vb->device = device;
+	vb->data = data;
+	vb->dynamic = (flags & GS_DYNAMIC) != 0;
+	return vb;
+}
+
+void gs_vertexbuffer_destroy(gs_vertbuffer_t *vb)
+{
+	if (!vb)
+		return;
+
+	if (vb->device->cur_vertex_buffer == vb)
+		vb->device->cur_vertex_buffer = NULL;
+
+	gs_vbdata_destroy(vb->data);
+	bfree(vb);
+}
+
+void gs_vertexbuffer_flush(gs_vertbuffer_t *vb)
+{
+	/* vertices are read straight from the buffer data when drawing */
+	UNUSED_PARAMETER(vb);
+}
+
+#define COPY_ATTRIB(val)                                                           \
+	do {                                                                       \
+		if (dst->val && src->val)                                          \
+			memcpy(dst->val, src->val, sizeof(*dst->val) * dst->num); \
+	} while (false)
+
+void gs_vertexbuffer_flush_direct(gs_vertbuffer_t *vb, const struct gs_vb_data *data)
+{
+	struct gs_vb_data *dst = vb->data;
+	const struct gs_vb_data *src = data;
+
+	if (!vb->dynamic) {
+		blog(LOG_ERROR, "vertex buffer is not dynamic");
+		return;
+	}
+
+	if (!dst || dst == src)
+		return;
+
+	COPY_ATTRIB(points);
+	COPY_ATTRIB(normals);
+	COPY_ATTRIB(tangents);
+	COPY_ATTRIB(colors);
+
+	for (size_t i = 0; i < dst->num_tex && i < src->num_tex; i++) {
+		struct gs_tvertarray *dst_tv = dst->tvarray + i;
+		const struct gs_tvertarray *src_tv = src->tvarray + i;
+
+		if (dst_tv->array && src_tv->array && dst_tv->width == src_tv->width)
+			memcpy(dst_tv->array, src_tv->array, sizeof(float) * dst_tv->width * dst->num);
+	}
+}
+
+#undef COPY_ATTRIB
+
+struct gs_vb_data *gs_vertexbuffer_get_data(const gs_vertbuffer_t *vb)
+{
+	return vb->data;
+}
+
+/* ------------------------------------------------------------------------- */
+/* index buffers                                                             */
+
+gs_indexbuffer_t *device_indexbuffer_create(gs_device_t *device, enum gs_index_type type, void *indices, size_t num,
+					    uint32_t flags)
+{
+	struct gs_index_buffer *ib = bzalloc(sizeof(struct gs_index_buffer));
+	ib->device = device;
+	ib->type = type;
+	ib->data = indices;
+	ib->num = num;
+	ib->width = type == GS_UNSIGNED_LONG ? 4 : 2;
+	ib->dynamic = (flags & GS_DYNAMIC) != 0;
+	return ib;
+}
+
+void gs_indexbuffer_destroy(gs_indexbuffer_t *ib)
+{
+	if (!ib)
+		return;
+
+	if (ib->device->cur_index_buffer == ib)
+		ib->device->cur_index_buffer = NULL;
+
+	bfree(ib->data);
+	bfree(ib);
+}
+
+void gs_indexbuffer_flush(gs_indexbuffer_t *ib)
+{
+	UNUSED_PARAMETER(ib);
+}
+
+void gs_indexbuffer_flush_direct(gs_indexbuffer_t *ib, const void *data)
+{
+	if (!ib->dynamic) {
+		blog(LOG_ERROR, "index buffer is not dynamic");
+		return;
+	}
+
+	if (ib->data && data && ib->data != data)
+		memcpy(ib->data, data, ib->num * ib->width);
+}
+
+void *gs_indexbuffer_get_data(const gs_indexbuffer_t *ib)
+{
+	return ib->data;
+}
+
+size_t gs_indexbuffer_get_num_indices(const gs_indexbuffer_t *ib)
+{
+	return ib->num;
+}
+
+enum gs_index_type gs_indexbuffer_get_type(const gs_indexbuffer_t *ib)
+{
+	return ib->type;
+}
+
+/* ------------------------------------------------------------------------- */
+/* sampler states                                                            */
+
+gs_samplerstate_t *device_samplerstate_create(gs_device_t *device, const struct gs_sampler_info *info)
+{
+	struct gs_sampler_state *sampler = bzalloc(sizeof(struct gs_sampler_state));
+	sampler->device = device;
+	sampler->info = *info;
+	vec4_from_rgba(&sampler->border_color, info->border_color);
+	return sampler;
+}
+
+void gs_samplerstate_destroy(gs_samplerstate_t *samplerstate)
+{
+	if (!samplerstate)
+		return;
+
+	if (samplerstate->device) {
+		for (size_t i = 0; i < GS_MAX_TEXTURES; i++) {
+			if (samplerstate->device->cur_samplers[i] == samplerstate)
+				samplerstate->device->cur_samplers[i] = NULL;
+		}
+	}
+
+	bfree(samplerstate);
+}
+
+/* ------------------------------------------------------------------------- */
+/* timers                                                                    */
+
+gs_timer_t *device_timer_create(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+	return bzalloc(sizeof(struct gs_timer));
+}
+
+gs_timer_range_t *device_timer_range_create(gs_device_t *device)
+{
+	struct gs_timer_range *range = bzalloc(sizeof(struct gs_timer_range));
+	range->device = device;
+	return range;
+}
+
+void gs_timer_destroy(gs_timer_t *timer)
+{
+	bfree(timer);
+}
+
+void gs_timer_begin(gs_timer_t *timer)
+{
+	timer->begin = os_gettime_ns();
+}
+
+void gs_timer_end(gs_timer_t *timer)
+{
+	timer->end = os_gettime_ns();
+}
+
+bool gs_timer_get_data(gs_timer_t *timer, uint64_t *ticks)
+{
+	if (timer->end < timer->begin)
+		return false;
+
+	*ticks = timer->end - timer->begin;
+	return true;
+}
+
+void gs_timer_range_destroy(gs_timer_range_t *range)
+{
+	bfree(range);
+}
+
+void gs_timer_range_begin(gs_timer_range_t *range)
+{
+	UNUSED_PARAMETER(range);
+}
+
+void gs_timer_range_end(gs_timer_range_t *range)
+{
+	UNUSED_PARAMETER(range);
+}
+
+bool gs_timer_range_get_data(gs_timer_range_t *range, bool *disjoint, uint64_t *frequency)
+{
+	UNUSED_PARAMETER(range);
+
+	/* draws complete before device_draw returns, and timers count
+	 * nanoseconds */
+	*disjoint = false;
+	*frequency = 1000000000;
+	return true;
+}
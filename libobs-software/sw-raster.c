@@ -0,0 +1,1381 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <math.h>
+#include <string.h>
+
+#include <util/platform.h>
+#include <graphics/half.h>
+#include <graphics/srgb.h>
+#include <graphics/vec2.h>
+#include <graphics/vec3.h>
+
+#include "sw-subsystem.h"
+
+#define SW_BAND_HEIGHT 32
+#define SW_MAX_WORKERS 15
+#define SW_INLINE_PIXELS (256 * 256)
+
+#define SW_SRGB_ENCODE_SIZE 16384
+
+/* interpolated attributes: 1/w, then u, v, r, g, b, a (all divided by w) */
+#define SW_PLANE_Q 0
+#define SW_PLANE_U 1
+#define SW_PLANE_V 2
+#define SW_PLANE_COLOR 3
+#define SW_NUM_PLANES 7
+
+struct sw_edge {
+	float a, b, c;
+};
+
+struct sw_triangle {
+	struct sw_edge edges[3];
+	int y_start, y_end;
+
+	/* attribute planes relative to the first vertex */
+	float x0, y0;
+	float f0[SW_NUM_PLANES];
+	float dx[SW_NUM_PLANES];
+	float dy[SW_NUM_PLANES];
+};
+
+struct sw_tex_unit {
+	const gs_texture_t *tex;
+	enum gs_address_mode address_u;
+	enum gs_address_mode address_v;
+	struct vec4 border;
+	bool point;
+	bool srgb;
+};
+
+struct sw_draw_state {
+	gs_texture_t *target;
+	int clip_x0, clip_y0, clip_x1, clip_y1;
+
+	bool blend;
+	enum gs_blend_type src_c, dst_c, src_a, dst_a;
+	enum gs_blend_op_type op;
+	bool write[4];
+	bool write_all;
+	bool srgb_target;
+	bool perspective;
+
+	enum sw_pixel_program ps;
+	uint32_t ps_flags;
+
+	struct sw_tex_unit images[4];
+	struct vec4 color;
+	float multiplier;
+	float gamma;
+	struct matrix4 color_matrix;
+	struct vec4 color_vec[3];
+	float range_min[3];
+	float range_max[3];
+
+	const struct sw_triangle *triangles;
+	size_t num_triangles;
+
+	volatile long next_band;
+	long num_bands;
+};
+
+struct sw_workers {
+	pthread_t threads[SW_MAX_WORKERS];
+	size_t count;
+
+	os_sem_t *start_sem;
+	os_sem_t *done_sem;
+	struct sw_draw_state *job;
+	bool stop;
+
+	DARRAY(struct sw_triangle) triangles;
+};
+
+/* ------------------------------------------------------------------------- */
+/* format conversion                                                         */
+
+static float srgb_decode_table[256];
+static uint8_t srgb_encode_table[SW_SRGB_ENCODE_SIZE];
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static void init_tables(void)
+{
+	for (size_t i = 0; i < 256; i++)
+		srgb_decode_table[i] = gs_srgb_nonlinear_to_linear((float)i / 255.0f);
+
+	for (size_t i = 0; i < SW_SRGB_ENCODE_SIZE; i++) {
+		float linear = (float)i / (float)(SW_SRGB_ENCODE_SIZE - 1);
+		srgb_encode_table[i] = gs_float_to_u8(gs_srgb_linear_to_nonlinear(linear));
+	}
+}
+
+static inline float saturate(float f)
+{
+	return f < 0.0f ? 0.0f : (f > 1.0f ? 1.0f : f);
+}
+
+static inline uint8_t unorm8(float f)
+{
+	return (uint8_t)(saturate(f) * 255.0f + 0.5f);
+}
+
+static inline uint16_t unorm16(float f)
+{
+	return (uint16_t)(saturate(f) * 65535.0f + 0.5f);
+}
+
+static inline uint32_t unorm_bits(float f, uint32_t max)
+{
+	return (uint32_t)(saturate(f) * (float)max + 0.5f);
+}
+
+static inline float srgb_decode(float f)
+{
+	return srgb_decode_table[unorm8(f)];
+}
+
+static inline float srgb_encode(float f)
+{
+	size_t idx = (size_t)(saturate(f) * (float)(SW_SRGB_ENCODE_SIZE - 1) + 0.5f);
+	return (float)srgb_encode_table[idx] / 255.0f;
+}
+
+static inline float half_to_float(uint16_t h)
+{
+	uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+	uint32_t exponent = (h >> 10) & 0x1f;
+	uint32_t mantissa = h & 0x3ff;
+	uint32_t bits;
+	float f;
+
+	if (exponent == 0) {
+		/* zero and subnormals, mantissa * 2^-24 */
+		f = (float)mantissa / 16777216.0f;
+		return sign ? -f : f;
+	} else if (exponent == 31) {
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	} else {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+static inline uint16_t read_u16(const uint8_t *p, size_t i)
+{
+	uint16_t val;
+	memcpy(&val, p + i * 2, sizeof(val));
+	return val;
+}
+
+static inline float read_f32(const uint8_t *p, size_t i)
+{
+	float val;
+	memcpy(&val, p + i * 4, sizeof(val));
+	return val;
+}
+
+static inline void write_u16(uint8_t *p, size_t i, uint16_t val)
+{
+	memcpy(p + i * 2, &val, sizeof(val));
+}
+
+static inline void write_f32(uint8_t *p, size_t i, float val)
+{
+	memcpy(p + i * 4, &val, sizeof(val));
+}
+
+void sw_load_texel(const gs_texture_t *tex, int x, int y, struct vec4 *out)
+{
+	const uint8_t *p = tex->data + (size_t)y * tex->linesize + (size_t)x * tex->bpp;
+	uint32_t packed;
+
+	switch (tex->format) {
+	case GS_A8:
+		vec4_set(out, 0.0f, 0.0f, 0.0f, (float)p[0] / 255.0f);
+		break;
+	case GS_R8:
+		vec4_set(out, (float)p[0] / 255.0f, 0.0f, 0.0f, 1.0f);
+		break;
+	case GS_R8G8:
+		vec4_set(out, (float)p[0] / 255.0f, (float)p[1] / 255.0f, 0.0f, 1.0f);
+		break;
+	case GS_RGBA:
+	case GS_RGBA_UNORM:
+		vec4_set(out, (float)p[0] / 255.0f, (float)p[1] / 255.0f, (float)p[2] / 255.0f, (float)p[3] / 255.0f);
+		break;
+	case GS_BGRA:
+	case GS_BGRA_UNORM:
+		vec4_set(out, (float)p[2] / 255.0f, (float)p[1] / 255.0f, (float)p[0] / 255.0f, (float)p[3] / 255.0f);
+		break;
+	case GS_BGRX:
+	case GS_BGRX_UNORM:
+		vec4_set(out, (float)p[2] / 255.0f, (float)p[1] / 255.0f, (float)p[0] / 255.0f, 1.0f);
+		break;
+	case GS_R10G10B10A2:
+		memcpy(&packed, p, sizeof(packed));
+		vec4_set(out, (float)(packed & 0x3ff) / 1023.0f, (float)((packed >> 10) & 0x3ff) / 1023.0f,
+			 (float)((packed >> 20) & 0x3ff) / 1023.0f, (float)(packed >> 30) / 3.0f);
+		break;
+	case GS_R16:
+		vec4_set(out, (float)read_u16(p, 0) / 65535.0f, 0.0f, 0.0f, 1.0f);
+		break;
+	case GS_RG16:
+		vec4_set(out, (float)read_u16(p, 0) / 65535.0f, (float)read_u16(p, 1) / 65535.0f, 0.0f, 1.0f);
+		break;
+	case GS_RGBA16:
+		vec4_set(out, (float)read_u16(p, 0) / 65535.0f, (float)read_u16(p, 1) / 65535.0f,
+			 (float)read_u16(p, 2) / 65535.0f, (float)read_u16(p, 3) / 65535.0f);
+		break;
+	case GS_R16F:
+		vec4_set(out, half_to_float(read_u16(p, 0)), 0.0f, 0.0f, 1.0f);
+		break;
+	case GS_RG16F:
+		vec4_set(out, half_to_float(read_u16(p, 0)), half_to_float(read_u16(p, 1)), 0.0f, 1.0f);
+		break;
+	case GS_RGBA16F:
+		vec4_set(out, half_to_float(read_u16(p, 0)), half_to_float(read_u16(p, 1)),
+			 half_to_float(read_u16(p, 2)), half_to_float(read_u16(p, 3)));
+		break;
+	case GS_R32F:
+		vec4_set(out, read_f32(p, 0), 0.0f, 0.0f, 1.0f);
+		break;
+	case GS_RG32F:
+		vec4_set(out, read_f32(p, 0), read_f32(p, 1), 0.0f, 1.0f);
+		break;
+	case GS_RGBA32F:
+		vec4_set(out, read_f32(p, 0), read_f32(p, 1), read_f32(p, 2), read_f32(p, 3));
+		break;
+	case GS_DXT1:
+	case GS_DXT3:
+	case GS_DXT5:
+	case GS_UNKNOWN:
+		vec4_zero(out);
+		break;
+	}
+}
+
+void sw_store_texel(gs_texture_t *tex, int x, int y, const struct vec4 *c)
+{
+	uint8_t *p = tex->data + (size_t)y * tex->linesize + (size_t)x * tex->bpp;
+	uint32_t packed;
+
+	switch (tex->format) {
+	case GS_A8:
+		p[0] = unorm8(c->w);
+		break;
+	case GS_R8:
+		p[0] = unorm8(c->x);
+		break;
+	case GS_R8G8:
+		p[0] = unorm8(c->x);
+		p[1] = unorm8(c->y);
+		break;
+	case GS_RGBA:
+	case GS_RGBA_UNORM:
+		p[0] = unorm8(c->x);
+		p[1] = unorm8(c->y);
+		p[2] = unorm8(c->z);
+		p[3] = unorm8(c->w);
+		break;
+	case GS_BGRA:
+	case GS_BGRA_UNORM:
+		p[0] = unorm8(c->z);
+		p[1] = unorm8(c->y);
+		p[2] = unorm8(c->x);
+		p[3] = unorm8(c->w);
+		break;
+	case GS_BGRX:
+	case GS_BGRX_UNORM:
+		p[0] = unorm8(c->z);
+		p[1] = unorm8(c->y);
+		p[2] = unorm8(c->x);
+		p[3] = 255;
+		break;
+	case GS_R10G10B10A2:
+		packed = unorm_bits(c->x, 1023) | (unorm_bits(c->y, 1023) << 10) | (unorm_bits(c->z, 1023) << 20) |
+			 (unorm_bits(c->w, 3) << 30);
+		memcpy(p, &packed, sizeof(packed));
+		break;
+	case GS_R16:
+		write_u16(p, 0, unorm16(c->x));
+		break;
+	case GS_RG16:
+		write_u16(p, 0, unorm16(c->x));
+		write_u16(p, 1, unorm16(c->y));
+		break;
+	case GS_RGBA16:
+		for (size_t i = 0; i < 4; i++)
+			write_u16(p, i, unorm16(c->ptr[i]));
+		break;
+	case GS_R16F:
+		write_u16(p, 0, half_from_float(c->x).u);
+		break;
+	case GS_RG16F:
+		write_u16(p, 0, half_from_float(c->x).u);
+		write_u16(p, 1, half_from_float(c->y).u);
+		break;
+	case GS_RGBA16F:
+		for (size_t i = 0; i < 4; i++)
+			write_u16(p, i, half_from_float(c->ptr[i]).u);
+		break;
+	case GS_R32F:
+		write_f32(p, 0, c->x);
+		break;
+	case GS_RG32F:
+		write_f32(p, 0, c->x);
+		write_f32(p, 1, c->y);
+		break;
+	case GS_RGBA32F:
+		for (size_t i = 0; i < 4; i++)
+			write_f32(p, i, c->ptr[i]);
+		break;
+	case GS_DXT1:
+	case GS_DXT3:
+	case GS_DXT5:
+	case GS_UNKNOWN:
+		break;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* sampling                                                                  */
+
+static inline int wrap_coord(int i, int size, enum gs_address_mode mode)
+{
+	int period;
+
+	switch (mode) {
+	case GS_ADDRESS_WRAP:
+		i %= size;
+		return i < 0 ? i + size : i;
+	case GS_ADDRESS_MIRROR:
+		period = size * 2;
+		i %= period;
+		if (i < 0)
+			i += period;
+		return i < size ? i : period - 1 - i;
+	case GS_ADDRESS_MIRRORONCE:
+		if (i < 0)
+			i = -1 - i;
+		return i < size ? i : size - 1;
+	case GS_ADDRESS_BORDER:
+		return (i < 0 || i >= size) ? -1 : i;
+	case GS_ADDRESS_CLAMP:
+		break;
+	}
+
+	return i < 0 ? 0 : (i >= size ? size - 1 : i);
+}
+
+static inline void fetch(const struct sw_tex_unit *unit, int x, int y, struct vec4 *out)
+{
+	const gs_texture_t *tex = unit->tex;
+
+	x = wrap_coord(x, (int)tex->width, unit->address_u);
+	y = wrap_coord(y, (int)tex->height, unit->address_v);
+	if (x < 0 || y < 0) {
+		*out = unit->border;
+		return;
+	}
+
+	sw_load_texel(tex, x, y, out);
+
+	if (unit->srgb) {
+		out->x = srgb_decode(out->x);
+		out->y = srgb_decode(out->y);
+		out->z = srgb_decode(out->z);
+	}
+}
+
+static inline void load(const struct sw_tex_unit *unit, int x, int y, struct vec4 *out)
+{
+	if (!unit->tex) {
+		vec4_zero(out);
+		return;
+	}
+
+	x = x < 0 ? 0 : (x >= (int)unit->tex->width ? (int)unit->tex->width - 1 : x);
+	y = y < 0 ? 0 : (y >= (int)unit->tex->height ? (int)unit->tex->height - 1 : y);
+	sw_load_texel(unit->tex, x, y, out);
+}
+
+static inline void lerp(struct vec4 *dst, const struct vec4 *a, const struct vec4 *b, float t)
+{
+	struct vec4 diff;
+	vec4_sub(&diff, b, a);
+	vec4_mulf(&diff, &diff, t);
+	vec4_add(dst, a, &diff);
+}
+
+/* the common case of a bilinear tap fully inside an 8-bit texture */
+static inline bool sample_rgba8(const gs_texture_t *tex, int x, int y, float tx, float ty, struct vec4 *out)
+{
+	const uint8_t *row0 = tex->data + (size_t)y * tex->linesize + (size_t)x * 4;
+	const uint8_t *row1 = row0 + tex->linesize;
+	float w00 = (1.0f - tx) * (1.0f - ty) / 255.0f;
+	float w10 = tx * (1.0f - ty) / 255.0f;
+	float w01 = (1.0f - tx) * ty / 255.0f;
+	float w11 = tx * ty / 255.0f;
+	float c[4];
+
+	switch (tex->format) {
+	case GS_RGBA:
+	case GS_RGBA_UNORM:
+	case GS_BGRA:
+	case GS_BGRA_UNORM:
+	case GS_BGRX:
+	case GS_BGRX_UNORM:
+		break;
+	default:
+		return false;
+	}
+
+	for (size_t i = 0; i < 4; i++)
+		c[i] = row0[i] * w00 + row0[i + 4] * w10 + row1[i] * w01 + row1[i + 4] * w11;
+
+	if (tex->format == GS_RGBA || tex->format == GS_RGBA_UNORM)
+		vec4_set(out, c[0], c[1], c[2], c[3]);
+	else
+		vec4_set(out, c[2], c[1], c[0], (tex->format == GS_BGRX || tex->format == GS_BGRX_UNORM) ? 1.0f : c[3]);
+	return true;
+}
+
+static void sample(const struct sw_tex_unit *unit, float u, float v, struct vec4 *out)
+{
+	const gs_texture_t *tex = unit->tex;
+	struct vec4 t00, t10, t01, t11, top, bottom;
+	float fx, fy, tx, ty;
+	int x0, y0;
+
+	if (!tex) {
+		vec4_zero(out);
+		return;
+	}
+
+	fx = u * (float)tex->width;
+	fy = v * (float)tex->height;
+
+	if (unit->point) {
+		fetch(unit, (int)floorf(fx), (int)floorf(fy), out);
+		return;
+	}
+
+	fx -= 0.5f;
+	fy -= 0.5f;
+	x0 = (int)floorf(fx);
+	y0 = (int)floorf(fy);
+	tx = fx - (float)x0;
+	ty = fy - (float)y0;
+
+	if (!unit->srgb && x0 >= 0 && y0 >= 0 && x0 + 1 < (int)tex->width && y0 + 1 < (int)tex->height &&
+	    sample_rgba8(tex, x0, y0, tx, ty, out))
+		return;
+
+	fetch(unit, x0, y0, &t00);
+	fetch(unit, x0 + 1, y0, &t10);
+	fetch(unit, x0, y0 + 1, &t01);
+	fetch(unit, x0 + 1, y0 + 1, &t11);
+
+	lerp(&top, &t00, &t10, tx);
+	lerp(&bottom, &t01, &t11, tx);
+	lerp(out, &top, &bottom, ty);
+}
+
+/* ------------------------------------------------------------------------- */
+/* pixel programs                                                            */
+
+static inline void yuv_to_rgb(const struct sw_draw_state *d, const float *in, struct vec4 *out)
+{
+	float yuv[3];
+
+	for (size_t i = 0; i < 3; i++) {
+		float val = in[i];
+		val = val < d->range_min[i] ? d->range_min[i] : val;
+		val = val > d->range_max[i] ? d->range_max[i] : val;
+		yuv[i] = val;
+	}
+
+	for (size_t i = 0; i < 3; i++) {
+		const struct vec4 *cv = &d->color_vec[i];
+		out->ptr[i] = cv->x * yuv[0] + cv->y * yuv[1] + cv->z * yuv[2] + cv->w;
+	}
+
+	out->w = 1.0f;
+}
+
+static inline float rgb_to_yuv(const struct sw_draw_state *d, size_t i, const struct vec4 *rgb)
+{
+	const struct vec4 *cv = &d->color_vec[i];
+	return cv->x * rgb->x + cv->y * rgb->y + cv->z * rgb->z + cv->w;
+}
+
+static inline void alpha_divide(struct vec4 *c)
+{
+	float mul = c->w > 0.0f ? 1.0f / c->w : 0.0f;
+	c->x *= mul;
+	c->y *= mul;
+	c->z *= mul;
+}
+
+/* component order of the luma pair and chroma for packed 4:2:2 textures */
+static const int packed_swizzle[3][4] = {
+	{2, 0, 1, 3}, /* YUY2: y01 = zx, cbcr = yw */
+	{1, 3, 2, 0}, /* UYVY: y01 = yw, cbcr = zx */
+	{2, 0, 3, 1}, /* YVYU: y01 = zx, cbcr = wy */
+};
+
+static void shade(const struct sw_draw_state *d, int px, int py, float u, float v, const float *vcolor,
+		  struct vec4 *out)
+{
+	const struct sw_tex_unit *image = &d->images[0];
+	struct vec4 texel, chroma;
+	const int *swizzle;
+	float yuv[3];
+
+	switch (d->ps) {
+	case SW_PS_DRAW:
+		sample(image, u, v, out);
+		break;
+
+	case SW_PS_ALPHA_DIVIDE:
+		sample(image, u, v, out);
+		alpha_divide(out);
+		break;
+
+	case SW_PS_NONLINEAR_ALPHA:
+		sample(image, u, v, out);
+		for (size_t i = 0; i < 3; i++) {
+			float c = gs_srgb_linear_to_nonlinear(out->ptr[i]) * out->w;
+			out->ptr[i] = gs_srgb_nonlinear_to_linear(c);
+		}
+		break;
+
+	case SW_PS_SRGB_DECOMPRESS:
+		sample(image, u, v, out);
+		for (size_t i = 0; i < 3; i++)
+			out->ptr[i] = gs_srgb_nonlinear_to_linear(out->ptr[i]);
+		break;
+
+	case SW_PS_SOLID:
+		*out = d->color;
+		break;
+
+	case SW_PS_SOLID_COLORED:
+		vec4_set(out, vcolor[0], vcolor[1], vcolor[2], vcolor[3]);
+		vec4_mul(out, out, &d->color);
+		break;
+
+	case SW_PS_COLOR_MATRIX:
+		sample(image, u, v, &texel);
+		alpha_divide(&texel);
+		for (size_t i = 0; i < 3; i++)
+			texel.ptr[i] = powf(texel.ptr[i], d->gamma);
+		vec4_transform(out, &texel, &d->color_matrix);
+		out->x *= out->w;
+		out->y *= out->w;
+		out->z *= out->w;
+		break;
+
+	case SW_PS_TO_Y:
+		load(image, px, py, &texel);
+		vec4_set(out, rgb_to_yuv(d, 0, &texel), 0.0f, 0.0f, 1.0f);
+		break;
+
+	case SW_PS_TO_U:
+		sample(image, u, v, &texel);
+		vec4_set(out, rgb_to_yuv(d, 1, &texel), 0.0f, 0.0f, 1.0f);
+		break;
+
+	case SW_PS_TO_V:
+		sample(image, u, v, &texel);
+		vec4_set(out, rgb_to_yuv(d, 2, &texel), 0.0f, 0.0f, 1.0f);
+		break;
+
+	case SW_PS_TO_UV:
+		sample(image, u, v, &texel);
+		vec4_set(out, rgb_to_yuv(d, 1, &texel), rgb_to_yuv(d, 2, &texel), 0.0f, 1.0f);
+		break;
+
+	case SW_PS_FROM_PLANAR:
+		load(image, px, py, &texel);
+		yuv[0] = texel.x;
+		sample(&d->images[1], u, v, &chroma);
+		yuv[1] = chroma.x;
+		sample(&d->images[2], u, v, &chroma);
+		yuv[2] = chroma.x;
+		yuv_to_rgb(d, yuv, out);
+
+		if (d->ps_flags & SW_PS_ALPHA_PLANE) {
+			load(&d->images[3], px, py, &texel);
+			out->w = texel.x;
+		}
+		break;
+
+	case SW_PS_FROM_NV12:
+		load(image, px, py, &texel);
+		sample(&d->images[1], u, v, &chroma);
+		yuv[0] = texel.x;
+		yuv[1] = chroma.x;
+		yuv[2] = chroma.y;
+		yuv_to_rgb(d, yuv, out);
+		break;
+
+	case SW_PS_FROM_YUY2:
+	case SW_PS_FROM_UYVY:
+	case SW_PS_FROM_YVYU:
+		swizzle = packed_swizzle[d->ps - SW_PS_FROM_YUY2];
+		load(image, px / 2, py, &texel);
+		sample(image, u, v, &chroma);
+		yuv[0] = texel.ptr[swizzle[px & 1]];
+		yuv[1] = chroma.ptr[swizzle[2]];
+		yuv[2] = chroma.ptr[swizzle[3]];
+		yuv_to_rgb(d, yuv, out);
+		break;
+
+	case SW_PS_UNSUPPORTED:
+		/* rejected by setup_state */
+		vec4_zero(out);
+		break;
+	}
+
+	if (d->ps_flags & SW_PS_OPAQUE)
+		out->w = 1.0f;
+
+	if (d->ps_flags & SW_PS_MULTIPLY) {
+		out->x *= d->multiplier;
+		out->y *= d->multiplier;
+		out->z *= d->multiplier;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* output merger                                                             */
+
+static inline float blend_factor(enum gs_blend_type type, const struct vec4 *src, const struct vec4 *dst, size_t i)
+{
+	switch (type) {
+	case GS_BLEND_ZERO:
+		return 0.0f;
+	case GS_BLEND_ONE:
+		return 1.0f;
+	case GS_BLEND_SRCCOLOR:
+		return src->ptr[i];
+	case GS_BLEND_INVSRCCOLOR:
+		return 1.0f - src->ptr[i];
+	case GS_BLEND_SRCALPHA:
+		return src->w;
+	case GS_BLEND_INVSRCALPHA:
+		return 1.0f - src->w;
+	case GS_BLEND_DSTCOLOR:
+		return dst->ptr[i];
+	case GS_BLEND_INVDSTCOLOR:
+		return 1.0f - dst->ptr[i];
+	case GS_BLEND_DSTALPHA:
+		return dst->w;
+	case GS_BLEND_INVDSTALPHA:
+		return 1.0f - dst->w;
+	case GS_BLEND_SRCALPHASAT:
+		if (i == 3)
+			return 1.0f;
+		return src->w < 1.0f - dst->w ? src->w : 1.0f - dst->w;
+	}
+
+	return 1.0f;
+}
+
+static inline float blend_channel(const struct sw_draw_state *d, const struct vec4 *src, const struct vec4 *dst,
+				  size_t i)
+{
+	enum gs_blend_type src_type = i == 3 ? d->src_a : d->src_c;
+	enum gs_blend_type dst_type = i == 3 ? d->dst_a : d->dst_c;
+	float s = src->ptr[i];
+	float t = dst->ptr[i];
+
+	switch (d->op) {
+	case GS_BLEND_OP_SUBTRACT:
+		return s * blend_factor(src_type, src, dst, i) - t * blend_factor(dst_type, src, dst, i);
+	case GS_BLEND_OP_REVERSE_SUBTRACT:
+		return t * blend_factor(dst_type, src, dst, i) - s * blend_factor(src_type, src, dst, i);
+	case GS_BLEND_OP_MIN:
+		return s < t ? s : t;
+	case GS_BLEND_OP_MAX:
+		return s > t ? s : t;
+	case GS_BLEND_OP_ADD:
+		break;
+	}
+
+	return s * blend_factor(src_type, src, dst, i) + t * blend_factor(dst_type, src, dst, i);
+}
+
+static void output(const struct sw_draw_state *d, int x, int y, struct vec4 *src)
+{
+	struct vec4 dst, result;
+
+	if (d->blend || !d->write_all) {
+		sw_load_texel(d->target, x, y, &dst);
+		if (d->srgb_target) {
+			dst.x = srgb_decode(dst.x);
+			dst.y = srgb_decode(dst.y);
+			dst.z = srgb_decode(dst.z);
+		}
+
+		for (size_t i = 0; i < 4; i++) {
+			if (!d->write[i])
+				result.ptr[i] = dst.ptr[i];
+			else if (d->blend)
+				result.ptr[i] = blend_channel(d, src, &dst, i);
+			else
+				result.ptr[i] = src->ptr[i];
+		}
+	} else {
+		result = *src;
+	}
+
+	if (d->srgb_target) {
+		result.x = srgb_encode(result.x);
+		result.y = srgb_encode(result.y);
+		result.z = srgb_encode(result.z);
+	}
+
+	sw_store_texel(d->target, x, y, &result);
+}
+
+/* ------------------------------------------------------------------------- */
+/* rasterization                                                             */
+
+static void raster_rows(const struct sw_draw_state *d, const struct sw_triangle *t, int y_begin, int y_end)
+{
+	float attr[SW_NUM_PLANES];
+	struct vec4 color;
+
+	if (y_begin < t->y_start)
+		y_begin = t->y_start;
+	if (y_end > t->y_end)
+		y_end = t->y_end;
+
+	for (int y = y_begin; y < y_end; y++) {
+		float yc = (float)y + 0.5f;
+		float lo = (float)d->clip_x0;
+		float hi = (float)d->clip_x1;
+		bool inside = true;
+
+		/* left edges (a > 0) are inclusive, right edges exclusive, and
+		 * horizontal edges only include their top, which keeps shared
+		 * edges from being drawn twice */
+		for (size_t i = 0; i < 3; i++) {
+			const struct sw_edge *e = &t->edges[i];
+			float row = e->b * yc + e->c;
+
+			if (e->a > 0.0f) {
+				float bound = -row / e->a;
+				if (bound > lo)
+					lo = bound;
+			} else if (e->a < 0.0f) {
+				float bound = -row / e->a;
+				if (bound < hi)
+					hi = bound;
+			} else if (!(row > 0.0f || (row == 0.0f && e->b > 0.0f))) {
+				inside = false;
+			}
+		}
+
+		if (!inside)
+			continue;
+
+		int x_start = (int)ceilf(lo - 0.5f);
+		int x_end = (int)ceilf(hi - 0.5f);
+		if (x_start < d->clip_x0)
+			x_start = d->clip_x0;
+		if (x_end > d->clip_x1)
+			x_end = d->clip_x1;
+		if (x_start >= x_end)
+			continue;
+
+		float xc = (float)x_start + 0.5f - t->x0;
+		float ydiff = yc - t->y0;
+		for (size_t i = 0; i < SW_NUM_PLANES; i++)
+			attr[i] = t->f0[i] + t->dy[i] * ydiff + t->dx[i] * xc;
+
+		for (int x = x_start; x < x_end; x++) {
+			float w = d->perspective ? 1.0f / attr[SW_PLANE_Q] : 1.0f;
+			float vcolor[4];
+
+			for (size_t i = 0; i < 4; i++)
+				vcolor[i] = attr[SW_PLANE_COLOR + i] * w;
+
+			shade(d, x, y, attr[SW_PLANE_U] * w, attr[SW_PLANE_V] * w, vcolor, &color);
+			output(d, x, y, &color);
+
+			for (size_t i = 0; i < SW_NUM_PLANES; i++)
+				attr[i] += t->dx[i];
+		}
+	}
+}
+
+static void raster_band(const struct sw_draw_state *d, long band)
+{
+	int y_begin = d->clip_y0 + (int)band * SW_BAND_HEIGHT;
+	int y_end = y_begin + SW_BAND_HEIGHT;
+	if (y_end > d->clip_y1)
+		y_end = d->clip_y1;
+
+	/* every band walks the triangles in order, so overlapping triangles
+	 * still blend in submission order */
+	for (size_t i = 0; i < d->num_triangles; i++) {
+		const struct sw_triangle *t = d->triangles + i;
+		if (t->y_start < y_end && t->y_end > y_begin)
+			raster_rows(d, t, y_begin, y_end);
+	}
+}
+
+static void run_bands(struct sw_draw_state *d)
+{
+	long band;
+
+	while ((band = os_atomic_inc_long(&d->next_band) - 1) < d->num_bands)
+		raster_band(d, band);
+}
+
+/* ------------------------------------------------------------------------- */
+/* worker pool                                                               */
+
+static void *worker_thread(void *data)
+{
+	struct sw_workers *workers = data;
+
+	os_set_thread_name("libobs-software: raster worker");
+
+	for (;;) {
+		os_sem_wait(workers->start_sem);
+		if (workers->stop)
+			break;
+
+		run_bands(workers->job);
+		os_sem_post(workers->done_sem);
+	}
+
+	return NULL;
+}
+
+struct sw_workers *sw_workers_create(void)
+{
+	struct sw_workers *workers = bzalloc(sizeof(struct sw_workers));
+	int threads = os_get_logical_cores() - 1;
+
+	pthread_once(&tables_once, init_tables);
+
+	if (threads > SW_MAX_WORKERS)
+		threads = SW_MAX_WORKERS;
+
+	if (threads <= 0 || os_sem_init(&workers->start_sem, 0) != 0)
+		return workers;
+	if (os_sem_init(&workers->done_sem, 0) != 0) {
+		os_sem_destroy(workers->start_sem);
+		workers->start_sem = NULL;
+		return workers;
+	}
+
+	for (int i = 0; i < threads; i++) {
+		if (pthread_create(&workers->threads[workers->count], NULL, worker_thread, workers) != 0)
+			break;
+		workers->count++;
+	}
+
+	return workers;
+}
+
+void sw_workers_destroy(struct sw_workers *workers)
+{
+	if (!workers)
+		return;
+
+	workers->stop = true;
+	for (size_t i = 0; i < workers->count; i++)
+		os_sem_post(workers->start_sem);
+	for (size_t i = 0; i < workers->count; i++)
+		pthread_join(workers->threads[i], NULL);
+
+	os_sem_destroy(workers->start_sem);
+	os_sem_destroy(workers->done_sem);
+	da_free(workers->triangles);
+	bfree(workers);
+}
+
+size_t sw_workers_count(const struct sw_workers *workers)
+{
+	return workers ? workers->count : 0;
+}
+
+static void workers_run(struct sw_workers *workers, struct sw_draw_state *d, uint64_t pixels)
+{
+	size_t wake = workers->count;
+
+	d->next_band = 0;
+
+	if (!wake || pixels < SW_INLINE_PIXELS || d->num_bands < 2) {
+		run_bands(d);
+		return;
+	}
+
+	if ((size_t)d->num_bands - 1 < wake)
+		wake = (size_t)d->num_bands - 1;
+
+	workers->job = d;
+	for (size_t i = 0; i < wake; i++)
+		os_sem_post(workers->start_sem);
+
+	run_bands(d);
+
+	for (size_t i = 0; i < wake; i++)
+		os_sem_wait(workers->done_sem);
+	workers->job = NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/* triangle setup                                                            */
+
+struct sw_vertex {
+	float x, y;
+	float attr[SW_NUM_PLANES];
+};
+
+static inline bool vertex_less(const struct sw_vertex *a, const struct sw_vertex *b)
+{
+	return a->x < b->x || (a->x == b->x && a->y < b->y);
+}
+
+/* edges are always computed from the same endpoint order so that triangles
+ * sharing an edge see bit-identical bounds */
+static void make_edge(struct sw_edge *e, const struct sw_vertex *va, const struct sw_vertex *vb)
+{
+	bool swap = vertex_less(vb, va);
+	const struct sw_vertex *p = swap ? vb : va;
+	const struct sw_vertex *q = swap ? va : vb;
+
+	e->a = p->y - q->y;
+	e->b = q->x - p->x;
+	e->c = -e->a * p->x - e->b * p->y;
+
+	if (swap) {
+		e->a = -e->a;
+		e->b = -e->b;
+		e->c = -e->c;
+	}
+}
+
+static bool setup_triangle(const struct sw_draw_state *d, enum gs_cull_mode cull, const struct sw_vertex *v0,
+			   const struct sw_vertex *v1, const struct sw_vertex *v2, struct sw_triangle *t,
+			   uint64_t *pixels)
+{
+	float cross = (v1->x - v0->x) * (v2->y - v0->y) - (v2->x - v0->x) * (v1->y - v0->y);
+	float min_x, max_x, min_y, max_y;
+
+	if (cross == 0.0f || !isfinite(cross))
+		return false;
+
+	/* positive area is clockwise on screen, which with counter-clockwise
+	 * front faces is a back face */
+	if ((cull == GS_BACK && cross > 0.0f) || (cull == GS_FRONT && cross < 0.0f))
+		return false;
+
+	if (cross < 0.0f) {
+		const struct sw_vertex *tmp = v1;
+		v1 = v2;
+		v2 = tmp;
+		cross = -cross;
+	}
+
+	make_edge(&t->edges[0], v0, v1);
+	make_edge(&t->edges[1], v1, v2);
+	make_edge(&t->edges[2], v2, v0);
+
+	min_x = fminf(v0->x, fminf(v1->x, v2->x));
+	max_x = fmaxf(v0->x, fmaxf(v1->x, v2->x));
+	min_y = fminf(v0->y, fminf(v1->y, v2->y));
+	max_y = fmaxf(v0->y, fmaxf(v1->y, v2->y));
+
+	if (max_x <= (float)d->clip_x0 || min_x >= (float)d->clip_x1)
+		return false;
+
+	t->y_start = (int)fmaxf(ceilf(min_y - 0.5f), (float)d->clip_y0);
+	t->y_end = (int)fminf(ceilf(max_y - 0.5f), (float)d->clip_y1);
+	if (t->y_start >= t->y_end)
+		return false;
+
+	t->x0 = v0->x;
+	t->y0 = v0->y;
+
+	float x1 = v1->x - v0->x, y1 = v1->y - v0->y;
+	float x2 = v2->x - v0->x, y2 = v2->y - v0->y;
+	for (size_t i = 0; i < SW_NUM_PLANES; i++) {
+		float f1 = v1->attr[i] - v0->attr[i];
+		float f2 = v2->attr[i] - v0->attr[i];
+
+		t->f0[i] = v0->attr[i];
+		t->dx[i] = (f1 * y2 - f2 * y1) / cross;
+		t->dy[i] = (f2 * x1 - f1 * x2) / cross;
+	}
+
+	float w = fminf(max_x, (float)d->clip_x1) - fmaxf(min_x, (float)d->clip_x0);
+	*pixels += (uint64_t)((double)w * (double)(t->y_end - t->y_start) * 0.5);
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* vertex programs                                                           */
+
+struct sw_vertex_input {
+	enum sw_vertex_program program;
+	const struct gs_vb_data *vb;
+	struct matrix4 viewproj;
+	struct vec2 mul_val;
+	struct vec2 add_val;
+	struct vec2 scale;
+
+	float vp_x, vp_y, vp_w, vp_h;
+	bool perspective;
+};
+
+static bool process_vertex(struct sw_vertex_input *in, uint32_t idx, struct sw_vertex *out)
+{
+	struct vec4 pos;
+	float u = 0.0f, v = 0.0f;
+	struct vec4 color;
+
+	vec4_set(&color, 1.0f, 1.0f, 1.0f, 1.0f);
+
+	if (in->program == SW_VS_FULLSCREEN) {
+		/* the vertex id triangle from format_conversion.effect */
+		float id_high = (float)(idx >> 1);
+		float id_low = (float)(idx & 1);
+
+		vec4_set(&pos, id_high * 4.0f - 1.0f, id_low * 4.0f - 1.0f, 0.0f, 1.0f);
+		u = id_high * 2.0f;
+		v = 1.0f - id_low * 2.0f;
+
+	} else {
+		const struct gs_vb_data *vb = in->vb;
+		if (!vb || idx >= vb->num)
+			return false;
+
+		vec4_from_vec3(&pos, &vb->points[idx]);
+		pos.w = 1.0f;
+		vec4_transform(&pos, &pos, &in->viewproj);
+
+		if (vb->num_tex && vb->tvarray[0].array && vb->tvarray[0].width >= 2) {
+			const float *uv = (const float *)vb->tvarray[0].array + idx * vb->tvarray[0].width;
+			u = uv[0];
+			v = uv[1];
+
+			/* batched solid sprites pass their color as a float4
+			 * texture coordinate */
+			if (vb->tvarray[0].width == 4)
+				vec4_set(&color, uv[0], uv[1], uv[2], uv[3]);
+		}
+
+		if (vb->colors)
+			vec4_from_rgba(&color, vb->colors[idx]);
+
+		if (in->program == SW_VS_CROP) {
+			u = u * in->mul_val.x + in->add_val.x;
+			v = v * in->mul_val.y + in->add_val.y;
+		} else if (in->program == SW_VS_REPEAT) {
+			u *= in->scale.x;
+			v *= in->scale.y;
+		}
+	}
+
+	/* no near plane clipping; triangles crossing it are dropped */
+	if (pos.w <= 1e-6f)
+		return false;
+
+	float q = 1.0f / pos.w;
+	if (pos.w != 1.0f)
+		in->perspective = true;
+
+	out->x = (pos.x * q * 0.5f + 0.5f) * in->vp_w + in->vp_x;
+	out->y = (0.5f - pos.y * q * 0.5f) * in->vp_h + in->vp_y;
+	out->attr[SW_PLANE_Q] = q;
+	out->attr[SW_PLANE_U] = u * q;
+	out->attr[SW_PLANE_V] = v * q;
+	for (size_t i = 0; i < 4; i++)
+		out->attr[SW_PLANE_COLOR + i] = color.ptr[i] * q;
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* draw state                                                                */
+
+static inline bool read_param(gs_shader_t *shader, const char *name, void *dst, size_t size)
+{
+	gs_sparam_t *param = sw_shader_param(shader, name);
+	if (!param || param->cur_value.num < size)
+		return false;
+
+	memcpy(dst, param->cur_value.array, size);
+	return true;
+}
+
+static void setup_unit(gs_device_t *device, gs_shader_t *shader, const char *name, struct sw_tex_unit *unit)
+{
+	gs_sparam_t *param = sw_shader_param(shader, name);
+	const gs_samplerstate_t *sampler = NULL;
+	enum gs_sample_filter filter;
+
+	memset(unit, 0, sizeof(*unit));
+	if (!param || !param->texture)
+		return;
+
+	if (param->next_sampler)
+		sampler = param->next_sampler;
+	else if (shader->samplers.num)
+		sampler = shader->samplers.array[0];
+	else
+		sampler = device->default_sampler;
+
+	filter = sampler->info.filter;
+	unit->tex = param->texture;
+	unit->address_u = sampler->info.address_u;
+	unit->address_v = sampler->info.address_v;
+	unit->border = sampler->border_color;
+	unit->point = filter == GS_FILTER_POINT || filter == GS_FILTER_MIN_MAG_POINT_MIP_LINEAR ||
+		      filter == GS_FILTER_MIN_LINEAR_MAG_MIP_POINT ||
+		      filter == GS_FILTER_MIN_LINEAR_MAG_POINT_MIP_LINEAR;
+	unit->srgb = param->srgb && gs_is_srgb_format(param->texture->format);
+}
+
+static bool setup_state(gs_device_t *device, gs_texture_t *target, struct sw_draw_state *d)
+{
+	gs_shader_t *ps = device->cur_pixel_shader;
+	struct gs_rect *vp = &device->cur_viewport;
+	float vec3_val[3];
+
+	if (ps->pixel_program == SW_PS_UNSUPPORTED) {
+		if (!ps->warned_unsupported) {
+			blog(LOG_ERROR, "Software renderer: cannot draw with unsupported pixel shader %s, skipping",
+			     ps->name ? ps->name : "(unknown)");
+			ps->warned_unsupported = true;
+		}
+		return false;
+	}
+
+	memset(d, 0, sizeof(*d));
+	d->target = target;
+
+	d->clip_x0 = vp->x > 0 ? vp->x : 0;
+	d->clip_y0 = vp->y > 0 ? vp->y : 0;
+	d->clip_x1 = vp->x + vp->cx;
+	d->clip_y1 = vp->y + vp->cy;
+
+	if (device->scissor_enabled) {
+		struct gs_rect *sc = &device->cur_scissor;
+		if (sc->x > d->clip_x0)
+			d->clip_x0 = sc->x;
+		if (sc->y > d->clip_y0)
+			d->clip_y0 = sc->y;
+		if (sc->x + sc->cx < d->clip_x1)
+			d->clip_x1 = sc->x + sc->cx;
+		if (sc->y + sc->cy < d->clip_y1)
+			d->clip_y1 = sc->y + sc->cy;
+	}
+
+	if (d->clip_x1 > (int)target->width)
+		d->clip_x1 = (int)target->width;
+	if (d->clip_y1 > (int)target->height)
+		d->clip_y1 = (int)target->height;
+	if (d->clip_x0 >= d->clip_x1 || d->clip_y0 >= d->clip_y1)
+		return false;
+
+	d->blend = device->blend_enabled;
+	d->src_c = device->blend_src_c;
+	d->dst_c = device->blend_dst_c;
+	d->src_a = device->blend_src_a;
+	d->dst_a = device->blend_dst_a;
+	d->op = device->blend_op;
+	d->write[0] = device->write_red;
+	d->write[1] = device->write_green;
+	d->write[2] = device->write_blue;
+	d->write[3] = device->write_alpha;
+	d->write_all = d->write[0] && d->write[1] && d->write[2] && d->write[3];
+	d->srgb_target = device->framebuffer_srgb && gs_is_srgb_format(target->format);
+
+	if (!d->write[0] && !d->write[1] && !d->write[2] && !d->write[3])
+		return false;
+
+	d->ps = ps->pixel_program;
+	d->ps_flags = ps->pixel_flags;
+
+	setup_unit(device, ps, "image", &d->images[0]);
+	setup_unit(device, ps, "image1", &d->images[1]);
+	setup_unit(device, ps, "image2", &d->images[2]);
+	setup_unit(device, ps, "image3", &d->images[3]);
+
+	vec4_set(&d->color, 1.0f, 1.0f, 1.0f, 1.0f);
+	read_param(ps, "color", &d->color, sizeof(d->color));
+
+	d->multiplier = 1.0f;
+	read_param(ps, "multiplier", &d->multiplier, sizeof(float));
+
+	d->gamma = 1.0f;
+	read_param(ps, "gamma", &d->gamma, sizeof(float));
+
+	matrix4_identity(&d->color_matrix);
+	read_param(ps, "color_matrix", &d->color_matrix, sizeof(struct matrix4));
+
+	read_param(ps, "color_vec0", &d->color_vec[0], sizeof(struct vec4));
+	read_param(ps, "color_vec1", &d->color_vec[1], sizeof(struct vec4));
+	read_param(ps, "color_vec2", &d->color_vec[2], sizeof(struct vec4));
+
+	for (size_t i = 0; i < 3; i++) {
+		d->range_min[i] = 0.0f;
+		d->range_max[i] = 1.0f;
+	}
+	if (read_param(ps, "color_range_min", vec3_val, sizeof(vec3_val)))
+		memcpy(d->range_min, vec3_val, sizeof(vec3_val));
+	if (read_param(ps, "color_range_max", vec3_val, sizeof(vec3_val)))
+		memcpy(d->range_max, vec3_val, sizeof(vec3_val));
+
+	return true;
+}
+
+static void setup_vertex_input(gs_device_t *device, struct sw_vertex_input *in)
+{
+	gs_shader_t *vs = device->cur_vertex_shader;
+	struct matrix4 viewproj;
+
+	memset(in, 0, sizeof(*in));
+	in->program = vs->vertex_program;
+	in->vb = device->cur_vertex_buffer ? device->cur_vertex_buffer->data : NULL;
+
+	/* parameters are stored transposed, the same as the d3d11 backend */
+	if (vs->viewproj && read_param(vs, "ViewProj", &viewproj, sizeof(viewproj)))
+		matrix4_transpose(&in->viewproj, &viewproj);
+	else
+		matrix4_copy(&in->viewproj, &device->cur_viewproj);
+
+	vec2_set(&in->mul_val, 1.0f, 1.0f);
+	vec2_zero(&in->add_val);
+	vec2_set(&in->scale, 1.0f, 1.0f);
+	read_param(vs, "mul_val", &in->mul_val, sizeof(struct vec2));
+	read_param(vs, "add_val", &in->add_val, sizeof(struct vec2));
+	read_param(vs, "scale", &in->scale, sizeof(struct vec2));
+
+	in->vp_x = (float)device->cur_viewport.x;
+	in->vp_y = (float)device->cur_viewport.y;
+	in->vp_w = (float)device->cur_viewport.cx;
+	in->vp_h = (float)device->cur_viewport.cy;
+}
+
+static inline uint32_t get_index(const gs_indexbuffer_t *ib, uint32_t i)
+{
+	if (!ib)
+		return i;
+
+	if (i >= ib->num)
+		return UINT32_MAX;
+
+	return ib->type == GS_UNSIGNED_LONG ? ((const uint32_t *)ib->data)[i] : ((const uint16_t *)ib->data)[i];
+}
+
+void sw_draw(gs_device_t *device, gs_texture_t *target, enum gs_draw_mode draw_mode, uint32_t start_vert,
+	     uint32_t num_verts)
+{
+	struct sw_workers *workers = device->workers;
+	gs_indexbuffer_t *ib = device->cur_index_buffer;
+	struct sw_vertex_input in;
+	struct sw_draw_state d;
+	struct sw_vertex verts[3];
+	uint64_t pixels = 0;
+	uint32_t num_tris = 0;
+
+	if (draw_mode != GS_TRIS && draw_mode != GS_TRISTRIP) {
+		if (!device->warned_lines) {
+			blog(LOG_WARNING, "Software renderer: points and lines are not rasterized");
+			device->warned_lines = true;
+		}
+		return;
+	}
+
+	if (!setup_state(device, target, &d))
+		return;
+
+	setup_vertex_input(device, &in);
+
+	if (draw_mode == GS_TRIS)
+		num_tris = num_verts / 3;
+	else if (num_verts >= 3)
+		num_tris = num_verts - 2;
+
+	workers->triangles.num = 0;
+	da_reserve(workers->triangles, num_tris);
+
+	for (uint32_t i = 0; i < num_tris; i++) {
+		uint32_t first = draw_mode == GS_TRIS ? start_vert + i * 3 : start_vert + i;
+		uint32_t order[3] = {0, 1, 2};
+		bool valid = true;
+
+		/* odd strip triangles are reversed to keep their winding */
+		if (draw_mode == GS_TRISTRIP && (i & 1)) {
+			order[0] = 1;
+			order[1] = 0;
+		}
+
+		for (size_t j = 0; j < 3 && valid; j++) {
+			uint32_t idx = get_index(ib, first + order[j]);
+			valid = idx != UINT32_MAX && process_vertex(&in, idx, &verts[j]);
+		}
+
+		if (!valid)
+			continue;
+
+		struct sw_triangle *t = da_push_back_new(workers->triangles);
+		if (!setup_triangle(&d, device->cur_cull_mode, &verts[0], &verts[1], &verts[2], t, &pixels))
+			workers->triangles.num--;
+	}
+
+	if (!workers->triangles.num)
+		return;
+
+	d.perspective = in.perspective;
+	d.triangles = workers->triangles.array;
+	d.num_triangles = workers->triangles.num;
+	d.num_bands = (d.clip_y1 - d.clip_y0 + SW_BAND_HEIGHT - 1) / SW_BAND_HEIGHT;
+
+	workers_run(workers, &d, pixels);
+}
+
+void sw_clear(gs_texture_t *target, const struct vec4 *color, bool srgb)
+{
+	struct vec4 c = *color;
+	size_t row_size = (size_t)target->linesize;
+
+	if (srgb && gs_is_srgb_format(target->format)) {
+		c.x = srgb_encode(c.x);
+		c.y = srgb_encode(c.y);
+		c.z = srgb_encode(c.z);
+	}
+
+	/* encode a single pixel, then replicate it */
+	sw_store_texel(target, 0, 0, &c);
+	for (uint32_t x = 1; x < target->width; x++)
+		memcpy(target->data + x * target->bpp, target->data, target->bpp);
+	for (uint32_t y = 1; y < target->height; y++)
+		memcpy(target->data + y * row_size, target->data, row_size);
+}
@@ -0,0 +1,480 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <assert.h>
+
+#include <util/dstr.h>
+#include <graphics/shader-parser.h>
+#include <graphics/vec2.h>
+#include <graphics/vec3.h>
+#include <graphics/matrix3.h>
+
+#include "sw-subsystem.h"
+
+static inline void shader_param_free(struct gs_shader_param *param)
+{
+	bfree(param->name);
+	da_free(param->cur_value);
+	da_free(param->def_value);
+}
+
+/* ------------------------------------------------------------------------- */
+/* kernels, keyed by effect file and technique                               */
+
+#define MUL SW_PS_MULTIPLY
+#define OPAQUE SW_PS_OPAQUE
+#define ALPHA SW_PS_ALPHA_PLANE
+
+struct sw_vertex_kernel {
+	const char *effect;
+	enum sw_vertex_program program;
+};
+
+struct sw_pixel_kernel {
+	const char *effect;
+	const char *technique;
+	enum sw_pixel_program program;
+	uint32_t flags;
+};
+
+static const struct sw_vertex_kernel vertex_kernels[] = {
+	{"crop_filter.effect", SW_VS_CROP},
+	{"repeat.effect", SW_VS_REPEAT},
+	{"format_conversion.effect", SW_VS_FULLSCREEN},
+};
+
+/* techniques missing from this list (tonemapping, PQ/HLG, 10/12-bit
+ * formats, deinterlacing, other filters) have no kernel */
+static const struct sw_pixel_kernel pixel_kernels[] = {
+	{"default.effect", "Draw", SW_PS_DRAW, 0},
+	{"default.effect", "DrawMultiply", SW_PS_DRAW, MUL},
+	{"default.effect", "DrawAlphaDivide", SW_PS_ALPHA_DIVIDE, 0},
+	{"default.effect", "DrawNonlinearAlpha", SW_PS_NONLINEAR_ALPHA, 0},
+	{"default.effect", "DrawNonlinearAlphaMultiply", SW_PS_NONLINEAR_ALPHA, MUL},
+	{"default.effect", "DrawSrgbDecompress", SW_PS_SRGB_DECOMPRESS, 0},
+	{"default.effect", "DrawSrgbDecompressMultiply", SW_PS_SRGB_DECOMPRESS, MUL},
+
+	{"default_rect.effect", "Draw", SW_PS_DRAW, 0},
+	{"default_rect.effect", "DrawOpaque", SW_PS_DRAW, OPAQUE},
+	{"default_rect.effect", "DrawSrgbDecompress", SW_PS_SRGB_DECOMPRESS, 0},
+
+	{"opaque.effect", "Draw", SW_PS_DRAW, OPAQUE},
+	{"opaque.effect", "DrawMultiply", SW_PS_DRAW, OPAQUE | MUL},
+	{"opaque.effect", "DrawSrgbDecompress", SW_PS_SRGB_DECOMPRESS, OPAQUE},
+	{"opaque.effect", "DrawSrgbDecompressMultiply", SW_PS_SRGB_DECOMPRESS, OPAQUE | MUL},
+
+	{"premultiplied_alpha.effect", "Draw", SW_PS_ALPHA_DIVIDE, 0},
+	{"repeat.effect", "Draw", SW_PS_DRAW, 0},
+
+	{"solid.effect", "Solid", SW_PS_SOLID, 0},
+	{"solid.effect", "SolidColored", SW_PS_SOLID_COLORED, 0},
+	{"solid.effect", "SolidBatch", SW_PS_SOLID_COLORED, 0},
+
+	/* the scalers are sampled bilinearly */
+	{"area.effect", "Draw", SW_PS_DRAW, 0},
+	{"area.effect", "DrawMultiply", SW_PS_DRAW, MUL},
+	{"area.effect", "DrawUpscale", SW_PS_DRAW, 0},
+	{"area.effect", "DrawUpscaleMultiply", SW_PS_DRAW, MUL},
+	{"bicubic_scale.effect", "Draw", SW_PS_DRAW, 0},
+	{"bicubic_scale.effect", "DrawMultiply", SW_PS_DRAW, MUL},
+	{"bicubic_scale.effect", "DrawUndistort", SW_PS_DRAW, 0},
+	{"bicubic_scale.effect", "DrawUndistortMultiply", SW_PS_DRAW, MUL},
+	{"lanczos_scale.effect", "Draw", SW_PS_DRAW, 0},
+	{"lanczos_scale.effect", "DrawMultiply", SW_PS_DRAW, MUL},
+	{"lanczos_scale.effect", "DrawUndistort", SW_PS_DRAW, 0},
+	{"lanczos_scale.effect", "DrawUndistortMultiply", SW_PS_DRAW, MUL},
+	{"bilinear_lowres_scale.effect", "Draw", SW_PS_DRAW, 0},
+	{"bilinear_lowres_scale.effect", "DrawMultiply", SW_PS_DRAW, MUL},
+
+	{"format_conversion.effect", "Planar_Y", SW_PS_TO_Y, 0},
+	{"format_conversion.effect", "Planar_U", SW_PS_TO_U, 0},
+	{"format_conversion.effect", "Planar_V", SW_PS_TO_V, 0},
+	{"format_conversion.effect", "Planar_U_Left", SW_PS_TO_U, 0},
+	{"format_conversion.effect", "Planar_V_Left", SW_PS_TO_V, 0},
+	{"format_conversion.effect", "NV12_Y", SW_PS_TO_Y, 0},
+	{"format_conversion.effect", "NV12_UV", SW_PS_TO_UV, 0},
+	{"format_conversion.effect", "UYVY_Reverse", SW_PS_FROM_UYVY, 0},
+	{"format_conversion.effect", "YUY2_Reverse", SW_PS_FROM_YUY2, 0},
+	{"format_conversion.effect", "YVYU_Reverse", SW_PS_FROM_YVYU, 0},
+	{"format_conversion.effect", "I420_Reverse", SW_PS_FROM_PLANAR, 0},
+	{"format_conversion.effect", "I40A_Reverse", SW_PS_FROM_PLANAR, ALPHA},
+	{"format_conversion.effect", "I422_Reverse", SW_PS_FROM_PLANAR, 0},
+	{"format_conversion.effect", "I42A_Reverse", SW_PS_FROM_PLANAR, ALPHA},
+	{"format_conversion.effect", "I444_Reverse", SW_PS_FROM_PLANAR, 0},
+	{"format_conversion.effect", "YUVA_Reverse", SW_PS_FROM_PLANAR, ALPHA},
+	{"format_conversion.effect", "NV12_Reverse", SW_PS_FROM_NV12, 0},
+
+	{"crop_filter.effect", "Draw", SW_PS_DRAW, 0},
+	{"crop_filter.effect", "DrawMultiply", SW_PS_DRAW, MUL},
+	{"color_correction_filter.effect", "Draw", SW_PS_COLOR_MATRIX, 0},
+};
+
+#undef MUL
+#undef OPAQUE
+#undef ALPHA
+
+/* the effect parser names shaders
+ * "<effect path> (<type> shader, technique <technique>, pass <pass>)" */
+static bool parse_location(const char *location, struct dstr *effect, struct dstr *technique)
+{
+	const char *tech;
+	const char *paren;
+	const char *file;
+	const char *end;
+
+	if (!location)
+		return false;
+
+	tech = strstr(location, ", technique ");
+	if (!tech)
+		return false;
+
+	/* the path itself may contain " (" */
+	paren = tech;
+	while (paren > location && strncmp(paren, " (", 2) != 0)
+		paren--;
+	if (paren == location)
+		return false;
+
+	file = paren;
+	while (file > location && file[-1] != '/' && file[-1] != '\\')
+		file--;
+
+	tech += 12;
+	end = strchr(tech, ',');
+	if (!end)
+		return false;
+
+	dstr_ncopy(effect, file, paren - file);
+	dstr_ncopy(technique, tech, end - tech);
+	return true;
+}
+
+static void classify_vertex_shader(struct gs_shader *shader, const char *effect)
+{
+	shader->vertex_program = SW_VS_DEFAULT;
+
+	for (size_t i = 0; i < sizeof(vertex_kernels) / sizeof(vertex_kernels[0]); i++) {
+		if (strcmp(vertex_kernels[i].effect, effect) == 0) {
+			shader->vertex_program = vertex_kernels[i].program;
+			break;
+		}
+	}
+}
+
+static bool classify_pixel_shader(struct gs_shader *shader, const char *effect, const char *technique)
+{
+	for (size_t i = 0; i < sizeof(pixel_kernels) / sizeof(pixel_kernels[0]); i++) {
+		const struct sw_pixel_kernel *kernel = &pixel_kernels[i];
+
+		if (strcmp(kernel->effect, effect) == 0 && strcmp(kernel->technique, technique) == 0) {
+			shader->pixel_program = kernel->program;
+			shader->pixel_flags = kernel->flags;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void add_param(struct gs_shader *shader, struct shader_var *var)
+{
+	struct gs_shader_param param = {0};
+
+	param.array_count = var->array_count;
+	param.name = bstrdup(var->name);
+	param.type = get_shader_param_type(var->type);
+
+	da_move(param.def_value, var->default_val);
+	da_copy(param.cur_value, param.def_value);
+
+	da_push_back(shader->params, &param);
+}
+
+static void add_sampler(struct gs_shader *shader, struct shader_sampler *sampler)
+{
+	gs_samplerstate_t *new_sampler;
+	struct gs_sampler_info info;
+
+	shader_sampler_convert(sampler, &info);
+	new_sampler = device_samplerstate_create(shader->device, &info);
+
+	da_push_back(shader->samplers, &new_sampler);
+}
+
+static struct gs_shader *shader_create(gs_device_t *device, enum gs_shader_type type, const char *shader_str,
+				       const char *file, char **error_string)
+{
+	struct gs_shader *shader;
+	struct shader_parser parser;
+	struct dstr effect = {0};
+	struct dstr technique = {0};
+	bool named;
+
+	shader_parser_init(&parser);
+	if (!shader_parse(&parser, shader_str, file)) {
+		char *errors = shader_parser_geterrors(&parser);
+		if (errors) {
+			blog(LOG_DEBUG, "Shader errors for %s:\n%s", file, errors);
+			if (error_string)
+				*error_string = errors;
+			else
+				bfree(errors);
+		}
+
+		shader_parser_free(&parser);
+		return NULL;
+	}
+
+	shader = bzalloc(sizeof(struct gs_shader));
+	shader->device = device;
+	shader->type = type;
+	shader->name = bstrdup(file);
+
+	for (size_t i = 0; i < parser.params.num; i++)
+		add_param(shader, parser.params.array + i);
+	for (size_t i = 0; i < parser.samplers.num; i++)
+		add_sampler(shader, parser.samplers.array + i);
+
+	shader->viewproj = gs_shader_get_param_by_name(shader, "ViewProj");
+	shader->world = gs_shader_get_param_by_name(shader, "World");
+
+	named = parse_location(file, &effect, &technique);
+
+	if (type == GS_SHADER_VERTEX) {
+		classify_vertex_shader(shader, named ? effect.array : "");
+
+	} else if (!named || !classify_pixel_shader(shader, effect.array, technique.array)) {
+		/* effects often contain techniques that are never used, so
+		 * the effect is still created, but nothing is drawn with it */
+		shader->pixel_program = SW_PS_UNSUPPORTED;
+		shader->pixel_flags = 0;
+		blog(LOG_WARNING, "Software renderer: no kernel for pixel shader %s, it is unsupported",
+		     file ? file : "(unknown)");
+	}
+
+	dstr_free(&effect);
+	dstr_free(&technique);
+	shader_parser_free(&parser);
+	return shader;
+}
+
+gs_shader_t *device_vertexshader_create(gs_device_t *device, const char *shader, const char *file, char **error_string)
+{
+	struct gs_shader *ptr;
+	ptr = shader_create(device, GS_SHADER_VERTEX, shader, file, error_string);
+	if (!ptr)
+		blog(LOG_ERROR, "device_vertexshader_create (software) failed");
+	return ptr;
+}
+
+gs_shader_t *device_pixelshader_create(gs_device_t *device, const char *shader, const char *file, char **error_string)
+{
+	struct gs_shader *ptr;
+	ptr = shader_create(device, GS_SHADER_PIXEL, shader, file, error_string);
+	if (!ptr)
+		blog(LOG_ERROR, "device_pixelshader_create (software) failed");
+	return ptr;
+}
+
+void gs_shader_destroy(gs_shader_t *shader)
+{
+	if (!shader)
+		return;
+
+	if (shader->device->cur_vertex_shader == shader)
+		shader->device->cur_vertex_shader = NULL;
+	if (shader->device->cur_pixel_shader == shader)
+		shader->device->cur_pixel_shader = NULL;
+
+	for (size_t i = 0; i < shader->samplers.num; i++)
+		gs_samplerstate_destroy(shader->samplers.array[i]);
+
+	for (size_t i = 0; i < shader->params.num; i++)
+		shader_param_free(shader->params.array + i);
+
+	da_free(shader->samplers);
+	da_free(shader->params);
+	bfree(shader->name);
+	bfree(shader);
+}
+
+gs_sparam_t *sw_shader_param(gs_shader_t *shader, const char *name)
+{
+	return shader ? gs_shader_get_param_by_name(shader, name) : NULL;
+}
+
+int gs_shader_get_num_params(const gs_shader_t *shader)
+{
+	return (int)shader->params.num;
+}
+
+gs_sparam_t *gs_shader_get_param_by_idx(gs_shader_t *shader, uint32_t param)
+{
+	assert(param < shader->params.num);
+	return shader->params.array + param;
+}
+
+gs_sparam_t *gs_shader_get_param_by_name(gs_shader_t *shader, const char *name)
+{
+	for (size_t i = 0; i < shader->params.num; i++) {
+		struct gs_shader_param *param = shader->params.array + i;
+
+		if (strcmp(param->name, name) == 0)
+			return param;
+	}
+
+	return NULL;
+}
+
+gs_sparam_t *gs_shader_get_viewproj_matrix(const gs_shader_t *shader)
+{
+	return shader->viewproj;
+}
+
+gs_sparam_t *gs_shader_get_world_matrix(const gs_shader_t *shader)
+{
+	return shader->world;
+}
+
+void gs_shader_get_param_info(const gs_sparam_t *param, struct gs_shader_param_info *info)
+{
+	info->type = param->type;
+	info->name = param->name;
+}
+
+void gs_shader_set_bool(gs_sparam_t *param, bool val)
+{
+	int int_val = val;
+	da_copy_array(param->cur_value, &int_val, sizeof(int_val));
+}
+
+void gs_shader_set_float(gs_sparam_t *param, float val)
+{
+	da_copy_array(param->cur_value, &val, sizeof(val));
+}
+
+void gs_shader_set_int(gs_sparam_t *param, int val)
+{
+	da_copy_array(param->cur_value, &val, sizeof(val));
+}
+
+void gs_shader_set_matrix3(gs_sparam_t *param, const struct matrix3 *val)
+{
+	struct matrix4 mat;
+	matrix4_from_matrix3(&mat, val);
+
+	da_copy_array(param->cur_value, &mat, sizeof(mat));
+}
+
+void gs_shader_set_matrix4(gs_sparam_t *param, const struct matrix4 *val)
+{
+	da_copy_array(param->cur_value, val, sizeof(*val));
+}
+
+void gs_shader_set_vec2(gs_sparam_t *param, const struct vec2 *val)
+{
+	da_copy_array(param->cur_value, val->ptr, sizeof(*val));
+}
+
+void gs_shader_set_vec3(gs_sparam_t *param, const struct vec3 *val)
+{
+	da_copy_array(param->cur_value, val->ptr, sizeof(float) * 3);
+}
+
+void gs_shader_set_vec4(gs_sparam_t *param, const struct vec4 *val)
+{
+	da_copy_array(param->cur_value, val->ptr, sizeof(*val));
+}
+
+void gs_shader_set_texture(gs_sparam_t *param, gs_texture_t *val)
+{
+	param->texture = val;
+}
+
+void gs_shader_set_val(gs_sparam_t *param, const void *val, size_t size)
+{
+	int count = param->array_count;
+	size_t expected_size = 0;
+	if (!count)
+		count = 1;
+
+	switch (param->type) {
+	case GS_SHADER_PARAM_FLOAT:
+		expected_size = sizeof(float);
+		break;
+	case GS_SHADER_PARAM_BOOL:
+	case GS_SHADER_PARAM_INT:
+		expected_size = sizeof(int);
+		break;
+	case GS_SHADER_PARAM_INT2:
+		expected_size = sizeof(int) * 2;
+		break;
+	case GS_SHADER_PARAM_INT3:
+		expected_size = sizeof(int) * 3;
+		break;
+	case GS_SHADER_PARAM_INT4:
+		expected_size = sizeof(int) * 4;
+		break;
+	case GS_SHADER_PARAM_VEC2:
+		expected_size = sizeof(float) * 2;
+		break;
+	case GS_SHADER_PARAM_VEC3:
+		expected_size = sizeof(float) * 3;
+		break;
+	case GS_SHADER_PARAM_VEC4:
+		expected_size = sizeof(float) * 4;
+		break;
+	case GS_SHADER_PARAM_MATRIX4X4:
+		expected_size = sizeof(float) * 4 * 4;
+		break;
+	case GS_SHADER_PARAM_TEXTURE:
+		expected_size = sizeof(struct gs_shader_texture);
+		break;
+	default:
+		expected_size = 0;
+	}
+
+	expected_size *= count;
+	if (!expected_size)
+		return;
+
+	if (expected_size != size) {
+		blog(LOG_ERROR, "gs_shader_set_val (software): Size of shader "
+				"param does not match the size of the input");
+		return;
+	}
+
+	if (param->type == GS_SHADER_PARAM_TEXTURE) {
+		struct gs_shader_texture shader_tex;
+		memcpy(&shader_tex, val, sizeof(shader_tex));
+		gs_shader_set_texture(param, shader_tex.tex);
+		param->srgb = shader_tex.srgb;
+	} else {
+		da_copy_array(param->cur_value, val, size);
+	}
+}
+
+void gs_shader_set_default(gs_sparam_t *param)
+{
+	gs_shader_set_val(param, param->def_value.array, param->def_value.num);
+}
+
+void gs_shader_set_next_sampler(gs_sparam_t *param, gs_samplerstate_t *sampler)
+{
+	param->next_sampler = sampler;
+}
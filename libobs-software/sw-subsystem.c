@@ -0,0 +1,811 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <util/platform.h>
+#include <graphics/matrix3.h>
+
+#include "sw-subsystem.h"
+
+const char *device_get_name(void)
+{
+	return "Software";
+}
+
+int device_get_type(void)
+{
+	return GS_DEVICE_SOFTWARE;
+}
+
+const char *device_preprocessor_name(void)
+{
+	return "_SOFTWARE";
+}
+
+const char *gpu_get_driver_version(void)
+{
+	return "libobs-software";
+}
+
+const char *gpu_get_renderer(void)
+{
+	return "CPU";
+}
+
+uint64_t gpu_get_dmem(void)
+{
+	return 0;
+}
+
+uint64_t gpu_get_smem(void)
+{
+	return 0;
+}
+
+int device_create(gs_device_t **p_device, uint32_t adapter)
+{
+	struct gs_device *device = bzalloc(sizeof(struct gs_device));
+	struct gs_sampler_info default_info = {0};
+
+	UNUSED_PARAMETER(adapter);
+
+	blog(LOG_INFO, "---------------------------------");
+	blog(LOG_INFO, "Initializing software renderer...");
+
+	device->workers = sw_workers_create();
+
+	default_info.filter = GS_FILTER_LINEAR;
+	default_info.address_u = GS_ADDRESS_CLAMP;
+	default_info.address_v = GS_ADDRESS_CLAMP;
+	default_info.address_w = GS_ADDRESS_CLAMP;
+	default_info.max_anisotropy = 1;
+	device->default_sampler = device_samplerstate_create(device, &default_info);
+
+	device->cur_cull_mode = GS_BACK;
+	device->blend_enabled = true;
+	device->blend_src_c = GS_BLEND_SRCALPHA;
+	device->blend_dst_c = GS_BLEND_INVSRCALPHA;
+	device->blend_src_a = GS_BLEND_ONE;
+	device->blend_dst_a = GS_BLEND_INVSRCALPHA;
+	device->blend_op = GS_BLEND_OP_ADD;
+	device->write_red = true;
+	device->write_green = true;
+	device->write_blue = true;
+	device->write_alpha = true;
+
+	matrix4_identity(&device->cur_proj);
+	matrix4_identity(&device->cur_view);
+	matrix4_identity(&device->cur_viewproj);
+
+	blog(LOG_INFO, "Software renderer loaded successfully, %zu raster worker thread(s)",
+	     sw_workers_count(device->workers) + 1);
+
+	*p_device = device;
+	return GS_SUCCESS;
+}
+
+void device_destroy(gs_device_t *device)
+{
+	if (device) {
+		gs_samplerstate_destroy(device->default_sampler);
+		sw_workers_destroy(device->workers);
+		da_free(device->proj_stack);
+		bfree(device);
+	}
+}
+
+void device_enter_context(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+void device_leave_context(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+void *device_get_device_obj(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+	return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/* swap chains                                                               */
+
+static bool swapchain_init_target(struct gs_swap_chain *swap)
+{
+	gs_texture_destroy(swap->target);
+	swap->target = NULL;
+
+	if (!swap->info.cx || !swap->info.cy)
+		return true;
+
+	swap->target = device_texture_create(swap->device, swap->info.cx, swap->info.cy, GS_BGRA, 1, NULL,
+					     GS_RENDER_TARGET);
+	return swap->target != NULL;
+}
+
+gs_swapchain_t *device_swapchain_create(gs_device_t *device, const struct gs_init_data *info)
+{
+	struct gs_swap_chain *swap = bzalloc(sizeof(struct gs_swap_chain));
+
+	/* there is nothing to present to, so the swap chain is only a
+	 * memory backed render target */
+	swap->device = device;
+	swap->info = *info;
+
+	if (!swapchain_init_target(swap)) {
+		blog(LOG_ERROR, "device_swapchain_create (software) failed");
+		bfree(swap);
+		return NULL;
+	}
+
+	return swap;
+}
+
+void gs_swapchain_destroy(gs_swapchain_t *swapchain)
+{
+	if (!swapchain)
+		return;
+
+	if (swapchain->device->cur_swap == swapchain)
+		device_load_swapchain(swapchain->device, NULL);
+
+	gs_texture_destroy(swapchain->target);
+	bfree(swapchain);
+}
+
+void device_resize(gs_device_t *device, uint32_t cx, uint32_t cy)
+{
+	struct gs_swap_chain *swap = device->cur_swap;
+
+	if (!swap) {
+		blog(LOG_WARNING, "device_resize (software): No active swap");
+		return;
+	}
+
+	swap->info.cx = cx;
+	swap->info.cy = cy;
+
+	if (!swapchain_init_target(swap))
+		blog(LOG_ERROR, "device_resize (software) failed");
+}
+
+enum gs_color_space device_get_color_space(gs_device_t *device)
+{
+	return device->cur_color_space;
+}
+
+void device_update_color_space(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+void device_get_size(const gs_device_t *device, uint32_t *cx, uint32_t *cy)
+{
+	if (device->cur_swap) {
+		*cx = device->cur_swap->info.cx;
+		*cy = device->cur_swap->info.cy;
+	} else {
+		blog(LOG_WARNING, "device_get_size (software): No active swap");
+		*cx = 0;
+		*cy = 0;
+	}
+}
+
+uint32_t device_get_width(const gs_device_t *device)
+{
+	if (device->cur_swap)
+		return device->cur_swap->info.cx;
+
+	blog(LOG_WARNING, "device_get_width (software): No active swap");
+	return 0;
+}
+
+uint32_t device_get_height(const gs_device_t *device)
+{
+	if (device->cur_swap)
+		return device->cur_swap->info.cy;
+
+	blog(LOG_WARNING, "device_get_height (software): No active swap");
+	return 0;
+}
+
+void device_load_swapchain(gs_device_t *device, gs_swapchain_t *swapchain)
+{
+	device->cur_swap = swapchain;
+}
+
+bool device_is_present_ready(gs_device_t *device)
+{
+	return device->cur_swap != NULL;
+}
+
+void device_present(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+void device_flush(gs_device_t *device)
+{
+	/* draws are complete by the time device_draw returns */
+	UNUSED_PARAMETER(device);
+}
+
+/* ------------------------------------------------------------------------- */
+/* resource binding                                                          */
+
+void device_load_vertexbuffer(gs_device_t *device, gs_vertbuffer_t *vertbuffer)
+{
+	device->cur_vertex_buffer = vertbuffer;
+}
+
+void device_load_indexbuffer(gs_device_t *device, gs_indexbuffer_t *indexbuffer)
+{
+	device->cur_index_buffer = indexbuffer;
+}
+
+void device_load_texture(gs_device_t *device, gs_texture_t *tex, int unit)
+{
+	device->cur_textures[unit] = tex;
+}
+
+void device_load_texture_srgb(gs_device_t *device, gs_texture_t *tex, int unit)
+{
+	device->cur_textures[unit] = tex;
+}
+
+void device_load_samplerstate(gs_device_t *device, gs_samplerstate_t *samplerstate, int unit)
+{
+	device->cur_samplers[unit] = samplerstate;
+}
+
+void device_load_vertexshader(gs_device_t *device, gs_shader_t *vertshader)
+{
+	if (vertshader && vertshader->type != GS_SHADER_VERTEX) {
+		blog(LOG_ERROR, "Specified shader is not a vertex shader");
+		blog(LOG_ERROR, "device_load_vertexshader (software) failed");
+		return;
+	}
+
+	device->cur_vertex_shader = vertshader;
+}
+
+void device_load_pixelshader(gs_device_t *device, gs_shader_t *pixelshader)
+{
+	if (pixelshader && pixelshader->type != GS_SHADER_PIXEL) {
+		blog(LOG_ERROR, "Specified shader is not a pixel shader");
+		blog(LOG_ERROR, "device_load_pixelshader (software) failed");
+		return;
+	}
+
+	device->cur_pixel_shader = pixelshader;
+
+	for (size_t i = 0; i < GS_MAX_TEXTURES; i++) {
+		device->cur_textures[i] = NULL;
+		device->cur_samplers[i] = pixelshader && i < pixelshader->samplers.num ? pixelshader->samplers.array[i]
+										      : NULL;
+	}
+}
+
+void device_load_default_samplerstate(gs_device_t *device, bool b_3d, int unit)
+{
+	UNUSED_PARAMETER(b_3d);
+	device->cur_samplers[unit] = device->default_sampler;
+}
+
+gs_shader_t *device_get_vertex_shader(const gs_device_t *device)
+{
+	return device->cur_vertex_shader;
+}
+
+gs_shader_t *device_get_pixel_shader(const gs_device_t *device)
+{
+	return device->cur_pixel_shader;
+}
+
+gs_texture_t *device_get_render_target(const gs_device_t *device)
+{
+	return device->cur_render_target;
+}
+
+gs_zstencil_t *device_get_zstencil_target(const gs_device_t *device)
+{
+	return device->cur_zstencil_buffer;
+}
+
+void device_set_render_target_with_color_space(gs_device_t *device, gs_texture_t *tex, gs_zstencil_t *zstencil,
+					       enum gs_color_space space)
+{
+	if (tex) {
+		if (tex->type != GS_TEXTURE_2D) {
+			blog(LOG_ERROR, "Texture is not a 2D texture");
+			goto fail;
+		}
+
+		if (!tex->is_render_target) {
+			blog(LOG_ERROR, "Texture is not a render target");
+			goto fail;
+		}
+	}
+
+	device->cur_render_target = tex;
+	device->cur_zstencil_buffer = zstencil;
+	device->cur_color_space = space;
+	return;
+
+fail:
+	blog(LOG_ERROR, "device_set_render_target (software) failed");
+}
+
+void device_set_render_target(gs_device_t *device, gs_texture_t *tex, gs_zstencil_t *zstencil)
+{
+	device_set_render_target_with_color_space(device, tex, zstencil, GS_CS_SRGB);
+}
+
+void device_set_cube_render_target(gs_device_t *device, gs_texture_t *cubetex, int side, gs_zstencil_t *zstencil)
+{
+	UNUSED_PARAMETER(side);
+	UNUSED_PARAMETER(zstencil);
+
+	if (!cubetex) {
+		device_set_render_target(device, NULL, NULL);
+		return;
+	}
+
+	blog(LOG_ERROR, "device_set_cube_render_target (software): cube textures are not supported");
+}
+
+void device_enable_framebuffer_srgb(gs_device_t *device, bool enable)
+{
+	device->framebuffer_srgb = enable;
+}
+
+bool device_framebuffer_srgb_enabled(gs_device_t *device)
+{
+	return device->framebuffer_srgb;
+}
+
+/* ------------------------------------------------------------------------- */
+/* drawing                                                                   */
+
+void device_begin_frame(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+void device_begin_scene(gs_device_t *device)
+{
+	for (size_t i = 0; i < GS_MAX_TEXTURES; i++)
+		device->cur_textures[i] = NULL;
+}
+
+void device_end_scene(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+static inline gs_texture_t *get_target(const gs_device_t *device)
+{
+	if (device->cur_render_target)
+		return device->cur_render_target;
+
+	return device->cur_swap ? device->cur_swap->target : NULL;
+}
+
+static void update_viewproj_matrix(struct gs_device *device)
+{
+	gs_shader_t *vs = device->cur_vertex_shader;
+	struct matrix4 transposed;
+
+	gs_matrix_get(&device->cur_view);
+
+	/* same conventions as the d3d11 backend: negate the Z column of the
+	 * view matrix for a right-handed coordinate system */
+	device->cur_view.x.z = -device->cur_view.x.z;
+	device->cur_view.y.z = -device->cur_view.y.z;
+	device->cur_view.z.z = -device->cur_view.z.z;
+	device->cur_view.t.z = -device->cur_view.t.z;
+
+	matrix4_mul(&device->cur_viewproj, &device->cur_view, &device->cur_proj);
+
+	if (vs->viewproj) {
+		matrix4_transpose(&transposed, &device->cur_viewproj);
+		gs_shader_set_matrix4(vs->viewproj, &transposed);
+	}
+}
+
+void device_draw(gs_device_t *device, enum gs_draw_mode draw_mode, uint32_t start_vert, uint32_t num_verts)
+{
+	gs_effect_t *effect = gs_get_effect();
+	gs_texture_t *target = get_target(device);
+
+	if (!device->cur_vertex_shader) {
+		blog(LOG_ERROR, "No vertex shader specified");
+		goto fail;
+	}
+
+	if (!device->cur_pixel_shader) {
+		blog(LOG_ERROR, "No pixel shader specified");
+		goto fail;
+	}
+
+	if (!device->cur_vertex_buffer && num_verts == 0 &&
+	    device->cur_vertex_shader->vertex_program != SW_VS_FULLSCREEN) {
+		blog(LOG_ERROR, "No vertex buffer specified");
+		goto fail;
+	}
+
+	if (!target) {
+		blog(LOG_ERROR, "No active swap chain or render target");
+		goto fail;
+	}
+
+	if (device->cur_zstencil_buffer && !device->warned_depth) {
+		blog(LOG_WARNING, "Software renderer: depth and stencil are ignored");
+		device->warned_depth = true;
+	}
+
+	if (effect)
+		gs_effect_update_params(effect);
+
+	update_viewproj_matrix(device);
+
+	if (num_verts == 0) {
+		if (device->cur_index_buffer)
+			num_verts = (uint32_t)device->cur_index_buffer->num;
+		else if (device->cur_vertex_buffer)
+			num_verts = (uint32_t)device->cur_vertex_buffer->data->num;
+	}
+
+	sw_draw(device, target, draw_mode, start_vert, num_verts);
+	return;
+
+fail:
+	blog(LOG_ERROR, "device_draw (software) failed");
+}
+
+void device_clear(gs_device_t *device, uint32_t clear_flags, const struct vec4 *color, float depth, uint8_t stencil)
+{
+	gs_texture_t *target = get_target(device);
+
+	UNUSED_PARAMETER(depth);
+	UNUSED_PARAMETER(stencil);
+
+	if ((clear_flags & GS_CLEAR_COLOR) != 0 && target)
+		sw_clear(target, color, device->framebuffer_srgb);
+}
+
+/* ------------------------------------------------------------------------- */
+/* render state                                                              */
+
+void device_set_cull_mode(gs_device_t *device, enum gs_cull_mode mode)
+{
+	device->cur_cull_mode = mode;
+}
+
+enum gs_cull_mode device_get_cull_mode(const gs_device_t *device)
+{
+	return device->cur_cull_mode;
+}
+
+void device_enable_blending(gs_device_t *device, bool enable)
+{
+	device->blend_enabled = enable;
+}
+
+void device_enable_depth_test(gs_device_t *device, bool enable)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(enable);
+}
+
+void device_enable_stencil_test(gs_device_t *device, bool enable)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(enable);
+}
+
+void device_enable_stencil_write(gs_device_t *device, bool enable)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(enable);
+}
+
+void device_enable_color(gs_device_t *device, bool red, bool green, bool blue, bool alpha)
+{
+	device->write_red = red;
+	device->write_green = green;
+	device->write_blue = blue;
+	device->write_alpha = alpha;
+}
+
+void device_blend_function(gs_device_t *device, enum gs_blend_type src, enum gs_blend_type dest)
+{
+	device_blend_function_separate(device, src, dest, src, dest);
+}
+
+void device_blend_function_separate(gs_device_t *device, enum gs_blend_type src_c, enum gs_blend_type dest_c,
+				    enum gs_blend_type src_a, enum gs_blend_type dest_a)
+{
+	device->blend_src_c = src_c;
+	device->blend_dst_c = dest_c;
+	device->blend_src_a = src_a;
+	device->blend_dst_a = dest_a;
+}
+
+void device_blend_op(gs_device_t *device, enum gs_blend_op_type op)
+{
+	device->blend_op = op;
+}
+
+void device_depth_function(gs_device_t *device, enum gs_depth_test test)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(test);
+}
+
+void device_stencil_function(gs_device_t *device, enum gs_stencil_side side, enum gs_depth_test test)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(side);
+	UNUSED_PARAMETER(test);
+}
+
+void device_stencil_op(gs_device_t *device, enum gs_stencil_side side, enum gs_stencil_op_type fail,
+		       enum gs_stencil_op_type zfail, enum gs_stencil_op_type zpass)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(side);
+	UNUSED_PARAMETER(fail);
+	UNUSED_PARAMETER(zfail);
+	UNUSED_PARAMETER(zpass);
+}
+
+void device_set_viewport(gs_device_t *device, int x, int y, int width, int height)
+{
+	device->cur_viewport.x = x;
+	device->cur_viewport.y = y;
+	device->cur_viewport.cx = width;
+	device->cur_viewport.cy = height;
+}
+
+void device_get_viewport(const gs_device_t *device, struct gs_rect *rect)
+{
+	*rect = device->cur_viewport;
+}
+
+void device_set_scissor_rect(gs_device_t *device, const struct gs_rect *rect)
+{
+	device->scissor_enabled = rect != NULL;
+	if (rect)
+		device->cur_scissor = *rect;
+}
+
+void device_ortho(gs_device_t *device, float left, float right, float top, float bottom, float near, float far)
+{
+	struct matrix4 *dst = &device->cur_proj;
+
+	float rml = right - left;
+	float bmt = bottom - top;
+	float fmn = far - near;
+
+	vec4_zero(&dst->x);
+	vec4_zero(&dst->y);
+	vec4_zero(&dst->z);
+	vec4_zero(&dst->t);
+
+	dst->x.x = 2.0f / rml;
+	dst->t.x = (left + right) / -rml;
+
+	dst->y.y = 2.0f / -bmt;
+	dst->t.y = (bottom + top) / bmt;
+
+	dst->z.z = 1.0f / fmn;
+	dst->t.z = near / -fmn;
+
+	dst->t.w = 1.0f;
+}
+
+void device_frustum(gs_device_t *device, float left, float right, float top, float bottom, float near, float far)
+{
+	struct matrix4 *dst = &device->cur_proj;
+
+	float rml = right - left;
+	float bmt = bottom - top;
+	float fmn = far - near;
+	float nearx2 = 2.0f * near;
+
+	vec4_zero(&dst->x);
+	vec4_zero(&dst->y);
+	vec4_zero(&dst->z);
+	vec4_zero(&dst->t);
+
+	dst->x.x = nearx2 / rml;
+	dst->z.x = (left + right) / -rml;
+
+	dst->y.y = nearx2 / -bmt;
+	dst->z.y = (bottom + top) / bmt;
+
+	dst->z.z = far / fmn;
+	dst->t.z = (near * far) / -fmn;
+
+	dst->z.w = 1.0f;
+}
+
+void device_projection_push(gs_device_t *device)
+{
+	da_push_back(device->proj_stack, &device->cur_proj);
+}
+
+void device_projection_pop(gs_device_t *device)
+{
+	struct matrix4 *end;
+	if (!device->proj_stack.num)
+		return;
+
+	end = da_end(device->proj_stack);
+	device->cur_proj = *end;
+	da_pop_back(device->proj_stack);
+}
+
+void device_debug_marker_begin(gs_device_t *device, const char *markername, const float color[4])
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(markername);
+	UNUSED_PARAMETER(color);
+}
+
+void device_debug_marker_end(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+}
+
+/* ------------------------------------------------------------------------- */
+/* capabilities                                                              */
+
+bool device_is_monitor_hdr(gs_device_t *device, void *monitor)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(monitor);
+	return false;
+}
+
+bool device_shared_texture_available(void)
+{
+	return false;
+}
+
+bool device_nv12_available(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+	return false;
+}
+
+bool device_p010_available(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+	return false;
+}
+
+#if defined(__linux__) || defined(__FreeBSD__) || defined(__DragonFly__)
+
+gs_texture_t *device_texture_create_from_dmabuf(gs_device_t *device, unsigned int width, unsigned int height,
+						uint32_t drm_format, enum gs_color_format color_format,
+						uint32_t n_planes, const int *fds, const uint32_t *strides,
+						const uint32_t *offsets, const uint64_t *modifiers)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(width);
+	UNUSED_PARAMETER(height);
+	UNUSED_PARAMETER(drm_format);
+	UNUSED_PARAMETER(color_format);
+	UNUSED_PARAMETER(n_planes);
+	UNUSED_PARAMETER(fds);
+	UNUSED_PARAMETER(strides);
+	UNUSED_PARAMETER(offsets);
+	UNUSED_PARAMETER(modifiers);
+	return NULL;
+}
+
+bool device_query_dmabuf_capabilities(gs_device_t *device, enum gs_dmabuf_flags *dmabuf_flags,
+				      uint32_t **drm_formats, size_t *n_formats)
+{
+	UNUSED_PARAMETER(device);
+	*dmabuf_flags = GS_DMABUF_FLAG_NONE;
+	*drm_formats = NULL;
+	*n_formats = 0;
+	return false;
+}
+
+bool device_query_dmabuf_modifiers_for_format(gs_device_t *device, uint32_t drm_format, uint64_t **modifiers,
+					      size_t *n_modifiers)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(drm_format);
+	*modifiers = NULL;
+	*n_modifiers = 0;
+	return false;
+}
+
+gs_texture_t *device_texture_create_from_pixmap(gs_device_t *device, uint32_t width, uint32_t height,
+						enum gs_color_format color_format, uint32_t target, void *pixmap)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(width);
+	UNUSED_PARAMETER(height);
+	UNUSED_PARAMETER(color_format);
+	UNUSED_PARAMETER(target);
+	UNUSED_PARAMETER(pixmap);
+	return NULL;
+}
+
+bool device_query_sync_capabilities(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+	return false;
+}
+
+gs_sync_t *device_sync_create(gs_device_t *device)
+{
+	UNUSED_PARAMETER(device);
+	return NULL;
+}
+
+gs_sync_t *device_sync_create_from_syncobj_timeline_point(gs_device_t *device, int syncobj_fd,
+							  uint64_t timeline_point)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(syncobj_fd);
+	UNUSED_PARAMETER(timeline_point);
+	return NULL;
+}
+
+void device_sync_destroy(gs_device_t *device, gs_sync_t *sync)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(sync);
+}
+
+bool device_sync_export_syncobj_timeline_point(gs_device_t *device, gs_sync_t *sync, int syncobj_fd,
+					       uint64_t timeline_point)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(sync);
+	UNUSED_PARAMETER(syncobj_fd);
+	UNUSED_PARAMETER(timeline_point);
+	return false;
+}
+
+bool device_sync_signal_syncobj_timeline_point(gs_device_t *device, int syncobj_fd, uint64_t timeline_point)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(syncobj_fd);
+	UNUSED_PARAMETER(timeline_point);
+	return false;
+}
+
+bool device_sync_wait(gs_device_t *device, gs_sync_t *sync)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(sync);
+
+	/* every draw has completed by the time it returns */
+	return true;
+}
+
+#endif
@@ -0,0 +1,243 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include <util/darray.h>
+#include <util/threading.h>
+#include <graphics/graphics.h>
+#include <graphics/device-exports.h>
+#include <graphics/matrix4.h>
+#include <graphics/vec4.h>
+
+/*
+ * Software graphics subsystem.
+ *
+ *   Implements the graphics device exports entirely on the CPU so the render
+ * pipeline can run on machines without a GPU.  Textures live in system
+ * memory in their native formats, and draws are rasterized in horizontal
+ * bands spread across a pool of worker threads.
+ *
+ *   There is no shader compiler.  Effect shaders are matched by effect file
+ * and technique to built-in kernels (see sw-shader.c) that cover the libobs
+ * effects (default, opaque, solid, repeat, premultiplied alpha, the scale
+ * filters sampled bilinearly, and the SDR paths of format_conversion).  Of
+ * the built-in filters only crop and color correction have kernels; draws
+ * with any other pixel shader are skipped.  The kernels are plain C, there
+ * are no hand-written SIMD paths.
+ */
+
+/* ------------------------------------------------------------------------- */
+/* vertex programs                                                           */
+
+enum sw_vertex_program {
+	SW_VS_DEFAULT,    /* position * ViewProj, TEXCOORD0, COLOR */
+	SW_VS_CROP,       /* like default, uv * mul_val + add_val */
+	SW_VS_REPEAT,     /* like default, uv * scale */
+	SW_VS_FULLSCREEN, /* generated from the vertex id, covers the viewport */
+};
+
+/* ------------------------------------------------------------------------- */
+/* pixel programs                                                            */
+
+enum sw_pixel_program {
+	SW_PS_DRAW,
+	SW_PS_ALPHA_DIVIDE,
+	SW_PS_NONLINEAR_ALPHA,
+	SW_PS_SRGB_DECOMPRESS,
+	SW_PS_SOLID,
+	SW_PS_SOLID_COLORED,
+	SW_PS_COLOR_MATRIX,
+
+	/* RGB to YUV, format_conversion.effect */
+	SW_PS_TO_Y,
+	SW_PS_TO_U,
+	SW_PS_TO_V,
+	SW_PS_TO_UV,
+
+	/* YUV to RGB, format_conversion.effect */
+	SW_PS_FROM_PLANAR,
+	SW_PS_FROM_NV12,
+	SW_PS_FROM_YUY2,
+	SW_PS_FROM_UYVY,
+	SW_PS_FROM_YVYU,
+
+	/* no kernel for the shader, draws using it are skipped */
+	SW_PS_UNSUPPORTED,
+};
+
+#define SW_PS_MULTIPLY (1 << 0)
+#define SW_PS_OPAQUE (1 << 1)
+#define SW_PS_ALPHA_PLANE (1 << 2)
+
+/* ------------------------------------------------------------------------- */
+
+struct gs_sampler_state {
+	gs_device_t *device;
+	struct gs_sampler_info info;
+	struct vec4 border_color;
+};
+
+struct gs_shader_param {
+	char *name;
+	enum gs_shader_param_type type;
+	int array_count;
+
+	gs_texture_t *texture;
+	bool srgb;
+	gs_samplerstate_t *next_sampler;
+
+	DARRAY(uint8_t) cur_value;
+	DARRAY(uint8_t) def_value;
+};
+
+struct gs_shader {
+	gs_device_t *device;
+	enum gs_shader_type type;
+	char *name;
+
+	DARRAY(struct gs_shader_param) params;
+	DARRAY(gs_samplerstate_t *) samplers;
+
+	gs_sparam_t *viewproj;
+	gs_sparam_t *world;
+
+	enum sw_vertex_program vertex_program;
+	enum sw_pixel_program pixel_program;
+	uint32_t pixel_flags;
+	bool warned_unsupported;
+};
+
+struct gs_texture {
+	gs_device_t *device;
+	enum gs_texture_type type;
+	enum gs_color_format format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t linesize;
+	uint32_t bpp;
+	uint8_t *data;
+
+	bool is_dynamic;
+	bool is_render_target;
+};
+
+struct gs_stage_surface {
+	gs_device_t *device;
+	enum gs_color_format format;
+	uint32_t width;
+	uint32_t height;
+	uint32_t linesize;
+	uint8_t *data;
+};
+
+struct gs_zstencil_buffer {
+	gs_device_t *device;
+	enum gs_zstencil_format format;
+	uint32_t width;
+	uint32_t height;
+};
+
+struct gs_vertex_buffer {
+	gs_device_t *device;
+	struct gs_vb_data *data;
+	bool dynamic;
+};
+
+struct gs_index_buffer {
+	gs_device_t *device;
+	enum gs_index_type type;
+	void *data;
+	size_t num;
+	size_t width;
+	bool dynamic;
+};
+
+struct gs_timer {
+	uint64_t begin;
+	uint64_t end;
+};
+
+struct gs_timer_range {
+	gs_device_t *device;
+};
+
+struct gs_swap_chain {
+	gs_device_t *device;
+	struct gs_init_data info;
+	gs_texture_t *target;
+};
+
+struct sw_workers;
+
+struct gs_device {
+	struct sw_workers *workers;
+
+	gs_texture_t *cur_render_target;
+	gs_zstencil_t *cur_zstencil_buffer;
+	gs_texture_t *cur_textures[GS_MAX_TEXTURES];
+	gs_samplerstate_t *cur_samplers[GS_MAX_TEXTURES];
+	gs_vertbuffer_t *cur_vertex_buffer;
+	gs_indexbuffer_t *cur_index_buffer;
+	gs_shader_t *cur_vertex_shader;
+	gs_shader_t *cur_pixel_shader;
+	gs_swapchain_t *cur_swap;
+	enum gs_color_space cur_color_space;
+
+	enum gs_cull_mode cur_cull_mode;
+	struct gs_rect cur_viewport;
+	struct gs_rect cur_scissor;
+	bool scissor_enabled;
+	bool framebuffer_srgb;
+
+	bool blend_enabled;
+	enum gs_blend_type blend_src_c;
+	enum gs_blend_type blend_dst_c;
+	enum gs_blend_type blend_src_a;
+	enum gs_blend_type blend_dst_a;
+	enum gs_blend_op_type blend_op;
+	bool write_red;
+	bool write_green;
+	bool write_blue;
+	bool write_alpha;
+
+	gs_samplerstate_t *default_sampler;
+
+	struct matrix4 cur_proj;
+	struct matrix4 cur_view;
+	struct matrix4 cur_viewproj;
+
+	DARRAY(struct matrix4) proj_stack;
+
+	bool warned_lines;
+	bool warned_depth;
+};
+
+/* ------------------------------------------------------------------------- */
+
+extern struct sw_workers *sw_workers_create(void);
+extern void sw_workers_destroy(struct sw_workers *workers);
+extern size_t sw_workers_count(const struct sw_workers *workers);
+
+extern void sw_draw(gs_device_t *device, gs_texture_t *target, enum gs_draw_mode draw_mode, uint32_t start_vert,
+		    uint32_t num_verts);
+extern void sw_clear(gs_texture_t *target, const struct vec4 *color, bool srgb);
+
+extern void sw_load_texel(const gs_texture_t *tex, int x, int y, struct vec4 *out);
+extern void sw_store_texel(gs_texture_t *tex, int x, int y, const struct vec4 *color);
+
+extern gs_sparam_t *sw_shader_param(gs_shader_t *shader, const char *name);
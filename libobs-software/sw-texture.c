@@ -0,0 +1,372 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include "sw-subsystem.h"
+
+/* ------------------------------------------------------------------------- */
+/* 2D textures                                                               */
+
+gs_texture_t *device_texture_create(gs_device_t *device, uint32_t width, uint32_t height,
+				    enum gs_color_format color_format, uint32_t levels, const uint8_t **data,
+				    uint32_t flags)
+{
+	struct gs_texture *tex;
+	uint32_t bpp = gs_get_format_bpp(color_format);
+
+	if (!width || !height || !bpp || gs_is_compressed_format(color_format)) {
+		blog(LOG_ERROR, "device_texture_create (software): unsupported %ux%u texture of format %d", width,
+		     height, (int)color_format);
+		return NULL;
+	}
+
+	tex = bzalloc(sizeof(struct gs_texture));
+	tex->device = device;
+	tex->type = GS_TEXTURE_2D;
+	tex->format = color_format;
+	tex->width = width;
+	tex->height = height;
+	tex->bpp = bpp / 8;
+	tex->linesize = width * tex->bpp;
+	tex->is_dynamic = (flags & GS_DYNAMIC) != 0;
+	tex->is_render_target = (flags & GS_RENDER_TARGET) != 0;
+
+	/* mip levels are never sampled, so only the base level is kept */
+	tex->data = bzalloc((size_t)tex->linesize * height);
+	if (data && *data)
+		memcpy(tex->data, *data, (size_t)tex->linesize * height);
+
+	UNUSED_PARAMETER(levels);
+	return tex;
+}
+
+gs_texture_t *device_cubetexture_create(gs_device_t *device, uint32_t size, enum gs_color_format color_format,
+					uint32_t levels, const uint8_t **data, uint32_t flags)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(size);
+	UNUSED_PARAMETER(color_format);
+	UNUSED_PARAMETER(levels);
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(flags);
+
+	blog(LOG_ERROR, "device_cubetexture_create (software): cube textures are not supported");
+	return NULL;
+}
+
+gs_texture_t *device_voltexture_create(gs_device_t *device, uint32_t width, uint32_t height, uint32_t depth,
+				       enum gs_color_format color_format, uint32_t levels, const uint8_t *const *data,
+				       uint32_t flags)
+{
+	UNUSED_PARAMETER(device);
+	UNUSED_PARAMETER(width);
+	UNUSED_PARAMETER(height);
+	UNUSED_PARAMETER(depth);
+	UNUSED_PARAMETER(color_format);
+	UNUSED_PARAMETER(levels);
+	UNUSED_PARAMETER(data);
+	UNUSED_PARAMETER(flags);
+
+	blog(LOG_ERROR, "device_voltexture_create (software): volume textures are not supported");
+	return NULL;
+}
+
+enum gs_texture_type device_get_texture_type(const gs_texture_t *texture)
+{
+	return texture->type;
+}
+
+void gs_texture_destroy(gs_texture_t *tex)
+{
+	if (!tex)
+		return;
+
+	gs_device_t *device = tex->device;
+	for (size_t i = 0; i < GS_MAX_TEXTURES; i++) {
+		if (device->cur_textures[i] == tex)
+			device->cur_textures[i] = NULL;
+	}
+
+	if (device->cur_render_target == tex)
+		device->cur_render_target = NULL;
+
+	bfree(tex->data);
+	bfree(tex);
+}
+
+uint32_t gs_texture_get_width(const gs_texture_t *tex)
+{
+	return tex->width;
+}
+
+uint32_t gs_texture_get_height(const gs_texture_t *tex)
+{
+	return tex->height;
+}
+
+enum gs_color_format gs_texture_get_color_format(const gs_texture_t *tex)
+{
+	return tex->format;
+}
+
+bool gs_texture_map(gs_texture_t *tex, uint8_t **ptr, uint32_t *linesize)
+{
+	if (!tex->is_dynamic) {
+		blog(LOG_ERROR, "Texture is not dynamic");
+		blog(LOG_ERROR, "gs_texture_map (software) failed");
+		return false;
+	}
+
+	*ptr = tex->data;
+	*linesize = tex->linesize;
+	return true;
+}
+
+void gs_texture_unmap(gs_texture_t *tex)
+{
+	UNUSED_PARAMETER(tex);
+}
+
+bool gs_texture_is_rect(const gs_texture_t *tex)
+{
+	UNUSED_PARAMETER(tex);
+	return false;
+}
+
+void *gs_texture_get_obj(gs_texture_t *tex)
+{
+	return tex->data;
+}
+
+void gs_cubetexture_destroy(gs_texture_t *cubetex)
+{
+	gs_texture_destroy(cubetex);
+}
+
+uint32_t gs_cubetexture_get_size(const gs_texture_t *cubetex)
+{
+	return cubetex->width;
+}
+
+enum gs_color_format gs_cubetexture_get_color_format(const gs_texture_t *cubetex)
+{
+	return cubetex->format;
+}
+
+void gs_voltexture_destroy(gs_texture_t *voltex)
+{
+	gs_texture_destroy(voltex);
+}
+
+uint32_t gs_voltexture_get_width(const gs_texture_t *voltex)
+{
+	return voltex->width;
+}
+
+uint32_t gs_voltexture_get_height(const gs_texture_t *voltex)
+{
+	return voltex->height;
+}
+
+uint32_t gs_voltexture_get_depth(const gs_texture_t *voltex)
+{
+	UNUSED_PARAMETER(voltex);
+	return 0;
+}
+
+enum gs_color_format gs_voltexture_get_color_format(const gs_texture_t *voltex)
+{
+	return voltex->format;
+}
+
+/* ------------------------------------------------------------------------- */
+/* staging surfaces                                                          */
+
+gs_stagesurf_t *device_stagesurface_create(gs_device_t *device, uint32_t width, uint32_t height,
+					   enum gs_color_format color_format)
+{
+	struct gs_stage_surface *surf;
+	uint32_t bpp = gs_get_format_bpp(color_format) / 8;
+
+	if (!width || !height || !bpp) {
+		blog(LOG_ERROR, "device_stagesurface_create (software) failed");
+		return NULL;
+	}
+
+	surf = bzalloc(sizeof(struct gs_stage_surface));
+	surf->device = device;
+	surf->format = color_format;
+	surf->width = width;
+	surf->height = height;
+	surf->linesize = width * bpp;
+	surf->data = bzalloc((size_t)surf->linesize * height);
+	return surf;
+}
+
+void gs_stagesurface_destroy(gs_stagesurf_t *stagesurf)
+{
+	if (!stagesurf)
+		return;
+
+	bfree(stagesurf->data);
+	bfree(stagesurf);
+}
+
+uint32_t gs_stagesurface_get_width(const gs_stagesurf_t *stagesurf)
+{
+	return stagesurf->width;
+}
+
+uint32_t gs_stagesurface_get_height(const gs_stagesurf_t *stagesurf)
+{
+	return stagesurf->height;
+}
+
+enum gs_color_format gs_stagesurface_get_color_format(const gs_stagesurf_t *stagesurf)
+{
+	return stagesurf->format;
+}
+
+bool gs_stagesurface_map(gs_stagesurf_t *stagesurf, uint8_t **data, uint32_t *linesize)
+{
+	*data = stagesurf->data;
+	*linesize = stagesurf->linesize;
+	return true;
+}
+
+void gs_stagesurface_unmap(gs_stagesurf_t *stagesurf)
+{
+	UNUSED_PARAMETER(stagesurf);
+}
+
+/* ------------------------------------------------------------------------- */
+/* depth/stencil buffers                                                     */
+
+gs_zstencil_t *device_zstencil_create(gs_device_t *device, uint32_t width, uint32_t height,
+				      enum gs_zstencil_format format)
+{
+	/* depth and stencil are not rasterized, but libobs still creates
+	 * buffers for texrenders that ask for them */
+	struct gs_zstencil_buffer *zs = bzalloc(sizeof(struct gs_zstencil_buffer));
+	zs->device = device;
+	zs->format = format;
+	zs->width = width;
+	zs->height = height;
+	return zs;
+}
+
+void gs_zstencil_destroy(gs_zstencil_t *zstencil)
+{
+	if (!zstencil)
+		return;
+
+	if (zstencil->device->cur_zstencil_buffer == zstencil)
+		zstencil->device->cur_zstencil_buffer = NULL;
+
+	bfree(zstencil);
+}
+
+/* ------------------------------------------------------------------------- */
+/* copies                                                                    */
+
+void device_copy_texture_region(gs_device_t *device, gs_texture_t *dst, uint32_t dst_x, uint32_t dst_y,
+				gs_texture_t *src, uint32_t src_x, uint32_t src_y, uint32_t src_w, uint32_t src_h)
+{
+	UNUSED_PARAMETER(device);
+
+	if (!src) {
+		blog(LOG_ERROR, "Source texture is NULL");
+		goto fail;
+	}
+
+	if (!dst) {
+		blog(LOG_ERROR, "Destination texture is NULL");
+		goto fail;
+	}
+
+	if (dst->type != GS_TEXTURE_2D || src->type != GS_TEXTURE_2D) {
+		blog(LOG_ERROR, "Source and destination textures must be 2D "
+				"textures");
+		goto fail;
+	}
+
+	if (gs_generalize_format(dst->format) != gs_generalize_format(src->format)) {
+		blog(LOG_ERROR, "Source and destination formats do not match");
+		goto fail;
+	}
+
+	uint32_t nw = src_w ? src_w : (src->width - src_x);
+	uint32_t nh = src_h ? src_h : (src->height - src_y);
+
+	if (src->width - src_x < nw || src->height - src_y < nh) {
+		blog(LOG_ERROR, "Source texture region is out of bounds");
+		goto fail;
+	}
+
+	if (dst->width - dst_x < nw || dst->height - dst_y < nh) {
+		blog(LOG_ERROR, "Destination texture region is not big "
+				"enough to hold the source region");
+		goto fail;
+	}
+
+	for (uint32_t y = 0; y < nh; y++) {
+		const uint8_t *in = src->data + (size_t)(src_y + y) * src->linesize + src_x * src->bpp;
+		uint8_t *out = dst->data + (size_t)(dst_y + y) * dst->linesize + dst_x * dst->bpp;
+		memmove(out, in, (size_t)nw * src->bpp);
+	}
+
+	return;
+
+fail:
+	blog(LOG_ERROR, "device_copy_texture (software) failed");
+}
+
+void device_copy_texture(gs_device_t *device, gs_texture_t *dst, gs_texture_t *src)
+{
+	device_copy_texture_region(device, dst, 0, 0, src, 0, 0, 0, 0);
+}
+
+void device_stage_texture(gs_device_t *device, gs_stagesurf_t *dst, gs_texture_t *src)
+{
+	UNUSED_PARAMETER(device);
+
+	if (!src || !dst) {
+		blog(LOG_ERROR, "device_stage_texture (software): NULL texture or surface");
+		return;
+	}
+
+	if (src->type != GS_TEXTURE_2D) {
+		blog(LOG_ERROR, "Source texture must be a 2D texture");
+		goto fail;
+	}
+
+	if (gs_generalize_format(dst->format) != gs_generalize_format(src->format)) {
+		blog(LOG_ERROR, "Source and destination formats do not match");
+		goto fail;
+	}
+
+	if (dst->width != src->width || dst->height != src->height) {
+		blog(LOG_ERROR, "Source and destination must have the same "
+				"dimensions");
+		goto fail;
+	}
+
+	memcpy(dst->data, src->data, (size_t)src->linesize * src->height);
+	return;
+
+fail:
+	blog(LOG_ERROR, "device_stage_texture (software) failed");
+}
@@ -1,4 +1,7 @@
+#include <math.h>
+
 #include "obs-internal.h"
+#include "util/sse-intrin.h"
 #include "pulseaudio-wrapper.h"
 
 #define PULSE_DATA(voidptr) struct audio_monitor *data = voidptr;
@@ -23,8 +26,38 @@ struct audio_monitor {
 
 	bool ignore;
 	pthread_mutex_t playback_mutex;
+
+	/* bus mode: new_data holds interleaved float frames that the bus
+	 * mixes into its stream */
+	struct monitor_bus *bus;
+	bool bus_active;
+	uint32_t max_packet_frames;
+	uint_fast64_t dropped_frames;
+	uint_fast32_t underruns;
 };
 
+/* All monitored sources of a device share one stream in bus mode.  The bus
+ * pulls from every input when the server asks for data, so the server's
+ * clock paces all of them and each input sits at the same latency. */
+struct monitor_bus {
+	pa_stream *stream;
+	char *device;
+	pa_sample_spec spec;
+	pa_buffer_attr attr;
+	size_t bytes_per_frame;
+	uint32_t prebuf_frames;
+	long refs;
+
+	DARRAY(struct audio_monitor *) inputs;
+	DARRAY(float) mix;
+	DARRAY(float) input;
+
+	uint_fast64_t frames;
+};
+
+static pthread_mutex_t bus_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct monitor_bus *) buses;
+
 static enum speaker_layout pulseaudio_channels_to_obs_speakers(uint_fast32_t channels)
 {
 	switch (channels) {
@@ -149,11 +182,16 @@ static void process_s32(void *p, size_t frames, size_t channels, float vol)
 
 static void process_float(void *p, size_t frames, size_t channels, float vol)
 {
-	register float *cur = (float *)p;
-	register float *end = cur + frames * channels;
+	float *cur = (float *)p;
+	size_t count = frames * channels;
+	size_t i = 0;
 
-	while (cur < end)
-		*(cur++) *= vol;
+	const __m128 vol_ps = _mm_set1_ps(vol);
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_ps(cur + i, _mm_mul_ps(_mm_loadu_ps(cur + i), vol_ps));
+
+	for (; i < count; i++)
+		cur[i] *= vol;
 }
 
 void process_volume(const struct audio_monitor *monitor, float vol, uint8_t *const *resample_data,
@@ -234,6 +272,7 @@ static void on_audio_playback(void *param, obs_source_t *source, const struct au
 	struct audio_monitor *monitor = param;
 	float vol = source->user_volume;
 	size_t bytes;
+	bool mixed = monitor->bus != NULL;
 
 	uint8_t *resample_data[MAX_AV_PLANES];
 	uint32_t resample_frames;
@@ -254,7 +293,8 @@ static void on_audio_playback(void *param, obs_source_t *source, const struct au
 
 	bytes = monitor->bytes_per_frame * resample_frames;
 
-	if (!close_float(vol, 1.0f, EPSILON)) {
+	/* the bus applies the volume while mixing */
+	if (!mixed && !close_float(vol, 1.0f, EPSILON)) {
 		process_volume(monitor, vol, resample_data, resample_frames);
 	}
 
@@ -262,9 +302,284 @@ static void on_audio_playback(void *param, obs_source_t *source, const struct au
 	monitor->packets++;
 	monitor->frames += resample_frames;
 
+	if (resample_frames > monitor->max_packet_frames)
+		monitor->max_packet_frames = resample_frames;
+
 unlock:
 	pthread_mutex_unlock(&monitor->playback_mutex);
-	do_stream_write(param);
+	if (!mixed)
+		do_stream_write(param);
+}
+
+/* ------------------------------------------------------------------------- */
+/* monitoring bus */
+
+static void mix_float(float *dst, const float *src, size_t count, float vol)
+{
+	size_t i = 0;
+
+	const __m128 vol_ps = _mm_set1_ps(vol);
+	for (; i + 4 <= count; i += 4) {
+		__m128 mixed = _mm_mul_ps(_mm_loadu_ps(src + i), vol_ps);
+		_mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(dst + i), mixed));
+	}
+
+	for (; i < count; i++)
+		dst[i] += src[i] * vol;
+}
+
+static inline float clamp_sample(float val)
+{
+	return val > 1.0f ? 1.0f : (val < -1.0f ? -1.0f : val);
+}
+
+static void convert_s16(int16_t *dst, const float *src, size_t count)
+{
+	size_t i = 0;
+
+	const __m128 max_ps = _mm_set1_ps(1.0f);
+	const __m128 min_ps = _mm_set1_ps(-1.0f);
+	const __m128 scale_ps = _mm_set1_ps(32767.0f);
+	for (; i + 8 <= count; i += 8) {
+		__m128 lo = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i), max_ps), min_ps);
+		__m128 hi = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(src + i + 4), max_ps), min_ps);
+		__m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(lo, scale_ps)),
+						 _mm_cvtps_epi32(_mm_mul_ps(hi, scale_ps)));
+		_mm_storeu_si128((__m128i *)(dst + i), packed);
+	}
+
+	for (; i < count; i++)
+		dst[i] = (int16_t)lrintf(clamp_sample(src[i]) * 32767.0f);
+}
+
+static void convert_mix(const struct monitor_bus *bus, void *dst, size_t frames)
+{
+	const float *src = bus->mix.array;
+	size_t count = frames * bus->spec.channels;
+
+	switch (bus->spec.format) {
+	case PA_SAMPLE_U8:
+		for (size_t i = 0; i < count; i++)
+			((uint8_t *)dst)[i] = (uint8_t)lrintf(clamp_sample(src[i]) * 127.0f + 128.0f);
+		break;
+	case PA_SAMPLE_S16LE:
+		convert_s16(dst, src, count);
+		break;
+	case PA_SAMPLE_S32LE:
+		for (size_t i = 0; i < count; i++)
+			((int32_t *)dst)[i] = (int32_t)lrint((double)clamp_sample(src[i]) * 2147483647.0);
+		break;
+	case PA_SAMPLE_FLOAT32LE:
+		memcpy(dst, src, count * sizeof(float));
+		break;
+	default:
+		memset(dst, 0, frames * bus->bytes_per_frame);
+		break;
+	}
+}
+
+static void mix_input(struct monitor_bus *bus, struct audio_monitor *input, size_t frames)
+{
+	size_t frame_size = bus->spec.channels * sizeof(float);
+	size_t wanted = frames * frame_size;
+	size_t prebuf, avail, bytes;
+
+	pthread_mutex_lock(&input->playback_mutex);
+
+	/* an input needs one packet on top of the common prebuffer to ride
+	 * out the gaps between its packets */
+	prebuf = (bus->prebuf_frames + input->max_packet_frames) * frame_size;
+	avail = input->new_data.size;
+
+	if (!input->bus_active) {
+		if (avail < prebuf)
+			goto unlock;
+		input->bus_active = true;
+	}
+
+	/* drop whatever piled up beyond that so all inputs stay in step */
+	if (avail > prebuf * 2 + wanted) {
+		size_t drop = avail - prebuf - wanted;
+		deque_pop_front(&input->new_data, NULL, drop);
+		input->dropped_frames += drop / frame_size;
+		avail -= drop;
+	}
+
+	bytes = avail < wanted ? avail : wanted;
+	da_resize(bus->input, bytes / sizeof(float));
+	deque_pop_front(&input->new_data, bus->input.array, bytes);
+
+	mix_float(bus->mix.array, bus->input.array, bytes / sizeof(float), input->source->user_volume);
+
+	if (bytes < wanted) {
+		input->bus_active = false;
+		input->underruns++;
+	}
+
+unlock:
+	pthread_mutex_unlock(&input->playback_mutex);
+}
+
+/* called from the mainloop thread with the mainloop locked */
+static void monitor_bus_write(pa_stream *stream, size_t nbytes, void *param)
+{
+	struct monitor_bus *bus = param;
+
+	while (nbytes >= bus->bytes_per_frame) {
+		void *buffer = NULL;
+		size_t bytes = nbytes;
+		size_t frames;
+
+		if (pa_stream_begin_write(stream, &buffer, &bytes) < 0 || !buffer)
+			return;
+
+		frames = bytes / bus->bytes_per_frame;
+		if (!frames) {
+			pa_stream_cancel_write(stream);
+			return;
+		}
+
+		da_resize(bus->mix, frames * bus->spec.channels);
+		memset(bus->mix.array, 0, bus->mix.num * sizeof(float));
+
+		for (size_t i = 0; i < bus->inputs.num; i++)
+			mix_input(bus, bus->inputs.array[i], frames);
+
+		bytes = frames * bus->bytes_per_frame;
+		convert_mix(bus, buffer, frames);
+		pa_stream_write(stream, buffer, bytes, NULL, 0LL, PA_SEEK_RELATIVE);
+
+		bus->frames += frames;
+		nbytes -= bytes < nbytes ? bytes : nbytes;
+	}
+}
+
+static void monitor_bus_destroy(struct monitor_bus *bus)
+{
+	if (bus->stream) {
+		pulseaudio_lock();
+		pa_stream_disconnect(bus->stream);
+		pulseaudio_unlock();
+
+		pulseaudio_write_callback(bus->stream, NULL, NULL);
+
+		pulseaudio_lock();
+		pa_stream_unref(bus->stream);
+		pulseaudio_unlock();
+
+		blog(LOG_INFO, "Stopped monitoring bus in '%s', played %" PRIuFAST64 " frames", bus->device,
+		     bus->frames);
+	}
+
+	da_free(bus->inputs);
+	da_free(bus->mix);
+	da_free(bus->input);
+	bfree(bus->device);
+	bfree(bus);
+}
+
+static struct monitor_bus *monitor_bus_create(const char *device, const pa_sample_spec *spec)
+{
+	struct monitor_bus *bus = bzalloc(sizeof(*bus));
+	bus->device = bstrdup(device);
+	bus->spec = *spec;
+	bus->bytes_per_frame = pa_frame_size(spec);
+	bus->prebuf_frames = spec->rate * 25 / 1000;
+	bus->refs = 1;
+
+	pa_channel_map channel_map = pulseaudio_channel_map(pulseaudio_channels_to_obs_speakers(spec->channels));
+
+	bus->stream = pulseaudio_stream_new("OBS Monitoring", spec, &channel_map);
+	if (!bus->stream) {
+		blog(LOG_ERROR, "Unable to create monitoring bus stream");
+		goto fail;
+	}
+
+	pulseaudio_write_callback(bus->stream, monitor_bus_write, bus);
+
+	bus->attr.fragsize = (uint32_t)-1;
+	bus->attr.maxlength = (uint32_t)-1;
+	bus->attr.minreq = (uint32_t)-1;
+	bus->attr.prebuf = (uint32_t)-1;
+	bus->attr.tlength = pa_usec_to_bytes(25000, spec);
+
+	pa_stream_flags_t flags = PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE;
+
+	if (pulseaudio_connect_playback(bus->stream, device, &bus->attr, flags) < 0) {
+		blog(LOG_ERROR, "Unable to connect monitoring bus stream");
+		goto fail;
+	}
+
+	blog(LOG_INFO, "Started monitoring bus in '%s'", device);
+	return bus;
+
+fail:
+	monitor_bus_destroy(bus);
+	return NULL;
+}
+
+static struct monitor_bus *monitor_bus_acquire(const char *device, const pa_sample_spec *spec)
+{
+	struct monitor_bus *bus = NULL;
+
+	pthread_mutex_lock(&bus_mutex);
+
+	/* buses of an old device live on until their last monitor was reset */
+	for (size_t i = 0; i < buses.num; i++) {
+		if (strcmp(buses.array[i]->device, device) == 0 && pa_sample_spec_equal(&buses.array[i]->spec, spec)) {
+			bus = buses.array[i];
+			bus->refs++;
+			break;
+		}
+	}
+
+	if (!bus) {
+		bus = monitor_bus_create(device, spec);
+		if (bus)
+			da_push_back(buses, &bus);
+	}
+
+	pthread_mutex_unlock(&bus_mutex);
+	return bus;
+}
+
+static void monitor_bus_release(struct monitor_bus *bus)
+{
+	pthread_mutex_lock(&bus_mutex);
+
+	if (--bus->refs == 0) {
+		da_erase_item(buses, &bus);
+		if (!buses.num)
+			da_free(buses);
+		monitor_bus_destroy(bus);
+	}
+
+	pthread_mutex_unlock(&bus_mutex);
+}
+
+static void monitor_bus_attach(struct audio_monitor *monitor)
+{
+	pulseaudio_lock();
+	da_push_back(monitor->bus->inputs, &monitor);
+	pulseaudio_unlock();
+}
+
+static void monitor_bus_detach(struct audio_monitor *monitor)
+{
+	struct monitor_bus *bus = monitor->bus;
+
+	pulseaudio_lock();
+	da_erase_item(bus->inputs, &monitor);
+	pulseaudio_unlock();
+
+	blog(LOG_INFO,
+	     "Stopped mixed monitoring of '%s': %" PRIuFAST32 " packets with %" PRIuFAST64 " frames, %" PRIuFAST64
+	     " frames dropped, %" PRIuFAST32 " underruns",
+	     obs_source_get_name(monitor->source), monitor->packets, monitor->frames, monitor->dropped_frames,
+	     monitor->underruns);
+
+	monitor_bus_release(bus);
+	monitor->bus = NULL;
 }
 
 static void pulseaudio_server_info(pa_context *c, const pa_server_info *i, void *userdata)
@@ -404,13 +719,15 @@ static bool audio_monitor_init(struct audio_monitor *monitor, obs_source_t *sour
 	}
 
 	const struct audio_output_info *info = audio_output_get_info(obs->audio.audio);
+	bool mixed = obs->audio.monitoring_bus;
+	enum audio_format format = mixed ? AUDIO_FORMAT_FLOAT : pulseaudio_to_obs_audio_format(monitor->format);
 
 	struct resample_info from = {.samples_per_sec = info->samples_per_sec,
 				     .speakers = info->speakers,
 				     .format = AUDIO_FORMAT_FLOAT_PLANAR};
 	struct resample_info to = {.samples_per_sec = (uint32_t)monitor->samples_per_sec,
 				   .speakers = pulseaudio_channels_to_obs_speakers(monitor->channels),
-				   .format = pulseaudio_to_obs_audio_format(monitor->format)};
+				   .format = format};
 
 	monitor->resampler = audio_resampler_create(&to, &from);
 	if (!monitor->resampler) {
@@ -421,6 +738,12 @@ static bool audio_monitor_init(struct audio_monitor *monitor, obs_source_t *sour
 	monitor->speakers = pulseaudio_channels_to_obs_speakers(spec.channels);
 	monitor->bytes_per_frame = pa_frame_size(&spec);
 
+	if (mixed) {
+		monitor->bytes_per_frame = spec.channels * sizeof(float);
+		monitor->bus = monitor_bus_acquire(monitor->device, &spec);
+		return monitor->bus != NULL;
+	}
+
 	pa_channel_map channel_map = pulseaudio_channel_map(monitor->speakers);
 
 	monitor->stream = pulseaudio_stream_new(obs_source_get_name(monitor->source), &spec, &channel_map);
@@ -453,6 +776,9 @@ static void audio_monitor_init_final(struct audio_monitor *monitor)
 	if (monitor->ignore)
 		return;
 
+	if (monitor->bus)
+		monitor_bus_attach(monitor);
+
 	obs_source_add_audio_capture_callback(monitor->source, on_audio_playback, monitor);
 }
 
@@ -464,6 +790,9 @@ static inline void audio_monitor_free(struct audio_monitor *monitor)
 	if (monitor->source)
 		obs_source_remove_audio_capture_callback(monitor->source, on_audio_playback, monitor);
 
+	if (monitor->bus)
+		monitor_bus_detach(monitor);
+
 	audio_resampler_destroy(monitor->resampler);
 	deque_free(&monitor->new_data);
 
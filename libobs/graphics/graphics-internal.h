@@ -297,6 +297,15 @@ struct blend_state {
 	enum gs_blend_op_type op;
 };
 
+struct gs_pooled_texture {
+	gs_texture_t *tex;
+	const void *owner;
+	uint64_t last_frame;
+	uint32_t cx, cy;
+	enum gs_color_format format;
+	bool in_use;
+};
+
 struct graphics_subsystem {
 	void *module;
 	gs_device_t *device;
@@ -332,4 +341,26 @@ struct graphics_subsystem {
 	DARRAY(struct blend_state) blend_state_stack;
 
 	bool linear_srgb;
+
+	DARRAY(struct gs_pooled_texture) texture_pool;
+	struct gs_texture_pool_stats texture_pool_stats;
+	uint64_t frame_count;
+	uint64_t draw_calls;
 };
+
+extern void gs_image_cache_free(graphics_t *graphics);
+
+extern gs_texture_t *gs_texture_pool_acquire_owned(uint32_t cx, uint32_t cy, enum gs_color_format format,
+						   const void *owner);
+extern bool gs_texture_pool_reclaim(gs_texture_t *tex, const void *owner);
+extern void gs_texture_pool_forget_owner(const void *owner);
+extern void gs_texture_pool_begin_frame(graphics_t *graphics);
+extern void gs_texture_pool_free(graphics_t *graphics);
+
+/* Texrenders for libobs' filter chain, exported only for the tests.  The
+ * render target is borrowed from the texture pool; gs_texrender_release hands
+ * it back once drawn, so other texrenders of the same size and format can use
+ * it later in the frame.  If nothing else took it in the meantime, the next
+ * gs_texrender_begin reclaims it with its contents intact. */
+EXPORT gs_texrender_t *gs_texrender_create_pooled(enum gs_color_format format, enum gs_zstencil_format zsformat);
+EXPORT void gs_texrender_release(gs_texrender_t *texrender);
@@ -239,12 +239,16 @@ void gs_destroy(graphics_t *graphics)
 	while (thread_graphics)
 		gs_leave_context();
 
+	gs_image_cache_free(graphics);
+
 	if (graphics->device) {
 		struct gs_effect *effect = graphics->first_effect;
 
 		thread_graphics = graphics;
 		graphics->exports.device_enter_context(graphics->device);
 
+		gs_texture_pool_free(graphics);
+
 		while (effect) {
 			struct gs_effect *next = effect->next;
 			gs_effect_actually_destroy(effect);
@@ -1916,6 +1920,7 @@ void gs_begin_frame(void)
 	if (!gs_valid("gs_begin_frame"))
 		return;
 
+	gs_texture_pool_begin_frame(graphics);
 	graphics->exports.device_begin_frame(graphics->device);
 }
 
@@ -1936,9 +1941,20 @@ void gs_draw(enum gs_draw_mode draw_mode, uint32_t start_vert, uint32_t num_vert
 	if (!gs_valid("gs_draw"))
 		return;
 
+	graphics->draw_calls++;
 	graphics->exports.device_draw(graphics->device, draw_mode, start_vert, num_verts);
 }
 
+uint64_t gs_get_draw_calls(void)
+{
+	graphics_t *graphics = thread_graphics;
+
+	if (!gs_valid("gs_get_draw_calls"))
+		return 0;
+
+	return graphics->draw_calls;
+}
+
 void gs_end_scene(void)
 {
 	graphics_t *graphics = thread_graphics;
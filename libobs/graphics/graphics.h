@@ -455,6 +455,35 @@ EXPORT void gs_texrender_reset(gs_texrender_t *texrender);
 EXPORT gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender);
 EXPORT enum gs_color_format gs_texrender_get_format(const gs_texrender_t *texrender);
 
+/* ---------------------------------------------------
+ * render target pool
+ * --------------------------------------------------- */
+
+struct gs_texture_pool_stats {
+	uint64_t acquired;
+	uint64_t reused;
+	uint64_t reclaimed;
+	uint64_t created;
+	uint64_t destroyed;
+
+	uint32_t frame_acquired;
+	uint32_t frame_created;
+
+	uint32_t textures;
+	uint32_t in_use;
+	uint64_t bytes;
+};
+
+/**
+ * Hands out a render target of the given size and format, reusing a free one
+ * if possible.  Textures that stay unused for a while are destroyed at the
+ * start of a later frame.
+ */
+EXPORT gs_texture_t *gs_texture_pool_acquire(uint32_t cx, uint32_t cy, enum gs_color_format format);
+EXPORT void gs_texture_pool_release(gs_texture_t *tex);
+EXPORT void gs_texture_pool_trim(void);
+EXPORT void gs_texture_pool_get_stats(struct gs_texture_pool_stats *stats);
+
 /* ---------------------------------------------------
  * graphics subsystem
  * --------------------------------------------------- */
@@ -501,6 +530,7 @@ struct gs_init_data {
 #define GS_DEVICE_OPENGL 1
 #define GS_DEVICE_DIRECT3D_11 2
 #define GS_DEVICE_METAL 3
+#define GS_DEVICE_SOFTWARE 4
 
 EXPORT const char *gs_get_device_name(void);
 EXPORT const char *gs_get_driver_version(void);
@@ -682,6 +712,9 @@ EXPORT void gs_stage_texture(gs_stagesurf_t *dst, gs_texture_t *src);
 EXPORT void gs_begin_frame(void);
 EXPORT void gs_begin_scene(void);
 EXPORT void gs_draw(enum gs_draw_mode draw_mode, uint32_t start_vert, uint32_t num_verts);
+
+/** Returns the number of draw calls issued on this context so far */
+EXPORT uint64_t gs_get_draw_calls(void);
 EXPORT void gs_end_scene(void);
 
 #define GS_CLEAR_COLOR (1 << 0)
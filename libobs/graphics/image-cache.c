@@ -0,0 +1,477 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <inttypes.h>
+#include <sys/stat.h>
+
+#include "image-cache.h"
+#include "graphics-internal.h"
+#include "../util/base.h"
+#include "../util/bmem.h"
+#include "../util/dstr.h"
+#include "../util/platform.h"
+#include "../util/task.h"
+#include "../util/threading.h"
+#include "../util/uthash.h"
+
+#define MAX_DECODE_THREADS 4
+
+struct gs_cached_image {
+	UT_hash_handle hh;
+	char *key;
+	char *path;
+	enum gs_image_alpha_mode alpha_mode;
+	uint32_t max_cx;
+	uint32_t max_cy;
+
+	/* protected by cache.mutex */
+	long refs;
+	bool in_cache;
+
+	volatile bool decoded;
+	os_event_t *decoded_event;
+
+	/* written once by the decoder before 'decoded' is set */
+	uint8_t *data;
+	uint64_t data_size;
+	enum gs_color_format format;
+	enum gs_color_space space;
+	uint32_t cx;
+	uint32_t cy;
+
+	/* only touched with the graphics context entered */
+	gs_texture_t *texture;
+	graphics_t *graphics;
+};
+
+static struct {
+	pthread_mutex_t mutex;
+	struct gs_cached_image *entries;
+
+	os_task_queue_t *decoders[MAX_DECODE_THREADS];
+	size_t num_decoders;
+	size_t next_decoder;
+
+	uint64_t pending_decodes;
+	uint64_t decoded_bytes;
+	uint64_t texture_bytes;
+	uint64_t hits;
+	uint64_t misses;
+} cache = {.mutex = PTHREAD_MUTEX_INITIALIZER};
+
+bool gs_image_cache_supported(const char *file)
+{
+	const char *ext;
+
+	if (!file || !*file)
+		return false;
+
+	/* animated gifs keep per-instance playback state */
+	ext = os_get_path_extension(file);
+	return !ext || astrcmpi(ext, ".gif") != 0;
+}
+
+static bool make_key(struct dstr *key, const char *file, enum gs_image_alpha_mode alpha_mode, uint32_t max_cx,
+		     uint32_t max_cy)
+{
+	struct stat stats;
+
+	if (os_stat(file, &stats) != 0)
+		return false;
+
+	dstr_printf(key, "%s|%lld|%lld|%d|%ux%u", file, (long long)stats.st_mtime, (long long)stats.st_size,
+		    (int)alpha_mode, max_cx, max_cy);
+	return true;
+}
+
+static inline bool is_8bit_4ch(enum gs_color_format format)
+{
+	return format == GS_RGBA || format == GS_BGRA || format == GS_BGRX || format == GS_RGBA_UNORM ||
+	       format == GS_BGRX_UNORM || format == GS_BGRA_UNORM;
+}
+
+/* box filter, each output pixel is the average of the source pixels it
+ * covers.  data is premultiplied, so averaging alpha is correct. */
+static uint8_t *downscale_8bit_4ch(const uint8_t *src, uint32_t src_cx, uint32_t src_cy, uint32_t dst_cx,
+				   uint32_t dst_cy)
+{
+	uint8_t *dst = bmalloc((size_t)dst_cx * dst_cy * 4);
+
+	for (uint32_t y = 0; y < dst_cy; y++) {
+		uint32_t y0 = (uint32_t)((uint64_t)y * src_cy / dst_cy);
+		uint32_t y1 = (uint32_t)((uint64_t)(y + 1) * src_cy / dst_cy);
+		if (y1 <= y0)
+			y1 = y0 + 1;
+
+		for (uint32_t x = 0; x < dst_cx; x++) {
+			uint32_t x0 = (uint32_t)((uint64_t)x * src_cx / dst_cx);
+			uint32_t x1 = (uint32_t)((uint64_t)(x + 1) * src_cx / dst_cx);
+			uint32_t sum[4] = {0};
+			uint32_t count;
+
+			if (x1 <= x0)
+				x1 = x0 + 1;
+			count = (x1 - x0) * (y1 - y0);
+
+			for (uint32_t sy = y0; sy < y1; sy++) {
+				const uint8_t *row = src + ((size_t)sy * src_cx + x0) * 4;
+				for (uint32_t sx = x0; sx < x1; sx++) {
+					sum[0] += row[0];
+					sum[1] += row[1];
+					sum[2] += row[2];
+					sum[3] += row[3];
+					row += 4;
+				}
+			}
+
+			uint8_t *out = dst + ((size_t)y * dst_cx + x) * 4;
+			for (size_t c = 0; c < 4; c++)
+				out[c] = (uint8_t)((sum[c] + count / 2) / count);
+		}
+	}
+
+	return dst;
+}
+
+static void scale_to_fit(struct gs_cached_image *image)
+{
+	uint32_t cx = image->cx;
+	uint32_t cy = image->cy;
+
+	if (!image->max_cx || !image->max_cy)
+		return;
+	if (cx <= image->max_cx && cy <= image->max_cy)
+		return;
+	if (!is_8bit_4ch(image->format))
+		return;
+
+	if ((uint64_t)cx * image->max_cy > (uint64_t)cy * image->max_cx) {
+		cy = (uint32_t)((uint64_t)cy * image->max_cx / cx);
+		cx = image->max_cx;
+	} else {
+		cx = (uint32_t)((uint64_t)cx * image->max_cy / cy);
+		cy = image->max_cy;
+	}
+
+	if (!cx)
+		cx = 1;
+	if (!cy)
+		cy = 1;
+
+	uint8_t *scaled = downscale_8bit_4ch(image->data, image->cx, image->cy, cx, cy);
+	bfree(image->data);
+	image->data = scaled;
+	image->cx = cx;
+	image->cy = cy;
+}
+
+static void decode_image(struct gs_cached_image *image)
+{
+	image->data = gs_create_texture_file_data3(image->path, image->alpha_mode, &image->format, &image->cx,
+						   &image->cy, &image->space);
+
+	if (image->data) {
+		scale_to_fit(image);
+		image->data_size = (uint64_t)image->cx * image->cy * gs_get_format_bpp(image->format) / 8;
+	} else {
+		blog(LOG_WARNING, "%s: Failed to load file '%s'", __FUNCTION__, image->path);
+		image->cx = 0;
+		image->cy = 0;
+	}
+
+	pthread_mutex_lock(&cache.mutex);
+	cache.decoded_bytes += image->data_size;
+
+	/* current users keep the failed entry, the next acquire tries again */
+	if (!image->data && image->in_cache) {
+		HASH_DELETE(hh, cache.entries, image);
+		image->in_cache = false;
+	}
+	pthread_mutex_unlock(&cache.mutex);
+
+	os_atomic_set_bool(&image->decoded, true);
+	os_event_signal(image->decoded_event);
+}
+
+static void decode_task(void *param)
+{
+	struct gs_cached_image *image = param;
+
+	decode_image(image);
+
+	pthread_mutex_lock(&cache.mutex);
+	cache.pending_decodes--;
+	pthread_mutex_unlock(&cache.mutex);
+
+	gs_cached_image_release(image);
+}
+
+static os_task_queue_t *get_decoder(void)
+{
+	os_task_queue_t *queue;
+
+	if (!cache.num_decoders) {
+		int threads = os_get_logical_cores() / 2;
+		if (threads < 1)
+			threads = 1;
+		if (threads > MAX_DECODE_THREADS)
+			threads = MAX_DECODE_THREADS;
+
+		for (int i = 0; i < threads; i++) {
+			queue = os_task_queue_create();
+			if (queue)
+				cache.decoders[cache.num_decoders++] = queue;
+		}
+
+		if (!cache.num_decoders)
+			return NULL;
+	}
+
+	queue = cache.decoders[cache.next_decoder];
+	cache.next_decoder = (cache.next_decoder + 1) % cache.num_decoders;
+	return queue;
+}
+
+static void cached_image_destroy(struct gs_cached_image *image)
+{
+	if (image->texture) {
+		gs_enter_context(image->graphics);
+		gs_texture_destroy(image->texture);
+		gs_leave_context();
+	}
+
+	os_event_destroy(image->decoded_event);
+	bfree(image->data);
+	bfree(image->path);
+	bfree(image->key);
+	bfree(image);
+}
+
+gs_cached_image_t *gs_image_cache_acquire(const char *file, enum gs_image_alpha_mode alpha_mode, bool async)
+{
+	return gs_image_cache_acquire_scaled(file, alpha_mode, 0, 0, async);
+}
+
+gs_cached_image_t *gs_image_cache_acquire_scaled(const char *file, enum gs_image_alpha_mode alpha_mode,
+						 uint32_t max_cx, uint32_t max_cy, bool async)
+{
+	struct gs_cached_image *image = NULL;
+	struct dstr key = {0};
+	bool decode_now = false;
+
+	if (!gs_image_cache_supported(file))
+		return NULL;
+	if (!make_key(&key, file, alpha_mode, max_cx, max_cy)) {
+		blog(LOG_WARNING, "%s: Failed to stat file '%s'", __FUNCTION__, file);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&cache.mutex);
+
+	HASH_FIND_STR(cache.entries, key.array, image);
+	if (image) {
+		image->refs++;
+		cache.hits++;
+		dstr_free(&key);
+
+	} else {
+		image = bzalloc(sizeof(*image));
+		image->key = key.array;
+		image->path = bstrdup(file);
+		image->alpha_mode = alpha_mode;
+		image->max_cx = max_cx;
+		image->max_cy = max_cy;
+		image->refs = 1;
+		image->in_cache = true;
+		os_event_init(&image->decoded_event, OS_EVENT_TYPE_MANUAL);
+
+		HASH_ADD_KEYPTR(hh, cache.entries, image->key, strlen(image->key), image);
+		cache.misses++;
+
+		os_task_queue_t *decoder = async ? get_decoder() : NULL;
+		if (decoder) {
+			/* the decode task holds its own reference */
+			image->refs++;
+			cache.pending_decodes++;
+			os_task_queue_queue_task(decoder, decode_task, image);
+		} else {
+			decode_now = true;
+		}
+	}
+
+	pthread_mutex_unlock(&cache.mutex);
+
+	if (decode_now)
+		decode_image(image);
+	else if (!async)
+		gs_cached_image_wait(image);
+
+	return image;
+}
+
+void gs_cached_image_release(gs_cached_image_t *image)
+{
+	bool destroy = false;
+
+	if (!image)
+		return;
+
+	pthread_mutex_lock(&cache.mutex);
+	if (--image->refs == 0) {
+		if (image->in_cache)
+			HASH_DELETE(hh, cache.entries, image);
+		if (image->texture)
+			cache.texture_bytes -= image->data_size;
+		else
+			cache.decoded_bytes -= image->data_size;
+		destroy = true;
+	}
+	pthread_mutex_unlock(&cache.mutex);
+
+	if (destroy)
+		cached_image_destroy(image);
+}
+
+bool gs_cached_image_decoded(gs_cached_image_t *image)
+{
+	return image && os_atomic_load_bool(&image->decoded);
+}
+
+void gs_cached_image_wait(gs_cached_image_t *image)
+{
+	if (image && !os_atomic_load_bool(&image->decoded))
+		os_event_wait(image->decoded_event);
+}
+
+bool gs_cached_image_loaded(gs_cached_image_t *image)
+{
+	return gs_cached_image_decoded(image) && image->cx && image->cy;
+}
+
+/* these are called while rendering, so they report 0 until the decode
+ * finished instead of waiting for it */
+uint32_t gs_cached_image_get_width(gs_cached_image_t *image)
+{
+	return gs_cached_image_decoded(image) ? image->cx : 0;
+}
+
+uint32_t gs_cached_image_get_height(gs_cached_image_t *image)
+{
+	return gs_cached_image_decoded(image) ? image->cy : 0;
+}
+
+enum gs_color_space gs_cached_image_get_space(gs_cached_image_t *image)
+{
+	return gs_cached_image_decoded(image) ? image->space : GS_CS_SRGB;
+}
+
+uint64_t gs_cached_image_get_mem_usage(gs_cached_image_t *image)
+{
+	return gs_cached_image_decoded(image) ? image->data_size : 0;
+}
+
+gs_texture_t *gs_cached_image_get_texture(gs_cached_image_t *image)
+{
+	if (!image || !gs_get_context())
+		return NULL;
+	if (!os_atomic_load_bool(&image->decoded))
+		return NULL;
+
+	if (!image->texture && image->data) {
+		image->texture =
+			gs_texture_create(image->cx, image->cy, image->format, 1, (const uint8_t **)&image->data, 0);
+		image->graphics = gs_get_context();
+
+		if (image->texture) {
+			/* the pixel data now lives on the GPU */
+			pthread_mutex_lock(&cache.mutex);
+			cache.decoded_bytes -= image->data_size;
+			cache.texture_bytes += image->data_size;
+			pthread_mutex_unlock(&cache.mutex);
+
+			bfree(image->data);
+			image->data = NULL;
+		}
+	}
+
+	return image->texture;
+}
+
+void gs_image_cache_get_stats(struct gs_image_cache_stats *stats)
+{
+	if (!stats)
+		return;
+
+	pthread_mutex_lock(&cache.mutex);
+	stats->entries = HASH_CNT(hh, cache.entries);
+	stats->pending_decodes = cache.pending_decodes;
+	stats->decoded_bytes = cache.decoded_bytes;
+	stats->texture_bytes = cache.texture_bytes;
+	stats->hits = cache.hits;
+	stats->misses = cache.misses;
+	pthread_mutex_unlock(&cache.mutex);
+}
+
+void gs_image_cache_free(graphics_t *graphics)
+{
+	os_task_queue_t *decoders[MAX_DECODE_THREADS];
+	struct gs_cached_image *image, *tmp;
+	size_t num_decoders;
+	size_t leaked;
+
+	pthread_mutex_lock(&cache.mutex);
+	num_decoders = cache.num_decoders;
+	memcpy(decoders, cache.decoders, sizeof(decoders));
+	cache.num_decoders = 0;
+	cache.next_decoder = 0;
+	pthread_mutex_unlock(&cache.mutex);
+
+	/* finishes any queued decodes */
+	for (size_t i = 0; i < num_decoders; i++)
+		os_task_queue_destroy(decoders[i]);
+
+	/* entries still referenced must not keep textures of a destroyed
+	 * context.  their pixel data went to the texture, so they are left
+	 * unloaded and out of the cache for the next acquire to decode again */
+	if (graphics->device)
+		gs_enter_context(graphics);
+	pthread_mutex_lock(&cache.mutex);
+
+	leaked = HASH_CNT(hh, cache.entries);
+	if (leaked || cache.hits || cache.misses)
+		blog(LOG_INFO, "Image cache: %" PRIu64 " hits, %" PRIu64 " misses, %zu leaked", cache.hits,
+		     cache.misses, leaked);
+
+	HASH_ITER (hh, cache.entries, image, tmp) {
+		if (image->texture && image->graphics == graphics) {
+			gs_texture_destroy(image->texture);
+			cache.texture_bytes -= image->data_size;
+			image->texture = NULL;
+			image->graphics = NULL;
+			image->data_size = 0;
+			image->cx = 0;
+			image->cy = 0;
+
+			HASH_DELETE(hh, cache.entries, image);
+			image->in_cache = false;
+		}
+	}
+
+	pthread_mutex_unlock(&cache.mutex);
+	if (graphics->device)
+		gs_leave_context();
+}
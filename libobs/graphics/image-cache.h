@@ -0,0 +1,77 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include "graphics.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Process-wide cache of decoded still images.
+ *
+ *   Entries are keyed by path, modification time, file size and alpha mode,
+ * so the same file used by several sources is only decoded and uploaded
+ * once.  Entries are reference counted and freed when the last user releases
+ * them.  Animated images are not cached; use gs_image_file4_t for those.
+ */
+
+struct gs_cached_image;
+typedef struct gs_cached_image gs_cached_image_t;
+
+struct gs_image_cache_stats {
+	uint64_t entries;
+	uint64_t pending_decodes;
+	uint64_t decoded_bytes;
+	uint64_t texture_bytes;
+	uint64_t hits;
+	uint64_t misses;
+};
+
+EXPORT bool gs_image_cache_supported(const char *file);
+
+EXPORT gs_cached_image_t *gs_image_cache_acquire(const char *file, enum gs_image_alpha_mode alpha_mode, bool async);
+
+/* Same as gs_image_cache_acquire, but images larger than max_cx x max_cy are
+ * downscaled (preserving aspect ratio) after decoding.  Scaled and unscaled
+ * versions of a file are separate entries. */
+EXPORT gs_cached_image_t *gs_image_cache_acquire_scaled(const char *file, enum gs_image_alpha_mode alpha_mode,
+							uint32_t max_cx, uint32_t max_cy, bool async);
+
+EXPORT void gs_cached_image_release(gs_cached_image_t *image);
+
+EXPORT bool gs_cached_image_decoded(gs_cached_image_t *image);
+EXPORT void gs_cached_image_wait(gs_cached_image_t *image);
+EXPORT bool gs_cached_image_loaded(gs_cached_image_t *image);
+
+/* These return 0 until the image is decoded. */
+EXPORT uint32_t gs_cached_image_get_width(gs_cached_image_t *image);
+EXPORT uint32_t gs_cached_image_get_height(gs_cached_image_t *image);
+EXPORT enum gs_color_space gs_cached_image_get_space(gs_cached_image_t *image);
+EXPORT uint64_t gs_cached_image_get_mem_usage(gs_cached_image_t *image);
+
+/* Must be called with the graphics context entered.  The texture is created
+ * on first use and shared by every user of the entry. */
+EXPORT gs_texture_t *gs_cached_image_get_texture(gs_cached_image_t *image);
+
+EXPORT void gs_image_cache_get_stats(struct gs_image_cache_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,245 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ *   Pool of render targets keyed by size and format.  Intermediate targets
+ * (filter chains mostly) borrow a texture for as long as they need its
+ * contents and hand it back afterwards, so a frame only needs as many
+ * targets of a given size as are alive at the same time.
+ *
+ *   The pool belongs to the graphics context and is only touched with the
+ * context entered, so it needs no locking of its own.
+ */
+
+#include <inttypes.h>
+#include "graphics-internal.h"
+
+/* free textures that have not been used for this many frames */
+#define MAX_IDLE_FRAMES 60
+
+static inline uint64_t texture_bytes(const struct gs_pooled_texture *entry)
+{
+	return (uint64_t)entry->cx * entry->cy * gs_get_format_bpp(entry->format) / 8;
+}
+
+static void destroy_entry(graphics_t *graphics, size_t idx)
+{
+	struct gs_pooled_texture *entry = graphics->texture_pool.array + idx;
+	struct gs_texture_pool_stats *stats = &graphics->texture_pool_stats;
+
+	stats->bytes -= texture_bytes(entry);
+	stats->textures--;
+	stats->destroyed++;
+
+	gs_texture_destroy(entry->tex);
+	da_erase(graphics->texture_pool, idx);
+}
+
+static struct gs_pooled_texture *find_entry(graphics_t *graphics, const gs_texture_t *tex)
+{
+	for (size_t i = 0; i < graphics->texture_pool.num; i++) {
+		struct gs_pooled_texture *entry = graphics->texture_pool.array + i;
+		if (entry->tex == tex)
+			return entry;
+	}
+
+	return NULL;
+}
+
+gs_texture_t *gs_texture_pool_acquire_owned(uint32_t cx, uint32_t cy, enum gs_color_format format,
+					    const void *owner)
+{
+	graphics_t *graphics = gs_get_context();
+	struct gs_texture_pool_stats *stats;
+	struct gs_pooled_texture *best = NULL;
+	struct gs_pooled_texture *entry;
+	gs_texture_t *tex;
+
+	if (!graphics || !cx || !cy)
+		return NULL;
+
+	stats = &graphics->texture_pool_stats;
+	stats->acquired++;
+	stats->frame_acquired++;
+
+	/* prefer a texture the caller had last, then the one that has been
+	 * free the longest so recently released contents stay reclaimable */
+	for (size_t i = 0; i < graphics->texture_pool.num; i++) {
+		entry = graphics->texture_pool.array + i;
+
+		if (entry->in_use || entry->cx != cx || entry->cy != cy || entry->format != format)
+			continue;
+
+		if (owner && entry->owner == owner) {
+			best = entry;
+			break;
+		}
+		if (!best || entry->last_frame < best->last_frame)
+			best = entry;
+	}
+
+	if (best) {
+		best->in_use = true;
+		best->owner = owner;
+		best->last_frame = graphics->frame_count;
+		stats->reused++;
+		stats->in_use++;
+		return best->tex;
+	}
+
+	tex = gs_texture_create(cx, cy, format, 1, NULL, GS_RENDER_TARGET);
+	if (!tex)
+		return NULL;
+
+	entry = da_push_back_new(graphics->texture_pool);
+	entry->tex = tex;
+	entry->owner = owner;
+	entry->last_frame = graphics->frame_count;
+	entry->cx = cx;
+	entry->cy = cy;
+	entry->format = format;
+	entry->in_use = true;
+
+	stats->created++;
+	stats->frame_created++;
+	stats->textures++;
+	stats->in_use++;
+	stats->bytes += texture_bytes(entry);
+	return tex;
+}
+
+gs_texture_t *gs_texture_pool_acquire(uint32_t cx, uint32_t cy, enum gs_color_format format)
+{
+	if (!gs_get_context()) {
+		blog(LOG_DEBUG, "gs_texture_pool_acquire: called while not in a graphics context");
+		return NULL;
+	}
+
+	return gs_texture_pool_acquire_owned(cx, cy, format, NULL);
+}
+
+void gs_texture_pool_release(gs_texture_t *tex)
+{
+	graphics_t *graphics = gs_get_context();
+	struct gs_pooled_texture *entry;
+
+	if (!graphics || !tex)
+		return;
+
+	entry = find_entry(graphics, tex);
+	if (!entry || !entry->in_use) {
+		blog(LOG_WARNING, "gs_texture_pool_release: texture %p is not an acquired pool texture", tex);
+		return;
+	}
+
+	entry->in_use = false;
+	entry->last_frame = graphics->frame_count;
+	graphics->texture_pool_stats.in_use--;
+}
+
+bool gs_texture_pool_reclaim(gs_texture_t *tex, const void *owner)
+{
+	graphics_t *graphics = gs_get_context();
+	struct gs_pooled_texture *entry;
+
+	if (!graphics || !tex || !owner)
+		return false;
+
+	entry = find_entry(graphics, tex);
+	if (!entry || entry->in_use || entry->owner != owner)
+		return false;
+
+	entry->in_use = true;
+	entry->last_frame = graphics->frame_count;
+	graphics->texture_pool_stats.reclaimed++;
+	graphics->texture_pool_stats.in_use++;
+	return true;
+}
+
+void gs_texture_pool_forget_owner(const void *owner)
+{
+	graphics_t *graphics = gs_get_context();
+
+	if (!graphics || !owner)
+		return;
+
+	for (size_t i = 0; i < graphics->texture_pool.num; i++) {
+		struct gs_pooled_texture *entry = graphics->texture_pool.array + i;
+		if (entry->owner == owner)
+			entry->owner = NULL;
+	}
+}
+
+void gs_texture_pool_begin_frame(graphics_t *graphics)
+{
+	graphics->frame_count++;
+	graphics->texture_pool_stats.frame_acquired = 0;
+	graphics->texture_pool_stats.frame_created = 0;
+
+	for (size_t i = graphics->texture_pool.num; i > 0; i--) {
+		struct gs_pooled_texture *entry = graphics->texture_pool.array + (i - 1);
+
+		if (!entry->in_use && graphics->frame_count - entry->last_frame > MAX_IDLE_FRAMES)
+			destroy_entry(graphics, i - 1);
+	}
+}
+
+void gs_texture_pool_trim(void)
+{
+	graphics_t *graphics = gs_get_context();
+
+	if (!graphics)
+		return;
+
+	for (size_t i = graphics->texture_pool.num; i > 0; i--) {
+		if (!graphics->texture_pool.array[i - 1].in_use)
+			destroy_entry(graphics, i - 1);
+	}
+}
+
+void gs_texture_pool_get_stats(struct gs_texture_pool_stats *stats)
+{
+	graphics_t *graphics = gs_get_context();
+
+	if (!stats)
+		return;
+
+	if (graphics)
+		*stats = graphics->texture_pool_stats;
+	else
+		memset(stats, 0, sizeof(*stats));
+}
+
+void gs_texture_pool_free(graphics_t *graphics)
+{
+	struct gs_texture_pool_stats *stats = &graphics->texture_pool_stats;
+
+	if (stats->in_use)
+		blog(LOG_WARNING, "Texture pool: %" PRIu32 " textures still acquired at shutdown", stats->in_use);
+
+	if (stats->acquired)
+		blog(LOG_INFO,
+		     "Texture pool: %" PRIu64 " acquisitions, %" PRIu64 " reused, %" PRIu64 " reclaimed, %" PRIu64
+		     " created",
+		     stats->acquired, stats->reused, stats->reclaimed, stats->created);
+
+	for (size_t i = 0; i < graphics->texture_pool.num; i++)
+		gs_texture_destroy(graphics->texture_pool.array[i].tex);
+
+	da_free(graphics->texture_pool);
+	memset(stats, 0, sizeof(*stats));
+}
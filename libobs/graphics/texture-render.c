@@ -21,7 +21,7 @@
  */
 
 #include <assert.h>
-#include "graphics.h"
+#include "graphics-internal.h"
 
 struct gs_texture_render {
 	gs_texture_t *target, *prev_target;
@@ -34,6 +34,8 @@ struct gs_texture_render {
 	enum gs_zstencil_format zsformat;
 
 	bool rendered;
+	bool pooled;
+	bool released;
 };
 
 gs_texrender_t *gs_texrender_create(enum gs_color_format format, enum gs_zstencil_format zsformat)
@@ -46,10 +48,31 @@ gs_texrender_t *gs_texrender_create(enum gs_color_format format, enum gs_zstenci
 	return texrender;
 }
 
+gs_texrender_t *gs_texrender_create_pooled(enum gs_color_format format, enum gs_zstencil_format zsformat)
+{
+	gs_texrender_t *texrender = gs_texrender_create(format, zsformat);
+	texrender->pooled = true;
+
+	return texrender;
+}
+
+static void texrender_free_target(gs_texrender_t *texrender)
+{
+	if (!texrender->pooled)
+		gs_texture_destroy(texrender->target);
+	else if (texrender->target && !texrender->released)
+		gs_texture_pool_release(texrender->target);
+
+	texrender->target = NULL;
+	texrender->released = false;
+}
+
 void gs_texrender_destroy(gs_texrender_t *texrender)
 {
 	if (texrender) {
-		gs_texture_destroy(texrender->target);
+		texrender_free_target(texrender);
+		if (texrender->pooled)
+			gs_texture_pool_forget_owner(texrender);
 		gs_zstencil_destroy(texrender->zs);
 		bfree(texrender);
 	}
@@ -60,24 +83,24 @@ static bool texrender_resetbuffer(gs_texrender_t *texrender, uint32_t cx, uint32
 	if (!texrender)
 		return false;
 
-	gs_texture_destroy(texrender->target);
+	texrender_free_target(texrender);
 	gs_zstencil_destroy(texrender->zs);
 
-	texrender->target = NULL;
 	texrender->zs = NULL;
 	texrender->cx = cx;
 	texrender->cy = cy;
 
-	texrender->target = gs_texture_create(cx, cy, texrender->format, 1, NULL, GS_RENDER_TARGET);
+	if (texrender->pooled)
+		texrender->target = gs_texture_pool_acquire_owned(cx, cy, texrender->format, texrender);
+	else
+		texrender->target = gs_texture_create(cx, cy, texrender->format, 1, NULL, GS_RENDER_TARGET);
 	if (!texrender->target)
 		return false;
 
 	if (texrender->zsformat != GS_ZS_NONE) {
 		texrender->zs = gs_zstencil_create(cx, cy, texrender->zsformat);
 		if (!texrender->zs) {
-			gs_texture_destroy(texrender->target);
-			texrender->target = NULL;
-
+			texrender_free_target(texrender);
 			return false;
 		}
 	}
@@ -92,13 +115,28 @@ bool gs_texrender_begin(gs_texrender_t *texrender, uint32_t cx, uint32_t cy)
 
 bool gs_texrender_begin_with_color_space(gs_texrender_t *texrender, uint32_t cx, uint32_t cy, enum gs_color_space space)
 {
-	if (!texrender || texrender->rendered)
+	if (!texrender)
+		return false;
+
+	/* a released target that was handed to someone else has lost its
+	 * contents, so it has to be rendered again */
+	if (texrender->released) {
+		if (gs_texture_pool_reclaim(texrender->target, texrender)) {
+			texrender->released = false;
+		} else {
+			texrender->target = NULL;
+			texrender->released = false;
+			texrender->rendered = false;
+		}
+	}
+
+	if (texrender->rendered)
 		return false;
 
 	if (!cx || !cy)
 		return false;
 
-	if (texrender->cx != cx || texrender->cy != cy)
+	if (texrender->cx != cx || texrender->cy != cy || !texrender->target)
 		if (!texrender_resetbuffer(texrender, cx, cy))
 			return false;
 
@@ -136,13 +174,34 @@ void gs_texrender_end(gs_texrender_t *texrender)
 
 void gs_texrender_reset(gs_texrender_t *texrender)
 {
-	if (texrender)
-		texrender->rendered = false;
+	if (!texrender)
+		return;
+
+	/* a pooled target is kept and rendered to again by the next begin, it
+	 * only goes back to the pool through gs_texrender_release */
+	texrender->rendered = false;
+}
+
+void gs_texrender_release(gs_texrender_t *texrender)
+{
+	if (!texrender || !texrender->pooled || !texrender->target || texrender->released)
+		return;
+	if (!gs_get_context()) {
+		blog(LOG_DEBUG, "gs_texrender_release: called while not in a graphics context");
+		return;
+	}
+
+	gs_texture_pool_release(texrender->target);
+	texrender->released = true;
 }
 
 gs_texture_t *gs_texrender_get_texture(const gs_texrender_t *texrender)
 {
-	return texrender ? texrender->target : NULL;
+	/* only pooled texrenders are ever released */
+	if (!texrender || texrender->released)
+		return NULL;
+
+	return texrender->target;
 }
 
 enum gs_color_format gs_texrender_get_format(const gs_texrender_t *texrender)
@@ -62,6 +62,10 @@ struct audio_mix {
 	float buffer_unclamped[MAX_AUDIO_CHANNELS][AUDIO_OUTPUT_FRAMES];
 };
 
+/* how long the audio thread waits for an external clock before it falls back
+ * to the system timer for a tick */
+#define CLOCK_TIMEOUT_MS 100
+
 struct audio_output {
 	struct audio_output_info info;
 	size_t block_size;
@@ -73,6 +77,13 @@ struct audio_output {
 
 	bool initialized;
 
+	volatile bool clock_attached;
+	volatile long clock_ticks;
+	volatile long clock_frames;
+	os_event_t *clock_event;
+
+	struct audio_output_latency latency;
+
 	audio_input_callback_t input_cb;
 	void *input_param;
 	pthread_mutex_t input_mutex;
@@ -157,8 +168,36 @@ static inline void clamp_audio_output(struct audio_output *audio, size_t bytes)
 	}
 }
 
-static void input_and_output(struct audio_output *audio, uint64_t audio_time, uint64_t prev_time)
+static void update_latency(struct audio_output *audio, uint64_t audio_time, uint64_t new_ts, uint64_t wake_time,
+			   uint64_t mix_start)
+{
+	struct audio_output_latency *latency = &audio->latency;
+	uint64_t now = os_gettime_ns();
+	uint64_t output = now > new_ts ? now - new_ts : 0;
+	uint64_t late = wake_time > audio_time ? wake_time - audio_time : 0;
+	uint64_t mix = now - mix_start;
+
+	pthread_mutex_lock(&audio->input_mutex);
+
+	latency->external_clock = os_atomic_load_bool(&audio->clock_attached);
+	latency->ticks++;
+	latency->output_ns = output;
+	latency->total_output_ns += output;
+	if (output > latency->max_output_ns)
+		latency->max_output_ns = output;
+	latency->mix_ns = mix;
+	if (mix > latency->max_mix_ns)
+		latency->max_mix_ns = mix;
+	latency->late_ns = late;
+	if (late > latency->max_late_ns)
+		latency->max_late_ns = late;
+
+	pthread_mutex_unlock(&audio->input_mutex);
+}
+
+static void input_and_output(struct audio_output *audio, uint64_t audio_time, uint64_t prev_time, uint64_t wake_time)
 {
+	uint64_t mix_start = os_gettime_ns();
 	size_t bytes = AUDIO_OUTPUT_FRAMES * audio->block_size;
 	struct audio_output_data data[MAX_AUDIO_MIXES];
 	uint32_t active_mixes = 0;
@@ -200,6 +239,47 @@ static void input_and_output(struct audio_output *audio, uint64_t audio_time, ui
 	/* output */
 	for (size_t i = 0; i < MAX_AUDIO_MIXES; i++)
 		do_audio_output(audio, i, new_ts, AUDIO_OUTPUT_FRAMES);
+
+	update_latency(audio, audio_time, new_ts, wake_time, mix_start);
+}
+
+/* waits for the next device period, returns false if it stopped reporting */
+static bool wait_for_clock_tick(struct audio_output *audio)
+{
+	while (!os_atomic_load_long(&audio->clock_ticks)) {
+		if (os_event_timedwait(audio->clock_event, CLOCK_TIMEOUT_MS) == ETIMEDOUT)
+			return false;
+		if (os_event_try(audio->stop_event) != EAGAIN)
+			return true;
+		if (!os_atomic_load_bool(&audio->clock_attached))
+			return false;
+	}
+
+	os_atomic_dec_long(&audio->clock_ticks);
+	return true;
+}
+
+/* Returns false if the tick should be timed by the system clock instead.
+ * Mixes are timestamped with the system clock that sources use, so as the
+ * device clock drifts from it, a tick is mixed without waiting for the
+ * device once it falls a tick behind, and a device period is skipped once
+ * it runs a tick ahead.  This only moves the start of a tick; it still mixes
+ * AUDIO_OUTPUT_FRAMES frames against the same audio buffering, so the
+ * latency of the mix does not change. */
+static bool wait_for_clock(struct audio_output *audio, uint64_t audio_time, uint64_t tick_ns)
+{
+	if (!os_atomic_load_bool(&audio->clock_attached))
+		return false;
+
+	if (os_gettime_ns() > audio_time + tick_ns)
+		return true;
+
+	do {
+		if (!wait_for_clock_tick(audio))
+			return false;
+	} while (os_gettime_ns() + tick_ns < audio_time);
+
+	return true;
 }
 
 static void *audio_thread(void *param)
@@ -214,6 +294,7 @@ static void *audio_thread(void *param)
 	uint64_t samples = 0;
 	uint64_t start_time = os_gettime_ns();
 	uint64_t prev_time = start_time;
+	const uint64_t tick_ns = audio_frames_to_ns(rate, AUDIO_OUTPUT_FRAMES);
 
 	os_set_thread_name("audio-io: audio thread");
 
@@ -224,11 +305,14 @@ static void *audio_thread(void *param)
 		samples += AUDIO_OUTPUT_FRAMES;
 		uint64_t audio_time = start_time + audio_frames_to_ns(rate, samples);
 
-		os_sleepto_ns_fast(audio_time);
+		if (!wait_for_clock(audio, audio_time, tick_ns))
+			os_sleepto_ns_fast(audio_time);
+
+		uint64_t wake_time = os_gettime_ns();
 
 		profile_start(audio_thread_name);
 
-		input_and_output(audio, audio_time, prev_time);
+		input_and_output(audio, audio_time, prev_time, wake_time);
 		prev_time = audio_time;
 
 		profile_end(audio_thread_name);
@@ -373,13 +457,17 @@ int audio_output_open(audio_t **audio, struct audio_output_info *info)
 		goto fail0;
 	if (os_event_init(&out->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
 		goto fail1;
-	if (pthread_create(&out->thread, NULL, audio_thread, out) != 0)
+	if (os_event_init(&out->clock_event, OS_EVENT_TYPE_AUTO) != 0)
 		goto fail2;
+	if (pthread_create(&out->thread, NULL, audio_thread, out) != 0)
+		goto fail3;
 
 	out->initialized = true;
 	*audio = out;
 	return AUDIO_OUTPUT_SUCCESS;
 
+fail3:
+	os_event_destroy(out->clock_event);
 fail2:
 	os_event_destroy(out->stop_event);
 fail1:
@@ -398,8 +486,10 @@ void audio_output_close(audio_t *audio)
 
 	if (audio->initialized) {
 		os_event_signal(audio->stop_event);
+		os_event_signal(audio->clock_event);
 		pthread_join(audio->thread, &thread_ret);
 		os_event_destroy(audio->stop_event);
+		os_event_destroy(audio->clock_event);
 		pthread_mutex_destroy(&audio->input_mutex);
 	}
 
@@ -453,3 +543,56 @@ uint32_t audio_output_get_sample_rate(const audio_t *audio)
 {
 	return audio->info.samples_per_sec;
 }
+
+bool audio_output_attach_clock(audio_t *audio)
+{
+	if (!audio || os_atomic_set_bool(&audio->clock_attached, true))
+		return false;
+
+	os_atomic_store_long(&audio->clock_frames, 0);
+	os_atomic_store_long(&audio->clock_ticks, 0);
+	return true;
+}
+
+void audio_output_detach_clock(audio_t *audio)
+{
+	if (!audio)
+		return;
+
+	os_atomic_set_bool(&audio->clock_attached, false);
+	os_event_signal(audio->clock_event);
+}
+
+void audio_output_clock_advance(audio_t *audio, uint32_t frames)
+{
+	uint64_t total;
+	long prev;
+
+	if (!audio || !frames || !os_atomic_load_bool(&audio->clock_attached))
+		return;
+
+	/* only the frames short of a full tick are kept */
+	do {
+		prev = os_atomic_load_long(&audio->clock_frames);
+		total = (uint64_t)prev + frames;
+	} while (!os_atomic_compare_swap_long(&audio->clock_frames, prev, (long)(total % AUDIO_OUTPUT_FRAMES)));
+
+	if (total < AUDIO_OUTPUT_FRAMES)
+		return;
+
+	for (uint64_t i = total / AUDIO_OUTPUT_FRAMES; i > 0; i--)
+		os_atomic_inc_long(&audio->clock_ticks);
+	os_event_signal(audio->clock_event);
+}
+
+void audio_output_get_latency(audio_t *audio, struct audio_output_latency *latency)
+{
+	if (!audio) {
+		memset(latency, 0, sizeof(*latency));
+		return;
+	}
+
+	pthread_mutex_lock(&audio->input_mutex);
+	*latency = audio->latency;
+	pthread_mutex_unlock(&audio->input_mutex);
+}
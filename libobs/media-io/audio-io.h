@@ -202,6 +202,24 @@ static inline uint64_t ns_to_audio_frames(size_t sample_rate, uint64_t frames)
 	return util_mul_div64(frames, sample_rate, 1000000000ULL);
 }
 
+/* Timing of the audio thread, in nanoseconds.  output_ns is the age of the
+ * mixed audio when it is handed to outputs, i.e. audio buffering plus one
+ * tick; late_ns is how long after its scheduled time a tick started. */
+struct audio_output_latency {
+	bool external_clock;
+	uint64_t ticks;
+
+	uint64_t output_ns;
+	uint64_t max_output_ns;
+	uint64_t total_output_ns;
+
+	uint64_t mix_ns;
+	uint64_t max_mix_ns;
+
+	uint64_t late_ns;
+	uint64_t max_late_ns;
+};
+
 #define AUDIO_OUTPUT_SUCCESS 0
 #define AUDIO_OUTPUT_INVALIDPARAM -1
 #define AUDIO_OUTPUT_FAIL -2
@@ -223,6 +241,16 @@ EXPORT size_t audio_output_get_channels(const audio_t *audio);
 EXPORT uint32_t audio_output_get_sample_rate(const audio_t *audio);
 EXPORT const struct audio_output_info *audio_output_get_info(const audio_t *audio);
 
+/* Lets an audio device drive the audio thread instead of the system timer.
+ * Only one clock can be attached at a time.  This only changes when ticks
+ * start, within one tick of the system timer; tick size and audio buffering,
+ * and so latency, stay the same. */
+EXPORT bool audio_output_attach_clock(audio_t *audio);
+EXPORT void audio_output_detach_clock(audio_t *audio);
+EXPORT void audio_output_clock_advance(audio_t *audio, uint32_t frames);
+
+EXPORT void audio_output_get_latency(audio_t *audio, struct audio_output_latency *latency);
+
 #ifdef __cplusplus
 }
 #endif
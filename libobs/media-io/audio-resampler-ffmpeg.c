@@ -17,12 +17,15 @@
 
 #include "../util/bmem.h"
 #include "audio-resampler.h"
+#include "audio-resampler-polyphase.h"
 #include "audio-io.h"
 #include <libavutil/avutil.h>
 #include <libavformat/avformat.h>
 #include <libswresample/swresample.h>
 
 struct audio_resampler {
+	struct polyphase_resampler *polyphase;
+
 	struct SwrContext *context;
 	bool opened;
 
@@ -97,11 +100,36 @@ static inline uint64_t convert_speaker_layout(enum speaker_layout layout)
 }
 #endif
 
+static enum audio_resampler_type default_type = AUDIO_RESAMPLER_SWRESAMPLE;
+
+void audio_resampler_set_default_type(enum audio_resampler_type type)
+{
+	default_type = type;
+}
+
+enum audio_resampler_type audio_resampler_get_default_type(void)
+{
+	return default_type;
+}
+
 audio_resampler_t *audio_resampler_create(const struct resample_info *dst, const struct resample_info *src)
+{
+	return audio_resampler_create_type(default_type, dst, src);
+}
+
+audio_resampler_t *audio_resampler_create_type(enum audio_resampler_type type, const struct resample_info *dst,
+					       const struct resample_info *src)
 {
 	struct audio_resampler *rs = bzalloc(sizeof(struct audio_resampler));
 	int errcode;
 
+	/* conversions the polyphase resampler can't do go to swresample */
+	if (type == AUDIO_RESAMPLER_POLYPHASE) {
+		rs->polyphase = polyphase_resampler_create(dst, src);
+		if (rs->polyphase)
+			return rs;
+	}
+
 	rs->opened = false;
 	rs->input_freq = src->samples_per_sec;
 	rs->input_format = convert_audio_format(src->format);
@@ -169,6 +197,7 @@ audio_resampler_t *audio_resampler_create(const struct resample_info *dst, const
 void audio_resampler_destroy(audio_resampler_t *rs)
 {
 	if (rs) {
+		polyphase_resampler_destroy(rs->polyphase);
 		if (rs->context)
 			swr_free(&rs->context);
 		if (rs->output_buffer[0])
@@ -183,6 +212,8 @@ bool audio_resampler_resample(audio_resampler_t *rs, uint8_t *output[], uint32_t
 {
 	if (!rs)
 		return false;
+	if (rs->polyphase)
+		return polyphase_resampler_resample(rs->polyphase, output, out_frames, ts_offset, input, in_frames);
 
 	struct SwrContext *context = rs->context;
 	int ret;
@@ -216,3 +247,8 @@ bool audio_resampler_resample(audio_resampler_t *rs, uint8_t *output[], uint32_t
 	*out_frames = (uint32_t)ret;
 	return true;
 }
+
+enum audio_resampler_type audio_resampler_get_type(const audio_resampler_t *rs)
+{
+	return rs && rs->polyphase ? AUDIO_RESAMPLER_POLYPHASE : AUDIO_RESAMPLER_SWRESAMPLE;
+}
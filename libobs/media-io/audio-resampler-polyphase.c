@@ -0,0 +1,428 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ *   Polyphase resampler.  For a rate pair reduced to out:in = L:M, output
+ * sample n sits at input position n * M / L, so its fractional part is one
+ * of L phases.  Each phase gets its own slice of a Kaiser windowed sinc
+ * filter, and every output sample is a single dot product of that slice
+ * with the input around it.
+ *
+ *   The filter bank only depends on the rate pair, so resamplers with the
+ * same pair share it.
+ */
+
+#include <math.h>
+#include <inttypes.h>
+#include "../util/base.h"
+#include "../util/bmem.h"
+#include "../util/darray.h"
+#include "../util/threading.h"
+#include "../util/sse-intrin.h"
+#include "audio-resampler-polyphase.h"
+
+/* zero crossings on each side of the filter when upsampling */
+#define HALF_TAPS 16
+#define KAISER_BETA 9.0
+/* cutoff relative to the lower of the two nyquist frequencies */
+#define PASSBAND 0.95
+#define MAX_PHASES 1024
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+struct polyphase_bank {
+	uint32_t in_rate;
+	uint32_t out_rate;
+	uint32_t phases;
+	uint32_t step;
+	uint32_t taps;
+	float *coeffs;
+	long refs;
+};
+
+struct polyphase_resampler {
+	struct polyphase_bank *bank;
+	uint32_t channels;
+	enum audio_format in_format;
+	enum audio_format out_format;
+
+	/* per channel input, starting with the samples still needed by the
+	 * next output sample */
+	DARRAY(float) input[MAX_AUDIO_CHANNELS];
+	size_t pos;
+	uint32_t phase;
+
+	DARRAY(float) output[MAX_AUDIO_CHANNELS];
+	DARRAY(uint8_t) packed;
+};
+
+static pthread_mutex_t bank_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct polyphase_bank *) banks;
+
+/* ------------------------------------------------------------------------- */
+/* filter banks */
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+	while (b) {
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+static double bessel_i0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+
+	for (int k = 1; k < 64; k++) {
+		double val = x / (2.0 * k);
+		term *= val * val;
+		sum += term;
+		if (term < sum * 1e-12)
+			break;
+	}
+
+	return sum;
+}
+
+static void fill_bank(struct polyphase_bank *bank)
+{
+	double ratio = bank->out_rate < bank->in_rate ? (double)bank->out_rate / (double)bank->in_rate : 1.0;
+	double cutoff = PASSBAND * ratio;
+	double half = bank->taps / 2.0;
+	double i0_beta = bessel_i0(KAISER_BETA);
+
+	for (uint32_t p = 0; p < bank->phases; p++) {
+		float *coeffs = bank->coeffs + (size_t)p * bank->taps;
+		double vals[1024];
+		double *phase_vals = bank->taps <= 1024 ? vals : bmalloc(sizeof(double) * bank->taps);
+		double sum = 0.0;
+
+		for (uint32_t k = 0; k < bank->taps; k++) {
+			/* distance from this tap to the output position */
+			double d = (double)k - (half - 1.0) - (double)p / (double)bank->phases;
+			double x = d / half;
+			double window = fabs(x) < 1.0 ? bessel_i0(KAISER_BETA * sqrt(1.0 - x * x)) / i0_beta : 0.0;
+			double sinc = fabs(d) < 1e-9 ? 1.0 : sin(M_PI * cutoff * d) / (M_PI * cutoff * d);
+
+			phase_vals[k] = sinc * window;
+			sum += phase_vals[k];
+		}
+
+		/* unity gain at DC for every phase */
+		for (uint32_t k = 0; k < bank->taps; k++)
+			coeffs[k] = (float)(phase_vals[k] / sum);
+
+		if (phase_vals != vals)
+			bfree(phase_vals);
+	}
+}
+
+static struct polyphase_bank *bank_acquire(uint32_t in_rate, uint32_t out_rate)
+{
+	struct polyphase_bank *bank = NULL;
+	uint32_t div = gcd(in_rate, out_rate);
+
+	if (out_rate / div > MAX_PHASES)
+		return NULL;
+
+	pthread_mutex_lock(&bank_mutex);
+
+	for (size_t i = 0; i < banks.num; i++) {
+		if (banks.array[i]->in_rate == in_rate && banks.array[i]->out_rate == out_rate) {
+			bank = banks.array[i];
+			bank->refs++;
+			goto unlock;
+		}
+	}
+
+	double ratio = out_rate < in_rate ? (double)out_rate / (double)in_rate : 1.0;
+
+	bank = bzalloc(sizeof(*bank));
+	bank->in_rate = in_rate;
+	bank->out_rate = out_rate;
+	bank->phases = out_rate / div;
+	bank->step = in_rate / div;
+	/* widen the filter when downsampling to keep its transition band
+	 * relative to the output rate, and pad to whole SIMD vectors */
+	bank->taps = ((uint32_t)ceil(2.0 * HALF_TAPS / ratio) + 3) & ~3U;
+	bank->coeffs = bmalloc(sizeof(float) * bank->phases * bank->taps);
+	bank->refs = 1;
+	fill_bank(bank);
+
+	da_push_back(banks, &bank);
+
+	blog(LOG_DEBUG, "polyphase resampler: created filter bank for %" PRIu32 " -> %" PRIu32 " Hz (%" PRIu32
+			" phases, %" PRIu32 " taps)",
+	     in_rate, out_rate, bank->phases, bank->taps);
+
+unlock:
+	pthread_mutex_unlock(&bank_mutex);
+	return bank;
+}
+
+static void bank_release(struct polyphase_bank *bank)
+{
+	if (!bank)
+		return;
+
+	pthread_mutex_lock(&bank_mutex);
+
+	if (--bank->refs == 0) {
+		da_erase_item(banks, &bank);
+		if (!banks.num)
+			da_free(banks);
+
+		bfree(bank->coeffs);
+		bfree(bank);
+	}
+
+	pthread_mutex_unlock(&bank_mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+/* sample conversion */
+
+static void read_channel(float *dst, enum audio_format format, const uint8_t *const input[], uint32_t channels,
+			 uint32_t channel, uint32_t frames)
+{
+	bool planar = is_audio_planar(format);
+	const uint8_t *data = planar ? input[channel] : input[0];
+	size_t stride = planar ? 1 : channels;
+	size_t offset = planar ? 0 : channel;
+
+	switch (format) {
+	case AUDIO_FORMAT_U8BIT:
+	case AUDIO_FORMAT_U8BIT_PLANAR:
+		for (uint32_t i = 0; i < frames; i++)
+			dst[i] = ((float)data[i * stride + offset] - 128.0f) / 128.0f;
+		break;
+	case AUDIO_FORMAT_16BIT:
+	case AUDIO_FORMAT_16BIT_PLANAR:
+		for (uint32_t i = 0; i < frames; i++)
+			dst[i] = (float)((const int16_t *)data)[i * stride + offset] / 32768.0f;
+		break;
+	case AUDIO_FORMAT_32BIT:
+	case AUDIO_FORMAT_32BIT_PLANAR:
+		for (uint32_t i = 0; i < frames; i++)
+			dst[i] = (float)((double)((const int32_t *)data)[i * stride + offset] / 2147483648.0);
+		break;
+	case AUDIO_FORMAT_FLOAT:
+	case AUDIO_FORMAT_FLOAT_PLANAR:
+		if (planar) {
+			memcpy(dst, data, frames * sizeof(float));
+		} else {
+			for (uint32_t i = 0; i < frames; i++)
+				dst[i] = ((const float *)data)[i * stride + offset];
+		}
+		break;
+	case AUDIO_FORMAT_UNKNOWN:
+		memset(dst, 0, frames * sizeof(float));
+		break;
+	}
+}
+
+static inline float clamp_sample(float val)
+{
+	return val > 1.0f ? 1.0f : (val < -1.0f ? -1.0f : val);
+}
+
+static void write_channel(uint8_t *data, enum audio_format format, const float *src, uint32_t channels,
+			  uint32_t channel, uint32_t frames)
+{
+	bool planar = is_audio_planar(format);
+	size_t stride = planar ? 1 : channels;
+	size_t offset = planar ? 0 : channel;
+
+	switch (format) {
+	case AUDIO_FORMAT_U8BIT:
+	case AUDIO_FORMAT_U8BIT_PLANAR:
+		for (uint32_t i = 0; i < frames; i++)
+			data[i * stride + offset] = (uint8_t)lrintf(clamp_sample(src[i]) * 127.0f + 128.0f);
+		break;
+	case AUDIO_FORMAT_16BIT:
+	case AUDIO_FORMAT_16BIT_PLANAR:
+		for (uint32_t i = 0; i < frames; i++)
+			((int16_t *)data)[i * stride + offset] = (int16_t)lrintf(clamp_sample(src[i]) * 32767.0f);
+		break;
+	case AUDIO_FORMAT_32BIT:
+	case AUDIO_FORMAT_32BIT_PLANAR:
+		for (uint32_t i = 0; i < frames; i++)
+			((int32_t *)data)[i * stride + offset] =
+				(int32_t)lrint((double)clamp_sample(src[i]) * 2147483647.0);
+		break;
+	case AUDIO_FORMAT_FLOAT:
+	case AUDIO_FORMAT_FLOAT_PLANAR:
+		for (uint32_t i = 0; i < frames; i++)
+			((float *)data)[i * stride + offset] = src[i];
+		break;
+	case AUDIO_FORMAT_UNKNOWN:
+		break;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* resampling */
+
+static inline float dot_product(const float *samples, const float *coeffs, uint32_t taps)
+{
+	__m128 sum0 = _mm_setzero_ps();
+	__m128 sum1 = _mm_setzero_ps();
+	uint32_t i = 0;
+
+	for (; i + 8 <= taps; i += 8) {
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coeffs + i)));
+		sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(samples + i + 4), _mm_loadu_ps(coeffs + i + 4)));
+	}
+	if (i < taps)
+		sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(samples + i), _mm_loadu_ps(coeffs + i)));
+
+	sum0 = _mm_add_ps(sum0, sum1);
+	sum0 = _mm_add_ps(sum0, _mm_movehl_ps(sum0, sum0));
+	sum0 = _mm_add_ss(sum0, _mm_shuffle_ps(sum0, sum0, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(sum0);
+}
+
+struct polyphase_resampler *polyphase_resampler_create(const struct resample_info *dst,
+						       const struct resample_info *src)
+{
+	struct polyphase_resampler *rs;
+	struct polyphase_bank *bank;
+
+	if (dst->speakers != src->speakers || dst->speakers == SPEAKERS_UNKNOWN)
+		return NULL;
+	if (!dst->samples_per_sec || !src->samples_per_sec || dst->samples_per_sec == src->samples_per_sec)
+		return NULL;
+	if (dst->format == AUDIO_FORMAT_UNKNOWN || src->format == AUDIO_FORMAT_UNKNOWN)
+		return NULL;
+
+	bank = bank_acquire(src->samples_per_sec, dst->samples_per_sec);
+	if (!bank)
+		return NULL;
+
+	rs = bzalloc(sizeof(*rs));
+	rs->bank = bank;
+	rs->channels = get_audio_channels(dst->speakers);
+	rs->in_format = src->format;
+	rs->out_format = dst->format;
+
+	/* start with the first output sample right on the first input sample */
+	for (uint32_t c = 0; c < rs->channels; c++) {
+		da_resize(rs->input[c], bank->taps / 2 - 1);
+		memset(rs->input[c].array, 0, rs->input[c].num * sizeof(float));
+	}
+
+	return rs;
+}
+
+void polyphase_resampler_destroy(struct polyphase_resampler *rs)
+{
+	if (!rs)
+		return;
+
+	for (uint32_t c = 0; c < MAX_AUDIO_CHANNELS; c++) {
+		da_free(rs->input[c]);
+		da_free(rs->output[c]);
+	}
+	da_free(rs->packed);
+
+	bank_release(rs->bank);
+	bfree(rs);
+}
+
+bool polyphase_resampler_resample(struct polyphase_resampler *rs, uint8_t *output[], uint32_t *out_frames,
+				  uint64_t *ts_offset, const uint8_t *const input[], uint32_t in_frames)
+{
+	const struct polyphase_bank *bank = rs->bank;
+	uint32_t taps = bank->taps;
+	size_t buffered = rs->input[0].num;
+	size_t pos = rs->pos;
+	uint32_t phase = rs->phase;
+	uint64_t frames = 0;
+
+	/* input that the next output sample has not reached yet */
+	double pending = (double)buffered - (double)(pos + taps / 2 - 1) - (double)phase / (double)bank->phases;
+	*ts_offset = pending > 0.0 ? (uint64_t)(pending * 1000000000.0 / (double)bank->in_rate) : 0;
+
+	for (uint32_t c = 0; c < rs->channels; c++) {
+		da_resize(rs->input[c], buffered + in_frames);
+		read_channel(rs->input[c].array + buffered, rs->in_format, input, rs->channels, c, in_frames);
+	}
+	buffered += in_frames;
+
+	/* output n needs the taps starting at pos + (phase + n * step) / phases */
+	if (buffered >= pos + taps) {
+		uint64_t last = (uint64_t)(buffered - pos - taps + 1) * bank->phases;
+		frames = (last - phase + bank->step - 1) / bank->step;
+	}
+
+	for (uint32_t c = 0; c < rs->channels; c++) {
+		const float *samples = rs->input[c].array;
+		size_t cur_pos = pos;
+		uint32_t cur_phase = phase;
+		float *out;
+
+		da_resize(rs->output[c], (size_t)frames);
+		out = rs->output[c].array;
+
+		for (uint64_t n = 0; n < frames; n++) {
+			out[n] = dot_product(samples + cur_pos, bank->coeffs + (size_t)cur_phase * taps, taps);
+
+			cur_phase += bank->step;
+			cur_pos += cur_phase / bank->phases;
+			cur_phase %= bank->phases;
+		}
+
+		if (c == rs->channels - 1) {
+			rs->pos = cur_pos;
+			rs->phase = cur_phase;
+		}
+	}
+
+	/* drop input no output needs anymore */
+	if (rs->pos) {
+		for (uint32_t c = 0; c < rs->channels; c++)
+			da_erase_range(rs->input[c], 0, rs->pos);
+		rs->pos = 0;
+	}
+
+	if (rs->out_format == AUDIO_FORMAT_FLOAT_PLANAR) {
+		for (uint32_t c = 0; c < rs->channels; c++)
+			output[c] = (uint8_t *)rs->output[c].array;
+	} else {
+		bool planar = is_audio_planar(rs->out_format);
+		size_t plane_size = (size_t)frames * get_audio_bytes_per_channel(rs->out_format);
+
+		da_resize(rs->packed, plane_size * rs->channels);
+
+		for (uint32_t c = 0; c < rs->channels; c++) {
+			uint8_t *plane = rs->packed.array + (planar ? plane_size * c : 0);
+			write_channel(plane, rs->out_format, rs->output[c].array, rs->channels, c, (uint32_t)frames);
+
+			if (planar || c == 0)
+				output[c] = plane;
+		}
+	}
+
+	*out_frames = (uint32_t)frames;
+	return true;
+}
@@ -33,7 +33,20 @@ struct resample_info {
 	enum speaker_layout speakers;
 };
 
+enum audio_resampler_type {
+	AUDIO_RESAMPLER_SWRESAMPLE,
+	AUDIO_RESAMPLER_POLYPHASE,
+};
+
+/* type used by audio_resampler_create; conversions the polyphase resampler
+ * does not handle (channel remixing, equal rates) always use swresample */
+EXPORT void audio_resampler_set_default_type(enum audio_resampler_type type);
+EXPORT enum audio_resampler_type audio_resampler_get_default_type(void);
+
 EXPORT audio_resampler_t *audio_resampler_create(const struct resample_info *dst, const struct resample_info *src);
+EXPORT audio_resampler_t *audio_resampler_create_type(enum audio_resampler_type type, const struct resample_info *dst,
+						      const struct resample_info *src);
+EXPORT enum audio_resampler_type audio_resampler_get_type(const audio_resampler_t *resampler);
 EXPORT void audio_resampler_destroy(audio_resampler_t *resampler);
 
 EXPORT bool audio_resampler_resample(audio_resampler_t *resampler, uint8_t *output[], uint32_t *out_frames,
@@ -0,0 +1,365 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include "util/c99defs.h"
+#include "util/bmem.h"
+#include "util/darray.h"
+#include "util/threading.h"
+#include "util/util_uint64.h"
+#include "media-io/audio-io.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* must be powers of two.  a ring starts at AUDIO_QUEUE_FRAMES and is replaced
+ * with one twice its size while full, up to about as much audio as
+ * audio_input_buf accepts (MAX_BUF_SIZE) */
+#define AUDIO_QUEUE_FRAMES 16384
+#define AUDIO_QUEUE_SEGMENTS 256
+#define AUDIO_QUEUE_MAX_FRAMES (1 << 20)
+
+/* longest segment, so large outputs never fill a ring on their own */
+#define AUDIO_QUEUE_SEGMENT_FRAMES (AUDIO_QUEUE_FRAMES / 4)
+
+struct audio_segment {
+	uint64_t timestamp;
+	uint32_t frames;
+	bool push_back;
+	bool reset;
+};
+
+/* Wait-free single producer/single consumer ring of timestamped audio
+ * segments.  The counters run freely; each one is written by one side only. */
+struct audio_queue_ring {
+	size_t frames;
+	size_t segments;
+	float *data[MAX_AUDIO_CHANNELS];
+	struct audio_segment *segs;
+
+	/* producer */
+	volatile long segments_written;
+	long frames_written;
+	/* set once the producer moved on to next, after its last segment */
+	volatile bool closed;
+	struct audio_queue_ring *next;
+
+	/* consumer */
+	volatile long segments_read;
+	volatile long frames_read;
+};
+
+/* Queue of audio from whichever thread outputs a source's audio to the audio
+ * thread.  The producer replaces a full ring with a larger one, the consumer
+ * moves on to it and frees the old one once it read everything from it. */
+struct audio_queue {
+	/* producer */
+	struct audio_queue_ring *write;
+	uint64_t dropped_frames;
+
+	/* consumer */
+	struct audio_queue_ring *read;
+	DARRAY(float) scratch;
+};
+
+/* consumer position while draining; nothing it read is released to the
+ * producer until audio_queue_end_read */
+struct audio_queue_reader {
+	struct audio_queue_ring *ring;
+	long written;
+	long read;
+	long frames_read;
+};
+
+static inline unsigned long audio_queue_count(long written, long read)
+{
+	return (unsigned long)written - (unsigned long)read;
+}
+
+static inline long audio_queue_advance(long counter, unsigned long count)
+{
+	return (long)((unsigned long)counter + count);
+}
+
+static inline struct audio_queue_ring *audio_queue_ring_create(size_t frames, size_t segments)
+{
+	struct audio_queue_ring *ring = (struct audio_queue_ring *)bzalloc(sizeof(*ring));
+	ring->frames = frames;
+	ring->segments = segments;
+	ring->segs = (struct audio_segment *)bzalloc(segments * sizeof(struct audio_segment));
+	return ring;
+}
+
+static inline void audio_queue_ring_free(struct audio_queue_ring *ring)
+{
+	for (size_t i = 0; i < MAX_AUDIO_CHANNELS; i++)
+		bfree(ring->data[i]);
+	bfree(ring->segs);
+	bfree(ring);
+}
+
+static inline void audio_queue_init(struct audio_queue *queue)
+{
+	queue->write = queue->read = audio_queue_ring_create(AUDIO_QUEUE_FRAMES, AUDIO_QUEUE_SEGMENTS);
+}
+
+static inline void audio_queue_free(struct audio_queue *queue)
+{
+	struct audio_queue_ring *ring = queue->read;
+
+	while (ring) {
+		struct audio_queue_ring *next = ring->next;
+		audio_queue_ring_free(ring);
+		ring = next;
+	}
+
+	queue->write = queue->read = NULL;
+	da_free(queue->scratch);
+}
+
+static inline void audio_queue_publish(struct audio_queue_ring *ring, long segments)
+{
+	os_atomic_store_long(&ring->segments_written, audio_queue_advance(segments, 1));
+}
+
+/* ------------------------------------------------------------------------- */
+/* producer */
+
+/* replaces the full write ring, returns NULL once it is as large as allowed */
+static inline struct audio_queue_ring *audio_queue_grow(struct audio_queue *queue)
+{
+	struct audio_queue_ring *ring = queue->write;
+	struct audio_queue_ring *next;
+
+	if (ring->frames >= AUDIO_QUEUE_MAX_FRAMES)
+		return NULL;
+
+	next = audio_queue_ring_create(ring->frames * 2, ring->segments * 2);
+	ring->next = next;
+	os_atomic_set_bool(&ring->closed, true);
+	queue->write = next;
+	return next;
+}
+
+static inline bool audio_queue_has_space(struct audio_queue_ring *ring, uint32_t frames, unsigned long segments)
+{
+	unsigned long used_segments =
+		audio_queue_count(ring->segments_written, os_atomic_load_long(&ring->segments_read));
+	unsigned long used_frames = audio_queue_count(ring->frames_written, os_atomic_load_long(&ring->frames_read));
+
+	return used_segments + segments <= ring->segments && used_frames + frames <= ring->frames;
+}
+
+/* returns false if frames had to be dropped */
+static inline bool audio_queue_push(struct audio_queue *queue, const struct audio_data *in, size_t channels,
+				    size_t sample_rate, bool push_back)
+{
+	uint32_t offset = 0;
+
+	while (offset < in->frames) {
+		struct audio_queue_ring *ring = queue->write;
+		long segments = ring->segments_written;
+		uint32_t frames = in->frames - offset;
+		struct audio_segment *seg;
+		size_t pos, first;
+
+		if (frames > AUDIO_QUEUE_SEGMENT_FRAMES)
+			frames = AUDIO_QUEUE_SEGMENT_FRAMES;
+
+		/* always leave a segment free for a reset */
+		if (!audio_queue_has_space(ring, frames, 2)) {
+			if (!audio_queue_grow(queue)) {
+				queue->dropped_frames += in->frames - offset;
+				return false;
+			}
+			continue;
+		}
+
+		for (size_t ch = 0; ch < channels; ch++) {
+			if (!ring->data[ch])
+				ring->data[ch] = (float *)bmalloc(ring->frames * sizeof(float));
+		}
+
+		pos = (unsigned long)ring->frames_written & (ring->frames - 1);
+		first = ring->frames - pos;
+		if (first > frames)
+			first = frames;
+
+		for (size_t ch = 0; ch < channels; ch++) {
+			const float *src = (const float *)in->data[ch] + offset;
+
+			memcpy(ring->data[ch] + pos, src, first * sizeof(float));
+			if (frames > first)
+				memcpy(ring->data[ch], src + first, (frames - first) * sizeof(float));
+		}
+
+		seg = &ring->segs[(unsigned long)segments & (ring->segments - 1)];
+		seg->timestamp = in->timestamp;
+		if (offset && sample_rate)
+			seg->timestamp += util_mul_div64(offset, 1000000000ULL, sample_rate);
+		seg->frames = frames;
+		seg->push_back = push_back || offset > 0;
+		seg->reset = false;
+
+		ring->frames_written = audio_queue_advance(ring->frames_written, frames);
+		audio_queue_publish(ring, segments);
+		offset += frames;
+	}
+
+	return true;
+}
+
+/* returns false if the queue is completely full */
+static inline bool audio_queue_push_reset(struct audio_queue *queue, uint64_t timestamp)
+{
+	struct audio_queue_ring *ring = queue->write;
+	struct audio_segment *seg;
+
+	if (!audio_queue_has_space(ring, 0, 1)) {
+		ring = audio_queue_grow(queue);
+		if (!ring)
+			return false;
+	}
+
+	long segments = ring->segments_written;
+	seg = &ring->segs[(unsigned long)segments & (ring->segments - 1)];
+	seg->timestamp = timestamp;
+	seg->frames = 0;
+	seg->push_back = false;
+	seg->reset = true;
+
+	audio_queue_publish(ring, segments);
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* consumer */
+
+/* points the audio data at the queued frames, copying them out first if they
+ * wrap around the end of the ring */
+static inline void audio_queue_map_segment(struct audio_queue *queue, struct audio_queue_ring *ring,
+					   struct audio_data *in, size_t channels, long frames_read)
+{
+	size_t pos = (unsigned long)frames_read & (ring->frames - 1);
+	size_t first = ring->frames - pos;
+	bool copy = in->frames > first;
+
+	for (size_t ch = 0; ch < channels; ch++) {
+		if (!ring->data[ch])
+			copy = true;
+	}
+
+	if (copy)
+		da_resize(queue->scratch, channels * in->frames);
+
+	for (size_t ch = 0; ch < channels; ch++) {
+		const float *plane = ring->data[ch];
+		float *out;
+
+		if (plane && !copy) {
+			in->data[ch] = (uint8_t *)(plane + pos);
+			continue;
+		}
+
+		out = queue->scratch.array + ch * in->frames;
+		if (!plane) {
+			memset(out, 0, in->frames * sizeof(float));
+		} else if (in->frames > first) {
+			memcpy(out, plane + pos, first * sizeof(float));
+			memcpy(out + first, plane, (in->frames - first) * sizeof(float));
+		} else {
+			memcpy(out, plane + pos, in->frames * sizeof(float));
+		}
+
+		in->data[ch] = (uint8_t *)out;
+	}
+}
+
+static inline void audio_queue_begin_ring(struct audio_queue_ring *ring, struct audio_queue_reader *reader)
+{
+	reader->ring = ring;
+	reader->written = os_atomic_load_long(&ring->segments_written);
+	reader->read = ring->segments_read;
+	reader->frames_read = ring->frames_read;
+}
+
+static inline void audio_queue_begin_read(struct audio_queue *queue, struct audio_queue_reader *reader)
+{
+	audio_queue_begin_ring(queue->read, reader);
+}
+
+/* moves on to the next ring once the producer closed the current one and
+ * everything in it was read.  returns false if there is nothing to read */
+static inline bool audio_queue_next_ring(struct audio_queue *queue, struct audio_queue_reader *reader)
+{
+	while (reader->read == reader->written) {
+		struct audio_queue_ring *ring = reader->ring;
+
+		if (!os_atomic_load_bool(&ring->closed))
+			return false;
+
+		/* segments published before it was closed */
+		reader->written = os_atomic_load_long(&ring->segments_written);
+		if (reader->read != reader->written)
+			break;
+
+		queue->read = ring->next;
+		audio_queue_ring_free(ring);
+		audio_queue_begin_ring(queue->read, reader);
+	}
+
+	return true;
+}
+
+/* returns the next segment published before audio_queue_begin_read, or in a
+ * ring that replaced it.  the audio data stays valid until the next call */
+static inline bool audio_queue_read(struct audio_queue *queue, struct audio_queue_reader *reader, size_t channels,
+				    struct audio_segment *seg, struct audio_data *in)
+{
+	struct audio_queue_ring *ring;
+
+	if (!audio_queue_next_ring(queue, reader))
+		return false;
+
+	ring = reader->ring;
+	*seg = ring->segs[(unsigned long)reader->read & (ring->segments - 1)];
+	reader->read = audio_queue_advance(reader->read, 1);
+
+	memset(in, 0, sizeof(*in));
+	if (seg->reset)
+		return true;
+
+	in->frames = seg->frames;
+	in->timestamp = seg->timestamp;
+	audio_queue_map_segment(queue, ring, in, channels, reader->frames_read);
+	reader->frames_read = audio_queue_advance(reader->frames_read, seg->frames);
+	return true;
+}
+
+static inline void audio_queue_end_read(struct audio_queue *queue, const struct audio_queue_reader *reader)
+{
+	UNUSED_PARAMETER(queue);
+
+	os_atomic_store_long(&reader->ring->frames_read, reader->frames_read);
+	os_atomic_store_long(&reader->ring->segments_read, reader->read);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -175,7 +175,7 @@ static bool ignore_audio(obs_source_t *source, size_t channels, size_t sample_ra
 	source->audio_ts = 0;
 	/* tell the timestamp adjustment code in source_output_audio_data to
 	 * reset everything, and hopefully fix the timestamps */
-	source->timing_set = false;
+	os_atomic_set_bool(&source->audio_timing_reset, true);
 	return false;
 }
 
@@ -616,6 +616,7 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 
 	source = data->first_audio_source;
 	while (source) {
+		obs_source_drain_audio_queue(source);
 		if (!obs_source_removed(source)) {
 			push_audio_tree(NULL, source, audio);
 		}
@@ -648,9 +649,7 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 				assert(false);
 #endif
 			} else {
-				pthread_mutex_lock(&source->audio_buf_mutex);
 				bool rerender = ignore_audio(source, channels, sample_rate, ts.start);
-				pthread_mutex_unlock(&source->audio_buf_mutex);
 
 				/* if we (potentially) recovered, re-render */
 				if (rerender)
@@ -684,12 +683,8 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 			if (source->audio_pending)
 				continue;
 
-			pthread_mutex_lock(&source->audio_buf_mutex);
-
 			if (source->audio_output_buf[0][0] && source->audio_ts)
 				mix_audio(mixes, source, channels, sample_rate, &ts);
-
-			pthread_mutex_unlock(&source->audio_buf_mutex);
 		}
 	}
 
@@ -699,9 +694,7 @@ bool audio_callback(void *param, uint64_t start_ts_in, uint64_t end_ts_in, uint6
 
 	source = data->first_audio_source;
 	while (source) {
-		pthread_mutex_lock(&source->audio_buf_mutex);
 		discard_audio(audio, source, channels, sample_rate, &ts);
-		pthread_mutex_unlock(&source->audio_buf_mutex);
 
 		source = (struct obs_source *)source->next_audio_source;
 	}
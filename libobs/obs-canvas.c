@@ -423,6 +423,16 @@ bool obs_canvas_get_video_info(const obs_canvas_t *canvas, struct obs_video_info
 	return true;
 }
 
+uint32_t obs_canvas_get_rendered_frames(const obs_canvas_t *canvas)
+{
+	return canvas->mix ? canvas->mix->rendered_frames : 0;
+}
+
+uint32_t obs_canvas_get_skipped_frames(const obs_canvas_t *canvas)
+{
+	return canvas->mix ? canvas->mix->skipped_frames : 0;
+}
+
 signal_handler_t *obs_canvas_get_signal_handler(obs_canvas_t *canvas)
 {
 	return canvas->context.signals;
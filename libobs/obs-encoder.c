@@ -26,7 +26,7 @@
 
 static void encoder_set_video(obs_encoder_t *encoder, video_t *video);
 
-struct obs_encoder_info *find_encoder(const char *id)
+static struct obs_encoder_info *find_encoder_type(const char *id)
 {
 	for (size_t i = 0; i < obs->encoder_types.num; i++) {
 		struct obs_encoder_info *info = obs->encoder_types.array + i;
@@ -38,6 +38,14 @@ struct obs_encoder_info *find_encoder(const char *id)
 	return NULL;
 }
 
+struct obs_encoder_info *find_encoder(const char *id)
+{
+	struct obs_encoder_info *info = find_encoder_type(id);
+	if (!info && obs_module_load_deferred_type(DEFERRED_ENCODER, id))
+		info = find_encoder_type(id);
+	return info;
+}
+
 const char *obs_encoder_get_display_name(const char *id)
 {
 	struct obs_encoder_info *ei = find_encoder(id);
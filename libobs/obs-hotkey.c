@@ -464,6 +464,8 @@ static inline void create_binding(obs_hotkey_t *hotkey, obs_key_combination_t co
 	binding->key = combo;
 	binding->hotkey_id = hotkey->id;
 	binding->hotkey = hotkey;
+
+	obs->hotkeys.key_index_dirty = true;
 }
 
 static inline void load_binding(obs_hotkey_t *hotkey, obs_data_t *data)
@@ -814,6 +816,9 @@ static inline bool remove_bindings(obs_hotkey_id id)
 		removed = true;
 	}
 
+	if (removed)
+		obs->hotkeys.key_index_dirty = true;
+
 	return removed;
 }
 
@@ -958,6 +963,8 @@ void obs_hotkeys_free(void)
 	}
 
 	da_free(obs->hotkeys.bindings);
+	da_free(obs->hotkeys.key_index);
+	obs->hotkeys.key_index_dirty = true;
 
 	for (size_t i = 0; i < OBS_KEY_LAST_VALUE; i++) {
 		if (obs->hotkeys.translations[i]) {
@@ -1004,6 +1011,16 @@ static inline bool is_pressed(obs_key_t key)
 	return obs_hotkeys_platform_is_pressed(obs->hotkeys.platform_context, key);
 }
 
+/* keys reported through key events are held until released; the platform is
+ * only asked while there is no key event source */
+static inline bool key_down(obs_key_t key)
+{
+	if (key > OBS_KEY_NONE && key < OBS_KEY_LAST_VALUE && obs->hotkeys.key_state[key])
+		return true;
+
+	return !os_atomic_load_bool(&obs->hotkeys.key_events) && is_pressed(key);
+}
+
 static inline void press_released_binding(obs_hotkey_binding_t *binding)
 {
 	binding->pressed = true;
@@ -1050,7 +1067,7 @@ static inline void handle_binding(obs_hotkey_binding_t *binding, uint32_t modifi
 	if ((!binding->modifiers_match && !modifiers_only) || !modifiers_match_)
 		goto reset;
 
-	if ((pressed && !*pressed) || (!pressed && !is_pressed(binding->key.key)))
+	if ((pressed && !*pressed) || (!pressed && !key_down(binding->key.key)))
 		goto reset;
 
 	if (binding->pressed || no_press)
@@ -1132,28 +1149,119 @@ static inline bool query_hotkey(void *data, size_t idx, obs_hotkey_binding_t *bi
 	return true;
 }
 
-static inline void query_hotkeys()
+static inline uint32_t get_modifiers(void)
 {
 	uint32_t modifiers = 0;
-	if (is_pressed(OBS_KEY_SHIFT))
+	if (key_down(OBS_KEY_SHIFT))
 		modifiers |= INTERACT_SHIFT_KEY;
-	if (is_pressed(OBS_KEY_CONTROL))
+	if (key_down(OBS_KEY_CONTROL))
 		modifiers |= INTERACT_CONTROL_KEY;
-	if (is_pressed(OBS_KEY_ALT))
+	if (key_down(OBS_KEY_ALT))
 		modifiers |= INTERACT_ALT_KEY;
-	if (is_pressed(OBS_KEY_META))
+	if (key_down(OBS_KEY_META))
 		modifiers |= INTERACT_COMMAND_KEY;
+	return modifiers;
+}
 
+static inline void query_hotkeys()
+{
 	struct obs_query_hotkeys_helper param = {
-		modifiers,
+		get_modifiers(),
 		obs->hotkeys.thread_disable_press,
 		obs->hotkeys.strict_modifiers,
 	};
 	enum_bindings(query_hotkey, &param);
 }
 
+static void update_key_index(void)
+{
+	struct obs_core_hotkeys *hotkeys = &obs->hotkeys;
+	size_t *start = hotkeys->key_index_start;
+
+	if (!hotkeys->key_index_dirty)
+		return;
+
+	/* count the bindings of each key, then turn the counts into offsets
+	 * and fill in the binding indices */
+	memset(start, 0, sizeof(hotkeys->key_index_start));
+	for (size_t i = 0; i < hotkeys->bindings.num; i++) {
+		obs_key_t key = hotkeys->bindings.array[i].key.key;
+		if (key > OBS_KEY_NONE && key < OBS_KEY_LAST_VALUE)
+			start[key + 1]++;
+	}
+	for (size_t key = 1; key <= OBS_KEY_LAST_VALUE; key++)
+		start[key] += start[key - 1];
+
+	da_resize(hotkeys->key_index, start[OBS_KEY_LAST_VALUE]);
+
+	for (size_t i = 0; i < hotkeys->bindings.num; i++) {
+		obs_key_t key = hotkeys->bindings.array[i].key.key;
+		if (key > OBS_KEY_NONE && key < OBS_KEY_LAST_VALUE)
+			hotkeys->key_index.array[start[key]++] = i;
+	}
+
+	/* filling advanced every offset to the start of the next key */
+	for (size_t key = OBS_KEY_LAST_VALUE; key > 0; key--)
+		start[key] = start[key - 1];
+	start[0] = 0;
+
+	hotkeys->key_index_dirty = false;
+}
+
+static inline bool is_modifier_key(obs_key_t key)
+{
+	return key == OBS_KEY_SHIFT || key == OBS_KEY_CONTROL || key == OBS_KEY_ALT || key == OBS_KEY_META;
+}
+
+static void handle_key_event(obs_key_t key, bool pressed)
+{
+	struct obs_core_hotkeys *hotkeys = &obs->hotkeys;
+
+	if (key <= OBS_KEY_NONE || key >= OBS_KEY_LAST_VALUE || hotkeys->key_state[key] == pressed)
+		return;
+
+	hotkeys->key_state[key] = pressed;
+
+	/* modifiers can change the state of any binding.  bindings only
+	 * trigger once their modifiers matched on a previous pass, so a second
+	 * pass picks up keys that were already held, like the next poll would */
+	if (is_modifier_key(key)) {
+		query_hotkeys();
+		query_hotkeys();
+		return;
+	}
+
+	update_key_index();
+
+	uint32_t modifiers = get_modifiers();
+	size_t end = hotkeys->key_index_start[key + 1];
+
+	/* stop if a callback changed the bindings under us */
+	for (size_t i = hotkeys->key_index_start[key]; i < end && !hotkeys->key_index_dirty; i++) {
+		obs_hotkey_binding_t *binding = &hotkeys->bindings.array[hotkeys->key_index.array[i]];
+		handle_binding(binding, modifiers, hotkeys->thread_disable_press, hotkeys->strict_modifiers, NULL);
+	}
+}
+
+void obs_hotkey_inject_key_event(obs_key_t key, bool pressed)
+{
+	if (!lock())
+		return;
+
+	handle_key_event(key, pressed);
+	unlock();
+}
+
+bool obs_hotkeys_key_events_active(void)
+{
+	return obs && os_atomic_load_bool(&obs->hotkeys.key_events);
+}
+
 #define NBSP "\xC2\xA0"
 
+/* with a key event source the thread only checks that it is still there */
+#define KEY_EVENTS_CHECK_MS 1000
+
 void *obs_hotkey_thread(void *arg)
 {
 	UNUSED_PARAMETER(arg);
@@ -1164,8 +1272,11 @@ void *obs_hotkey_thread(void *arg)
 		profile_store_name(obs_get_profiler_name_store(), "obs_hotkey_thread(%g" NBSP "ms)", 25.);
 	profile_register_root(hotkey_thread_name, (uint64_t)25000000);
 
-	while (os_event_timedwait(obs->hotkeys.stop_event, 25) == ETIMEDOUT) {
-		if (!lock())
+	for (;;) {
+		bool key_events = os_atomic_load_bool(&obs->hotkeys.key_events);
+		if (os_event_timedwait(obs->hotkeys.stop_event, key_events ? KEY_EVENTS_CHECK_MS : 25) != ETIMEDOUT)
+			break;
+		if (key_events || !lock())
 			continue;
 
 		profile_start(hotkey_thread_name);
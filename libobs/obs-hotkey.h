@@ -232,6 +232,14 @@ EXPORT void obs_enum_hotkey_bindings(obs_hotkey_binding_enum_func func, void *da
 
 EXPORT void obs_hotkey_inject_event(obs_key_combination_t hotkey, bool pressed);
 
+/* feeds a single key press or release through the key event path, as used by
+ * platform key event sources; keys stay held until released, also while
+ * hotkeys are polled */
+EXPORT void obs_hotkey_inject_key_event(obs_key_t key, bool pressed);
+
+/* whether hotkeys are driven by platform key events instead of polling */
+EXPORT bool obs_hotkeys_key_events_active(void);
+
 EXPORT void obs_hotkey_enable_background_press(bool enable);
 
 /* hotkey callback routing (trigger callbacks through e.g. a UI thread) */
@@ -38,6 +38,7 @@
 #include "media-io/audio-io.h"
 
 #include "obs.h"
+#include "obs-audio-queue.h"
 
 #include <obsversion.h>
 #include <caption/caption.h>
@@ -135,6 +136,12 @@ struct obs_module {
 	DARRAY(char *) outputs;
 	DARRAY(char *) encoders;
 	DARRAY(char *) services;
+
+	/* types are known from the module cache, but the binary has not been
+	 * loaded yet */
+	bool deferred;
+	uint32_t deferred_source_types;
+	uint64_t load_time_ns;
 };
 
 struct obs_disabled_module {
@@ -153,6 +160,20 @@ struct obs_disabled_module {
 
 extern void free_module(struct obs_module *mod);
 
+enum deferred_type_kind {
+	DEFERRED_SOURCE,
+	DEFERRED_OUTPUT,
+	DEFERRED_ENCODER,
+	DEFERRED_SERVICE,
+};
+
+/* loads the deferred module that provides a type, if there is one */
+extern bool obs_module_load_deferred_type(enum deferred_type_kind kind, const char *id);
+/* loads every deferred module providing types of a kind, for enumeration.
+ * for sources, source_types is a mask of (1 << enum obs_source_type). */
+extern void obs_module_load_deferred_kind(enum deferred_type_kind kind, uint32_t source_types);
+extern void obs_module_free_cache(void);
+
 struct obs_module_path {
 	char *bin;
 	char *data;
@@ -283,6 +304,7 @@ struct obs_view {
 
 extern bool obs_view_init(struct obs_view *view, enum view_type type);
 extern void obs_view_free(struct obs_view *view);
+extern bool obs_view_get_content_hash(struct obs_view *view, uint64_t *hash);
 
 /* ------------------------------------------------------------------------- */
 /* displays */
@@ -377,6 +399,20 @@ struct obs_core_video_mix {
 
 	float color_matrix[16];
 
+	/* render_texture holds content_hash, and the output and convert
+	 * textures were produced from it */
+	uint64_t content_hash;
+	bool content_valid;
+	bool output_valid;
+	bool convert_valid;
+
+	/* zero when rendering on every frame of the main canvas */
+	uint64_t frame_interval_ns;
+	uint64_t next_frame_ns;
+	bool frame_due;
+	uint32_t rendered_frames;
+	uint32_t skipped_frames;
+
 	bool encoder_only_mix;
 	long encoder_refs;
 
@@ -402,6 +438,7 @@ struct obs_core_video {
 	gs_samplerstate_t *point_sampler;
 
 	uint64_t video_time;
+	uint64_t content_frame;
 	uint64_t video_frame_interval_ns;
 	uint64_t video_half_frame_interval_ns;
 	uint64_t video_avg_frame_time_ns;
@@ -413,6 +450,9 @@ struct obs_core_video {
 
 	gs_texture_t *transparent_texture;
 
+	gs_vertbuffer_t *sprite_batch_vb[2];
+	uint32_t sprite_batch_capacity[2];
+
 	gs_effect_t *deinterlace_discard_effect;
 	gs_effect_t *deinterlace_discard_2x_effect;
 	gs_effect_t *deinterlace_linear_effect;
@@ -456,6 +496,7 @@ struct obs_core_audio {
 	DARRAY(struct audio_monitor *) monitors;
 	char *monitoring_device_name;
 	char *monitoring_device_id;
+	bool monitoring_bus;
 
 	pthread_mutex_t task_mutex;
 	struct deque tasks;
@@ -520,6 +561,16 @@ struct obs_core_hotkeys {
 	bool reroute_hotkeys;
 	DARRAY(obs_hotkey_binding_t) bindings;
 
+	/* set by platforms that report key presses and releases, in which
+	 * case the hotkey thread stops polling key states */
+	volatile bool key_events;
+	bool key_state[OBS_KEY_LAST_VALUE];
+
+	/* binding indices grouped by key, rebuilt when bindings change */
+	DARRAY(size_t) key_index;
+	size_t key_index_start[OBS_KEY_LAST_VALUE + 1];
+	bool key_index_dirty;
+
 	obs_hotkey_callback_router_func router_func;
 	void *router_func_data;
 
@@ -549,6 +600,16 @@ struct obs_core {
 	DARRAY(char *) safe_modules;
 	DARRAY(char *) disabled_modules;
 	DARRAY(char *) core_modules;
+	DARRAY(char *) lazy_modules;
+
+	char *module_cache_path;
+	obs_data_t *module_cache;
+	bool module_cache_dirty;
+	bool modules_post_loaded;
+	volatile long deferred_modules;
+	pthread_mutex_t deferred_modules_mutex;
+	bool deferred_loading;
+	os_event_t *deferred_loaded;
 
 	obs_source_info_array_t source_types;
 	obs_source_info_array_t input_types;
@@ -749,10 +810,15 @@ extern void obs_canvas_rename_source(obs_source_t *source, const char *name);
 /* ------------------------------------------------------------------------- */
 /* sources  */
 
+/* private obs_source_frame flag of frames wrapping data output with
+ * obs_source_output_video_ref */
+#define OBS_SOURCE_FRAME_EXTERNAL (1 << 7)
+
 struct async_frame {
 	struct obs_source_frame *frame;
 	long unused_count;
 	bool used;
+	bool external;
 };
 
 enum audio_action_type {
@@ -847,6 +913,8 @@ struct obs_source {
 
 	/* timing (if video is present, is based upon video) */
 	volatile bool timing_set;
+	/* set by the audio thread, which does not take audio_buf_mutex */
+	volatile bool audio_timing_reset;
 	volatile uint64_t timing_adjust;
 	uint64_t resample_offset;
 	uint64_t next_audio_ts_min;
@@ -865,6 +933,8 @@ struct obs_source {
 	struct obs_source *next_audio_source;
 	struct obs_source **prev_next_audio_source;
 	uint64_t audio_ts;
+	struct audio_queue *audio_queue;
+	bool audio_queue_dropping;
 	struct deque audio_input_buf[MAX_AUDIO_CHANNELS];
 	size_t last_audio_input_buf_size;
 	DARRAY(struct audio_action) audio_actions;
@@ -945,6 +1015,13 @@ struct obs_source {
 	bool rendering_filter;
 	bool filter_bypass_active;
 
+	/* content tracking, see OBS_SOURCE_CONTENT_TRACKED.  the hash is
+	 * computed at most once per frame on the graphics thread */
+	volatile long content_generation;
+	uint64_t content_frame;
+	uint64_t content_hash;
+	bool content_static;
+
 	/* sources specific hotkeys */
 	obs_hotkey_pair_id mute_unmute_key;
 	obs_hotkey_id push_to_mute_key;
@@ -1014,6 +1091,7 @@ extern void obs_transition_tick(obs_source_t *transition, float t);
 extern void obs_transition_enum_sources(obs_source_t *transition, obs_source_enum_proc_t enum_callback, void *param);
 extern void obs_transition_save(obs_source_t *source, obs_data_t *data);
 extern void obs_transition_load(obs_source_t *source, obs_data_t *data);
+extern bool obs_transition_get_content_hash(obs_source_t *transition, uint64_t *hash);
 
 struct audio_monitor *audio_monitor_create(obs_source_t *source);
 void audio_monitor_reset(struct audio_monitor *monitor);
@@ -1025,6 +1103,15 @@ extern obs_source_t *obs_source_create_set_last_ver(obs_canvas_t *canvas, const
 						    const char *uuid, obs_data_t *settings, obs_data_t *hotkey_data,
 						    uint32_t last_obs_ver, bool is_private);
 
+/* obs_source_create split into its steps so that the type's create callback
+ * can run on a worker thread while the rest of the source is set up by the
+ * loading thread */
+extern obs_source_t *obs_source_create_begin(const char *id, const char *name, const char *uuid,
+					     obs_data_t *settings, obs_data_t *hotkey_data, bool private,
+					     uint32_t last_obs_ver);
+extern void obs_source_create_data(obs_source_t *source);
+extern void obs_source_create_finish(obs_source_t *source, obs_canvas_t *canvas);
+
 extern void obs_source_destroy(struct obs_source *source);
 extern void obs_source_addref(obs_source_t *source);
 
@@ -1123,6 +1210,33 @@ extern void obs_source_deactivate(obs_source_t *source, enum view_type type);
 extern void obs_source_video_tick(obs_source_t *source, float seconds);
 extern float obs_source_get_target_volume(obs_source_t *source, obs_source_t *target);
 extern uint64_t obs_source_get_last_async_ts(const obs_source_t *source);
+extern void obs_source_drain_audio_queue(obs_source_t *source);
+
+/* returns false if the source (or anything it renders) may change without
+ * notice, in which case the hash cannot be used to skip rendering */
+extern bool obs_source_get_content_hash(obs_source_t *source, uint64_t *hash);
+extern bool obs_source_get_sprite(obs_source_t *source, struct obs_source_sprite *sprite);
+extern bool obs_scene_get_content_hash(obs_scene_t *scene, uint64_t *hash);
+
+static inline uint64_t content_hash_combine(uint64_t hash, uint64_t val)
+{
+	return hash ^ (val + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2));
+}
+
+static inline uint64_t content_hash_data(uint64_t hash, const void *data, size_t size)
+{
+	const uint8_t *bytes = data;
+	uint64_t val;
+
+	for (; size >= sizeof(val); size -= sizeof(val), bytes += sizeof(val)) {
+		memcpy(&val, bytes, sizeof(val));
+		hash = content_hash_combine(hash, val);
+	}
+
+	for (; size; size--)
+		hash = content_hash_combine(hash, *bytes++);
+	return hash;
+}
 
 extern void obs_source_audio_render(obs_source_t *source, uint32_t mixers, size_t channels, size_t sample_rate,
 				    size_t size);
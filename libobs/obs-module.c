@@ -15,6 +15,8 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 ******************************************************************************/
 
+#include <sys/stat.h>
+
 #include "util/platform.h"
 #include "util/dstr.h"
 
@@ -24,7 +26,9 @@
 
 extern const char *get_module_extension(void);
 
-obs_module_t *loadingModule = NULL;
+/* per thread, so types registered by a module loading on one thread are not
+ * attributed to it when another thread registers types at the same time */
+static THREAD_LOCAL obs_module_t *loadingModule = NULL;
 
 static inline int req_func_not_found(const char *name, const char *path)
 {
@@ -137,6 +141,31 @@ int obs_module_load_metadata(struct obs_module *mod)
 	return MODULE_SUCCESS;
 }
 
+static int open_module_binary(struct obs_module *mod, const char *path)
+{
+	int errorcode;
+
+	mod->module = os_dlopen(path);
+	if (!mod->module) {
+		blog(LOG_WARNING, "Module '%s' not loaded", path);
+		return MODULE_FAILED_TO_OPEN;
+	}
+
+	errorcode = load_module_exports(mod, path);
+	if (errorcode != MODULE_SUCCESS)
+		return errorcode;
+
+	/* Reject plugins compiled with a newer libobs. Patch version (lower 16-bit) is ignored. */
+	uint32_t ver = mod->ver ? mod->ver() & 0xFFFF0000 : 0;
+	if (ver > LIBOBS_API_VER) {
+		blog(LOG_WARNING, "Module '%s' compiled with newer libobs %d.%d", path, (ver >> 24) & 0xFF,
+		     (ver >> 16) & 0xFF);
+		return MODULE_INCOMPATIBLE_VER;
+	}
+
+	return MODULE_SUCCESS;
+}
+
 int obs_open_module(obs_module_t **module, const char *path, const char *data_path)
 {
 	struct obs_module mod = {0};
@@ -157,24 +186,10 @@ int obs_open_module(obs_module_t **module, const char *path, const char *data_pa
 
 	blog(LOG_DEBUG, "---------------------------------");
 
-	mod.module = os_dlopen(path);
-	if (!mod.module) {
-		blog(LOG_WARNING, "Module '%s' not loaded", path);
-		return MODULE_FAILED_TO_OPEN;
-	}
-
-	errorcode = load_module_exports(&mod, path);
+	errorcode = open_module_binary(&mod, path);
 	if (errorcode != MODULE_SUCCESS)
 		return errorcode;
 
-	/* Reject plugins compiled with a newer libobs. Patch version (lower 16-bit) is ignored. */
-	uint32_t ver = mod.ver ? mod.ver() & 0xFFFF0000 : 0;
-	if (ver > LIBOBS_API_VER) {
-		blog(LOG_WARNING, "Module '%s' compiled with newer libobs %d.%d", path, (ver >> 24) & 0xFF,
-		     (ver >> 16) & 0xFF);
-		return MODULE_INCOMPATIBLE_VER;
-	}
-
 	mod.bin_path = bstrdup(path);
 	mod.file = strrchr(mod.bin_path, '/');
 	mod.file = (!mod.file) ? mod.bin_path : (mod.file + 1);
@@ -258,6 +273,15 @@ void obs_log_loaded_modules(void)
 
 	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next)
 		blog(LOG_INFO, "    %s", mod->file);
+
+	blog(LOG_INFO, "  Module load times:");
+
+	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next) {
+		if (mod->deferred)
+			blog(LOG_INFO, "    %s: deferred", mod->file);
+		else
+			blog(LOG_INFO, "    %s: %.2f ms", mod->file, (double)mod->load_time_ns / 1000000.0);
+	}
 }
 
 const char *obs_get_module_file_name(obs_module_t *module)
@@ -490,6 +514,533 @@ bool obs_get_module_allow_disable(const char *name)
 	return !is_core_module(name);
 }
 
+/* ------------------------------------------------------------------------- */
+/* module cache / deferred loading                                           */
+
+#define MODULE_CACHE_VERSION 1
+
+static void free_module_types(struct obs_module *mod)
+{
+	for (size_t i = 0; i < mod->sources.num; i++) {
+		bfree(mod->sources.array[i]);
+	}
+	da_free(mod->sources);
+
+	for (size_t i = 0; i < mod->outputs.num; i++) {
+		bfree(mod->outputs.array[i]);
+	}
+	da_free(mod->outputs);
+
+	for (size_t i = 0; i < mod->encoders.num; i++) {
+		bfree(mod->encoders.array[i]);
+	}
+	da_free(mod->encoders);
+
+	for (size_t i = 0; i < mod->services.num; i++) {
+		bfree(mod->services.array[i]);
+	}
+	da_free(mod->services);
+}
+
+static const char *source_type_keys[] = {
+	[OBS_SOURCE_TYPE_INPUT] = "inputs",
+	[OBS_SOURCE_TYPE_FILTER] = "filters",
+	[OBS_SOURCE_TYPE_TRANSITION] = "transitions",
+	[OBS_SOURCE_TYPE_SCENE] = "scenes",
+};
+
+#define NUM_SOURCE_TYPE_KEYS (sizeof(source_type_keys) / sizeof(source_type_keys[0]))
+
+void obs_set_module_cache_path(const char *path)
+{
+	if (!obs)
+		return;
+
+	bfree(obs->module_cache_path);
+	obs->module_cache_path = bstrdup(path);
+}
+
+void obs_add_lazy_module(const char *name)
+{
+	if (!obs || !name)
+		return;
+
+	char *item = bstrdup(name);
+	da_push_back(obs->lazy_modules, &item);
+}
+
+static bool is_lazy_module(const char *name)
+{
+	for (size_t i = 0; i < obs->lazy_modules.num; i++) {
+		if (strcmp(name, obs->lazy_modules.array[i]) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+static void load_module_cache(void)
+{
+	if (obs->module_cache || !obs->module_cache_path)
+		return;
+
+	obs->module_cache = obs_data_create_from_json_file_safe(obs->module_cache_path, "bak");
+	if (obs->module_cache && obs_data_get_int(obs->module_cache, "version") != MODULE_CACHE_VERSION) {
+		obs_data_release(obs->module_cache);
+		obs->module_cache = NULL;
+	}
+
+	if (!obs->module_cache) {
+		obs->module_cache = obs_data_create();
+		obs_data_set_int(obs->module_cache, "version", MODULE_CACHE_VERSION);
+		obs->module_cache_dirty = true;
+	}
+}
+
+static void save_module_cache(void)
+{
+	if (!obs->module_cache || !obs->module_cache_dirty)
+		return;
+
+	if (obs_data_save_json_safe(obs->module_cache, obs->module_cache_path, "tmp", "bak"))
+		obs->module_cache_dirty = false;
+	else
+		blog(LOG_WARNING, "Failed to save module cache to '%s'", obs->module_cache_path);
+}
+
+void obs_module_free_cache(void)
+{
+	save_module_cache();
+	obs_data_release(obs->module_cache);
+	obs->module_cache = NULL;
+
+	bfree(obs->module_cache_path);
+	obs->module_cache_path = NULL;
+
+	for (size_t i = 0; i < obs->lazy_modules.num; i++)
+		bfree(obs->lazy_modules.array[i]);
+	da_free(obs->lazy_modules);
+}
+
+static bool get_binary_stat(const char *path, long long *mtime, long long *size)
+{
+	struct stat st;
+	if (os_stat(path, &st) != 0)
+		return false;
+
+	*mtime = (long long)st.st_mtime;
+	*size = (long long)st.st_size;
+	return true;
+}
+
+/* returns the cache entry of a module binary if it is still up to date */
+static obs_data_t *get_cache_entry(const char *bin_path)
+{
+	obs_data_t *modules = obs_data_get_obj(obs->module_cache, "modules");
+	obs_data_t *entry = modules ? obs_data_get_obj(modules, bin_path) : NULL;
+	long long mtime, size;
+
+	obs_data_release(modules);
+
+	if (entry && (!get_binary_stat(bin_path, &mtime, &size) || obs_data_get_int(entry, "mtime") != mtime ||
+		      obs_data_get_int(entry, "size") != size)) {
+		obs_data_release(entry);
+		entry = NULL;
+	}
+
+	return entry;
+}
+
+static void remove_cache_entry(const char *bin_path)
+{
+	obs_data_t *modules = obs_data_get_obj(obs->module_cache, "modules");
+	if (modules) {
+		obs_data_erase(modules, bin_path);
+		obs->module_cache_dirty = true;
+		obs_data_release(modules);
+	}
+}
+
+static void cat_ids(struct dstr *str, const char *id)
+{
+	if (str->len)
+		dstr_cat_ch(str, ';');
+	dstr_cat(str, id);
+}
+
+static void set_ids(obs_data_t *entry, const char *key, char **ids, size_t num)
+{
+	struct dstr str = {0};
+
+	for (size_t i = 0; i < num; i++)
+		cat_ids(&str, ids[i]);
+
+	obs_data_set_string(entry, key, str.array ? str.array : "");
+	dstr_free(&str);
+}
+
+static enum obs_source_type get_registered_source_type(const char *unversioned_id)
+{
+	for (size_t i = 0; i < obs->source_types.num; i++) {
+		const struct obs_source_info *info = &obs->source_types.array[i];
+		if (strcmp(info->unversioned_id, unversioned_id) == 0)
+			return info->type;
+	}
+
+	return OBS_SOURCE_TYPE_INPUT;
+}
+
+/* records which types a module registered, so that next time it can be
+ * deferred until one of them is needed */
+static void cache_module_types(obs_module_t *mod)
+{
+	struct dstr sources[NUM_SOURCE_TYPE_KEYS] = {0};
+	long long mtime, size;
+
+	if (!obs->module_cache || !get_binary_stat(mod->bin_path, &mtime, &size))
+		return;
+
+	obs_data_t *modules = obs_data_get_obj(obs->module_cache, "modules");
+	if (!modules) {
+		modules = obs_data_create();
+		obs_data_set_obj(obs->module_cache, "modules", modules);
+	}
+
+	obs_data_t *entry = obs_data_create();
+	obs_data_set_string(entry, "file", mod->file);
+	obs_data_set_int(entry, "mtime", mtime);
+	obs_data_set_int(entry, "size", size);
+
+	for (size_t i = 0; i < mod->sources.num; i++) {
+		enum obs_source_type type = get_registered_source_type(mod->sources.array[i]);
+		cat_ids(&sources[type], mod->sources.array[i]);
+	}
+
+	for (size_t i = 0; i < NUM_SOURCE_TYPE_KEYS; i++) {
+		obs_data_set_string(entry, source_type_keys[i], sources[i].array ? sources[i].array : "");
+		dstr_free(&sources[i]);
+	}
+
+	set_ids(entry, "outputs", mod->outputs.array, mod->outputs.num);
+	set_ids(entry, "encoders", mod->encoders.array, mod->encoders.num);
+	set_ids(entry, "services", mod->services.array, mod->services.num);
+
+	obs_data_set_obj(modules, mod->bin_path, entry);
+	obs->module_cache_dirty = true;
+
+	obs_data_release(entry);
+	obs_data_release(modules);
+}
+
+static size_t add_cached_ids(struct darray *ids, obs_data_t *entry, const char *key)
+{
+	char **list = strlist_split(obs_data_get_string(entry, key), ';', false);
+	size_t count = 0;
+
+	for (char **id = list; id && *id; id++, count++) {
+		char *copy = bstrdup(*id);
+		darray_push_back(sizeof(char *), ids, &copy);
+	}
+
+	strlist_free(list);
+	return count;
+}
+
+static bool defer_module(const struct obs_module_info2 *info)
+{
+	struct obs_module mod = {0};
+	size_t types = 0;
+
+	if (!obs->module_cache || !is_lazy_module(info->name))
+		return false;
+
+	obs_data_t *entry = get_cache_entry(info->bin_path);
+	if (!entry)
+		return false;
+
+	da_init(mod.sources);
+	da_init(mod.outputs);
+	da_init(mod.encoders);
+	da_init(mod.services);
+
+	for (size_t i = 0; i < NUM_SOURCE_TYPE_KEYS; i++) {
+		size_t count = add_cached_ids(&mod.sources.da, entry, source_type_keys[i]);
+		if (count)
+			mod.deferred_source_types |= 1 << i;
+		types += count;
+	}
+
+	types += add_cached_ids(&mod.outputs.da, entry, "outputs");
+	types += add_cached_ids(&mod.encoders.da, entry, "encoders");
+	types += add_cached_ids(&mod.services.da, entry, "services");
+	obs_data_release(entry);
+
+	/* a module that registers nothing must have been loaded for its side
+	 * effects, so it is never deferred */
+	if (!types) {
+		free_module_types(&mod);
+		return false;
+	}
+
+	mod.bin_path = bstrdup(info->bin_path);
+	mod.file = strrchr(mod.bin_path, '/');
+	mod.file = (!mod.file) ? mod.bin_path : (mod.file + 1);
+	mod.mod_name = get_module_name(mod.file);
+	mod.data_path = bstrdup(info->data_path);
+	mod.next = obs->first_module;
+	mod.load_state = OBS_MODULE_ENABLED;
+	mod.deferred = true;
+
+	obs_module_load_metadata(&mod);
+
+	obs->first_module = bmemdup(&mod, sizeof(mod));
+	os_atomic_inc_long(&obs->deferred_modules);
+
+	blog(LOG_DEBUG, "Deferring module '%s' until one of its types is used", mod.file);
+	return true;
+}
+
+/* type arrays are read without locking, so make sure that registering the
+ * types of deferred modules later never has to reallocate them */
+static void reserve_deferred_types(void)
+{
+	size_t sources[NUM_SOURCE_TYPE_KEYS] = {0};
+	size_t num_sources = 0, num_outputs = 0, num_encoders = 0, num_services = 0;
+
+	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next) {
+		if (!mod->deferred)
+			continue;
+
+		/* the per-type split is unknown here, so reserve the full
+		 * count for every source type array the module touches */
+		for (size_t i = 0; i < NUM_SOURCE_TYPE_KEYS; i++) {
+			if (mod->deferred_source_types & (1 << i))
+				sources[i] += mod->sources.num;
+		}
+
+		num_sources += mod->sources.num;
+		num_outputs += mod->outputs.num;
+		num_encoders += mod->encoders.num;
+		num_services += mod->services.num;
+	}
+
+	da_reserve(obs->source_types, obs->source_types.num + num_sources);
+	da_reserve(obs->input_types, obs->input_types.num + sources[OBS_SOURCE_TYPE_INPUT]);
+	da_reserve(obs->filter_types, obs->filter_types.num + sources[OBS_SOURCE_TYPE_FILTER]);
+	da_reserve(obs->transition_types, obs->transition_types.num + sources[OBS_SOURCE_TYPE_TRANSITION]);
+	da_reserve(obs->output_types, obs->output_types.num + num_outputs);
+	da_reserve(obs->encoder_types, obs->encoder_types.num + num_encoders);
+	da_reserve(obs->service_types, obs->service_types.num + num_services);
+}
+
+static const char *load_deferred_module_name = "load_deferred_module";
+
+/* assumes deferred_modules_mutex.  only one deferred module loads at a time;
+ * returns whether it had to wait for one to finish */
+static bool wait_deferred_load(void)
+{
+	bool waited = false;
+
+	while (obs->deferred_loading) {
+		pthread_mutex_unlock(&obs->deferred_modules_mutex);
+		os_event_wait(obs->deferred_loaded);
+		pthread_mutex_lock(&obs->deferred_modules_mutex);
+		waited = true;
+	}
+
+	return waited;
+}
+
+/* assumes deferred_modules_mutex, which is released while the module
+ * initializes so its load callback never runs with the lock held */
+static bool load_deferred_module(obs_module_t *mod)
+{
+	const uint64_t start = os_gettime_ns();
+	const bool post_load = obs->modules_post_loaded;
+	bool success = false;
+	int code;
+
+	mod->deferred = false;
+	os_atomic_dec_long(&obs->deferred_modules);
+
+	obs->deferred_loading = true;
+	os_event_reset(obs->deferred_loaded);
+	pthread_mutex_unlock(&obs->deferred_modules_mutex);
+
+	profile_start(load_deferred_module_name);
+
+	/* the module registers its types again while it initializes */
+	free_module_types(mod);
+
+	code = open_module_binary(mod, mod->bin_path);
+	if (code != MODULE_SUCCESS) {
+		blog(LOG_WARNING, "Failed to load deferred module '%s' (%d)", mod->file, code);
+		goto finish;
+	}
+
+	mod->set_pointer(mod);
+	if (mod->set_locale)
+		mod->set_locale(obs->locale);
+
+	if (!obs_init_module(mod))
+		goto finish;
+
+	if (post_load && mod->post_load)
+		mod->post_load();
+
+	mod->load_time_ns = os_gettime_ns() - start;
+	success = true;
+
+finish:
+	profile_end(load_deferred_module_name);
+
+	if (success)
+		blog(LOG_INFO, "Loaded deferred module '%s' in %.2f ms", mod->file,
+		     (double)mod->load_time_ns / 1000000.0);
+
+	pthread_mutex_lock(&obs->deferred_modules_mutex);
+
+	/* load it the regular way next time so failures get reported */
+	if (!success)
+		remove_cache_entry(mod->bin_path);
+
+	obs->deferred_loading = false;
+	os_event_signal(obs->deferred_loaded);
+	return success;
+}
+
+static bool source_id_matches(const char *registered, const char *id)
+{
+	size_t len = strlen(registered);
+
+	if (strncmp(registered, id, len) != 0)
+		return false;
+	if (!id[len])
+		return true;
+
+	/* versioned ids are the unversioned id with a "_v<version>" suffix */
+	if (id[len] != '_' || id[len + 1] != 'v' || !id[len + 2])
+		return false;
+
+	for (const char *ch = id + len + 2; *ch; ch++) {
+		if (*ch < '0' || *ch > '9')
+			return false;
+	}
+
+	return true;
+}
+
+static bool module_provides(const obs_module_t *mod, enum deferred_type_kind kind, const char *id)
+{
+	switch (kind) {
+	case DEFERRED_SOURCE:
+		for (size_t i = 0; i < mod->sources.num; i++) {
+			if (source_id_matches(mod->sources.array[i], id))
+				return true;
+		}
+		break;
+	case DEFERRED_OUTPUT:
+		for (size_t i = 0; i < mod->outputs.num; i++) {
+			if (strcmp(mod->outputs.array[i], id) == 0)
+				return true;
+		}
+		break;
+	case DEFERRED_ENCODER:
+		for (size_t i = 0; i < mod->encoders.num; i++) {
+			if (strcmp(mod->encoders.array[i], id) == 0)
+				return true;
+		}
+		break;
+	case DEFERRED_SERVICE:
+		for (size_t i = 0; i < mod->services.num; i++) {
+			if (strcmp(mod->services.array[i], id) == 0)
+				return true;
+		}
+		break;
+	}
+
+	return false;
+}
+
+static bool module_provides_kind(const obs_module_t *mod, enum deferred_type_kind kind, uint32_t source_types)
+{
+	switch (kind) {
+	case DEFERRED_SOURCE:
+		return (mod->deferred_source_types & source_types) != 0;
+	case DEFERRED_OUTPUT:
+		return mod->outputs.num != 0;
+	case DEFERRED_ENCODER:
+		return mod->encoders.num != 0;
+	case DEFERRED_SERVICE:
+		return mod->services.num != 0;
+	}
+
+	return false;
+}
+
+bool obs_module_load_deferred_type(enum deferred_type_kind kind, const char *id)
+{
+	bool loaded;
+
+	/* types registered while a module loads are checked for duplicates,
+	 * which must not pull in other modules */
+	if (!id || loadingModule || !os_atomic_load_long(&obs->deferred_modules))
+		return false;
+
+	pthread_mutex_lock(&obs->deferred_modules_mutex);
+
+	/* the module loading on another thread may be the one providing it */
+	loaded = wait_deferred_load();
+
+	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next) {
+		if (mod->deferred && module_provides(mod, kind, id)) {
+			if (load_deferred_module(mod))
+				loaded = true;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&obs->deferred_modules_mutex);
+	return loaded;
+}
+
+void obs_module_load_deferred_kind(enum deferred_type_kind kind, uint32_t source_types)
+{
+	if (loadingModule || !os_atomic_load_long(&obs->deferred_modules))
+		return;
+
+	pthread_mutex_lock(&obs->deferred_modules_mutex);
+	wait_deferred_load();
+
+	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next) {
+		if (mod->deferred && module_provides_kind(mod, kind, source_types))
+			load_deferred_module(mod);
+	}
+
+	pthread_mutex_unlock(&obs->deferred_modules_mutex);
+}
+
+void obs_load_deferred_modules(void)
+{
+	if (!obs || !os_atomic_load_long(&obs->deferred_modules))
+		return;
+
+	pthread_mutex_lock(&obs->deferred_modules_mutex);
+	wait_deferred_load();
+
+	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next) {
+		if (mod->deferred)
+			load_deferred_module(mod);
+	}
+
+	pthread_mutex_unlock(&obs->deferred_modules_mutex);
+}
+
+bool obs_module_is_deferred(obs_module_t *module)
+{
+	return module && module->deferred;
+}
+
 static void load_all_callback(void *param, const struct obs_module_info2 *info)
 {
 	struct fail_info *fail_info = param;
@@ -517,6 +1068,11 @@ static void load_all_callback(void *param, const struct obs_module_info2 *info)
 		return;
 	}
 
+	if (defer_module(info))
+		return;
+
+	const uint64_t start = os_gettime_ns();
+
 	int code = obs_open_module(&module, info->bin_path, info->data_path);
 	switch (code) {
 	case MODULE_MISSING_EXPORTS:
@@ -543,9 +1099,13 @@ static void load_all_callback(void *param, const struct obs_module_info2 *info)
 		free_module(module);
 		obs_create_disabled_module(&disabled_module, info->bin_path, info->data_path,
 					   OBS_MODULE_FAILED_TO_INITIALIZE);
+		return;
 	}
 
-	UNUSED_PARAMETER(param);
+	module->load_time_ns = os_gettime_ns() - start;
+
+	if (is_lazy_module(info->name))
+		cache_module_types(module);
 	return;
 
 load_failure:
@@ -564,7 +1124,10 @@ static const char *reset_win32_symbol_paths_name = "reset_win32_symbol_paths";
 void obs_load_all_modules(void)
 {
 	profile_start(obs_load_all_modules_name);
+	load_module_cache();
 	obs_find_modules2(load_all_callback, NULL);
+	reserve_deferred_types();
+	save_module_cache();
 #ifdef _WIN32
 	profile_start(reset_win32_symbol_paths_name);
 	reset_win32_symbol_paths();
@@ -581,7 +1144,10 @@ void obs_load_all_modules2(struct obs_module_failure_info *mfi)
 	memset(mfi, 0, sizeof(*mfi));
 
 	profile_start(obs_load_all_modules2_name);
+	load_module_cache();
 	obs_find_modules2(load_all_callback, &fail_info);
+	reserve_deferred_types();
+	save_module_cache();
 #ifdef _WIN32
 	profile_start(reset_win32_symbol_paths_name);
 	reset_win32_symbol_paths();
@@ -604,9 +1170,17 @@ void obs_module_failure_info_free(struct obs_module_failure_info *mfi)
 
 void obs_post_load_modules(void)
 {
+	pthread_mutex_lock(&obs->deferred_modules_mutex);
+	wait_deferred_load();
+
 	for (obs_module_t *mod = obs->first_module; !!mod; mod = mod->next)
 		if (mod->post_load)
 			mod->post_load();
+
+	/* deferred modules get theirs as soon as they are loaded */
+	obs->modules_post_loaded = true;
+
+	pthread_mutex_unlock(&obs->deferred_modules_mutex);
 }
 
 static inline void make_data_dir(struct dstr *parsed_data_dir, const char *data_dir, const char *name)
@@ -821,25 +1395,7 @@ void free_module(struct obs_module *mod)
 	bfree(mod->bin_path);
 	bfree(mod->data_path);
 
-	for (size_t i = 0; i < mod->sources.num; i++) {
-		bfree(mod->sources.array[i]);
-	}
-	da_free(mod->sources);
-
-	for (size_t i = 0; i < mod->outputs.num; i++) {
-		bfree(mod->outputs.array[i]);
-	}
-	da_free(mod->outputs);
-
-	for (size_t i = 0; i < mod->encoders.num; i++) {
-		bfree(mod->encoders.array[i]);
-	}
-	da_free(mod->encoders);
-
-	for (size_t i = 0; i < mod->services.num; i++) {
-		bfree(mod->services.array[i]);
-	}
-	da_free(mod->services);
+	free_module_types(mod);
 
 	if (mod->metadata) {
 		free_module_metadata(mod->metadata);
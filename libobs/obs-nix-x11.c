@@ -31,6 +31,12 @@
 #include <X11/XF86keysym.h>
 #include <X11/Sunkeysym.h>
 
+#if defined(XCB_XINPUT_FOUND)
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
 void obs_nix_x11_log_info(void)
 {
 	Display *dpy = obs_get_nix_platform_display();
@@ -96,6 +102,15 @@ struct obs_hotkeys_platform {
 	bool pressed[XINPUT_MOUSE_LEN];
 	bool update[XINPUT_MOUSE_LEN];
 	bool button_pressed[XINPUT_MOUSE_LEN];
+
+	/* raw key events are read on a connection of their own so they never
+	 * mix with the polled mouse state above */
+	xcb_connection_t *event_connection;
+	pthread_t event_thread;
+	bool event_thread_active;
+	int wake_fds[2];
+	obs_key_t keycode_keys[256];
+	bool keycode_down[256];
 #endif
 };
 
@@ -838,6 +853,238 @@ static inline void registerMouseEvents(struct obs_core_hotkeys *hotkeys)
 	xcb_input_xi_select_events(connection, window, 1, &mask.head);
 	xcb_flush(connection);
 }
+
+/* ------------------------------------------------------------------------- */
+/* raw key events */
+
+static void fill_keycode_keys(obs_hotkeys_platform_t *context)
+{
+	for (size_t i = 0; i < 256; i++)
+		context->keycode_keys[i] = OBS_KEY_NONE;
+
+	for (size_t i = 0; i < OBS_KEY_LAST_VALUE; i++) {
+		struct keycode_list *codes = &context->keycodes[i];
+
+		for (size_t j = 0; j < codes->list.num; j++)
+			context->keycode_keys[codes->list.array[j]] = (obs_key_t)i;
+	}
+
+	if (context->super_l_code)
+		context->keycode_keys[context->super_l_code] = OBS_KEY_META;
+	if (context->super_r_code)
+		context->keycode_keys[context->super_r_code] = OBS_KEY_META;
+}
+
+/* a key counts as held while any of its keycodes is (left/right shift etc) */
+static bool any_keycode_down(obs_hotkeys_platform_t *context, obs_key_t key)
+{
+	for (size_t i = 0; i < 256; i++) {
+		if (context->keycode_down[i] && context->keycode_keys[i] == key)
+			return true;
+	}
+
+	return false;
+}
+
+static void handle_raw_key(obs_hotkeys_platform_t *context, uint32_t code, bool pressed)
+{
+	obs_key_t key;
+
+	if (code >= 256)
+		return;
+
+	key = context->keycode_keys[code];
+	if (key == OBS_KEY_NONE)
+		return;
+
+	context->keycode_down[code] = pressed;
+	obs_hotkey_inject_key_event(key, pressed || any_keycode_down(context, key));
+}
+
+/* Mouse 2 for OBS is Right Click and Mouse 3 is Wheel Click, wheel axis
+ * clicks (4 to 7) are ignored like in mouse_button_pressed */
+static obs_key_t key_from_raw_button(uint32_t detail)
+{
+	switch (detail) {
+	case 1:
+		return OBS_KEY_MOUSE1;
+	case 2:
+		return OBS_KEY_MOUSE3;
+	case 3:
+		return OBS_KEY_MOUSE2;
+	}
+
+	if (detail >= 8 && detail - 8 <= OBS_KEY_MOUSE29 - OBS_KEY_MOUSE4)
+		return (obs_key_t)(OBS_KEY_MOUSE4 + (detail - 8));
+
+	return OBS_KEY_NONE;
+}
+
+static void handle_raw_event(obs_hotkeys_platform_t *context, xcb_generic_event_t *ev)
+{
+	if ((ev->response_type & 0x7f) != XCB_GE_GENERIC)
+		return;
+
+	switch (((xcb_ge_event_t *)ev)->event_type) {
+	case XCB_INPUT_RAW_KEY_PRESS:
+		handle_raw_key(context, ((xcb_input_raw_key_press_event_t *)ev)->detail, true);
+		break;
+	case XCB_INPUT_RAW_KEY_RELEASE:
+		handle_raw_key(context, ((xcb_input_raw_key_release_event_t *)ev)->detail, false);
+		break;
+	case XCB_INPUT_RAW_BUTTON_PRESS: {
+		obs_key_t key = key_from_raw_button(((xcb_input_raw_button_press_event_t *)ev)->detail);
+		if (key != OBS_KEY_NONE)
+			obs_hotkey_inject_key_event(key, true);
+		break;
+	}
+	case XCB_INPUT_RAW_BUTTON_RELEASE: {
+		obs_key_t key = key_from_raw_button(((xcb_input_raw_button_release_event_t *)ev)->detail);
+		if (key != OBS_KEY_NONE)
+			obs_hotkey_inject_key_event(key, false);
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+static void *key_event_thread(void *data)
+{
+	obs_hotkeys_platform_t *context = data;
+	xcb_connection_t *connection = context->event_connection;
+	struct pollfd fds[2] = {
+		{.fd = xcb_get_file_descriptor(connection), .events = POLLIN},
+		{.fd = context->wake_fds[0], .events = POLLIN},
+	};
+
+	os_set_thread_name("libobs: hotkey events");
+
+	for (;;) {
+		xcb_generic_event_t *ev;
+
+		while ((ev = xcb_poll_for_event(connection))) {
+			handle_raw_event(context, ev);
+			free(ev);
+		}
+
+		if (xcb_connection_has_error(connection)) {
+			blog(LOG_WARNING, "[hotkeys] X connection for key events lost, "
+					  "falling back to polling");
+
+			/* releases will never arrive for keys held now, polling
+			 * picks up whatever is still pressed */
+			pthread_mutex_lock(&obs->hotkeys.mutex);
+			memset(obs->hotkeys.key_state, 0, sizeof(obs->hotkeys.key_state));
+			os_atomic_set_bool(&obs->hotkeys.key_events, false);
+			pthread_mutex_unlock(&obs->hotkeys.mutex);
+			break;
+		}
+
+		if (poll(fds, 2, -1) < 0 && errno != EINTR)
+			break;
+		if (fds[1].revents)
+			break;
+	}
+
+	return NULL;
+}
+
+static bool query_xinput2(xcb_connection_t *connection)
+{
+	const xcb_query_extension_reply_t *ext = xcb_get_extension_data(connection, &xcb_input_id);
+	xcb_input_xi_query_version_reply_t *reply;
+	bool success;
+
+	if (!ext || !ext->present)
+		return false;
+
+	/* raw events reach the root window without a grab as of 2.1 */
+	reply = xcb_input_xi_query_version_reply(connection, xcb_input_xi_query_version(connection, 2, 2), NULL);
+	if (!reply)
+		return false;
+
+	success = reply->major_version > 2 || (reply->major_version == 2 && reply->minor_version >= 1);
+	free(reply);
+	return success;
+}
+
+static void start_key_events(struct obs_core_hotkeys *hotkeys)
+{
+	obs_hotkeys_platform_t *context = hotkeys->platform_context;
+	xcb_connection_t *connection;
+	xcb_generic_error_t *error;
+	xcb_window_t window;
+
+	connection = xcb_connect(NULL, NULL);
+	if (xcb_connection_has_error(connection))
+		goto fail;
+	if (!query_xinput2(connection))
+		goto fail;
+
+	window = root_window(context, connection);
+	if (!window)
+		goto fail;
+
+	struct {
+		xcb_input_event_mask_t head;
+		xcb_input_xi_event_mask_t mask;
+	} mask;
+	mask.head.deviceid = XCB_INPUT_DEVICE_ALL_MASTER;
+	mask.head.mask_len = sizeof(mask.mask) / sizeof(uint32_t);
+	mask.mask = XCB_INPUT_XI_EVENT_MASK_RAW_KEY_PRESS | XCB_INPUT_XI_EVENT_MASK_RAW_KEY_RELEASE |
+		    XCB_INPUT_XI_EVENT_MASK_RAW_BUTTON_PRESS | XCB_INPUT_XI_EVENT_MASK_RAW_BUTTON_RELEASE;
+
+	error = xcb_request_check(connection, xcb_input_xi_select_events_checked(connection, window, 1, &mask.head));
+	if (error) {
+		free(error);
+		goto fail;
+	}
+
+	if (pipe(context->wake_fds) != 0)
+		goto fail;
+
+	fill_keycode_keys(context);
+	context->event_connection = connection;
+
+	if (pthread_create(&context->event_thread, NULL, key_event_thread, context) != 0) {
+		close(context->wake_fds[0]);
+		close(context->wake_fds[1]);
+		context->event_connection = NULL;
+		goto fail;
+	}
+
+	context->event_thread_active = true;
+	os_atomic_set_bool(&hotkeys->key_events, true);
+	blog(LOG_INFO, "[hotkeys] Using XInput2 raw key events");
+	return;
+
+fail:
+	xcb_disconnect(connection);
+	blog(LOG_INFO, "[hotkeys] XInput2 raw key events unavailable, polling keys");
+}
+
+static void stop_key_events(struct obs_core_hotkeys *hotkeys)
+{
+	obs_hotkeys_platform_t *context = hotkeys->platform_context;
+	char wake = 0;
+
+	if (!context->event_thread_active)
+		return;
+
+	os_atomic_set_bool(&hotkeys->key_events, false);
+
+	if (write(context->wake_fds[1], &wake, 1) != 1)
+		blog(LOG_WARNING, "[hotkeys] Failed to wake key event thread");
+	pthread_join(context->event_thread, NULL);
+
+	close(context->wake_fds[0]);
+	close(context->wake_fds[1]);
+	xcb_disconnect(context->event_connection);
+
+	context->event_connection = NULL;
+	context->event_thread_active = false;
+}
 #endif
 
 static bool obs_nix_x11_hotkeys_platform_init(struct obs_core_hotkeys *hotkeys)
@@ -855,6 +1102,9 @@ static bool obs_nix_x11_hotkeys_platform_init(struct obs_core_hotkeys *hotkeys)
 #endif
 	fill_base_keysyms(hotkeys);
 	fill_keycodes(hotkeys);
+#if defined(XCB_XINPUT_FOUND)
+	start_key_events(hotkeys);
+#endif
 	return true;
 }
 
@@ -864,6 +1114,10 @@ static void obs_nix_x11_hotkeys_platform_free(struct obs_core_hotkeys *hotkeys)
 	if (!context)
 		return;
 
+#if defined(XCB_XINPUT_FOUND)
+	stop_key_events(hotkeys);
+#endif
+
 	for (size_t i = 0; i < OBS_KEY_LAST_VALUE; i++)
 		da_free(context->keycodes[i].list);
 
@@ -119,7 +119,7 @@ static inline bool log_flag_service(const struct obs_output *output, const char
 	return ret;
 }
 
-const struct obs_output_info *find_output(const char *id)
+static const struct obs_output_info *find_output_type(const char *id)
 {
 	size_t i;
 	for (i = 0; i < obs->output_types.num; i++)
@@ -129,6 +129,14 @@ const struct obs_output_info *find_output(const char *id)
 	return NULL;
 }
 
+const struct obs_output_info *find_output(const char *id)
+{
+	const struct obs_output_info *info = find_output_type(id);
+	if (!info && obs_module_load_deferred_type(DEFERRED_OUTPUT, id))
+		info = find_output_type(id);
+	return info;
+}
+
 const char *obs_output_get_display_name(const char *id)
 {
 	const struct obs_output_info *info = find_output(id);
@@ -202,6 +202,7 @@ static inline void full_unlock(struct obs_scene *scene)
 }
 
 static void obs_sceneitem_remove_internal(obs_sceneitem_t *item);
+static void scene_index_clear(struct obs_scene *scene);
 
 static void remove_all_items(struct obs_scene *scene)
 {
@@ -234,9 +235,11 @@ static void scene_destroy(void *data)
 	struct obs_scene *scene = data;
 
 	remove_all_items(scene);
+	scene_index_clear(scene);
 
 	pthread_mutex_destroy(&scene->video_mutex);
 	pthread_mutex_destroy(&scene->audio_mutex);
+	da_free(scene->sprite_batch);
 	bfree(scene);
 }
 
@@ -291,8 +294,237 @@ static void scene_enum_all_sources(void *data, obs_source_enum_proc_t enum_callb
 	scene_enum_sources(data, enum_callback, param, false);
 }
 
+/* ------------------------------------------------------------------------- */
+/* lookup indexes */
+
+static inline const char *source_index_name(const struct obs_source *source)
+{
+	return source->context.name ? source->context.name : "";
+}
+
+static struct scene_source_ref *find_source_ref(struct obs_scene *scene, const struct obs_source *source)
+{
+	struct scene_source_ref *ref;
+	HASH_FIND(hh_source, scene->refs_by_source, &source, sizeof(source), ref);
+	return ref;
+}
+
+static void index_ref_name(struct obs_scene *scene, struct scene_source_ref *ref)
+{
+	struct scene_source_ref *existing;
+
+	/* names are only unique within a canvas, so fall back to searching
+	 * the list while two sources in the scene share one */
+	HASH_FIND(hh_name, scene->refs_by_name, ref->name, strlen(ref->name), existing);
+	if (existing) {
+		ref->name_indexed = false;
+		scene->unindexed_names++;
+	} else {
+		HASH_ADD_KEYPTR(hh_name, scene->refs_by_name, ref->name, strlen(ref->name), ref);
+		ref->name_indexed = true;
+	}
+}
+
+static void unindex_ref_name(struct obs_scene *scene, struct scene_source_ref *ref)
+{
+	if (ref->name_indexed)
+		HASH_DELETE(hh_name, scene->refs_by_name, ref);
+	else
+		scene->unindexed_names--;
+	ref->name_indexed = false;
+}
+
+static void index_item_id(struct obs_scene *scene, struct obs_scene_item *item)
+{
+	struct obs_scene_item *existing;
+
+	HASH_FIND(hh_id, scene->items_by_id, &item->id, sizeof(item->id), existing);
+	if (existing) {
+		item->id_indexed = false;
+		scene->unindexed_ids++;
+	} else {
+		HASH_ADD(hh_id, scene->items_by_id, id, sizeof(item->id), item);
+		item->id_indexed = true;
+	}
+}
+
+static void unindex_item_id(struct obs_scene *scene, struct obs_scene_item *item)
+{
+	if (item->id_indexed)
+		HASH_DELETE(hh_id, scene->items_by_id, item);
+	else
+		scene->unindexed_ids--;
+	item->id_indexed = false;
+}
+
+static void scene_index_add(struct obs_scene *scene, struct obs_scene_item *item)
+{
+	struct scene_source_ref *ref = find_source_ref(scene, item->source);
+
+	if (ref) {
+		ref->count++;
+	} else {
+		ref = bzalloc(sizeof(*ref));
+		ref->source = item->source;
+		ref->item = item;
+		ref->count = 1;
+		ref->name = bstrdup(source_index_name(item->source));
+
+		HASH_ADD(hh_source, scene->refs_by_source, source, sizeof(ref->source), ref);
+		HASH_ADD_KEYPTR(hh_uuid, scene->refs_by_uuid, ref->source->context.uuid, UUID_STR_LENGTH, ref);
+		index_ref_name(scene, ref);
+	}
+
+	index_item_id(scene, item);
+
+	if (item->is_group)
+		scene->num_groups++;
+}
+
+static void free_source_ref(struct obs_scene *scene, struct scene_source_ref *ref)
+{
+	unindex_ref_name(scene, ref);
+	HASH_DELETE(hh_uuid, scene->refs_by_uuid, ref);
+	HASH_DELETE(hh_source, scene->refs_by_source, ref);
+	bfree(ref->name);
+	bfree(ref);
+}
+
+static void scene_index_remove(struct obs_scene *scene, struct obs_scene_item *item)
+{
+	struct scene_source_ref *ref = find_source_ref(scene, item->source);
+
+	if (ref) {
+		if (--ref->count == 0)
+			free_source_ref(scene, ref);
+		else if (ref->item == item)
+			ref->item = NULL;
+	}
+
+	unindex_item_id(scene, item);
+
+	if (item->is_group)
+		scene->num_groups--;
+}
+
+static void scene_index_clear(struct obs_scene *scene)
+{
+	struct scene_source_ref *ref, *tmp;
+
+	HASH_ITER (hh_source, scene->refs_by_source, ref, tmp) {
+		HASH_DELETE(hh_source, scene->refs_by_source, ref);
+		bfree(ref->name);
+		bfree(ref);
+	}
+
+	/* the handles of the removed entries are never touched again, so
+	 * the tables can simply be dropped */
+	HASH_CLEAR(hh_name, scene->refs_by_name);
+	HASH_CLEAR(hh_uuid, scene->refs_by_uuid);
+	HASH_CLEAR(hh_id, scene->items_by_id);
+
+	scene->unindexed_names = 0;
+	scene->unindexed_ids = 0;
+	scene->num_groups = 0;
+}
+
+/* for changes that relink items without going through attach/detach */
+static void scene_index_rebuild(struct obs_scene *scene)
+{
+	scene_index_clear(scene);
+
+	for (struct obs_scene_item *item = scene->first_item; item; item = item->next)
+		scene_index_add(scene, item);
+}
+
+static void scene_index_rename(struct obs_scene_item *item, const char *name)
+{
+	struct obs_scene *scene = item->parent;
+	struct scene_source_ref *ref;
+
+	if (!scene)
+		return;
+
+	full_lock(scene);
+
+	ref = item->parent == scene ? find_source_ref(scene, item->source) : NULL;
+	if (ref && strcmp(ref->name, name ? name : "") != 0) {
+		unindex_ref_name(scene, ref);
+		bfree(ref->name);
+		ref->name = bstrdup(name ? name : "");
+		index_ref_name(scene, ref);
+	}
+
+	full_unlock(scene);
+}
+
+static struct obs_scene_item *ref_get_item(struct obs_scene *scene, struct scene_source_ref *ref)
+{
+	struct obs_scene_item *item;
+
+	if (!ref)
+		return NULL;
+	if (ref->count == 1 && ref->item)
+		return ref->item;
+
+	for (item = scene->first_item; item; item = item->next) {
+		if (item->source == ref->source)
+			break;
+	}
+
+	if (ref->count == 1)
+		ref->item = item;
+	return item;
+}
+
+static struct obs_scene_item *scene_index_find_name(struct obs_scene *scene, const char *name)
+{
+	struct scene_source_ref *ref;
+	struct obs_scene_item *item;
+
+	if (scene->unindexed_names) {
+		for (item = scene->first_item; item; item = item->next) {
+			if (strcmp(source_index_name(item->source), name) == 0)
+				break;
+		}
+		return item;
+	}
+
+	HASH_FIND(hh_name, scene->refs_by_name, name, strlen(name), ref);
+	return ref_get_item(scene, ref);
+}
+
+static struct obs_scene_item *scene_index_find_uuid(struct obs_scene *scene, const char *uuid)
+{
+	struct scene_source_ref *ref;
+
+	if (strlen(uuid) != UUID_STR_LENGTH)
+		return NULL;
+
+	HASH_FIND_UUID(scene->refs_by_uuid, uuid, ref);
+	return ref_get_item(scene, ref);
+}
+
+static struct obs_scene_item *scene_index_find_id(struct obs_scene *scene, int64_t id)
+{
+	struct obs_scene_item *item;
+
+	if (scene->unindexed_ids) {
+		for (item = scene->first_item; item; item = item->next) {
+			if (item->id == id)
+				break;
+		}
+		return item;
+	}
+
+	HASH_FIND(hh_id, scene->items_by_id, &id, sizeof(id), item);
+	return item;
+}
+
 static inline void detach_sceneitem(struct obs_scene_item *item)
 {
+	scene_index_remove(item->parent, item);
+
 	if (item->prev)
 		item->prev->next = item->next;
 	else
@@ -320,6 +552,8 @@ static inline void attach_sceneitem(struct obs_scene *parent, struct obs_scene_i
 			parent->first_item->prev = item;
 		parent->first_item = item;
 	}
+
+	scene_index_add(parent, item);
 }
 
 void add_alignment(struct vec2 *v, uint32_t align, int cx, int cy)
@@ -894,6 +1128,24 @@ static bool are_texcoords_centered(struct matrix4 *m)
 	return memcmp(m, &copy, sizeof(*m)) == 0;
 }
 
+/* the item texture only has to be redrawn when something drawn into it has
+ * changed, which is never the case for content tracked sources that have not
+ * been updated */
+static bool item_texture_static(struct obs_scene_item *item, uint32_t cx, uint32_t cy, enum gs_color_space space,
+				uint64_t *hash)
+{
+	bool is_static = obs_source_get_content_hash(item->source, hash);
+
+	if (transition_active(item->show_transition) || transition_active(item->hide_transition))
+		is_static = false;
+
+	*hash = content_hash_combine(*hash, ((uint64_t)cx << 32) | cy);
+	*hash = content_hash_combine(*hash, (uint64_t)space);
+	*hash = content_hash_data(*hash, &item->crop, sizeof(item->crop));
+	*hash = content_hash_data(*hash, &item->bounds_crop, sizeof(item->bounds_crop));
+	return is_static;
+}
+
 static inline void render_item(struct obs_scene_item *item)
 {
 	GS_DEBUG_MARKER_BEGIN_FORMAT(GS_DEBUG_COLOR_ITEM, "Item: %s", obs_source_get_name(item->source));
@@ -912,6 +1164,7 @@ static inline void render_item(struct obs_scene_item *item)
 
 	if (!item->item_render && use_texrender) {
 		item->item_render = gs_texrender_create(format, GS_ZS_NONE);
+		item->item_render_valid = false;
 	}
 
 	if (item->item_render) {
@@ -925,7 +1178,13 @@ static inline void render_item(struct obs_scene_item *item)
 		uint32_t cx = calc_cx(item, width);
 		uint32_t cy = calc_cy(item, height);
 
-		if (cx && cy && gs_texrender_begin_with_color_space(item->item_render, cx, cy, source_space)) {
+		uint64_t hash;
+		const bool is_static = item_texture_static(item, cx, cy, source_space, &hash);
+		const bool cached = is_static && item->item_render_valid && item->item_render_hash == hash &&
+				    gs_texrender_get_texture(item->item_render);
+
+		if (!cached && cx && cy &&
+		    gs_texrender_begin_with_color_space(item->item_render, cx, cy, source_space)) {
 			float cx_scale = (float)width / (float)cx;
 			float cy_scale = (float)height / (float)cy;
 			struct vec4 clear_color;
@@ -955,6 +1214,9 @@ static inline void render_item(struct obs_scene_item *item)
 			}
 
 			gs_texrender_end(item->item_render);
+
+			item->item_render_hash = hash;
+			item->item_render_valid = is_static;
 		}
 	}
 
@@ -987,6 +1249,48 @@ cleanup:
 	GS_DEBUG_MARKER_END();
 }
 
+bool obs_scene_get_content_hash(obs_scene_t *scene, uint64_t *hash)
+{
+	struct obs_scene_item *item;
+	bool is_static = true;
+	uint64_t val;
+
+	val = content_hash_combine(scene_getwidth(scene), scene_getheight(scene));
+
+	video_lock(scene);
+
+	for (item = scene->first_item; item; item = item->next) {
+		uint64_t child;
+
+		if (!item->user_visible) {
+			if (transition_active(item->hide_transition))
+				is_static = false;
+			continue;
+		}
+
+		/* pending transform updates are applied while rendering */
+		if (transition_active(item->show_transition) || os_atomic_load_bool(&item->update_transform) ||
+		    source_size_changed(item) || obs_source_removed(item->source))
+			is_static = false;
+
+		if (!obs_source_get_content_hash(item->source, &child))
+			is_static = false;
+
+		val = content_hash_combine(val, (uint64_t)(uintptr_t)item);
+		val = content_hash_combine(val, child);
+		val = content_hash_data(val, &item->draw_transform, sizeof(item->draw_transform));
+		val = content_hash_data(val, &item->crop, sizeof(item->crop));
+		val = content_hash_data(val, &item->bounds_crop, sizeof(item->bounds_crop));
+		val = content_hash_combine(val, (uint64_t)item->scale_filter);
+		val = content_hash_combine(val, ((uint64_t)item->blend_method << 32) | (uint64_t)item->blend_type);
+	}
+
+	video_unlock(scene);
+
+	*hash = val;
+	return is_static;
+}
+
 static void scene_video_tick(void *data, float seconds)
 {
 	struct obs_scene *scene = data;
@@ -1056,6 +1360,182 @@ static inline bool scene_size_changed(obs_scene_t *scene)
 	return true;
 }
 
+/* ------------------------------------------------------------------------- */
+/* sprite batching                                                           */
+
+static const char *render_sprite_batch_name = "render_sprite_batch";
+
+/* items that draw as a single sprite with the default blending can be
+ * drawn together with their neighbours in one draw call */
+static bool item_get_sprite(struct obs_scene_item *item, struct obs_source_sprite *sprite)
+{
+	if (!item->user_visible || item->item_render || item_texture_enabled(item))
+		return false;
+	if (transition_active(item->show_transition) || transition_active(item->hide_transition))
+		return false;
+	if (!obs_source_get_width(item->source) || !obs_source_get_height(item->source))
+		return false;
+
+	/* items drawn without an item texture are always linear */
+	const bool previous = gs_set_linear_srgb(true);
+	const bool success = obs_source_get_sprite(item->source, sprite);
+	gs_set_linear_srgb(previous);
+
+	return success;
+}
+
+static inline bool sprite_batch_matches(const struct obs_scene *scene, const struct obs_source_sprite *sprite)
+{
+	const struct obs_source_sprite *first = &scene->sprite_batch.array[0].sprite;
+
+	/* solid sprites carry their color per vertex, so any of them can
+	 * share a batch */
+	return first->texture == sprite->texture && first->linear_srgb == sprite->linear_srgb &&
+	       first->premultiplied == sprite->premultiplied;
+}
+
+static gs_vertbuffer_t *get_sprite_batch_buffer(bool solid, uint32_t num_verts)
+{
+	struct obs_core_video *video = &obs->video;
+	const size_t idx = solid ? 1 : 0;
+
+	if (video->sprite_batch_vb[idx] && video->sprite_batch_capacity[idx] >= num_verts)
+		return video->sprite_batch_vb[idx];
+
+	gs_vertexbuffer_destroy(video->sprite_batch_vb[idx]);
+	video->sprite_batch_vb[idx] = NULL;
+	video->sprite_batch_capacity[idx] = 0;
+
+	uint32_t capacity = 64 * 6;
+	while (capacity < num_verts)
+		capacity *= 2;
+
+	/* solid sprites carry their color in the texture coordinates so that
+	 * it keeps full float precision */
+	const uint32_t width = solid ? 4 : 2;
+
+	struct gs_vb_data *vbd = gs_vbdata_create();
+	vbd->num = capacity;
+	vbd->points = bzalloc(sizeof(struct vec3) * capacity);
+	vbd->num_tex = 1;
+	vbd->tvarray = bzalloc(sizeof(struct gs_tvertarray));
+	vbd->tvarray[0].width = width;
+	vbd->tvarray[0].array = bzalloc(sizeof(float) * width * capacity);
+
+	video->sprite_batch_vb[idx] = gs_vertexbuffer_create(vbd, GS_DYNAMIC);
+	if (video->sprite_batch_vb[idx])
+		video->sprite_batch_capacity[idx] = capacity;
+
+	return video->sprite_batch_vb[idx];
+}
+
+static void fill_sprite_batch(struct gs_vb_data *vbd, const struct obs_scene *scene, bool solid)
+{
+	static const float corners[6][2] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {0.0f, 1.0f},
+					    {0.0f, 1.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}};
+	struct vec3 *points = vbd->points;
+	float *tex = vbd->tvarray[0].array;
+
+	for (size_t i = 0; i < scene->sprite_batch.num; i++) {
+		const struct scene_sprite *sprite = &scene->sprite_batch.array[i];
+
+		for (size_t j = 0; j < 6; j++) {
+			struct vec3 pos;
+			vec3_set(&pos, corners[j][0] * sprite->cx, corners[j][1] * sprite->cy, 0.0f);
+			vec3_transform(points++, &pos, &sprite->transform);
+
+			if (solid) {
+				*(tex++) = sprite->sprite.color.x;
+				*(tex++) = sprite->sprite.color.y;
+				*(tex++) = sprite->sprite.color.z;
+				*(tex++) = sprite->sprite.color.w;
+			} else {
+				*(tex++) = corners[j][0];
+				*(tex++) = corners[j][1];
+			}
+		}
+	}
+}
+
+static void flush_sprite_batch(struct obs_scene *scene)
+{
+	if (!scene->sprite_batch.num)
+		return;
+
+	const struct obs_source_sprite *first = &scene->sprite_batch.array[0].sprite;
+	const bool solid = !first->texture;
+	const uint32_t num_verts = (uint32_t)scene->sprite_batch.num * 6;
+
+	profile_start(render_sprite_batch_name);
+	GS_DEBUG_MARKER_BEGIN_FORMAT(GS_DEBUG_COLOR_ITEM, "Sprite batch: %zu items", scene->sprite_batch.num);
+
+	gs_vertbuffer_t *vb = get_sprite_batch_buffer(solid, num_verts);
+	if (!vb)
+		goto cleanup;
+
+	fill_sprite_batch(gs_vertexbuffer_get_data(vb), scene, solid);
+	gs_vertexbuffer_flush(vb);
+
+	const bool previous = gs_framebuffer_srgb_enabled();
+	gs_enable_framebuffer_srgb(first->linear_srgb);
+
+	gs_blend_state_push();
+	if (first->premultiplied)
+		gs_blend_function(GS_BLEND_ONE, GS_BLEND_INVSRCALPHA);
+
+	gs_effect_t *effect;
+	const char *tech_name;
+
+	if (solid) {
+		struct vec4 white;
+		vec4_set(&white, 1.0f, 1.0f, 1.0f, 1.0f);
+
+		effect = obs->video.solid_effect;
+		tech_name = "SolidBatch";
+		gs_effect_set_vec4(gs_effect_get_param_by_name(effect, "color"), &white);
+	} else {
+		gs_eparam_t *image;
+
+		effect = obs->video.default_effect;
+		tech_name = "Draw";
+		image = gs_effect_get_param_by_name(effect, "image");
+		if (first->linear_srgb)
+			gs_effect_set_texture_srgb(image, first->texture);
+		else
+			gs_effect_set_texture(image, first->texture);
+	}
+
+	gs_load_vertexbuffer(vb);
+	gs_load_indexbuffer(NULL);
+
+	while (gs_effect_loop(effect, tech_name))
+		gs_draw(GS_TRIS, 0, num_verts);
+
+	gs_load_vertexbuffer(NULL);
+
+	gs_blend_state_pop();
+	gs_enable_framebuffer_srgb(previous);
+
+cleanup:
+	GS_DEBUG_MARKER_END();
+	profile_end(render_sprite_batch_name);
+
+	da_resize(scene->sprite_batch, 0);
+}
+
+static void batch_item_sprite(struct obs_scene *scene, struct obs_scene_item *item,
+			      const struct obs_source_sprite *sprite)
+{
+	if (scene->sprite_batch.num && !sprite_batch_matches(scene, sprite))
+		flush_sprite_batch(scene);
+
+	struct scene_sprite *batched = da_push_back_new(scene->sprite_batch);
+	batched->sprite = *sprite;
+	batched->transform = item->draw_transform;
+	batched->cx = (float)obs_source_get_width(item->source);
+	batched->cy = (float)obs_source_get_height(item->source);
+}
+
 static void scene_video_render(void *data, gs_effect_t *effect)
 {
 	obs_scene_item_ptr_array_t remove_items;
@@ -1074,14 +1554,29 @@ static void scene_video_render(void *data, gs_effect_t *effect)
 	gs_blend_state_push();
 	gs_reset_blend_state();
 
+	/* items are drawn in order, so only runs of neighbouring items that
+	 * can share a draw call are batched */
 	item = scene->first_item;
 	while (item) {
-		if (item->user_visible || transition_active(item->hide_transition))
+		struct obs_source_sprite sprite;
+
+		if (!item->user_visible && !transition_active(item->hide_transition)) {
+			item = item->next;
+			continue;
+		}
+
+		if (item_get_sprite(item, &sprite)) {
+			batch_item_sprite(scene, item, &sprite);
+		} else {
+			flush_sprite_batch(scene);
 			render_item(item);
+		}
 
 		item = item->next;
 	}
 
+	flush_sprite_batch(scene);
+
 	gs_blend_state_pop();
 
 	video_unlock(scene);
@@ -2037,15 +2532,7 @@ obs_sceneitem_t *obs_scene_find_source(obs_scene_t *scene, const char *name)
 		return NULL;
 
 	full_lock(scene);
-
-	item = scene->first_item;
-	while (item) {
-		if (strcmp(item->source->context.name, name) == 0)
-			break;
-
-		item = item->next;
-	}
-
+	item = scene_index_find_name(scene, name);
 	full_unlock(scene);
 
 	return item;
@@ -2053,6 +2540,7 @@ obs_sceneitem_t *obs_scene_find_source(obs_scene_t *scene, const char *name)
 
 obs_sceneitem_t *obs_scene_find_source_recursive(obs_scene_t *scene, const char *name)
 {
+	struct obs_scene_item *found;
 	struct obs_scene_item *item;
 
 	if (!scene)
@@ -2060,47 +2548,82 @@ obs_sceneitem_t *obs_scene_find_source_recursive(obs_scene_t *scene, const char
 
 	full_lock(scene);
 
-	item = scene->first_item;
-	while (item) {
-		if (strcmp(item->source->context.name, name) == 0)
-			break;
+	found = scene_index_find_name(scene, name);
 
-		if (item->is_group) {
-			obs_scene_t *group = item->source->context.data;
-			obs_sceneitem_t *child = obs_scene_find_source(group, name);
-			if (child) {
-				item = child;
-				break;
+	/* a group further up the list may contain the source as well */
+	if (scene->num_groups) {
+		for (item = scene->first_item; item && item != found; item = item->next) {
+			if (item->is_group) {
+				obs_scene_t *group = item->source->context.data;
+				obs_sceneitem_t *child = obs_scene_find_source(group, name);
+				if (child) {
+					found = child;
+					break;
+				}
 			}
 		}
-
-		item = item->next;
 	}
 
 	full_unlock(scene);
 
+	return found;
+}
+
+obs_sceneitem_t *obs_scene_find_source_by_uuid(obs_scene_t *scene, const char *uuid)
+{
+	struct obs_scene_item *item;
+
+	if (!scene || !uuid)
+		return NULL;
+
+	full_lock(scene);
+	item = scene_index_find_uuid(scene, uuid);
+	full_unlock(scene);
+
 	return item;
 }
 
-obs_sceneitem_t *obs_scene_find_sceneitem_by_id(obs_scene_t *scene, int64_t id)
+obs_sceneitem_t *obs_scene_find_source_by_uuid_recursive(obs_scene_t *scene, const char *uuid)
 {
+	struct obs_scene_item *found;
 	struct obs_scene_item *item;
 
-	if (!scene)
+	if (!scene || !uuid)
 		return NULL;
 
 	full_lock(scene);
 
-	item = scene->first_item;
-	while (item) {
-		if (item->id == id)
-			break;
+	found = scene_index_find_uuid(scene, uuid);
 
-		item = item->next;
+	if (scene->num_groups) {
+		for (item = scene->first_item; item && item != found; item = item->next) {
+			if (item->is_group) {
+				obs_scene_t *group = item->source->context.data;
+				obs_sceneitem_t *child = obs_scene_find_source_by_uuid(group, uuid);
+				if (child) {
+					found = child;
+					break;
+				}
+			}
+		}
 	}
 
 	full_unlock(scene);
 
+	return found;
+}
+
+obs_sceneitem_t *obs_scene_find_sceneitem_by_id(obs_scene_t *scene, int64_t id)
+{
+	struct obs_scene_item *item;
+
+	if (!scene)
+		return NULL;
+
+	full_lock(scene);
+	item = scene_index_find_id(scene, id);
+	full_unlock(scene);
+
 	return item;
 }
 
@@ -2242,6 +2765,7 @@ static void sceneitem_renamed(void *param, calldata_t *data)
 	const char *name = calldata_string(data, "new_name");
 
 	sceneitem_rename_hotkey(scene_item, name);
+	scene_index_rename(scene_item, name);
 }
 
 static inline bool source_has_audio(obs_source_t *source)
@@ -2337,6 +2861,8 @@ static obs_sceneitem_t *obs_scene_add_internal(obs_scene_t *scene, obs_source_t
 		}
 	}
 
+	scene_index_add(scene, item);
+
 	full_unlock(scene);
 
 	if (!scene->source->context.private)
@@ -3293,7 +3819,18 @@ int64_t obs_sceneitem_get_id(const obs_sceneitem_t *item)
 
 void obs_sceneitem_set_id(obs_sceneitem_t *item, int64_t id)
 {
+	obs_scene_t *scene = item->parent;
+
+	if (!scene) {
+		item->id = id;
+		return;
+	}
+
+	full_lock(scene);
+	unindex_item_id(scene, item);
 	item->id = id;
+	index_item_id(scene, item);
+	full_unlock(scene);
 }
 
 obs_data_t *obs_sceneitem_get_private_settings(obs_sceneitem_t *item)
@@ -3577,6 +4114,7 @@ obs_sceneitem_t *obs_scene_insert_group(obs_scene_t *scene, const char *name, ob
 			items[idx]->next = NULL;
 		}
 		items[idx]->parent = sub_scene;
+		scene_index_add(sub_scene, items[idx]);
 		apply_group_transform(items[idx], item);
 	}
 	items[0]->prev = NULL;
@@ -3920,6 +4458,7 @@ bool obs_scene_reorder_items2(obs_scene_t *scene, struct obs_sceneitem_order_inf
 				sub_prev = sub_item;
 			}
 
+			scene_index_rebuild(sub_scene);
 			resize_group(info->item, false);
 			full_unlock(sub_scene);
 			obs_scene_release(sub_scene);
@@ -3939,6 +4478,7 @@ bool obs_scene_reorder_items2(obs_scene_t *scene, struct obs_sceneitem_order_inf
 		prev = item;
 	}
 
+	scene_index_rebuild(scene);
 	full_unlock(scene);
 
 	signal_reorder(scene->first_item);
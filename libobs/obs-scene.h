@@ -19,6 +19,7 @@
 
 #include "obs.h"
 #include "graphics/matrix4.h"
+#include "util/uthash.h"
 
 /* how obs scene! */
 
@@ -49,6 +50,8 @@ struct obs_scene_item {
 	bool locked;
 
 	gs_texrender_t *item_render;
+	uint64_t item_render_hash;
+	bool item_render_valid;
 	struct obs_sceneitem_crop crop;
 
 	bool absolute_coordinates;
@@ -94,6 +97,34 @@ struct obs_scene_item {
 	/* would do **prev_next, but not really great for reordering */
 	struct obs_scene_item *prev;
 	struct obs_scene_item *next;
+
+	/* lookup by id in the parent scene, unless another item there
+	 * already uses the same id */
+	bool id_indexed;
+	UT_hash_handle hh_id;
+};
+
+/* one per source used by the items of a scene, for lookups by name/uuid */
+struct scene_source_ref {
+	struct obs_source *source;
+
+	/* the item using the source while there is only one, otherwise the
+	 * first one in the list is searched for */
+	struct obs_scene_item *item;
+	size_t count;
+
+	char *name;
+	bool name_indexed;
+
+	UT_hash_handle hh_source;
+	UT_hash_handle hh_name;
+	UT_hash_handle hh_uuid;
+};
+
+struct scene_sprite {
+	struct obs_source_sprite sprite;
+	struct matrix4 transform;
+	float cx, cy;
 };
 
 struct obs_scene {
@@ -113,4 +144,15 @@ struct obs_scene {
 	pthread_mutex_t video_mutex;
 	pthread_mutex_t audio_mutex;
 	struct obs_scene_item *first_item;
+
+	/* lookup indexes, protected by the scene mutexes */
+	struct scene_source_ref *refs_by_source;
+	struct scene_source_ref *refs_by_name;
+	struct scene_source_ref *refs_by_uuid;
+	struct obs_scene_item *items_by_id;
+	size_t unindexed_names;
+	size_t unindexed_ids;
+	size_t num_groups;
+
+	DARRAY(struct scene_sprite) sprite_batch;
 };
@@ -19,7 +19,7 @@
 
 #define get_weak(service) ((obs_weak_service_t *)service->context.control)
 
-const struct obs_service_info *find_service(const char *id)
+static const struct obs_service_info *find_service_type(const char *id)
 {
 	size_t i;
 	for (i = 0; i < obs->service_types.num; i++)
@@ -29,6 +29,14 @@ const struct obs_service_info *find_service(const char *id)
 	return NULL;
 }
 
+const struct obs_service_info *find_service(const char *id)
+{
+	const struct obs_service_info *info = find_service_type(id);
+	if (!info && obs_module_load_deferred_type(DEFERRED_SERVICE, id))
+		info = find_service_type(id);
+	return info;
+}
+
 const char *obs_service_get_display_name(const char *id)
 {
 	const struct obs_service_info *info = find_service(id);
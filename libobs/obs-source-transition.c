@@ -852,6 +852,36 @@ bool obs_transition_video_render_direct(obs_source_t *transition, enum obs_trans
 	return transitioning;
 }
 
+bool obs_transition_get_content_hash(obs_source_t *transition, uint64_t *hash)
+{
+	struct matrix4 matrix;
+	obs_source_t *source;
+	uint64_t val;
+	bool is_static;
+
+	lock_transition(transition);
+	is_static = !transition->transitioning_video && !transition->transitioning_audio;
+	source = is_static ? obs_source_get_ref(transition->transition_sources[0]) : NULL;
+	matrix = transition->transition_matrices[0];
+	val = content_hash_combine(get_cx(transition), get_cy(transition));
+	unlock_transition(transition);
+
+	/* when idle, transitions just draw their first source */
+	val = content_hash_data(val, &matrix, sizeof(matrix));
+
+	if (source) {
+		uint64_t child;
+		if (!obs_source_get_content_hash(source, &child))
+			is_static = false;
+		val = content_hash_combine(val, (uint64_t)(uintptr_t)source);
+		val = content_hash_combine(val, child);
+		obs_source_release(source);
+	}
+
+	*hash = val;
+	return is_static;
+}
+
 static inline float get_sample_time(obs_source_t *transition, size_t sample_rate, size_t sample, uint64_t ts)
 {
 	uint64_t sample_ts_offset = util_mul_div64(sample, 1000000000ULL, sample_rate);
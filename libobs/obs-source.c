@@ -27,6 +27,7 @@
 #include "callback/calldata.h"
 #include "graphics/matrix3.h"
 #include "graphics/vec3.h"
+#include "graphics/graphics-internal.h"
 
 #include "obs.h"
 #include "obs-internal.h"
@@ -50,7 +51,7 @@ static inline bool destroying(const struct obs_source *source)
 	return os_atomic_load_long(&source->destroying);
 }
 
-struct obs_source_info *get_source_info(const char *id)
+static struct obs_source_info *find_source_info(const char *id)
 {
 	for (size_t i = 0; i < obs->source_types.num; i++) {
 		struct obs_source_info *info = &obs->source_types.array[i];
@@ -61,7 +62,7 @@ struct obs_source_info *get_source_info(const char *id)
 	return NULL;
 }
 
-struct obs_source_info *get_source_info2(const char *unversioned_id, uint32_t ver)
+static struct obs_source_info *find_source_info2(const char *unversioned_id, uint32_t ver)
 {
 	for (size_t i = 0; i < obs->source_types.num; i++) {
 		struct obs_source_info *info = &obs->source_types.array[i];
@@ -72,6 +73,22 @@ struct obs_source_info *get_source_info2(const char *unversioned_id, uint32_t ve
 	return NULL;
 }
 
+struct obs_source_info *get_source_info(const char *id)
+{
+	struct obs_source_info *info = find_source_info(id);
+	if (!info && obs_module_load_deferred_type(DEFERRED_SOURCE, id))
+		info = find_source_info(id);
+	return info;
+}
+
+struct obs_source_info *get_source_info2(const char *unversioned_id, uint32_t ver)
+{
+	struct obs_source_info *info = find_source_info2(unversioned_id, ver);
+	if (!info && obs_module_load_deferred_type(DEFERRED_SOURCE, unversioned_id))
+		info = find_source_info2(unversioned_id, ver);
+	return info;
+}
+
 static const char *source_signals[] = {
 	"void destroy(ptr source)",
 	"void remove(ptr source)",
@@ -244,8 +261,11 @@ static bool obs_source_init(struct obs_source *source)
 	if (pthread_mutex_init(&source->media_actions_mutex, NULL) != 0)
 		return false;
 
-	if (is_audio_source(source) || is_composite_source(source))
+	if (is_audio_source(source) || is_composite_source(source)) {
 		allocate_audio_output_buffer(source);
+		source->audio_queue = bzalloc(sizeof(struct audio_queue));
+		audio_queue_init(source->audio_queue);
+	}
 	if (source->info.audio_mix)
 		allocate_audio_mix_buffer(source);
 
@@ -433,9 +453,8 @@ void obs_source_audio_output_capture_device_changed(obs_source_t *src, const cha
 	}
 }
 
-static obs_source_t *obs_source_create_internal(const char *id, const char *name, const char *uuid,
-						obs_data_t *settings, obs_data_t *hotkey_data, bool private,
-						uint32_t last_obs_ver, obs_canvas_t *canvas)
+obs_source_t *obs_source_create_begin(const char *id, const char *name, const char *uuid, obs_data_t *settings,
+				     obs_data_t *hotkey_data, bool private, uint32_t last_obs_ver)
 {
 	struct obs_source *source = bzalloc(sizeof(struct obs_source));
 
@@ -477,23 +496,42 @@ static obs_source_t *obs_source_create_internal(const char *id, const char *name
 	if (!obs_source_init(source))
 		goto fail;
 
-	/* Scenes need canvases, fall back to using default canvas if none provided here. */
-	if (requires_canvas(source) && !canvas) {
-		blog(LOG_WARNING, "Attempted to add Scene without specifying a canvas! Using default canvas instead.");
-		canvas = obs->data.main_canvas;
-	}
-
 	if (!private)
 		obs_source_init_audio_hotkeys(source);
 
+	return source;
+
+fail:
+	blog(LOG_ERROR, "obs_source_create failed");
+	obs_source_destroy(source);
+	return NULL;
+}
+
+void obs_source_create_data(obs_source_t *source)
+{
+	const char *name = source->context.name;
+	const char *id = source->info.id;
+	bool has_info = !source->owns_info_id;
+
 	/* allow the source to be created even if creation fails so that the
 	 * user's data doesn't become lost */
-	if (info && info->create)
-		source->context.data = info->create(source->context.settings, source);
-	if ((!info || info->create) && !source->context.data)
+	if (has_info && source->info.create)
+		source->context.data = source->info.create(source->context.settings, source);
+	if ((!has_info || source->info.create) && !source->context.data)
 		blog(LOG_ERROR, "Failed to create source '%s'!", name);
 
-	blog(LOG_DEBUG, "%ssource '%s' (%s) created", private ? "private " : "", name, id);
+	blog(LOG_DEBUG, "%ssource '%s' (%s) created", source->context.private ? "private " : "", name, id);
+}
+
+void obs_source_create_finish(obs_source_t *source, obs_canvas_t *canvas)
+{
+	bool private = source->context.private;
+
+	/* Scenes need canvases, fall back to using default canvas if none provided here. */
+	if (requires_canvas(source) && !canvas) {
+		blog(LOG_WARNING, "Attempted to add Scene without specifying a canvas! Using default canvas instead.");
+		canvas = obs->data.main_canvas;
+	}
 
 	source->flags = source->default_flags;
 	source->enabled = true;
@@ -508,13 +546,19 @@ static obs_source_t *obs_source_create_internal(const char *id, const char *name
 		if (!canvas || canvas == obs->data.main_canvas)
 			obs_source_dosignal(source, "source_create", NULL);
 	}
+}
 
-	return source;
+static obs_source_t *obs_source_create_internal(const char *id, const char *name, const char *uuid,
+						obs_data_t *settings, obs_data_t *hotkey_data, bool private,
+						uint32_t last_obs_ver, obs_canvas_t *canvas)
+{
+	obs_source_t *source = obs_source_create_begin(id, name, uuid, settings, hotkey_data, private, last_obs_ver);
+	if (!source)
+		return NULL;
 
-fail:
-	blog(LOG_ERROR, "obs_source_create failed");
-	obs_source_destroy(source);
-	return NULL;
+	obs_source_create_data(source);
+	obs_source_create_finish(source, canvas);
+	return source;
 }
 
 obs_source_t *obs_source_create(const char *id, const char *name, obs_data_t *settings, obs_data_t *hotkey_data)
@@ -697,10 +741,48 @@ void obs_source_frame_init(struct obs_source_frame *frame, enum video_format for
 	}
 }
 
+#define EXTERNAL_FRAME_MAGIC 0x46545845 /* "EXTF" */
+
+/* frames output with obs_source_output_video_ref.  they carry
+ * OBS_SOURCE_FRAME_EXTERNAL, which libobs clears whenever it copies a frame,
+ * and the magic guards against frames that copied the flag some other way */
+struct external_frame {
+	struct obs_source_frame frame;
+	uint32_t magic;
+	obs_source_frame_release_t release;
+	void *param;
+};
+
+static inline struct external_frame *get_external_frame(struct obs_source_frame *frame)
+{
+	struct external_frame *ef = (struct external_frame *)frame;
+
+	if (!frame || !(frame->flags & OBS_SOURCE_FRAME_EXTERNAL))
+		return NULL;
+	return ef->magic == EXTERNAL_FRAME_MAGIC ? ef : NULL;
+}
+
+/* destroys a frame that went through the async cache, handing external data
+ * back to its owner instead of freeing it */
+static void async_frame_destroy(struct obs_source_frame *frame)
+{
+	struct external_frame *ef = get_external_frame(frame);
+
+	if (ef) {
+		ef->magic = 0;
+		if (ef->release)
+			ef->release(ef->param);
+		bfree(ef);
+		return;
+	}
+
+	obs_source_frame_destroy(frame);
+}
+
 static inline void obs_source_frame_decref(struct obs_source_frame *frame)
 {
 	if (os_atomic_dec_long(&frame->refs) == 0)
-		obs_source_frame_destroy(frame);
+		async_frame_destroy(frame);
 }
 
 static bool obs_source_filter_remove_refless(obs_source_t *source, obs_source_t *filter);
@@ -807,6 +889,13 @@ static void obs_source_destroy_defer(struct obs_source *source)
 		bfree(source->audio_data.data[i]);
 	for (i = 0; i < MAX_AUDIO_CHANNELS; i++)
 		deque_free(&source->audio_input_buf[i]);
+	if (source->audio_queue) {
+		if (source->audio_queue->dropped_frames)
+			blog(LOG_INFO, "Source '%s' dropped %" PRIu64 " audio frames: audio queue full",
+			     source->context.name, source->audio_queue->dropped_frames);
+		audio_queue_free(source->audio_queue);
+		bfree(source->audio_queue);
+	}
 	audio_resampler_destroy(source->resampler);
 	bfree(source->audio_output_buf[0][0]);
 	bfree(source->audio_mix_buf[0]);
@@ -1059,6 +1148,7 @@ static void obs_source_deferred_update(obs_source_t *source)
 		long count = os_atomic_load_long(&source->defer_update_count);
 		source->info.update(source->context.data, source->context.settings);
 		os_atomic_compare_swap_long(&source->defer_update_count, count, 0);
+		os_atomic_inc_long(&source->content_generation);
 		obs_source_dosignal(source, "source_update", "update");
 	}
 }
@@ -1076,10 +1166,19 @@ void obs_source_update(obs_source_t *source, obs_data_t *settings)
 		os_atomic_inc_long(&source->defer_update_count);
 	} else if (source->context.data && source->info.update) {
 		source->info.update(source->context.data, source->context.settings);
+		os_atomic_inc_long(&source->content_generation);
 		obs_source_dosignal(source, "source_update", "update");
 	}
 }
 
+void obs_source_content_changed(obs_source_t *source)
+{
+	if (!obs_source_valid(source, "obs_source_content_changed"))
+		return;
+
+	os_atomic_inc_long(&source->content_generation);
+}
+
 void obs_source_reset_settings(obs_source_t *source, obs_data_t *settings)
 {
 	if (!obs_source_valid(source, "obs_source_reset_settings"))
@@ -1466,7 +1565,40 @@ static void reset_audio_data(obs_source_t *source, uint64_t os_time)
 
 	source->last_audio_input_buf_size = 0;
 	source->audio_ts = os_time;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Audio queue.  Whoever outputs audio for a source (serialized by
+ * audio_buf_mutex) is the producer, the audio thread is the only consumer and
+ * never takes audio_buf_mutex, so the mixer does not wait for a source that is
+ * busy outputting audio.  Producers still wait for each other. */
+
+static void audio_queue_push_source(obs_source_t *source, const struct audio_data *in, bool push_back)
+{
+	size_t channels = audio_output_get_channels(obs->audio.audio);
+	size_t sample_rate = audio_output_get_sample_rate(obs->audio.audio);
+
+	struct audio_queue *queue = source->audio_queue;
+	bool dropping = !audio_queue_push(queue, in, channels, sample_rate, push_back);
+
+	if (dropping == source->audio_queue_dropping)
+		return;
+
+	source->audio_queue_dropping = dropping;
+	if (dropping)
+		blog(LOG_WARNING, "Source '%s' is dropping audio: audio queue full", source->context.name);
+	else
+		blog(LOG_INFO, "Source '%s' stopped dropping audio, %" PRIu64 " frames dropped so far",
+		     source->context.name, queue->dropped_frames);
+}
+
+/* asks the audio thread to clear the source's buffered audio */
+static void reset_audio_queue(obs_source_t *source, uint64_t os_time)
+{
 	source->next_audio_sys_ts_min = os_time;
+
+	if (source->audio_queue)
+		audio_queue_push_reset(source->audio_queue, os_time);
 }
 
 static void handle_ts_jump(obs_source_t *source, uint64_t expected, uint64_t ts, uint64_t diff, uint64_t os_time)
@@ -1478,7 +1610,7 @@ static void handle_ts_jump(obs_source_t *source, uint64_t expected, uint64_t ts,
 
 	pthread_mutex_lock(&source->audio_buf_mutex);
 	reset_audio_timing(source, ts, os_time);
-	reset_audio_data(source, os_time);
+	reset_audio_queue(source, os_time);
 	pthread_mutex_unlock(&source->audio_buf_mutex);
 }
 
@@ -1554,6 +1686,35 @@ static inline void source_output_audio_push_back(obs_source_t *source, const str
 	source->last_audio_input_buf_size = 0;
 }
 
+void obs_source_drain_audio_queue(obs_source_t *source)
+{
+	struct audio_queue *queue = source->audio_queue;
+	struct audio_queue_reader reader;
+	struct audio_segment seg;
+	struct audio_data in;
+	size_t channels;
+
+	if (!queue)
+		return;
+
+	audio_queue_begin_read(queue, &reader);
+	if (reader.read == reader.written)
+		return;
+
+	channels = audio_output_get_channels(obs->audio.audio);
+
+	while (audio_queue_read(queue, &reader, channels, &seg, &in)) {
+		if (seg.reset)
+			reset_audio_data(source, seg.timestamp);
+		else if (seg.push_back && source->audio_ts)
+			source_output_audio_push_back(source, &in);
+		else
+			source_output_audio_place(source, &in);
+	}
+
+	audio_queue_end_read(queue, &reader);
+}
+
 static inline bool source_muted(obs_source_t *source, uint64_t os_time)
 {
 	if (source->push_to_mute_enabled && source->user_push_to_mute_pressed)
@@ -1579,6 +1740,10 @@ static void source_output_audio_data(obs_source_t *source, const struct audio_da
 	bool using_direct_ts = false;
 	bool push_back = false;
 
+	/* the audio thread asked for the timing to be reset */
+	if (os_atomic_exchange_bool(&source->audio_timing_reset, false))
+		source->timing_set = false;
+
 	/* detects 'directly' set timestamps as long as they're within
 	 * a certain threshold */
 	if (uint64_diff(in.timestamp, os_time) < MAX_TS_VAR) {
@@ -1647,12 +1812,8 @@ static void source_output_audio_data(obs_source_t *source, const struct audio_da
 		source->last_sync_offset = sync_offset;
 	}
 
-	if (source->monitoring_type != OBS_MONITORING_TYPE_MONITOR_ONLY) {
-		if (push_back && source->audio_ts)
-			source_output_audio_push_back(source, &in);
-		else
-			source_output_audio_place(source, &in);
-	}
+	if (source->audio_queue && source->monitoring_type != OBS_MONITORING_TYPE_MONITOR_ONLY)
+		audio_queue_push_source(source, &in, push_back);
 
 	pthread_mutex_unlock(&source->audio_buf_mutex);
 
@@ -2957,6 +3118,45 @@ void obs_source_video_render(obs_source_t *source)
 	}
 }
 
+bool obs_source_get_sprite(obs_source_t *source, struct obs_source_sprite *sprite)
+{
+	const uint32_t flags = source->info.output_flags;
+
+	if (!source->info.get_sprite || source->info.type != OBS_SOURCE_TYPE_INPUT)
+		return false;
+	if ((flags & OBS_SOURCE_VIDEO) == 0 || (flags & OBS_SOURCE_ASYNC) != 0)
+		return false;
+	if (!source->context.data || !source->enabled)
+		return false;
+
+	pthread_mutex_lock(&source->filter_mutex);
+	const bool filtered = source->filters.num != 0;
+	pthread_mutex_unlock(&source->filter_mutex);
+
+	if (filtered)
+		return false;
+
+	/* anything that would need a color space conversion pass goes
+	 * through the regular render path */
+	const enum gs_color_space current_space = gs_get_color_space();
+	if (current_space != GS_CS_SRGB && current_space != GS_CS_SRGB_16F)
+		return false;
+
+	const enum gs_color_space source_space = obs_source_get_color_space(source, 1, &current_space);
+	if (source_space != GS_CS_SRGB && source_space != GS_CS_SRGB_16F)
+		return false;
+
+	memset(sprite, 0, sizeof(*sprite));
+	vec4_set(&sprite->color, 1.0f, 1.0f, 1.0f, 1.0f);
+
+	const bool srgb_aware = (flags & OBS_SOURCE_SRGB) != 0;
+	const bool previous_srgb = gs_set_linear_srgb(srgb_aware && gs_get_linear_srgb());
+	const bool success = source->info.get_sprite(source->context.data, sprite);
+	gs_set_linear_srgb(previous_srgb);
+
+	return success && (!sprite->texture || !gs_texture_is_rect(sprite->texture));
+}
+
 static uint32_t get_recurse_width(obs_source_t *source)
 {
 	uint32_t width;
@@ -2983,6 +3183,57 @@ static uint32_t get_recurse_height(obs_source_t *source)
 	return height;
 }
 
+static bool calc_content_hash(obs_source_t *source, uint64_t *hash)
+{
+	const uint32_t flags = source->info.output_flags;
+	uint64_t val = (uint64_t)(uintptr_t)source;
+	uint64_t child;
+	bool is_static = true;
+
+	val = content_hash_combine(val, (uint64_t)os_atomic_load_long(&source->content_generation));
+	val = content_hash_combine(val, source->enabled);
+
+	if (!source->context.data || !source->enabled) {
+		/* nothing of its own is rendered */
+	} else if (source->info.type == OBS_SOURCE_TYPE_SCENE) {
+		is_static = obs_scene_get_content_hash(source->context.data, &child);
+		val = content_hash_combine(val, child);
+	} else if ((flags & OBS_SOURCE_CONTENT_TRACKED) == 0 || (flags & OBS_SOURCE_ASYNC) != 0) {
+		is_static = false;
+	} else if (source->info.type == OBS_SOURCE_TYPE_TRANSITION) {
+		is_static = obs_transition_get_content_hash(source, &child);
+		val = content_hash_combine(val, child);
+	}
+
+	if (source->info.type != OBS_SOURCE_TYPE_FILTER) {
+		pthread_mutex_lock(&source->filter_mutex);
+
+		for (size_t i = 0; i < source->filters.num; i++) {
+			obs_source_t *filter = source->filters.array[i];
+
+			if (!obs_source_get_content_hash(filter, &child))
+				is_static = false;
+			val = content_hash_combine(val, child);
+		}
+
+		pthread_mutex_unlock(&source->filter_mutex);
+	}
+
+	*hash = val;
+	return is_static;
+}
+
+bool obs_source_get_content_hash(obs_source_t *source, uint64_t *hash)
+{
+	if (source->content_frame != obs->video.content_frame) {
+		source->content_static = calc_content_hash(source, &source->content_hash);
+		source->content_frame = obs->video.content_frame;
+	}
+
+	*hash = source->content_hash;
+	return source->content_static;
+}
+
 uint32_t obs_source_get_width(obs_source_t *source)
 {
 	if (!data_valid(source, "obs_source_get_width"))
@@ -3376,7 +3627,7 @@ static inline void copy_frame_data_plane(struct obs_source_frame *dst, const str
 static void copy_frame_data(struct obs_source_frame *dst, const struct obs_source_frame *src)
 {
 	dst->flip = src->flip;
-	dst->flags = src->flags;
+	dst->flags = src->flags & ~OBS_SOURCE_FRAME_EXTERNAL;
 	dst->trc = src->trc;
 	dst->full_range = src->full_range;
 	dst->max_luminance = src->max_luminance;
@@ -3493,7 +3744,7 @@ static void clean_cache(obs_source_t *source)
 		struct async_frame *af = &source->async_cache.array[i - 1];
 		if (!af->used) {
 			if (++af->unused_count == MAX_UNUSED_FRAME_DURATION) {
-				obs_source_frame_destroy(af->frame);
+				async_frame_destroy(af->frame);
 				da_erase(source->async_cache, i - 1);
 			}
 		}
@@ -3501,18 +3752,15 @@ static void clean_cache(obs_source_t *source)
 }
 
 #define MAX_ASYNC_FRAMES 30
-//if return value is not null then do (os_atomic_dec_long(&output->refs) == 0) && obs_source_frame_destroy(output)
-static inline struct obs_source_frame *cache_video(struct obs_source *source, const struct obs_source_frame *frame)
-{
-	struct obs_source_frame *new_frame = NULL;
-
-	pthread_mutex_lock(&source->async_mutex);
 
+/* call with async_mutex locked.  returns false if the frame queue overflowed
+ * and the new frame should be dropped */
+static bool prepare_async_cache(struct obs_source *source, const struct obs_source_frame *frame)
+{
 	if (source->async_frames.num >= MAX_ASYNC_FRAMES) {
 		free_async_cache(source);
 		source->last_frame_ts = 0;
-		pthread_mutex_unlock(&source->async_mutex);
-		return NULL;
+		return false;
 	}
 
 	if (async_texture_changed(source, frame)) {
@@ -3521,10 +3769,25 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source, co
 		source->async_cache_height = frame->height;
 	}
 
-	const enum video_format format = frame->format;
-	source->async_cache_format = format;
+	source->async_cache_format = frame->format;
 	source->async_cache_full_range = frame->full_range;
 	source->async_cache_trc = frame->trc;
+	return true;
+}
+
+//if return value is not null then do (os_atomic_dec_long(&output->refs) == 0) && obs_source_frame_destroy(output)
+static inline struct obs_source_frame *cache_video(struct obs_source *source, const struct obs_source_frame *frame)
+{
+	struct obs_source_frame *new_frame = NULL;
+
+	pthread_mutex_lock(&source->async_mutex);
+
+	if (!prepare_async_cache(source, frame)) {
+		pthread_mutex_unlock(&source->async_mutex);
+		return NULL;
+	}
+
+	const enum video_format format = frame->format;
 
 	for (size_t i = 0; i < source->async_cache.num; i++) {
 		struct async_frame *af = &source->async_cache.array[i];
@@ -3545,6 +3808,7 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source, co
 		new_frame = obs_source_frame_create(format, frame->width, frame->height);
 		new_af.frame = new_frame;
 		new_af.used = true;
+		new_af.external = false;
 		new_af.unused_count = 0;
 		new_frame->refs = 1;
 
@@ -3560,6 +3824,58 @@ static inline struct obs_source_frame *cache_video(struct obs_source *source, co
 	return new_frame;
 }
 
+/* same as cache_video, but wraps the frame data instead of copying it */
+static inline struct obs_source_frame *cache_external_video(struct obs_source *source,
+							    const struct obs_source_frame *frame,
+							    obs_source_frame_release_t release, void *param)
+{
+	struct external_frame *ef;
+	struct async_frame new_af;
+
+	pthread_mutex_lock(&source->async_mutex);
+
+	if (!prepare_async_cache(source, frame)) {
+		pthread_mutex_unlock(&source->async_mutex);
+		return NULL;
+	}
+
+	clean_cache(source);
+
+	ef = bmalloc(sizeof(*ef));
+	ef->frame = *frame;
+	ef->frame.refs = 2;
+	ef->frame.prev_frame = false;
+	ef->frame.flags |= OBS_SOURCE_FRAME_EXTERNAL;
+	ef->magic = EXTERNAL_FRAME_MAGIC;
+	ef->release = release;
+	ef->param = param;
+
+	new_af.frame = &ef->frame;
+	new_af.used = true;
+	new_af.external = true;
+	new_af.unused_count = 0;
+	da_push_back(source->async_cache, &new_af);
+
+	pthread_mutex_unlock(&source->async_mutex);
+
+	return &ef->frame;
+}
+
+static void push_async_frame(obs_source_t *source, struct obs_source_frame *output)
+{
+	pthread_mutex_lock(&source->async_mutex);
+	if (output) {
+		if (os_atomic_dec_long(&output->refs) == 0) {
+			async_frame_destroy(output);
+			output = NULL;
+		} else {
+			da_push_back(source->async_frames, &output);
+			source->async_active = true;
+		}
+	}
+	pthread_mutex_unlock(&source->async_mutex);
+}
+
 static void obs_source_output_video_internal(obs_source_t *source, const struct obs_source_frame *frame)
 {
 	if (!obs_source_valid(source, "obs_source_output_video"))
@@ -3579,17 +3895,7 @@ static void obs_source_output_video_internal(obs_source_t *source, const struct
 	struct obs_source_frame *output = cache_video(source, frame);
 
 	/* ------------------------------------------- */
-	pthread_mutex_lock(&source->async_mutex);
-	if (output) {
-		if (os_atomic_dec_long(&output->refs) == 0) {
-			obs_source_frame_destroy(output);
-			output = NULL;
-		} else {
-			da_push_back(source->async_frames, &output);
-			source->async_active = true;
-		}
-	}
-	pthread_mutex_unlock(&source->async_mutex);
+	push_async_frame(source, output);
 }
 
 void obs_source_output_video(obs_source_t *source, const struct obs_source_frame *frame)
@@ -3607,6 +3913,35 @@ void obs_source_output_video(obs_source_t *source, const struct obs_source_frame
 	obs_source_output_video_internal(source, &new_frame);
 }
 
+void obs_source_output_video_ref(obs_source_t *source, const struct obs_source_frame *frame,
+				 obs_source_frame_release_t release, void *param)
+{
+	if (!frame) {
+		obs_source_output_video(source, NULL);
+		return;
+	}
+
+	if (destroying(source) || !obs_source_valid(source, "obs_source_output_video_ref")) {
+		if (release)
+			release(param);
+		return;
+	}
+
+	struct obs_source_frame new_frame = *frame;
+	new_frame.full_range = format_is_yuv(frame->format) ? new_frame.full_range : true;
+
+	source_profiler_async_frame_received(source);
+
+	struct obs_source_frame *output = cache_external_video(source, &new_frame, release, param);
+	if (!output) {
+		if (release)
+			release(param);
+		return;
+	}
+
+	push_async_frame(source, output);
+}
+
 void obs_source_output_video2(obs_source_t *source, const struct obs_source_frame2 *frame)
 {
 	if (destroying(source))
@@ -3788,7 +4123,7 @@ void obs_source_show_preloaded_video(obs_source_t *source)
 	pthread_mutex_lock(&source->audio_buf_mutex);
 	sys_ts = (source->monitoring_type != OBS_MONITORING_TYPE_MONITOR_ONLY) ? os_gettime_ns() : 0;
 	reset_audio_timing(source, source->last_frame_ts, sys_ts);
-	reset_audio_data(source, sys_ts);
+	reset_audio_queue(source, sys_ts);
 	pthread_mutex_unlock(&source->audio_buf_mutex);
 }
 
@@ -4076,7 +4411,14 @@ void remove_async_frame(obs_source_t *source, struct obs_source_frame *frame)
 		struct async_frame *f = &source->async_cache.array[i];
 
 		if (f->frame == frame) {
-			f->used = false;
+			if (f->external) {
+				/* external data goes back to its owner as soon
+				 * as it is no longer needed */
+				da_erase(source->async_cache, i);
+				obs_source_frame_decref(frame);
+			} else {
+				f->used = false;
+			}
 			break;
 		}
 	}
@@ -4223,12 +4565,12 @@ void obs_source_release_frame(obs_source_t *source, struct obs_source_frame *fra
 		return;
 
 	if (!source) {
-		obs_source_frame_destroy(frame);
+		async_frame_destroy(frame);
 	} else {
 		pthread_mutex_lock(&source->async_mutex);
 
 		if (os_atomic_dec_long(&frame->refs) == 0)
-			obs_source_frame_destroy(frame);
+			async_frame_destroy(frame);
 		else
 			remove_async_frame(source, frame);
 
@@ -4400,7 +4742,7 @@ bool obs_source_process_filter_begin_with_color_space(obs_source_t *filter, enum
 	}
 
 	if (!filter->filter_texrender) {
-		filter->filter_texrender = gs_texrender_create(format, GS_ZS_NONE);
+		filter->filter_texrender = gs_texrender_create_pooled(format, GS_ZS_NONE);
 	}
 
 	if (gs_texrender_begin_with_color_space(filter->filter_texrender, cx, cy, space)) {
@@ -4459,6 +4801,10 @@ void obs_source_process_filter_tech_end(obs_source_t *filter, gs_effect_t *effec
 		if (texture) {
 			render_filter_tex(texture, effect, width, height, tech);
 		}
+
+		/* once drawn the intermediate target can go back to the pool
+		 * for the rest of the frame */
+		gs_texrender_release(filter->filter_texrender);
 	}
 
 	gs_set_linear_srgb(previous);
@@ -5407,19 +5753,14 @@ static inline void process_audio_source_tick(obs_source_t *source, uint32_t mixe
 {
 	bool audio_submix = !!(source->info.output_flags & OBS_SOURCE_SUBMIX);
 
-	pthread_mutex_lock(&source->audio_buf_mutex);
-
 	if (source->audio_input_buf[0].size < size) {
 		source->audio_pending = true;
-		pthread_mutex_unlock(&source->audio_buf_mutex);
 		return;
 	}
 
 	for (size_t ch = 0; ch < channels; ch++)
 		deque_peek_front(&source->audio_input_buf[ch], source->audio_output_buf[0][ch], size);
 
-	pthread_mutex_unlock(&source->audio_buf_mutex);
-
 	for (size_t mix = 1; mix < MAX_AUDIO_MIXES; mix++) {
 		uint32_t mix_and_val = (1 << mix);
 
@@ -5470,6 +5811,7 @@ void obs_source_audio_render(obs_source_t *source, uint32_t mixers, size_t chann
 
 	if (source->info.audio_mix) {
 		audio_submix(source, channels, sample_rate);
+		obs_source_drain_audio_queue(source);
 	}
 
 	if (!source->audio_ts) {
@@ -5626,7 +5968,7 @@ void obs_source_set_async_decoupled(obs_source_t *source, bool decouple)
 	if (decouple) {
 		pthread_mutex_lock(&source->audio_buf_mutex);
 		source->timing_set = false;
-		reset_audio_data(source, 0);
+		reset_audio_queue(source, 0);
 		pthread_mutex_unlock(&source->audio_buf_mutex);
 	}
 }
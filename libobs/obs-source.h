@@ -208,6 +208,20 @@ enum obs_media_state {
  */
 #define OBS_SOURCE_REQUIRES_CANVAS (1 << 17)
 
+/**
+ * Source only changes its video output when its settings are updated or
+ * when it calls obs_source_content_changed, which allows libobs to reuse
+ * previously rendered frames of scenes that contain it
+ */
+#define OBS_SOURCE_CONTENT_TRACKED (1 << 18)
+
+/**
+ * Source type's create callback may run on a worker thread while a scene
+ * collection is loaded with obs_load_sources_parallel.  The create callback
+ * of such a type must not register hotkeys.
+ */
+#define OBS_SOURCE_PARALLEL_CREATE (1 << 19)
+
 /** @} */
 
 typedef void (*obs_source_enum_proc_t)(obs_source_t *parent, obs_source_t *child, void *param);
@@ -216,6 +230,24 @@ struct obs_source_audio_mix {
 	struct audio_output_data output[MAX_AUDIO_MIXES];
 };
 
+/**
+ * Description of a source that renders as a single untransformed sprite the
+ * size of the source, used to batch it with neighbouring scene items
+ */
+struct obs_source_sprite {
+	/** Texture to draw, or NULL to fill the sprite with the color */
+	gs_texture_t *texture;
+
+	/** Color of solid sprites, not used for textured ones */
+	struct vec4 color;
+
+	/** Whether the sprite is drawn with sRGB framebuffer writes */
+	bool linear_srgb;
+
+	/** Whether the texture has premultiplied alpha */
+	bool premultiplied;
+};
+
 /**
  * Source definition structure
  */
@@ -555,6 +587,21 @@ struct obs_source_info {
 	/** Gets custom icons for dark and light themes */
 	const char *(*get_dark_icon)(void *type_data);
 	const char *(*get_light_icon)(void *type_data);
+
+	/**
+	 * Optional: describes what the source would draw in video_render as
+	 * a single sprite.  Scenes use it to draw runs of such sources with
+	 * a single draw call instead of rendering each one separately.
+	 *
+	 * Only called from the graphics thread while rendering, with the
+	 * same linear sRGB state video_render would see.
+	 *
+	 * @param  data    Source data
+	 * @param  sprite  Sprite to fill out, color defaults to opaque white
+	 * @return         false if the source cannot be drawn as a sprite
+	 *                 right now
+	 */
+	bool (*get_sprite)(void *data, struct obs_source_sprite *sprite);
 };
 
 EXPORT void obs_register_source_s(const struct obs_source_info *info, size_t size);
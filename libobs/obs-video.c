@@ -168,6 +168,34 @@ static inline void draw_mix_texture(const size_t mix_idx)
 	gs_enable_framebuffer_srgb(false);
 }
 
+/* the main texture can be kept from the last frame when everything drawn
+ * into it is content tracked and nothing has changed since */
+static bool main_texture_unchanged(struct obs_core_video_mix *video)
+{
+	bool is_static;
+	uint64_t hash;
+
+	pthread_mutex_lock(&obs->data.draw_callbacks_mutex);
+	is_static = obs->data.draw_callbacks.num == 0;
+	pthread_mutex_unlock(&obs->data.draw_callbacks_mutex);
+
+	if (!obs_view_get_content_hash(video->view, &hash))
+		is_static = false;
+
+	hash = content_hash_combine(hash, (uint64_t)video->render_space);
+	hash = content_hash_data(hash, &obs->video.sdr_white_level, sizeof(obs->video.sdr_white_level));
+	hash = content_hash_data(hash, &obs->video.hdr_nominal_peak_level, sizeof(obs->video.hdr_nominal_peak_level));
+
+	if (is_static && video->content_valid && video->content_hash == hash)
+		return true;
+
+	video->content_hash = hash;
+	video->content_valid = is_static;
+	video->output_valid = false;
+	video->convert_valid = false;
+	return false;
+}
+
 static const char *render_main_texture_name = "render_main_texture";
 static inline void render_main_texture(struct obs_core_video_mix *video)
 {
@@ -177,6 +205,9 @@ static inline void render_main_texture(struct obs_core_video_mix *video)
 	profile_start(render_main_texture_name);
 	GS_DEBUG_MARKER_BEGIN(GS_DEBUG_COLOR_MAIN_TEXTURE, render_main_texture_name);
 
+	if (main_texture_unchanged(video))
+		goto rendered;
+
 	struct vec4 clear_color;
 	vec4_set(&clear_color, 0.0f, 0.0f, 0.0f, 0.0f);
 
@@ -201,6 +232,7 @@ static inline void render_main_texture(struct obs_core_video_mix *video)
 	else
 		obs_view_render(video->view);
 
+rendered:
 	video->texture_rendered = true;
 
 	pthread_mutex_lock(&obs->data.draw_callbacks_mutex);
@@ -276,6 +308,8 @@ static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix
 	const uint32_t height = gs_texture_get_height(target);
 	if ((width == ovi->base_width) && (height == ovi->base_height))
 		return texture;
+	if (mix->output_valid)
+		return target;
 
 	profile_start(render_output_texture_name);
 
@@ -316,6 +350,8 @@ static inline gs_texture_t *render_output_texture(struct obs_core_video_mix *mix
 	gs_enable_blending(true);
 	gs_enable_framebuffer_srgb(false);
 
+	mix->output_valid = true;
+
 	profile_end(render_output_texture_name);
 
 	return target;
@@ -344,6 +380,14 @@ static const char *render_convert_texture_name = "render_convert_texture";
 static void render_convert_texture(struct obs_core_video_mix *video, gs_texture_t *const *const convert_textures,
 				   gs_texture_t *texture)
 {
+	/* unlike the encoder textures, which are swapped out whenever a frame
+	 * is queued, the raw conversion textures persist between frames */
+	const bool persistent = convert_textures == video->convert_textures;
+	if (persistent && video->convert_valid) {
+		video->texture_converted = true;
+		return;
+	}
+
 	profile_start(render_convert_texture_name);
 
 	gs_effect_t *effect = obs->video.conversion_effect;
@@ -399,6 +443,7 @@ static void render_convert_texture(struct obs_core_video_mix *video, gs_texture_
 	gs_enable_blending(true);
 
 	video->texture_converted = true;
+	video->convert_valid = persistent;
 
 	profile_end(render_convert_texture_name);
 }
@@ -802,6 +847,29 @@ void add_ready_encoder_group(obs_encoder_t *encoder)
 	pthread_mutex_unlock(&obs->video.encoder_group_mutex);
 }
 
+/* decides whether a mix renders on the next graphics frame, and how many of
+ * its own frames that frame stands for */
+static inline int mix_frame_count(struct obs_core_video_mix *mix, uint64_t time, int count)
+{
+	if (!mix->frame_interval_ns)
+		return count;
+
+	/* the main interval may not divide the mix interval evenly, so render
+	 * on whichever frame lands closest to the mix's next frame time */
+	if (time + obs->video.video_half_frame_interval_ns < mix->next_frame_ns)
+		return 0;
+
+	if (!mix->next_frame_ns)
+		mix->next_frame_ns = time;
+
+	int mix_count = 1;
+	if (time > mix->next_frame_ns)
+		mix_count += (int)((time - mix->next_frame_ns) / mix->frame_interval_ns);
+
+	mix->next_frame_ns += mix->frame_interval_ns * mix_count;
+	return mix_count;
+}
+
 static inline void video_sleep(struct obs_core_video *video, uint64_t *p_time, uint64_t interval_ns)
 {
 	struct obs_vframe_info vframe_info;
@@ -849,13 +917,19 @@ static inline void video_sleep(struct obs_core_video *video, uint64_t *p_time, u
 	pthread_mutex_lock(&obs->video.mixes_mutex);
 	for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
 		struct obs_core_video_mix *video = obs->video.mixes.array[i];
+		struct obs_vframe_info mix_info = vframe_info;
 		bool raw_active = video->raw_was_active;
 		bool gpu_active = video->gpu_was_active;
 
+		mix_info.count = mix_frame_count(video, *p_time, count);
+		video->frame_due = mix_info.count > 0;
+		if (!video->frame_due)
+			continue;
+
 		if (raw_active)
-			deque_push_back(&video->vframe_info_buffer, &vframe_info, sizeof(vframe_info));
+			deque_push_back(&video->vframe_info_buffer, &mix_info, sizeof(mix_info));
 		if (gpu_active)
-			deque_push_back(&video->vframe_info_buffer_gpu, &vframe_info, sizeof(vframe_info));
+			deque_push_back(&video->vframe_info_buffer_gpu, &mix_info, sizeof(mix_info));
 	}
 	pthread_mutex_unlock(&obs->video.mixes_mutex);
 }
@@ -919,7 +993,12 @@ static inline void output_frames(void)
 	for (size_t i = 0, num = obs->video.mixes.num; i < num; i++) {
 		struct obs_core_video_mix *mix = obs->video.mixes.array[i];
 		if (mix->view) {
-			output_frame(mix);
+			if (!mix->frame_interval_ns || mix->frame_due) {
+				output_frame(mix);
+				mix->rendered_frames++;
+			} else {
+				mix->skipped_frames++;
+			}
 		} else {
 			obs->video.mixes.array[i] = NULL;
 			obs_free_video_mix(mix);
@@ -1101,6 +1180,8 @@ bool obs_graphics_thread_loop(struct obs_graphics_context *context)
 
 	update_active_states();
 
+	obs->video.content_frame++;
+
 	profile_start(context->video_thread_name);
 	source_profiler_frame_begin();
 
@@ -140,6 +140,37 @@ void obs_view_render(obs_view_t *view)
 	pthread_mutex_unlock(&view->channels_mutex);
 }
 
+bool obs_view_get_content_hash(obs_view_t *view, uint64_t *hash)
+{
+	bool is_static = true;
+	uint64_t val = 0;
+
+	pthread_mutex_lock(&view->channels_mutex);
+
+	for (size_t i = 0; i < MAX_CHANNELS; i++) {
+		struct obs_source *source = view->channels[i];
+		uint64_t child;
+
+		if (!source)
+			continue;
+		if (source->removed) {
+			is_static = false;
+			continue;
+		}
+
+		if (!obs_source_get_content_hash(source, &child))
+			is_static = false;
+
+		val = content_hash_combine(val, (uint64_t)(uintptr_t)source);
+		val = content_hash_combine(val, child);
+	}
+
+	pthread_mutex_unlock(&view->channels_mutex);
+
+	*hash = val;
+	return is_static;
+}
+
 video_t *obs_view_add(obs_view_t *view)
 {
 	if (!obs->data.main_canvas->mix)
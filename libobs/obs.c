@@ -608,20 +608,28 @@ static int obs_init_video_mix(struct obs_video_info *ovi, struct obs_core_video_
 
 	pthread_mutex_init_value(&video->gpu_encoder_mutex);
 
-	make_video_info(&vi, ovi);
 	video->ovi = *ovi;
 
-	/* main view graphics thread drives all frame output,
-	 * so share FPS settings for aux views */
+	/* main view graphics thread drives all frame output, so aux views
+	 * can run at its frame rate or any lower one, but never faster */
 	pthread_mutex_lock(&obs->video.mixes_mutex);
 	size_t num = obs->video.mixes.num;
 	if (num && obs->data.main_canvas->mix) {
 		struct obs_video_info main_ovi = obs->data.main_canvas->mix->ovi;
-		video->ovi.fps_num = main_ovi.fps_num;
-		video->ovi.fps_den = main_ovi.fps_den;
+		uint64_t rate = (uint64_t)ovi->fps_num * main_ovi.fps_den;
+		uint64_t main_rate = (uint64_t)main_ovi.fps_num * ovi->fps_den;
+
+		if (!ovi->fps_num || !ovi->fps_den || rate >= main_rate) {
+			video->ovi.fps_num = main_ovi.fps_num;
+			video->ovi.fps_den = main_ovi.fps_den;
+		} else {
+			video->frame_interval_ns = util_mul_div64(1000000000ULL, ovi->fps_den, ovi->fps_num);
+		}
 	}
 	pthread_mutex_unlock(&obs->video.mixes_mutex);
 
+	make_video_info(&vi, &video->ovi);
+
 	video->gpu_conversion = ovi->gpu_conversion;
 	video->gpu_was_active = false;
 	video->raw_was_active = false;
@@ -861,6 +869,9 @@ static void obs_free_graphics(void)
 
 		gs_texture_destroy(video->transparent_texture);
 
+		for (size_t i = 0; i < 2; i++)
+			gs_vertexbuffer_destroy(video->sprite_batch_vb[i]);
+
 		gs_samplerstate_destroy(video->point_sampler);
 
 		gs_effect_destroy(video->default_effect);
@@ -1150,10 +1161,11 @@ static inline bool obs_init_hotkeys(void)
 	hotkeys->sceneitem_show = bstrdup("Show '%1'");
 	hotkeys->sceneitem_hide = bstrdup("Hide '%1'");
 
-	if (!obs_hotkeys_platform_init(hotkeys))
+	/* platform key event sources may deliver events right away */
+	if (pthread_mutex_init_recursive(&hotkeys->mutex) != 0)
 		return false;
 
-	if (pthread_mutex_init_recursive(&hotkeys->mutex) != 0)
+	if (!obs_hotkeys_platform_init(hotkeys))
 		goto fail;
 
 	if (os_event_init(&hotkeys->stop_event, OS_EVENT_TYPE_MANUAL) != 0)
@@ -1182,7 +1194,11 @@ static inline void stop_hotkeys(void)
 	}
 
 	os_event_destroy(hotkeys->stop_event);
+
+	/* key events can still arrive until the platform is freed */
+	pthread_mutex_lock(&hotkeys->mutex);
 	obs_hotkeys_free();
+	pthread_mutex_unlock(&hotkeys->mutex);
 }
 
 static inline void obs_free_hotkeys(void)
@@ -1229,6 +1245,12 @@ static bool obs_init(const char *locale, const char *module_config_path, profile
 	pthread_mutex_init_value(&obs->video.task_mutex);
 	pthread_mutex_init_value(&obs->video.encoder_group_mutex);
 	pthread_mutex_init_value(&obs->video.mixes_mutex);
+	pthread_mutex_init_value(&obs->deferred_modules_mutex);
+
+	if (pthread_mutex_init_recursive(&obs->deferred_modules_mutex) != 0)
+		return false;
+	if (os_event_init(&obs->deferred_loaded, OS_EVENT_TYPE_MANUAL) != 0)
+		return false;
 
 	obs->name_store_owned = !store;
 	obs->name_store = store ? store : profiler_name_store_create();
@@ -1462,6 +1484,10 @@ void obs_shutdown(void)
 	}
 	da_free(obs->core_modules);
 
+	obs_module_free_cache();
+	pthread_mutex_destroy(&obs->deferred_modules_mutex);
+	os_event_destroy(obs->deferred_loaded);
+
 	if (obs->name_store_owned)
 		profiler_name_store_free(obs->name_store);
 
@@ -1716,6 +1742,9 @@ bool obs_get_audio_info2(struct obs_audio_info2 *oai2)
 
 bool obs_enum_source_types(size_t idx, const char **id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_SOURCE, UINT32_MAX);
+
 	if (idx >= obs->source_types.num)
 		return false;
 	*id = obs->source_types.array[idx].id;
@@ -1724,6 +1753,9 @@ bool obs_enum_source_types(size_t idx, const char **id)
 
 bool obs_enum_input_types(size_t idx, const char **id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_SOURCE, 1 << OBS_SOURCE_TYPE_INPUT);
+
 	if (idx >= obs->input_types.num)
 		return false;
 	*id = obs->input_types.array[idx].id;
@@ -1732,6 +1764,9 @@ bool obs_enum_input_types(size_t idx, const char **id)
 
 bool obs_enum_input_types2(size_t idx, const char **id, const char **unversioned_id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_SOURCE, 1 << OBS_SOURCE_TYPE_INPUT);
+
 	if (idx >= obs->input_types.num)
 		return false;
 	if (id)
@@ -1749,6 +1784,8 @@ const char *obs_get_latest_input_type_id(const char *unversioned_id)
 	if (!unversioned_id)
 		return NULL;
 
+	obs_module_load_deferred_type(DEFERRED_SOURCE, unversioned_id);
+
 	for (size_t i = 0; i < obs->source_types.num; i++) {
 		struct obs_source_info *info = &obs->source_types.array[i];
 		if (strcmp(info->unversioned_id, unversioned_id) == 0 && (int)info->version > version) {
@@ -1766,6 +1803,9 @@ const char *obs_get_latest_input_type_id(const char *unversioned_id)
 
 bool obs_enum_filter_types(size_t idx, const char **id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_SOURCE, 1 << OBS_SOURCE_TYPE_FILTER);
+
 	if (idx >= obs->filter_types.num)
 		return false;
 	*id = obs->filter_types.array[idx].id;
@@ -1774,6 +1814,9 @@ bool obs_enum_filter_types(size_t idx, const char **id)
 
 bool obs_enum_transition_types(size_t idx, const char **id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_SOURCE, 1 << OBS_SOURCE_TYPE_TRANSITION);
+
 	if (idx >= obs->transition_types.num)
 		return false;
 	*id = obs->transition_types.array[idx].id;
@@ -1782,6 +1825,9 @@ bool obs_enum_transition_types(size_t idx, const char **id)
 
 bool obs_enum_output_types(size_t idx, const char **id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_OUTPUT, 0);
+
 	if (idx >= obs->output_types.num)
 		return false;
 	*id = obs->output_types.array[idx].id;
@@ -1790,6 +1836,9 @@ bool obs_enum_output_types(size_t idx, const char **id)
 
 bool obs_enum_encoder_types(size_t idx, const char **id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_ENCODER, 0);
+
 	if (idx >= obs->encoder_types.num)
 		return false;
 	*id = obs->encoder_types.array[idx].id;
@@ -1798,6 +1847,9 @@ bool obs_enum_encoder_types(size_t idx, const char **id)
 
 bool obs_enum_service_types(size_t idx, const char **id)
 {
+	if (idx == 0)
+		obs_module_load_deferred_kind(DEFERRED_SERVICE, 0);
+
 	if (idx >= obs->service_types.num)
 		return false;
 	*id = obs->service_types.array[idx].id;
@@ -2253,9 +2305,10 @@ gs_texture_t *obs_get_main_texture(void)
 	return video->render_texture;
 }
 
-static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_private)
+static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_private);
+
+static obs_source_t *load_source_begin(obs_data_t *source_data, bool is_private, obs_canvas_t **p_canvas)
 {
-	obs_data_array_t *filters = obs_data_get_array(source_data, "filters");
 	obs_source_t *source;
 	const char *name = obs_data_get_string(source_data, "name");
 	const char *uuid = obs_data_get_string(source_data, "uuid");
@@ -2264,16 +2317,7 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_priva
 	obs_data_t *settings = obs_data_get_obj(source_data, "settings");
 	obs_data_t *hotkeys = obs_data_get_obj(source_data, "hotkeys");
 	obs_canvas_t *canvas = NULL;
-	double volume;
-	double balance;
-	int64_t sync;
 	uint32_t prev_ver;
-	uint32_t caps;
-	uint32_t flags;
-	uint32_t mixers;
-	int di_order;
-	int di_mode;
-	int monitoring_type;
 
 	prev_ver = (uint32_t)obs_data_get_int(source_data, "prev_ver");
 
@@ -2289,16 +2333,43 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_priva
 		}
 	}
 
-	source = obs_source_create_set_last_ver(canvas, v_id, name, uuid, settings, hotkeys, prev_ver, is_private);
+	source = obs_source_create_begin(v_id, name, uuid, settings, hotkeys, is_private, prev_ver);
 
-	if (source->owns_info_id) {
+	if (source && source->owns_info_id) {
 		bfree((void *)source->info.unversioned_id);
 		source->info.unversioned_id = bstrdup(id);
 	}
 
-	obs_canvas_release(canvas);
+	if (!source) {
+		obs_canvas_release(canvas);
+		canvas = NULL;
+	}
+
 	obs_data_release(hotkeys);
+	obs_data_release(settings);
 
+	*p_canvas = canvas;
+	return source;
+}
+
+static void load_source_finish(obs_source_t *source, obs_data_t *source_data, obs_canvas_t *canvas)
+{
+	obs_data_array_t *filters = obs_data_get_array(source_data, "filters");
+	double volume;
+	double balance;
+	int64_t sync;
+	uint32_t prev_ver;
+	uint32_t caps;
+	uint32_t flags;
+	uint32_t mixers;
+	int di_order;
+	int di_mode;
+	int monitoring_type;
+
+	obs_source_create_finish(source, canvas);
+	obs_canvas_release(canvas);
+
+	prev_ver = (uint32_t)obs_data_get_int(source_data, "prev_ver");
 	caps = obs_source_get_output_flags(source);
 
 	obs_data_set_default_double(source_data, "volume", 1.0);
@@ -2378,9 +2449,17 @@ static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_priva
 
 		obs_data_array_release(filters);
 	}
+}
 
-	obs_data_release(settings);
+static obs_source_t *obs_load_source_type(obs_data_t *source_data, bool is_private)
+{
+	obs_canvas_t *canvas;
+	obs_source_t *source = load_source_begin(source_data, is_private, &canvas);
+	if (!source)
+		return NULL;
 
+	obs_source_create_data(source);
+	load_source_finish(source, source_data, canvas);
 	return source;
 }
 
@@ -2434,6 +2513,214 @@ void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb, void *priv
 	da_free(sources);
 }
 
+/* ------------------------------------------------------------------------- */
+/* parallel source loading */
+
+#define MAX_LOAD_THREADS 16
+
+struct load_item {
+	obs_source_t *source;
+	obs_canvas_t *canvas;
+	obs_data_t *source_data;
+	uint64_t create_ns;
+	uint64_t load_ns;
+};
+
+struct load_type_stats {
+	const char *id;
+	size_t count;
+	size_t parallel;
+	uint64_t create_ns;
+	uint64_t max_create_ns;
+	uint64_t load_ns;
+};
+
+struct parallel_load {
+	struct load_item *items;
+	DARRAY(size_t) queue;
+	volatile long next;
+};
+
+static void load_item_create(struct load_item *item)
+{
+	uint64_t start = os_gettime_ns();
+	obs_source_create_data(item->source);
+	item->create_ns = os_gettime_ns() - start;
+}
+
+static void create_queued_sources(struct parallel_load *load)
+{
+	for (;;) {
+		size_t idx = (size_t)os_atomic_inc_long(&load->next) - 1;
+		if (idx >= load->queue.num)
+			break;
+
+		load_item_create(&load->items[load->queue.array[idx]]);
+	}
+}
+
+static void *parallel_load_thread(void *param)
+{
+	os_set_thread_name("libobs: source loader");
+	create_queued_sources(param);
+	return NULL;
+}
+
+static inline bool can_create_in_parallel(obs_source_t *source)
+{
+	return !source->owns_info_id && (source->info.output_flags & OBS_SOURCE_PARALLEL_CREATE) != 0;
+}
+
+static int cmp_type_stats(const void *a, const void *b)
+{
+	const struct load_type_stats *sa = a;
+	const struct load_type_stats *sb = b;
+	uint64_t ta = sa->create_ns + sa->load_ns;
+	uint64_t tb = sb->create_ns + sb->load_ns;
+
+	return ta < tb ? 1 : (ta > tb ? -1 : 0);
+}
+
+static void log_load_breakdown(struct load_item *items, size_t count, size_t parallel, size_t threads,
+			       uint64_t total_ns)
+{
+	DARRAY(struct load_type_stats) stats;
+	da_init(stats);
+
+	for (size_t i = 0; i < count; i++) {
+		struct load_item *item = &items[i];
+		struct load_type_stats *entry;
+
+		if (!item->source)
+			continue;
+
+		entry = NULL;
+		for (size_t j = 0; j < stats.num; j++) {
+			if (strcmp(stats.array[j].id, item->source->info.id) == 0) {
+				entry = &stats.array[j];
+				break;
+			}
+		}
+		if (!entry) {
+			entry = da_push_back_new(stats);
+			entry->id = item->source->info.id;
+		}
+
+		entry->count++;
+		entry->create_ns += item->create_ns;
+		entry->load_ns += item->load_ns;
+		if (item->create_ns > entry->max_create_ns)
+			entry->max_create_ns = item->create_ns;
+		if (can_create_in_parallel(item->source))
+			entry->parallel++;
+	}
+
+	qsort(stats.array, stats.num, sizeof(*stats.array), cmp_type_stats);
+
+	blog(LOG_INFO, "Loaded %zu sources in %.2f ms (%zu created on %zu threads)", count, (double)total_ns / 1e6,
+	     parallel, threads);
+
+	for (size_t i = 0; i < stats.num; i++) {
+		struct load_type_stats *entry = &stats.array[i];
+		blog(LOG_INFO, "    %s: %zu sources (%zu parallel), create %.2f ms (max %.2f ms), load %.2f ms",
+		     entry->id, entry->count, entry->parallel, (double)entry->create_ns / 1e6,
+		     (double)entry->max_create_ns / 1e6, (double)entry->load_ns / 1e6);
+	}
+
+	da_free(stats);
+}
+
+void obs_load_sources_parallel(obs_data_array_t *array, obs_load_source_cb cb, void *private_data)
+{
+	struct parallel_load load = {0};
+	pthread_t threads[MAX_LOAD_THREADS];
+	size_t num_threads = 0;
+	uint64_t start = os_gettime_ns();
+	size_t count;
+
+	count = obs_data_array_count(array);
+	if (!count)
+		return;
+
+	load.items = bzalloc(sizeof(struct load_item) * count);
+
+	/* set up every source on this thread so that ids, hotkeys and
+	 * contexts are created in the same order as a serial load */
+	for (size_t i = 0; i < count; i++) {
+		struct load_item *item = &load.items[i];
+
+		item->source_data = obs_data_array_item(array, i);
+		item->source = load_source_begin(item->source_data, false, &item->canvas);
+
+		if (item->source && can_create_in_parallel(item->source))
+			da_push_back(load.queue, &i);
+	}
+
+	if (load.queue.num > 1) {
+		int cores = os_get_logical_cores();
+		size_t max_threads = cores > 1 ? (size_t)cores : 1;
+
+		if (max_threads > MAX_LOAD_THREADS)
+			max_threads = MAX_LOAD_THREADS;
+		if (max_threads > load.queue.num)
+			max_threads = load.queue.num;
+
+		for (size_t i = 0; i < max_threads; i++) {
+			if (pthread_create(&threads[num_threads], NULL, parallel_load_thread, &load) != 0)
+				break;
+			num_threads++;
+		}
+	}
+
+	/* types that did not opt in are created here while the workers run */
+	for (size_t i = 0; i < count; i++) {
+		struct load_item *item = &load.items[i];
+		if (item->source && !can_create_in_parallel(item->source))
+			load_item_create(item);
+	}
+
+	/* help out, or create everything if no thread could be started */
+	create_queued_sources(&load);
+
+	for (size_t i = 0; i < num_threads; i++)
+		pthread_join(threads[i], NULL);
+
+	/* sources only become visible once all of them exist, in array
+	 * order, so that scenes can resolve their items when loaded */
+	for (size_t i = 0; i < count; i++) {
+		struct load_item *item = &load.items[i];
+		if (item->source)
+			load_source_finish(item->source, item->source_data, item->canvas);
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		struct load_item *item = &load.items[i];
+		obs_source_t *source = item->source;
+		uint64_t load_start;
+
+		if (!source)
+			continue;
+
+		load_start = os_gettime_ns();
+		if (source->info.type == OBS_SOURCE_TYPE_TRANSITION)
+			obs_transition_load(source, item->source_data);
+		obs_source_load2(source);
+		if (cb)
+			cb(private_data, source);
+		item->load_ns = os_gettime_ns() - load_start;
+	}
+
+	log_load_breakdown(load.items, count, load.queue.num, num_threads, os_gettime_ns() - start);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_source_release(load.items[i].source);
+		obs_data_release(load.items[i].source_data);
+	}
+
+	da_free(load.queue);
+	bfree(load.items);
+}
+
 obs_data_t *obs_save_source(obs_source_t *source)
 {
 	obs_data_array_t *filters = obs_data_array_create();
@@ -3010,6 +3297,26 @@ bool obs_set_audio_monitoring_device(const char *name, const char *id)
 	return true;
 }
 
+void obs_set_audio_monitoring_bus(bool enable)
+{
+	pthread_mutex_lock(&obs->audio.monitoring_mutex);
+
+	if (obs->audio.monitoring_bus == enable) {
+		pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+		return;
+	}
+
+	obs->audio.monitoring_bus = enable;
+	pthread_mutex_unlock(&obs->audio.monitoring_mutex);
+
+	obs_reset_audio_monitoring();
+}
+
+bool obs_audio_monitoring_bus_enabled(void)
+{
+	return obs->audio.monitoring_bus;
+}
+
 void obs_get_audio_monitoring_device(const char **name, const char **id)
 {
 	if (name)
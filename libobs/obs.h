@@ -24,6 +24,7 @@
 #include "graphics/graphics.h"
 #include "graphics/vec2.h"
 #include "graphics/vec3.h"
+#include "graphics/vec4.h"
 #include "media-io/audio-io.h"
 #include "media-io/video-io.h"
 #include "callback/signal.h"
@@ -191,7 +192,8 @@ struct obs_transform_info {
 struct obs_video_info {
 #ifndef SWIG
 	/**
-	 * Graphics module to use (usually "libobs-opengl" or "libobs-d3d11")
+	 * Graphics module to use (usually "libobs-opengl" or "libobs-d3d11",
+	 * or "libobs-software" to render on the CPU without a GPU)
 	 */
 	const char *graphics_module;
 #endif
@@ -574,6 +576,31 @@ EXPORT void obs_add_safe_module(const char *name);
  */
 EXPORT void obs_add_core_module(const char *name);
 
+/**
+ * Sets the file used to cache the types each module registers.  Modules
+ * added with obs_add_lazy_module that are in the cache and have not changed
+ * since are not loaded by obs_load_all_modules; they are loaded the first
+ * time one of their types is used or enumerated.
+ *
+ * @param  path  Path of the cache file, or NULL to disable the cache.
+ */
+EXPORT void obs_set_module_cache_path(const char *path);
+
+/**
+ * Adds a module to the list of modules that may be loaded on demand.  Only
+ * add modules that do nothing but register types when they are loaded, and
+ * whose registrations do not depend on the system they run on.
+ *
+ * @param  name  Specifies the module's name (filename sans extension).
+ */
+EXPORT void obs_add_lazy_module(const char *name);
+
+/** Loads all modules that are still waiting to be loaded on demand */
+EXPORT void obs_load_deferred_modules(void);
+
+/** Returns true if the module has not been loaded yet */
+EXPORT bool obs_module_is_deferred(obs_module_t *module);
+
 /** Automatically loads all modules from module paths (convenience function) */
 EXPORT void obs_load_all_modules(void);
 
@@ -849,6 +876,14 @@ typedef void (*obs_load_source_cb)(void *private_data, obs_source_t *source);
 /** Loads sources from a data array */
 EXPORT void obs_load_sources(obs_data_array_t *array, obs_load_source_cb cb, void *private_data);
 
+/**
+ * Loads sources from a data array, creating sources whose type sets
+ * OBS_SOURCE_PARALLEL_CREATE on a pool of worker threads.  Sources are
+ * still added, signalled and loaded in array order, and a per-type breakdown
+ * of the load time is logged.
+ */
+EXPORT void obs_load_sources_parallel(obs_data_array_t *array, obs_load_source_cb cb, void *private_data);
+
 /** Saves sources to a data array */
 EXPORT obs_data_array_t *obs_save_sources(void);
 
@@ -885,6 +920,14 @@ EXPORT void obs_enum_audio_monitoring_devices(obs_enum_audio_device_cb cb, void
 EXPORT bool obs_set_audio_monitoring_device(const char *name, const char *id);
 EXPORT void obs_get_audio_monitoring_device(const char **name, const char **id);
 
+/**
+ * Mixes all monitored sources into a single output stream instead of opening
+ * one stream per source, where the platform supports it.  Resets monitoring
+ * when changed.
+ */
+EXPORT void obs_set_audio_monitoring_bus(bool enable);
+EXPORT bool obs_audio_monitoring_bus_enabled(void);
+
 EXPORT void obs_add_tick_callback(void (*tick)(void *param, float seconds), void *param);
 EXPORT void obs_remove_tick_callback(void (*tick)(void *param, float seconds), void *param);
 
@@ -1112,6 +1155,9 @@ EXPORT obs_properties_t *obs_source_properties(const obs_source_t *source);
 EXPORT void obs_source_update(obs_source_t *source, obs_data_t *settings);
 EXPORT void obs_source_reset_settings(obs_source_t *source, obs_data_t *settings);
 
+/** Signals that the video output of a content tracked source has changed */
+EXPORT void obs_source_content_changed(obs_source_t *source);
+
 /** Renders a video source. */
 EXPORT void obs_source_video_render(obs_source_t *source);
 
@@ -1416,6 +1462,17 @@ EXPORT void obs_source_draw(gs_texture_t *image, int x, int y, uint32_t cx, uint
 EXPORT void obs_source_output_video(obs_source_t *source, const struct obs_source_frame *frame);
 EXPORT void obs_source_output_video2(obs_source_t *source, const struct obs_source_frame2 *frame);
 
+typedef void (*obs_source_frame_release_t)(void *param);
+
+/**
+ * Outputs asynchronous video data without copying it.  libobs references the
+ * planes in frame->data directly until it is done with the frame, and then
+ * calls release(param).  The data must not be modified until then.  release
+ * may be called from any thread, including before this function returns.
+ */
+EXPORT void obs_source_output_video_ref(obs_source_t *source, const struct obs_source_frame *frame,
+					obs_source_frame_release_t release, void *param);
+
 EXPORT void obs_source_set_async_rotation(obs_source_t *source, long rotation);
 
 EXPORT void obs_source_output_cea708(obs_source_t *source, const struct obs_source_cea_708 *captions);
@@ -1691,6 +1748,11 @@ EXPORT obs_sceneitem_t *obs_scene_find_source(obs_scene_t *scene, const char *na
 
 EXPORT obs_sceneitem_t *obs_scene_find_source_recursive(obs_scene_t *scene, const char *name);
 
+/** Finds the scene item of a source by the source's UUID */
+EXPORT obs_sceneitem_t *obs_scene_find_source_by_uuid(obs_scene_t *scene, const char *uuid);
+
+EXPORT obs_sceneitem_t *obs_scene_find_source_by_uuid_recursive(obs_scene_t *scene, const char *uuid);
+
 EXPORT obs_sceneitem_t *obs_scene_find_sceneitem_by_id(obs_scene_t *scene, int64_t id);
 
 /** Gets scene by name, increments the reference */
@@ -2690,6 +2752,10 @@ EXPORT bool obs_canvas_has_video(obs_canvas_t *canvas);
 EXPORT video_t *obs_canvas_get_video(const obs_canvas_t *canvas);
 /** Get canvas video info (if it exists) */
 EXPORT bool obs_canvas_get_video_info(const obs_canvas_t *canvas, struct obs_video_info *ovi);
+/** Get the number of frames the canvas has rendered */
+EXPORT uint32_t obs_canvas_get_rendered_frames(const obs_canvas_t *canvas);
+/** Get the number of main canvas frames skipped due to a lower canvas frame rate */
+EXPORT uint32_t obs_canvas_get_skipped_frames(const obs_canvas_t *canvas);
 /** Renders the sources of this canvas's view context */
 EXPORT void obs_canvas_render(obs_canvas_t *canvas);
 
@@ -96,6 +96,16 @@ static void color_source_render(void *data, gs_effect_t *effect)
 	gs_enable_framebuffer_srgb(previous);
 }
 
+static bool color_source_get_sprite(void *data, struct obs_source_sprite *sprite)
+{
+	struct color_source *context = data;
+
+	/* same choice as color_source_render */
+	sprite->linear_srgb = gs_get_linear_srgb() || (context->color.w < 1.0f);
+	sprite->color = sprite->linear_srgb ? context->color_srgb : context->color;
+	return true;
+}
+
 static uint32_t color_source_getwidth(void *data)
 {
 	struct color_source *context = data;
@@ -166,7 +176,7 @@ struct obs_source_info color_source_info_v3 = {
 	.id = "color_source",
 	.version = 3,
 	.type = OBS_SOURCE_TYPE_INPUT,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_CUSTOM_DRAW | OBS_SOURCE_SRGB | OBS_SOURCE_CONTENT_TRACKED,
 	.create = color_source_create,
 	.destroy = color_source_destroy,
 	.update = color_source_update,
@@ -177,4 +187,5 @@ struct obs_source_info color_source_info_v3 = {
 	.video_render = color_source_render,
 	.get_properties = color_source_properties,
 	.icon_type = OBS_ICON_TYPE_COLOR,
+	.get_sprite = color_source_get_sprite,
 };
@@ -1,5 +1,6 @@
 #include <obs-module.h>
 #include <graphics/image-file.h>
+#include <graphics/image-cache.h>
 #include <util/threading.h>
 #include <util/platform.h>
 #include <util/dstr.h>
@@ -19,6 +20,8 @@ struct image_source {
 	bool persistent;
 	bool is_slide;
 	bool linear_alpha;
+	uint32_t max_cx;
+	uint32_t max_cy;
 	time_t file_timestamp;
 	float update_time_elapsed;
 	uint64_t last_time;
@@ -28,6 +31,7 @@ struct image_source {
 	volatile bool texture_loaded;
 
 	gs_image_file4_t if4;
+	gs_cached_image_t *cached;
 };
 
 static time_t get_modified_timestamp(const char *filename)
@@ -44,6 +48,11 @@ static const char *image_source_get_name(void *unused)
 	return obs_module_text("ImageInput");
 }
 
+static inline enum gs_image_alpha_mode get_alpha_mode(struct image_source *context)
+{
+	return context->linear_alpha ? GS_IMAGE_ALPHA_PREMULTIPLY_SRGB : GS_IMAGE_ALPHA_PREMULTIPLY;
+}
+
 void image_source_preload_image(void *data)
 {
 	struct image_source *context = data;
@@ -51,11 +60,25 @@ void image_source_preload_image(void *data)
 		return;
 
 	context->file_timestamp = get_modified_timestamp(context->file);
-	gs_image_file4_init(&context->if4, context->file,
-			    context->linear_alpha ? GS_IMAGE_ALPHA_PREMULTIPLY_SRGB : GS_IMAGE_ALPHA_PREMULTIPLY);
+	if (gs_image_cache_supported(context->file))
+		context->cached = gs_image_cache_acquire_scaled(context->file, get_alpha_mode(context), context->max_cx,
+								context->max_cy, false);
+	else
+		gs_image_file4_init(&context->if4, context->file, get_alpha_mode(context));
 	os_atomic_set_bool(&context->file_decoded, true);
 }
 
+bool image_source_is_decoded(void *data)
+{
+	struct image_source *context = data;
+	return os_atomic_load_bool(&context->file_decoded);
+}
+
+static inline bool image_source_loaded(struct image_source *context)
+{
+	return context->cached ? gs_cached_image_loaded(context->cached) : context->if4.image3.image2.image.loaded;
+}
+
 static void image_source_load_texture(void *data)
 {
 	struct image_source *context = data;
@@ -65,13 +88,17 @@ static void image_source_load_texture(void *data)
 	debug("loading texture '%s'", context->file);
 
 	obs_enter_graphics();
-	gs_image_file4_init_texture(&context->if4);
+	if (context->cached)
+		gs_cached_image_get_texture(context->cached);
+	else
+		gs_image_file4_init_texture(&context->if4);
 	obs_leave_graphics();
 
-	if (!context->if4.image3.image2.image.loaded)
+	if (!image_source_loaded(context))
 		warn("failed to load texture '%s'", context->file);
 	context->update_time_elapsed = 0;
 	os_atomic_set_bool(&context->texture_loaded, true);
+	obs_source_content_changed(context->source);
 }
 
 static void image_source_unload(void *data)
@@ -81,15 +108,29 @@ static void image_source_unload(void *data)
 	os_atomic_set_bool(&context->texture_loaded, false);
 
 	obs_enter_graphics();
+	gs_cached_image_release(context->cached);
+	context->cached = NULL;
 	gs_image_file4_free(&context->if4);
 	obs_leave_graphics();
+
+	obs_source_content_changed(context->source);
 }
 
 static void image_source_load(struct image_source *context)
 {
 	image_source_unload(context);
 
-	if (context->file && *context->file) {
+	if (!context->file || !*context->file)
+		return;
+
+	if (gs_image_cache_supported(context->file)) {
+		/* decoded in the background, the texture is created in tick */
+		context->file_timestamp = get_modified_timestamp(context->file);
+		context->cached = gs_image_cache_acquire_scaled(context->file, get_alpha_mode(context), context->max_cx,
+								context->max_cy, true);
+		if (!context->cached)
+			os_atomic_set_bool(&context->file_decoded, true);
+	} else {
 		image_source_preload_image(context);
 		image_source_load_texture(context);
 	}
@@ -103,6 +144,10 @@ static void image_source_update(void *data, obs_data_t *settings)
 	const bool linear_alpha = obs_data_get_bool(settings, "linear_alpha");
 	const bool is_slide = obs_data_get_bool(settings, "is_slide");
 
+	/* set by the slideshow to downscale slides to the display size */
+	context->max_cx = (uint32_t)obs_data_get_int(settings, "max_width");
+	context->max_cy = (uint32_t)obs_data_get_int(settings, "max_height");
+
 	if (context->file)
 		bfree(context->file);
 	context->file = bstrdup(file);
@@ -155,6 +200,7 @@ static void restart_gif(void *data)
 		gs_image_file4_update_texture(&context->if4);
 		obs_leave_graphics();
 
+		obs_source_content_changed(context->source);
 		context->restart_gif = false;
 	}
 }
@@ -188,12 +234,16 @@ static void image_source_destroy(void *data)
 static uint32_t image_source_getwidth(void *data)
 {
 	struct image_source *context = data;
+	if (context->cached)
+		return gs_cached_image_get_width(context->cached);
 	return context->if4.image3.image2.image.cx;
 }
 
 static uint32_t image_source_getheight(void *data)
 {
 	struct image_source *context = data;
+	if (context->cached)
+		return gs_cached_image_get_height(context->cached);
 	return context->if4.image3.image2.image.cy;
 }
 
@@ -204,7 +254,7 @@ static void image_source_render(void *data, gs_effect_t *effect)
 		return;
 
 	struct gs_image_file *const image = &context->if4.image3.image2.image;
-	gs_texture_t *const texture = image->texture;
+	gs_texture_t *const texture = context->cached ? gs_cached_image_get_texture(context->cached) : image->texture;
 	if (!texture)
 		return;
 
@@ -217,17 +267,39 @@ static void image_source_render(void *data, gs_effect_t *effect)
 	gs_eparam_t *const param = gs_effect_get_param_by_name(effect, "image");
 	gs_effect_set_texture_srgb(param, texture);
 
-	gs_draw_sprite(texture, 0, image->cx, image->cy);
+	gs_draw_sprite(texture, 0, gs_texture_get_width(texture), gs_texture_get_height(texture));
 
 	gs_blend_state_pop();
 
 	gs_enable_framebuffer_srgb(previous);
 }
 
+static bool image_source_get_sprite(void *data, struct obs_source_sprite *sprite)
+{
+	struct image_source *context = data;
+	if (!os_atomic_load_bool(&context->texture_loaded))
+		return false;
+
+	struct gs_image_file *const image = &context->if4.image3.image2.image;
+	gs_texture_t *const texture = context->cached ? gs_cached_image_get_texture(context->cached) : image->texture;
+	if (!texture || gs_texture_get_width(texture) != image_source_getwidth(context) ||
+	    gs_texture_get_height(texture) != image_source_getheight(context))
+		return false;
+
+	/* same state as image_source_render */
+	sprite->texture = texture;
+	sprite->linear_srgb = true;
+	sprite->premultiplied = true;
+	return true;
+}
+
 static void image_source_tick(void *data, float seconds)
 {
 	struct image_source *context = data;
 	if (!os_atomic_load_bool(&context->texture_loaded)) {
+		if (gs_cached_image_decoded(context->cached))
+			os_atomic_set_bool(&context->file_decoded, true);
+
 		if (os_atomic_load_bool(&context->file_decoded))
 			image_source_load_texture(context);
 		else
@@ -276,6 +348,8 @@ static void image_source_tick(void *data, float seconds)
 			obs_enter_graphics();
 			gs_image_file4_update_texture(&context->if4);
 			obs_leave_graphics();
+
+			obs_source_content_changed(context->source);
 		}
 	}
 
@@ -316,6 +390,8 @@ static obs_properties_t *image_source_properties(void *data)
 uint64_t image_source_get_memory_usage(void *data)
 {
 	struct image_source *s = data;
+	if (s->cached)
+		return gs_cached_image_get_mem_usage(s->cached);
 	return s->if4.image3.image2.mem_usage;
 }
 
@@ -356,6 +432,9 @@ static enum gs_color_space image_source_get_color_space(void *data, size_t count
 	UNUSED_PARAMETER(preferred_spaces);
 
 	struct image_source *const s = data;
+	if (s->cached)
+		return gs_cached_image_get_space(s->cached);
+
 	gs_image_file4_t *const if4 = &s->if4;
 	return if4->image3.image2.image.texture ? if4->space : GS_CS_SRGB;
 }
@@ -363,7 +442,7 @@ static enum gs_color_space image_source_get_color_space(void *data, size_t count
 static struct obs_source_info image_source_info = {
 	.id = "image_source",
 	.type = OBS_SOURCE_TYPE_INPUT,
-	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB,
+	.output_flags = OBS_SOURCE_VIDEO | OBS_SOURCE_SRGB | OBS_SOURCE_CONTENT_TRACKED | OBS_SOURCE_PARALLEL_CREATE,
 	.get_name = image_source_get_name,
 	.create = image_source_create,
 	.destroy = image_source_destroy,
@@ -380,6 +459,7 @@ static struct obs_source_info image_source_info = {
 	.icon_type = OBS_ICON_TYPE_IMAGE,
 	.activate = image_source_activate,
 	.video_get_color_space = image_source_get_color_space,
+	.get_sprite = image_source_get_sprite,
 };
 
 OBS_DECLARE_MODULE()
@@ -34,6 +34,9 @@ static const char *S_PLAYBACK_MODE           = "playback_mode";
 static const char *S_PLAYBACK_ONCE           = "once";
 static const char *S_PLAYBACK_LOOP           = "loop";
 static const char *S_PLAYBACK_RANDOM         = "random";
+static const char *S_PRELOAD_COUNT           = "preload_count";
+static const char *S_PRELOAD_MEMORY          = "preload_memory_limit";
+static const char *S_DOWNSCALE               = "downscale_slides";
 
 static const char *TR_CUT                    = "cut";
 static const char *TR_FADE                   = "fade";
@@ -58,6 +61,9 @@ static const char *TR_SLIDE                  = "slide";
 #define T_PLAYBACK_ONCE                      T_("PlaybackMode.Once")
 #define T_PLAYBACK_LOOP                      T_("PlaybackMode.Loop")
 #define T_PLAYBACK_RANDOM                    T_("PlaybackMode.Random")
+#define T_PRELOAD_COUNT                      T_("PreloadCount")
+#define T_PRELOAD_MEMORY                     T_("PreloadMemoryLimit")
+#define T_DOWNSCALE                          T_("DownscaleSlides")
 
 #define T_TR_(text) obs_module_text("SlideShow.Transition." text)
 #define T_TR_CUT                             T_TR_("Cut")
@@ -68,6 +74,8 @@ static const char *TR_SLIDE                  = "slide";
 /* clang-format on */
 
 extern void image_source_preload_image(void *data);
+extern bool image_source_is_decoded(void *data);
+extern uint64_t image_source_get_memory_usage(void *data);
 
 /* ------------------------------------------------------------------------- */
 
@@ -89,7 +97,9 @@ enum behavior {
 	BEHAVIOR_ALWAYS_PLAY,
 };
 
-#define SLIDE_BUFFER_COUNT 5
+#define DEFAULT_PRELOAD_COUNT 5
+#define MAX_PRELOAD_COUNT 50
+#define DEFAULT_PRELOAD_MEMORY_MB 512
 
 struct active_slides {
 	struct deque prev;
@@ -117,6 +127,12 @@ struct slideshow_data {
 	float elapsed;
 	enum behavior behavior;
 
+	/* slides kept decoded on each side of the current one */
+	size_t buffer_count;
+	size_t preload_count;
+	uint64_t preload_memory;
+	bool downscale;
+
 	enum obs_media_state state;
 };
 
@@ -129,6 +145,15 @@ struct slideshow {
 	uint32_t cx;
 	uint32_t cy;
 
+	/* bounding size slides are downscaled to, the canvas size when the
+	 * slideshow sizes itself automatically */
+	uint32_t decode_cx;
+	uint32_t decode_cy;
+
+	/* whether a slide had finished decoding when it was shown */
+	uint64_t preload_hits;
+	uint64_t preload_misses;
+
 	obs_hotkey_id play_pause_hotkey;
 	obs_hotkey_id restart_hotkey;
 	obs_hotkey_id stop_hotkey;
@@ -264,6 +289,14 @@ static void do_transition(void *data, bool to_null)
 	}
 }
 
+static inline void update_preload_stats(struct slideshow *ss)
+{
+	if (image_source_is_decoded(obs_obj_get_data(ss->data.slides.cur.source)))
+		ss->preload_hits++;
+	else
+		ss->preload_misses++;
+}
+
 /* get a source via its slide idx in one of slideshow_data's deques. *
  * only used in get_new_source().                                        */
 static inline struct source_data *deque_get_source(struct deque *buf, size_t slide_idx)
@@ -302,6 +335,10 @@ static inline obs_source_t *create_source_from_file(struct slideshow *ss, const
 	obs_data_set_string(settings, "file", file);
 	obs_data_set_bool(settings, "unload", false);
 	obs_data_set_bool(settings, "is_slide", !now);
+	if (ss->data.downscale) {
+		obs_data_set_int(settings, "max_width", ss->decode_cx);
+		obs_data_set_int(settings, "max_height", ss->decode_cy);
+	}
 	source = obs_source_create_private("image_source", NULL, settings);
 
 	obs_data_release(settings);
@@ -369,15 +406,9 @@ static struct source_data get_new_source(struct slideshow *ss, struct active_sli
 	return sd;
 }
 
-static void restart_slides(struct slideshow *ss)
+static void restart_slides_at(struct slideshow *ss, size_t start_idx)
 {
 	struct slideshow_data *ssd = &ss->data;
-	size_t start_idx = 0;
-
-	if (ssd->randomize && ssd->files.num > 0) {
-		start_idx = (size_t)rand() % ssd->files.num;
-	}
-
 	struct active_slides new_slides = {0};
 
 	if (ssd->files.num) {
@@ -387,14 +418,14 @@ static void restart_slides(struct slideshow *ss)
 		new_slides.cur = get_new_source(ss, &new_slides, start_idx);
 
 		idx = start_idx;
-		for (size_t i = 0; i < SLIDE_BUFFER_COUNT; i++) {
+		for (size_t i = 0; i < ssd->buffer_count; i++) {
 			idx = get_new_file(ssd, idx, true);
 			sd = get_new_source(ss, &new_slides, idx);
 			deque_push_back(&new_slides.next, &sd, sizeof(sd));
 		}
 
 		idx = start_idx;
-		for (size_t i = 0; i < SLIDE_BUFFER_COUNT; i++) {
+		for (size_t i = 0; i < ssd->buffer_count; i++) {
 			idx = get_new_file(ssd, idx, false);
 			sd = get_new_source(ss, &new_slides, idx);
 			deque_push_front(&new_slides.prev, &sd, sizeof(sd));
@@ -405,6 +436,116 @@ static void restart_slides(struct slideshow *ss)
 	ssd->slides = new_slides;
 }
 
+static void restart_slides(struct slideshow *ss)
+{
+	struct slideshow_data *ssd = &ss->data;
+	size_t start_idx = 0;
+
+	if (ssd->randomize && ssd->files.num > 0) {
+		start_idx = (size_t)rand() % ssd->files.num;
+	}
+
+	restart_slides_at(ss, start_idx);
+}
+
+/* limits the decode-ahead window so that all buffered slides (both sides plus
+ * the current one) fit within the memory limit */
+static size_t get_buffer_count(uint64_t slide_size, size_t preload_count, uint64_t limit_mb)
+{
+	if (!slide_size)
+		return preload_count ? preload_count : 1;
+
+	const uint64_t max_slides = limit_mb * 1024 * 1024 / slide_size;
+	size_t count = max_slides > 1 ? (size_t)((max_slides - 1) / 2) : 0;
+
+	if (count > preload_count)
+		count = preload_count;
+	return count ? count : 1;
+}
+
+static void get_decode_size(struct slideshow *ss, uint32_t *cx, uint32_t *cy)
+{
+	struct obs_video_info ovi;
+
+	*cx = ss->cx;
+	*cy = ss->cy;
+
+	if ((!*cx || !*cy) && obs_get_video_info(&ovi)) {
+		*cx = ovi.base_width;
+		*cy = ovi.base_height;
+	}
+}
+
+static inline uint64_t get_slide_mem_usage(struct source_data *sd)
+{
+	void *data = sd->source ? obs_obj_get_data(sd->source) : NULL;
+
+	if (!data || !image_source_is_decoded(data))
+		return 0;
+	return image_source_get_memory_usage(data);
+}
+
+/* size of the largest buffered slide that finished decoding */
+static uint64_t get_max_slide_size(struct active_slides *slides)
+{
+	const size_t count_prev = slides->prev.size / sizeof(struct source_data);
+	const size_t count_next = slides->next.size / sizeof(struct source_data);
+	uint64_t max_size = get_slide_mem_usage(&slides->cur);
+
+	for (size_t i = 0; i < count_prev; i++) {
+		uint64_t size = get_slide_mem_usage(deque_data(&slides->prev, i * sizeof(struct source_data)));
+		if (size > max_size)
+			max_size = size;
+	}
+
+	for (size_t i = 0; i < count_next; i++) {
+		uint64_t size = get_slide_mem_usage(deque_data(&slides->next, i * sizeof(struct source_data)));
+		if (size > max_size)
+			max_size = size;
+	}
+
+	return max_size;
+}
+
+/* downscaled slides are at most the bounding size.  otherwise the size of
+ * the slides decoded so far is used, with the bounding size as an estimate
+ * until the first one is done. */
+static void update_buffer_count(struct slideshow *ss)
+{
+	struct slideshow_data *ssd = &ss->data;
+	uint64_t slide_size = (uint64_t)ss->decode_cx * ss->decode_cy * 4;
+
+	if (!ssd->downscale) {
+		uint64_t decoded_size = get_max_slide_size(&ssd->slides);
+		if (decoded_size)
+			slide_size = decoded_size;
+	}
+
+	ssd->buffer_count = get_buffer_count(slide_size, ssd->preload_count, ssd->preload_memory);
+}
+
+/* shrinks the buffered slides to the current window once the real slide
+ * sizes are known */
+static void trim_active_slides(struct slideshow *ss)
+{
+	struct active_slides *slides = &ss->data.slides;
+	struct source_data sd;
+
+	update_buffer_count(ss);
+
+	const size_t max_size = ss->data.buffer_count * sizeof(struct source_data);
+
+	while (slides->next.size > max_size) {
+		deque_pop_back(&slides->next, &sd, sizeof(sd));
+		free_source_data(&sd);
+	}
+
+	while (slides->prev.size > max_size) {
+		deque_pop_front(&slides->prev, &sd, sizeof(sd));
+		free_source_data(&sd);
+	}
+}
+
 static void ss_update(void *data, obs_data_t *settings)
 {
 	struct slideshow *ss = data;
@@ -462,6 +603,7 @@ static void ss_update(void *data, obs_data_t *settings)
 	new_data.loop = strcmp(playback_mode, S_PLAYBACK_LOOP) == 0;
 
 	new_data.hide = obs_data_get_bool(settings, S_HIDE);
+	new_data.downscale = obs_data_get_bool(settings, S_DOWNSCALE);
 
 	if (!old_data.tr_name || strcmp(tr_name, old_data.tr_name) != 0)
 		new_tr = obs_source_create_private(tr_name, NULL, NULL);
@@ -543,10 +685,20 @@ static void ss_update(void *data, obs_data_t *settings)
 		cy = 0;
 	}
 
+	new_data.preload_count = (size_t)obs_data_get_int(settings, S_PRELOAD_COUNT);
+	if (new_data.preload_count > MAX_PRELOAD_COUNT)
+		new_data.preload_count = MAX_PRELOAD_COUNT;
+
+	new_data.preload_memory = (uint64_t)obs_data_get_int(settings, S_PRELOAD_MEMORY);
+
 	/* ------------------------------------- */
 	/* update settings data                  */
 
 	ss->data = new_data;
+	ss->cx = cx;
+	ss->cy = cy;
+	get_decode_size(ss, &ss->decode_cx, &ss->decode_cy);
+	update_buffer_count(ss);
 	if (new_tr) {
 		old_tr = ss->transition;
 		ss->transition = new_tr;
@@ -567,8 +719,6 @@ static void ss_update(void *data, obs_data_t *settings)
 	/* ------------------------------------- */
 	/* restart transition                    */
 
-	ss->cx = cx;
-	ss->cy = cy;
 	obs_transition_set_size(ss->transition, cx, cy);
 	obs_transition_set_alignment(ss->transition, OBS_ALIGN_CENTER);
 	obs_transition_set_scale_type(ss->transition, OBS_TRANSITION_SCALE_ASPECT);
@@ -644,7 +794,7 @@ static void ss_next_slide(void *data)
 	if (!ssd->files.num || obs_transition_get_time(ss->transition) < 1.0f)
 		return;
 
-	struct source_data *last = deque_data(&slides->next, (SLIDE_BUFFER_COUNT - 1) * sizeof(sd));
+	struct source_data *last = deque_data(&slides->next, slides->next.size - sizeof(sd));
 
 	size_t slide_idx = last->slide_idx;
 	if (ss->data.randomize)
@@ -659,6 +809,8 @@ static void ss_next_slide(void *data)
 	deque_pop_front(&slides->prev, &sd, sizeof(sd));
 	free_source_data(&sd);
 
+	trim_active_slides(ss);
+	update_preload_stats(ss);
 	do_transition(ss, false);
 }
 
@@ -689,6 +841,8 @@ static void ss_previous_slide(void *data)
 	deque_pop_back(&slides->next, &sd, sizeof(sd));
 	free_source_data(&sd);
 
+	trim_active_slides(ss);
+	update_preload_stats(ss);
 	do_transition(ss, false);
 }
 
@@ -765,10 +919,22 @@ static void total_slides_proc(void *data, calldata_t *cd)
 	calldata_set_int(cd, "total_files", ss->data.files.num);
 }
 
+static void preload_stats_proc(void *data, calldata_t *cd)
+{
+	struct slideshow *ss = data;
+	calldata_set_int(cd, "hits", (long long)ss->preload_hits);
+	calldata_set_int(cd, "misses", (long long)ss->preload_misses);
+	calldata_set_int(cd, "window", (long long)ss->data.buffer_count);
+}
+
 static void ss_destroy(void *data)
 {
 	struct slideshow *ss = data;
 
+	if (ss->preload_hits || ss->preload_misses)
+		blog(LOG_DEBUG, "[slideshow: '%s'] preload hits: %" PRIu64 ", misses: %" PRIu64,
+		     obs_source_get_name(ss->source), ss->preload_hits, ss->preload_misses);
+
 	os_task_queue_destroy(ss->queue);
 	obs_source_release(ss->transition);
 	free_slideshow_data(&ss->data);
@@ -806,6 +972,8 @@ static void *ss_create(obs_data_t *settings, obs_source_t *source)
 
 	proc_handler_add(ph, "void current_index(out int current_index)", current_slide_proc, ss);
 	proc_handler_add(ph, "void total_files(out int total_files)", total_slides_proc, ss);
+	proc_handler_add(ph, "void preload_stats(out int hits, out int misses, out int window)", preload_stats_proc,
+			 ss);
 
 	signal_handler_t *sh = obs_source_get_signal_handler(ss->source);
 	signal_handler_add(sh, "void slide_changed(int index, string path)");
@@ -829,6 +997,33 @@ static void ss_video_render(void *data, gs_effect_t *effect)
 	UNUSED_PARAMETER(effect);
 }
 
+/* slides are decoded for the bounding size, which follows the canvas when the
+ * slideshow sizes itself automatically.  decode them again when it changes. */
+static void check_decode_size(struct slideshow *ss)
+{
+	struct slideshow_data *ssd = &ss->data;
+	uint32_t cx, cy;
+
+	get_decode_size(ss, &cx, &cy);
+	if (cx == ss->decode_cx && cy == ss->decode_cy)
+		return;
+
+	ss->decode_cx = cx;
+	ss->decode_cy = cy;
+	update_buffer_count(ss);
+
+	if (!ssd->downscale || !ssd->files.num)
+		return;
+
+	/* keeps restart_slides_at from reusing slides decoded at the old size */
+	size_t slide_idx = ssd->slides.cur.slide_idx;
+	free_active_slides(&ssd->slides);
+	memset(&ssd->slides, 0, sizeof(ssd->slides));
+
+	restart_slides_at(ss, slide_idx < ssd->files.num ? slide_idx : 0);
+	do_transition(ss, false);
+}
+
 static void ss_video_tick(void *data, float seconds)
 {
 	struct slideshow *ss = data;
@@ -837,6 +1032,8 @@ static void ss_video_tick(void *data, float seconds)
 	if (!ss->transition || !ssd->slide_time)
 		return;
 
+	check_decode_size(ss);
+
 	if (ssd->restart_on_activate && ssd->use_cut) {
 		ssd->elapsed = 0.0f;
 		restart_slides(ss);
@@ -959,6 +1156,9 @@ static void ss_defaults(obs_data_t *settings)
 	obs_data_set_default_string(settings, S_BEHAVIOR, S_BEHAVIOR_ALWAYS_PLAY);
 	obs_data_set_default_string(settings, S_MODE, S_MODE_AUTO);
 	obs_data_set_default_string(settings, S_PLAYBACK_MODE, S_PLAYBACK_LOOP);
+	obs_data_set_default_int(settings, S_PRELOAD_COUNT, DEFAULT_PRELOAD_COUNT);
+	obs_data_set_default_int(settings, S_PRELOAD_MEMORY, DEFAULT_PRELOAD_MEMORY_MB);
+	obs_data_set_default_bool(settings, S_DOWNSCALE, true);
 }
 
 static const char *file_filter = "Image files (*.bmp *.tga *.png *.jpeg *.jpg"
@@ -1014,6 +1214,13 @@ static obs_properties_t *ss_properties(void *data)
 
 	obs_properties_add_bool(ppts, S_HIDE, T_HIDE);
 
+	obs_properties_add_int(ppts, S_PRELOAD_COUNT, T_PRELOAD_COUNT, 1, MAX_PRELOAD_COUNT, 1);
+
+	p = obs_properties_add_int(ppts, S_PRELOAD_MEMORY, T_PRELOAD_MEMORY, 16, 16384, 16);
+	obs_property_int_set_suffix(p, " MB");
+
+	obs_properties_add_bool(ppts, S_DOWNSCALE, T_DOWNSCALE);
+
 	p = obs_properties_add_list(ppts, S_CUSTOM_SIZE, T_CUSTOM_SIZE, OBS_COMBO_TYPE_EDITABLE,
 				    OBS_COMBO_FORMAT_STRING);
 
@@ -18,13 +18,16 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdio.h>
 #include <stdlib.h>
 #include <inttypes.h>
+#include <xcb/damage.h>
 #include <xcb/randr.h>
 #include <xcb/shm.h>
 #include <xcb/xfixes.h>
 #include <xcb/xinerama.h>
 
 #include <obs-module.h>
+#include <util/darray.h>
 #include <util/dstr.h>
+#include <util/platform.h>
 #include "xcursor-xcb.h"
 #include "xhelpers.h"
 
@@ -34,6 +37,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define INVALID_DISPLAY (-1)
 
+/* size of the texture damaged areas are uploaded through */
+#define XSHM_TILE_SIZE 256
+/* capture the full image if more rectangles or more than half the area is
+ * damaged, partial updates would not save anything then */
+#define XSHM_MAX_DAMAGE_RECTS 64
+
+struct xshm_tile {
+	int16_t x;
+	int16_t y;
+	uint16_t width;
+	uint16_t height;
+	uint32_t offset;
+	xcb_shm_get_image_cookie_t cookie;
+};
+
 struct xshm_data {
 	obs_source_t *source;
 
@@ -50,6 +68,23 @@ struct xshm_data {
 	int_fast32_t height;
 
 	gs_texture_t *texture;
+	gs_texture_t *tile_texture;
+
+	/* damage tracking */
+	bool use_damage;
+	bool damage_active;
+	bool damage_full;
+	uint8_t damage_event;
+	xcb_damage_damage_t damage;
+	xcb_xfixes_region_t damage_region;
+	DARRAY(struct xshm_tile) tiles;
+
+	/* statistics */
+	uint64_t frames;
+	uint64_t skipped;
+	uint64_t changed_pixels;
+	uint64_t capture_time_total;
+	uint64_t capture_time_max;
 
 	int_fast32_t cut_top;
 	int_fast32_t cut_left;
@@ -79,6 +114,17 @@ static inline void xshm_resize_texture(struct xshm_data *data)
 	if (data->texture)
 		gs_texture_destroy(data->texture);
 	data->texture = gs_texture_create(data->adj_width, data->adj_height, GS_BGRA, 1, NULL, GS_DYNAMIC);
+
+	if (data->tile_texture) {
+		gs_texture_destroy(data->tile_texture);
+		data->tile_texture = NULL;
+	}
+	if (data->damage_active) {
+		uint32_t cx = data->adj_width < XSHM_TILE_SIZE ? data->adj_width : XSHM_TILE_SIZE;
+		uint32_t cy = data->adj_height < XSHM_TILE_SIZE ? data->adj_height : XSHM_TILE_SIZE;
+		data->tile_texture = gs_texture_create(cx, cy, GS_BGRA, 1, NULL, GS_DYNAMIC);
+	}
+	data->damage_full = true;
 }
 
 /**
@@ -102,6 +148,50 @@ static bool xshm_check_extensions(xcb_connection_t *xcb)
 	return ok;
 }
 
+/**
+ * Start tracking damage on the root window
+ *
+ * @return false if the damage extension is not available
+ */
+static bool xshm_damage_init(struct xshm_data *data)
+{
+	const xcb_query_extension_reply_t *ext = xcb_get_extension_data(data->xcb, &xcb_damage_id);
+	if (!ext->present) {
+		blog(LOG_INFO, "Missing Damage extension, capturing full frames");
+		return false;
+	}
+
+	xcb_xfixes_query_version_cookie_t xfix_c = xcb_xfixes_query_version_unchecked(
+		data->xcb, XCB_XFIXES_MAJOR_VERSION, XCB_XFIXES_MINOR_VERSION);
+	free(xcb_xfixes_query_version_reply(data->xcb, xfix_c, NULL));
+
+	xcb_damage_query_version_cookie_t dmg_c =
+		xcb_damage_query_version_unchecked(data->xcb, XCB_DAMAGE_MAJOR_VERSION, XCB_DAMAGE_MINOR_VERSION);
+	free(xcb_damage_query_version_reply(data->xcb, dmg_c, NULL));
+
+	data->damage_event = ext->first_event + XCB_DAMAGE_NOTIFY;
+	data->damage = xcb_generate_id(data->xcb);
+	data->damage_region = xcb_generate_id(data->xcb);
+
+	xcb_damage_create(data->xcb, data->damage, data->xcb_screen->root, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+	xcb_xfixes_create_region(data->xcb, data->damage_region, 0, NULL);
+
+	data->damage_active = true;
+	data->damage_full = true;
+	return true;
+}
+
+static void xshm_damage_free(struct xshm_data *data)
+{
+	if (!data->damage_active)
+		return;
+
+	xcb_damage_destroy(data->xcb, data->damage);
+	xcb_xfixes_destroy_region(data->xcb, data->damage_region);
+	da_free(data->tiles);
+	data->damage_active = false;
+}
+
 /**
  * Update the capture
  *
@@ -184,12 +274,30 @@ static const char *xshm_getname(void *unused)
  */
 static void xshm_capture_stop(struct xshm_data *data)
 {
+	if (data->frames) {
+		blog(LOG_INFO,
+		     "Captured %" PRIu64 " frames (%" PRIu64 " unchanged, %" PRIu64
+		     " changed pixels), capture time avg %.2f ms, max %.2f ms",
+		     data->frames, data->skipped, data->changed_pixels,
+		     (double)data->capture_time_total / data->frames / 1000000.0,
+		     (double)data->capture_time_max / 1000000.0);
+	}
+	data->frames = 0;
+	data->skipped = 0;
+	data->changed_pixels = 0;
+	data->capture_time_total = 0;
+	data->capture_time_max = 0;
+
 	obs_enter_graphics();
 
 	if (data->texture) {
 		gs_texture_destroy(data->texture);
 		data->texture = NULL;
 	}
+	if (data->tile_texture) {
+		gs_texture_destroy(data->tile_texture);
+		data->tile_texture = NULL;
+	}
 	if (data->cursor) {
 		xcb_xcursor_destroy(data->cursor);
 		data->cursor = NULL;
@@ -202,6 +310,8 @@ static void xshm_capture_stop(struct xshm_data *data)
 		data->xshm = NULL;
 	}
 
+	xshm_damage_free(data);
+
 	if (data->xcb) {
 		xcb_disconnect(data->xcb);
 		data->xcb = NULL;
@@ -253,6 +363,9 @@ static void xshm_capture_start(struct xshm_data *data)
 		goto fail;
 	}
 
+	if (data->use_damage)
+		xshm_damage_init(data);
+
 	data->cursor = xcb_xcursor_init(data->xcb);
 	xcb_xcursor_offset(data->cursor, data->adj_x_org, data->adj_y_org);
 
@@ -279,6 +392,7 @@ static void xshm_update(void *vptr, obs_data_t *settings)
 	data->screen_id = obs_data_get_int(settings, "screen");
 	data->show_cursor = obs_data_get_bool(settings, "show_cursor");
 	data->advanced = obs_data_get_bool(settings, "advanced");
+	data->use_damage = obs_data_get_bool(settings, "damage_tracking");
 	data->server = bstrdup(obs_data_get_string(settings, "server"));
 
 	data->cut_top = obs_data_get_int(settings, "cut_top");
@@ -297,6 +411,7 @@ static void xshm_defaults(obs_data_t *defaults, int ver)
 	obs_data_set_default_int(defaults, "screen", ver == 1 ? 0 : INVALID_DISPLAY);
 	obs_data_set_default_bool(defaults, "show_cursor", true);
 	obs_data_set_default_bool(defaults, "advanced", false);
+	obs_data_set_default_bool(defaults, "damage_tracking", false);
 	obs_data_set_default_int(defaults, "cut_top", 0);
 	obs_data_set_default_int(defaults, "cut_left", 0);
 	obs_data_set_default_int(defaults, "cut_right", 0);
@@ -426,6 +541,7 @@ static obs_properties_t *xshm_properties(void *vptr)
 
 	obs_properties_add_list(props, "screen", obs_module_text("Display"), OBS_COMBO_TYPE_LIST, OBS_COMBO_FORMAT_INT);
 	obs_properties_add_bool(props, "show_cursor", obs_module_text("CaptureCursor"));
+	obs_properties_add_bool(props, "damage_tracking", obs_module_text("DamageTracking"));
 	obs_property_t *advanced = obs_properties_add_bool(props, "advanced", obs_module_text("AdvancedSettings"));
 
 	prop = obs_properties_add_int(props, "cut_top", obs_module_text("CropTop"), -4096, 4096, 1);
@@ -468,6 +584,21 @@ static void xshm_destroy(void *vptr)
 	bfree(data);
 }
 
+/**
+ * Capture statistics, times are in milliseconds
+ */
+static void xshm_get_capture_stats(void *vptr, calldata_t *cd)
+{
+	XSHM_DATA(vptr);
+
+	calldata_set_int(cd, "frames", (long long)data->frames);
+	calldata_set_int(cd, "skipped", (long long)data->skipped);
+	calldata_set_int(cd, "changed_pixels", (long long)data->changed_pixels);
+	calldata_set_float(cd, "capture_time_avg",
+			   data->frames ? (double)data->capture_time_total / data->frames / 1000000.0 : 0.0);
+	calldata_set_float(cd, "capture_time_max", (double)data->capture_time_max / 1000000.0);
+}
+
 /**
  * Create the capture
  */
@@ -476,11 +607,159 @@ static void *xshm_create(obs_data_t *settings, obs_source_t *source)
 	struct xshm_data *data = bzalloc(sizeof(struct xshm_data));
 	data->source = source;
 
+	proc_handler_t *ph = obs_source_get_proc_handler(source);
+	proc_handler_add(ph,
+			 "void get_capture_stats(out int frames, out int skipped, out int changed_pixels, "
+			 "out float capture_time_avg, out float capture_time_max)",
+			 xshm_get_capture_stats, data);
+
 	xshm_update(data, settings);
 
 	return data;
 }
 
+/**
+ * Check for new damage since the last frame
+ *
+ * @return true if anything changed
+ */
+static bool xshm_damage_pending(struct xshm_data *data)
+{
+	xcb_generic_event_t *event;
+	bool damaged = data->damage_full;
+
+	while ((event = xcb_poll_for_event(data->xcb))) {
+		if ((event->response_type & ~0x80) == data->damage_event)
+			damaged = true;
+		free(event);
+	}
+
+	return damaged;
+}
+
+/**
+ * Split the damaged rectangles within the captured area into tiles
+ *
+ * @return false if the full image should be captured instead
+ */
+static bool xshm_damage_tiles(struct xshm_data *data, const xcb_rectangle_t *rects, int count, uint64_t *pixels_out)
+{
+	const uint32_t tile_cx = gs_texture_get_width(data->tile_texture);
+	const uint32_t tile_cy = gs_texture_get_height(data->tile_texture);
+	const int_fast32_t x_end = data->adj_x_org + data->adj_width;
+	const int_fast32_t y_end = data->adj_y_org + data->adj_height;
+	/* uploading a tile reads full tile rows from the segment */
+	const uint64_t limit = (uint64_t)data->adj_width * data->adj_height * 4 - tile_cx * tile_cy * 4;
+	uint64_t pixels = 0;
+	uint32_t offset = 0;
+
+	da_resize(data->tiles, 0);
+
+	if (count > XSHM_MAX_DAMAGE_RECTS || !tile_cx || !tile_cy)
+		return false;
+
+	for (int i = 0; i < count; i++) {
+		int_fast32_t x0 = rects[i].x > data->adj_x_org ? rects[i].x : data->adj_x_org;
+		int_fast32_t y0 = rects[i].y > data->adj_y_org ? rects[i].y : data->adj_y_org;
+		int_fast32_t x1 = rects[i].x + rects[i].width;
+		int_fast32_t y1 = rects[i].y + rects[i].height;
+
+		if (x1 > x_end)
+			x1 = x_end;
+		if (y1 > y_end)
+			y1 = y_end;
+		if (x0 >= x1 || y0 >= y1)
+			continue;
+
+		for (int_fast32_t y = y0; y < y1; y += tile_cy) {
+			for (int_fast32_t x = x0; x < x1; x += tile_cx) {
+				struct xshm_tile *tile = da_push_back_new(data->tiles);
+
+				tile->x = (int16_t)x;
+				tile->y = (int16_t)y;
+				tile->width = (uint16_t)(x1 - x < (int_fast32_t)tile_cx ? x1 - x : tile_cx);
+				tile->height = (uint16_t)(y1 - y < (int_fast32_t)tile_cy ? y1 - y : tile_cy);
+				tile->offset = offset;
+
+				offset += tile->width * tile->height * 4;
+				pixels += tile->width * tile->height;
+				if (offset > limit || pixels * 2 > (uint64_t)data->adj_width * data->adj_height)
+					return false;
+			}
+		}
+	}
+
+	*pixels_out = pixels;
+	return true;
+}
+
+/**
+ * Fetch and upload only the damaged areas
+ *
+ * @return false if the full image has to be captured instead
+ */
+static bool xshm_capture_damage(struct xshm_data *data)
+{
+	xcb_xfixes_fetch_region_reply_t *region_r;
+	bool success = false;
+	uint64_t pixels;
+
+	xcb_damage_subtract(data->xcb, data->damage, XCB_NONE, data->damage_region);
+
+	/* tiles cannot be uploaded, and are sized by the texture */
+	if (!data->tile_texture)
+		return false;
+
+	region_r = xcb_xfixes_fetch_region_reply(
+		data->xcb, xcb_xfixes_fetch_region_unchecked(data->xcb, data->damage_region), NULL);
+	if (!region_r)
+		return false;
+
+	if (data->damage_full ||
+	    !xshm_damage_tiles(data, xcb_xfixes_fetch_region_rectangles(region_r),
+			       xcb_xfixes_fetch_region_rectangles_length(region_r), &pixels))
+		goto exit;
+
+	for (size_t i = 0; i < data->tiles.num; i++) {
+		struct xshm_tile *tile = &data->tiles.array[i];
+
+		tile->cookie = xcb_shm_get_image_unchecked(data->xcb, data->xcb_screen->root, tile->x, tile->y,
+							   tile->width, tile->height, ~0, XCB_IMAGE_FORMAT_Z_PIXMAP,
+							   data->xshm->seg, tile->offset);
+	}
+
+	success = true;
+	for (size_t i = 0; i < data->tiles.num; i++) {
+		xcb_shm_get_image_reply_t *img_r =
+			xcb_shm_get_image_reply(data->xcb, data->tiles.array[i].cookie, NULL);
+		if (!img_r)
+			success = false;
+		free(img_r);
+	}
+	if (!success)
+		goto exit;
+
+	obs_enter_graphics();
+
+	for (size_t i = 0; i < data->tiles.num; i++) {
+		struct xshm_tile *tile = &data->tiles.array[i];
+
+		gs_texture_set_image(data->tile_texture, data->xshm->data + tile->offset, tile->width * 4, false);
+		gs_copy_texture_region(data->texture, tile->x - data->adj_x_org, tile->y - data->adj_y_org,
+				       data->tile_texture, 0, 0, tile->width, tile->height);
+	}
+
+	xcb_xcursor_update(data->xcb, data->cursor);
+
+	obs_leave_graphics();
+
+	data->changed_pixels += pixels;
+
+exit:
+	free(region_r);
+	return success;
+}
+
 /**
  * Prepare the capture data
  */
@@ -494,8 +773,23 @@ static void xshm_video_tick(void *vptr, float seconds)
 	if (!obs_source_showing(data->source))
 		return;
 
+	uint64_t start_time = os_gettime_ns();
 	xcb_shm_get_image_cookie_t img_c;
-	xcb_shm_get_image_reply_t *img_r;
+	xcb_shm_get_image_reply_t *img_r = NULL;
+
+	if (data->damage_active) {
+		if (!xshm_damage_pending(data)) {
+			obs_enter_graphics();
+			xcb_xcursor_update(data->xcb, data->cursor);
+			obs_leave_graphics();
+
+			data->skipped++;
+			goto exit;
+		}
+
+		if (xshm_capture_damage(data))
+			goto exit;
+	}
 
 	img_c = xcb_shm_get_image_unchecked(data->xcb, data->xcb_screen->root, data->adj_x_org, data->adj_y_org,
 					    data->adj_width, data->adj_height, ~0, XCB_IMAGE_FORMAT_Z_PIXMAP,
@@ -513,8 +807,17 @@ static void xshm_video_tick(void *vptr, float seconds)
 
 	obs_leave_graphics();
 
+	data->changed_pixels += (uint64_t)data->adj_width * data->adj_height;
+	data->damage_full = false;
+
 exit:
 	free(img_r);
+
+	uint64_t capture_time = os_gettime_ns() - start_time;
+	data->capture_time_total += capture_time;
+	if (capture_time > data->capture_time_max)
+		data->capture_time_max = capture_time;
+	data->frames++;
 }
 
 /**
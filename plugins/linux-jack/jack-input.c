@@ -60,12 +60,18 @@ static void jack_update(void *vptr, obs_data_t *settings)
 	bool settings_changed = false;
 	bool new_jack_start_server = obs_data_get_bool(settings, "startjack");
 	int new_channel_count = obs_data_get_int(settings, "channels");
+	bool new_drive_clock = obs_data_get_bool(settings, "clock");
 
 	if (new_jack_start_server != data->start_jack_server) {
 		data->start_jack_server = new_jack_start_server;
 		settings_changed = true;
 	}
 
+	if (new_drive_clock != data->drive_clock) {
+		data->drive_clock = new_drive_clock;
+		settings_changed = true;
+	}
+
 	if (new_channel_count != data->channels)
 		/*
 		 * keep "old" channel count  for now,
@@ -124,6 +130,7 @@ static void jack_input_defaults(obs_data_t *settings)
 {
 	obs_data_set_default_int(settings, "channels", 2);
 	obs_data_set_default_bool(settings, "startjack", false);
+	obs_data_set_default_bool(settings, "clock", false);
 }
 
 /**
@@ -137,6 +144,7 @@ static obs_properties_t *jack_input_properties(void *unused)
 
 	obs_properties_add_int(props, "channels", obs_module_text("Channels"), 1, 8, 1);
 	obs_properties_add_bool(props, "startjack", obs_module_text("StartJACKServer"));
+	obs_properties_add_bool(props, "clock", obs_module_text("DriveAudioClock"));
 
 	return props;
 }
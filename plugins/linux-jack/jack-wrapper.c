@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <util/threading.h>
 #include <stdio.h>
+#include <inttypes.h>
 
 #include <util/platform.h>
 
@@ -93,6 +94,11 @@ int jack_process_callback(jack_nframes_t nframes, void *arg)
 	/* FIXME: this function is not realtime-safe, we should do something
 	 * about this */
 	obs_source_output_audio(data->source, &out);
+
+	/* advance after outputting so that this period is already queued when
+	 * the audio thread wakes up */
+	if (data->clock_attached)
+		audio_output_clock_advance(obs_get_audio(), nframes);
 	return 0;
 }
 
@@ -135,6 +141,20 @@ int_fast32_t jack_init(struct jack_data *data)
 		goto error;
 	}
 
+	if (data->drive_clock) {
+		uint32_t rate = audio_output_get_sample_rate(obs_get_audio());
+
+		if (jack_get_sample_rate(data->jack_client) != rate)
+			blog(LOG_WARNING,
+			     "JACK runs at %" PRIu32 " Hz but OBS at %" PRIu32 " Hz, "
+			     "not driving the audio clock",
+			     (uint32_t)jack_get_sample_rate(data->jack_client), rate);
+		else if (!audio_output_attach_clock(obs_get_audio()))
+			blog(LOG_WARNING, "The audio clock is already driven by another device");
+		else
+			data->clock_attached = true;
+	}
+
 	if (jack_activate(data->jack_client) != 0) {
 		blog(LOG_ERROR, "jack_activate Error:"
 				"Could not activate JACK client!");
@@ -156,6 +176,10 @@ void deactivate_jack(struct jack_data *data)
 
 	if (data->jack_client) {
 		jack_client_close(data->jack_client);
+		if (data->clock_attached) {
+			audio_output_detach_clock(obs_get_audio());
+			data->clock_attached = false;
+		}
 		if (data->jack_ports != NULL) {
 			bfree(data->jack_ports);
 			data->jack_ports = NULL;
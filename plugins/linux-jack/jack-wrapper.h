@@ -28,6 +28,7 @@ struct jack_data {
 	char *device;
 	uint_fast8_t channels;
 	bool start_jack_server;
+	bool drive_clock;
 
 	/* server info */
 	enum speaker_layout speakers;
@@ -36,6 +37,7 @@ struct jack_data {
 
 	jack_client_t *jack_client;
 	jack_port_t **jack_ports;
+	bool clock_attached;
 
 	pthread_mutex_t jack_mutex;
 };
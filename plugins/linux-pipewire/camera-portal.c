@@ -1186,6 +1186,13 @@ static bool parse_resolution(struct spa_rectangle *dest, const char *json)
 	return true;
 }
 
+static void get_pipewire_stats_proc(void *data, calldata_t *cd)
+{
+	struct camera_portal_source *camera_source = data;
+
+	obs_pipewire_stream_stats_to_calldata(camera_source->obs_pw_stream, cd);
+}
+
 static void *pipewire_camera_create(obs_data_t *settings, obs_source_t *source)
 {
 	struct camera_portal_source *camera_source;
@@ -1220,6 +1227,9 @@ static void *pipewire_camera_create(obs_data_t *settings, obs_source_t *source)
 		}
 	}
 
+	proc_handler_add(obs_source_get_proc_handler(source), OBS_PIPEWIRE_STATS_PROC, get_pipewire_stats_proc,
+			 camera_source);
+
 	access_camera(camera_source);
 
 	return camera_source;
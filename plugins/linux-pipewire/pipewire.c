@@ -23,12 +23,16 @@
 #include "formats.h"
 
 #include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <util/util_uint64.h>
 
 #include <gio/gio.h>
 #include <gio/gunixfdlist.h>
 #include <glib/gstdio.h>
 
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <glad/glad.h>
 #include <libdrm/drm_fourcc.h>
 #include <pipewire/pipewire.h>
@@ -65,6 +69,16 @@ struct spa_meta_videotransform {
 #define CURSOR_META_SIZE(width, height) \
 	(sizeof(struct spa_meta_cursor) + sizeof(struct spa_meta_bitmap) + width * height * 4)
 
+/* buffer pool of async sources, which hold on to buffers */
+#define POOL_DEFAULT_BUFFERS 6
+#define POOL_MAX_BUFFERS 16
+/* buffers that always stay with the producer */
+#define POOL_MIN_QUEUED 2
+/* frames between pool size checks */
+#define POOL_WINDOW_FRAMES 120
+/* frames to keep copying after requesting a new pool size */
+#define POOL_SETTLE_FRAMES 30
+
 struct obs_pw_version {
 	int major;
 	int minor;
@@ -95,11 +109,57 @@ struct _obs_pipewire {
 	GPtrArray *streams;
 };
 
+/**
+ * Our own mapping of a MemFd buffer
+ *
+ * PipeWire unmaps buffers when they are removed from the stream, frames libobs
+ * still holds point at this mapping instead and keep it alive.
+ */
+struct pw_buffer_map {
+	volatile long refs;
+	/* NULL once the buffer was removed from the stream */
+	struct pw_buffer *buffer;
+	uint32_t n_planes;
+	struct {
+		void *base;
+		size_t size;
+		uint8_t *data;
+	} planes[MAX_AV_PLANES];
+};
+
+/**
+ * A buffer that is handed to libobs without copying
+ */
+struct pw_held_buffer {
+	struct pw_buffer_pool *pool;
+	struct pw_buffer_map *map;
+	uint64_t ts;
+};
+
+/**
+ * Buffers held by libobs
+ *
+ * This outlives the stream while libobs still references buffers, released
+ * buffers are handed back to the loop thread to be queued again.
+ */
+struct pw_buffer_pool {
+	volatile long refs;
+
+	pthread_mutex_t mutex;
+	struct pw_loop *loop;
+	/* NULL once the stream is destroyed */
+	struct spa_source *requeue_event;
+	DARRAY(struct pw_buffer *) requeue;
+	DARRAY(struct pw_held_buffer *) held;
+	uint64_t max_hold;
+};
+
 struct _obs_pipewire_stream {
 	obs_pipewire *obs_pw;
 	obs_source_t *source;
 
 	gs_texture_t *texture;
+	bool texture_is_shm;
 
 	struct pw_stream *stream;
 	struct spa_hook stream_listener;
@@ -147,6 +207,21 @@ struct _obs_pipewire_stream {
 		bool release_point_will_signal;
 		bool set;
 	} sync;
+
+	struct pw_buffer_pool *pool;
+
+	struct {
+		uint32_t types;
+		bool explicit_sync;
+		uint32_t count;
+		uint32_t target;
+		uint32_t window_frames;
+		uint32_t starved;
+		uint32_t settle_frames;
+		bool resize;
+	} buffers;
+
+	struct obs_pipewire_stream_stats stats;
 };
 
 /* auxiliary methods */
@@ -580,8 +655,9 @@ static void return_unused_pw_buffer(struct pw_stream *stream, struct pw_buffer *
 	pw_stream_queue_buffer(stream, b);
 }
 
-static inline struct pw_buffer *find_latest_buffer(struct pw_stream *stream)
+static inline struct pw_buffer *find_latest_buffer(obs_pipewire_stream *obs_pw_stream)
 {
+	struct pw_stream *stream = obs_pw_stream->stream;
 	struct pw_buffer *b;
 
 	/* Find the most recent buffer */
@@ -590,14 +666,261 @@ static inline struct pw_buffer *find_latest_buffer(struct pw_stream *stream)
 		struct pw_buffer *aux = pw_stream_dequeue_buffer(stream);
 		if (!aux)
 			break;
-		if (b)
+		if (b) {
 			return_unused_pw_buffer(stream, b);
+			obs_pw_stream->stats.dropped++;
+		}
 		b = aux;
 	}
 
 	return b;
 }
 
+static uint64_t get_frame_interval(obs_pipewire_stream *obs_pw_stream)
+{
+	const struct spa_fraction *rate = &obs_pw_stream->format.info.raw.framerate;
+
+	if (!rate->num)
+		rate = &obs_pw_stream->format.info.raw.max_framerate;
+	if (rate->num && rate->denom)
+		return util_mul_div64(1000000000ULL, rate->denom, rate->num);
+
+	return util_mul_div64(1000000000ULL, obs_pw_stream->video_info.fps_den, obs_pw_stream->video_info.fps_num);
+}
+
+static void check_late_buffer(obs_pipewire_stream *obs_pw_stream, const struct spa_meta_header *header)
+{
+	uint64_t now = os_gettime_ns();
+	uint64_t delay;
+
+	/* producers stamp buffers with CLOCK_MONOTONIC like os_gettime_ns, an
+	 * implausible delay means a different clock and is ignored */
+	if (!header || header->pts <= 0 || (uint64_t)header->pts > now)
+		return;
+
+	delay = now - (uint64_t)header->pts;
+	if (delay > get_frame_interval(obs_pw_stream) && delay < 1000000000ULL)
+		obs_pw_stream->stats.late++;
+}
+
+/* ------------------------------------------------- */
+
+static void buffer_pool_release(struct pw_buffer_pool *pool)
+{
+	if (os_atomic_dec_long(&pool->refs) != 0)
+		return;
+
+	pthread_mutex_destroy(&pool->mutex);
+	da_free(pool->requeue);
+	da_free(pool->held);
+	bfree(pool);
+}
+
+static void buffer_map_release(struct pw_buffer_map *map)
+{
+	if (!map || os_atomic_dec_long(&map->refs) != 0)
+		return;
+
+	for (uint32_t i = 0; i < map->n_planes; i++)
+		munmap(map->planes[i].base, map->planes[i].size);
+	bfree(map);
+}
+
+/*
+ * Map the buffer ourselves, only possible if every plane is a MemFd
+ */
+static struct pw_buffer_map *buffer_map_create(struct pw_buffer *b)
+{
+	struct spa_buffer *buffer = b->buffer;
+	struct pw_buffer_map *map;
+
+	if (buffer->n_datas == 0 || buffer->n_datas > MAX_AV_PLANES)
+		return NULL;
+
+	for (uint32_t i = 0; i < buffer->n_datas; i++) {
+		if (buffer->datas[i].type != SPA_DATA_MemFd || buffer->datas[i].fd < 0)
+			return NULL;
+	}
+
+	map = bzalloc(sizeof(*map));
+	map->refs = 1;
+	map->buffer = b;
+
+	for (uint32_t i = 0; i < buffer->n_datas; i++) {
+		struct spa_data *d = &buffer->datas[i];
+		size_t size = (size_t)d->mapoffset + d->maxsize;
+		void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, (int)d->fd, 0);
+
+		if (base == MAP_FAILED) {
+			blog(LOG_WARNING, "[pipewire] Failed to map buffer, frames will be copied");
+			buffer_map_release(map);
+			return NULL;
+		}
+
+		map->planes[i].base = base;
+		map->planes[i].size = size;
+		map->planes[i].data = (uint8_t *)base + d->mapoffset;
+		map->n_planes++;
+	}
+
+	return map;
+}
+
+/*
+ * Called by libobs once it no longer needs a buffer, from any thread
+ */
+static void release_held_buffer(void *param)
+{
+	struct pw_held_buffer *held = param;
+	struct pw_buffer_pool *pool = held->pool;
+	uint64_t hold_time = os_gettime_ns() - held->ts;
+
+	pthread_mutex_lock(&pool->mutex);
+	da_erase_item(pool->held, &held);
+	if (held->map->buffer) {
+		da_push_back(pool->requeue, &held->map->buffer);
+		pw_loop_signal_event(pool->loop, pool->requeue_event);
+	}
+	if (hold_time > pool->max_hold)
+		pool->max_hold = hold_time;
+	pthread_mutex_unlock(&pool->mutex);
+
+	buffer_map_release(held->map);
+	bfree(held);
+	buffer_pool_release(pool);
+}
+
+static void requeue_released_buffers(void *data, uint64_t expirations)
+{
+	UNUSED_PARAMETER(expirations);
+	obs_pipewire_stream *obs_pw_stream = data;
+	struct pw_buffer_pool *pool = obs_pw_stream->pool;
+	DARRAY(struct pw_buffer *) requeue;
+
+	da_init(requeue);
+
+	pthread_mutex_lock(&pool->mutex);
+	da_move(requeue, pool->requeue);
+	pthread_mutex_unlock(&pool->mutex);
+
+	for (size_t i = 0; i < requeue.num; i++)
+		return_unused_pw_buffer(obs_pw_stream->stream, requeue.array[i]);
+	da_free(requeue);
+}
+
+static size_t get_held_buffer_count(struct pw_buffer_pool *pool)
+{
+	size_t count;
+
+	pthread_mutex_lock(&pool->mutex);
+	count = pool->held.num;
+	pthread_mutex_unlock(&pool->mutex);
+
+	return count;
+}
+
+static void update_buffer_params(obs_pipewire_stream *obs_pw_stream);
+
+/*
+ * Size the pool from the time libobs holds on to buffers
+ *
+ * Each window the longest hold time is turned into the number of frames libobs
+ * keeps in flight, plus the buffers the producer needs.  The pool only grows,
+ * resizing reallocates every buffer so it waits for libobs to release the held
+ * ones and frames are copied until the new buffers arrived.
+ */
+static void adapt_buffer_count(obs_pipewire_stream *obs_pw_stream)
+{
+	struct pw_buffer_pool *pool = obs_pw_stream->pool;
+	uint64_t interval = get_frame_interval(obs_pw_stream);
+	uint64_t max_hold;
+	uint32_t target;
+
+	if (obs_pw_stream->buffers.settle_frames) {
+		obs_pw_stream->buffers.settle_frames--;
+		return;
+	}
+
+	if (obs_pw_stream->buffers.resize) {
+		if (get_held_buffer_count(pool) == 0) {
+			obs_pw_stream->buffers.resize = false;
+			obs_pw_stream->buffers.settle_frames = POOL_SETTLE_FRAMES;
+			update_buffer_params(obs_pw_stream);
+		}
+		return;
+	}
+
+	if (++obs_pw_stream->buffers.window_frames < POOL_WINDOW_FRAMES)
+		return;
+
+	pthread_mutex_lock(&pool->mutex);
+	max_hold = pool->max_hold;
+	pool->max_hold = 0;
+	pthread_mutex_unlock(&pool->mutex);
+
+	target = POOL_MIN_QUEUED + 1;
+	if (interval)
+		target += (uint32_t)((max_hold + interval - 1) / interval);
+	if (obs_pw_stream->buffers.starved && target <= obs_pw_stream->buffers.count)
+		target = obs_pw_stream->buffers.count + 1;
+	target = SPA_MIN(target, POOL_MAX_BUFFERS);
+
+	obs_pw_stream->buffers.window_frames = 0;
+	obs_pw_stream->buffers.starved = 0;
+
+	if (target <= obs_pw_stream->buffers.target)
+		return;
+
+	blog(LOG_INFO, "[pipewire] Growing buffer pool from %u to %u buffers (held up to %.1f ms)",
+	     obs_pw_stream->buffers.target, target, (double)max_hold / 1000000.0);
+
+	obs_pw_stream->buffers.target = target;
+	obs_pw_stream->buffers.resize = true;
+}
+
+/*
+ * Hand the buffer to libobs without copying
+ *
+ * The buffer is queued again once libobs releases the frame.  Buffers are only
+ * held while enough of them stay with the producer to keep streaming.
+ */
+static bool output_held_buffer(obs_pipewire_stream *obs_pw_stream, struct pw_buffer *b,
+			       const struct obs_source_frame *frame)
+{
+	struct pw_buffer_pool *pool = obs_pw_stream->pool;
+	struct pw_buffer_map *map = b->user_data;
+	struct obs_source_frame held_frame;
+	struct pw_held_buffer *held;
+
+	adapt_buffer_count(obs_pw_stream);
+
+	if (!map || obs_pw_stream->buffers.resize || obs_pw_stream->buffers.settle_frames)
+		return false;
+
+	pthread_mutex_lock(&pool->mutex);
+	if (pool->held.num + 1 + POOL_MIN_QUEUED > obs_pw_stream->buffers.count) {
+		pthread_mutex_unlock(&pool->mutex);
+		obs_pw_stream->buffers.starved++;
+		return false;
+	}
+
+	held = bmalloc(sizeof(*held));
+	held->pool = pool;
+	held->map = map;
+	held->ts = os_gettime_ns();
+	da_push_back(pool->held, &held);
+	pthread_mutex_unlock(&pool->mutex);
+
+	held_frame = *frame;
+	for (uint32_t i = 0; i < map->n_planes; i++)
+		held_frame.data[i] = map->planes[i].data;
+
+	os_atomic_inc_long(&map->refs);
+	os_atomic_inc_long(&pool->refs);
+	obs_source_output_video_ref(obs_pw_stream->source, &held_frame, release_held_buffer, held);
+	return true;
+}
+
 static uint32_t get_spa_buffer_plane_count(const struct spa_buffer *buffer)
 {
 	uint32_t plane_count = 0;
@@ -660,17 +983,21 @@ static bool prepare_obs_frame(obs_pipewire_stream *obs_pw_stream, struct obs_sou
 
 static void process_video_async(obs_pipewire_stream *obs_pw_stream)
 {
+	struct spa_meta_header *header;
 	struct spa_buffer *buffer;
 	struct pw_buffer *b;
 	bool has_buffer;
 
-	b = find_latest_buffer(obs_pw_stream->stream);
+	b = find_latest_buffer(obs_pw_stream);
 	if (!b) {
 		blog(LOG_DEBUG, "[pipewire] Out of buffers!");
 		return;
 	}
 
 	buffer = b->buffer;
+	header = spa_buffer_find_meta_data(buffer, SPA_META_Header, sizeof(*header));
+	check_late_buffer(obs_pw_stream, header);
+
 	has_buffer = buffer->datas[0].chunk->size != 0;
 
 	if (!has_buffer)
@@ -702,8 +1029,16 @@ static void process_video_async(obs_pipewire_stream *obs_pw_stream)
 	}
 #endif
 
+	obs_pw_stream->stats.frames++;
+
+	if (output_held_buffer(obs_pw_stream, b, &out))
+		return;
+
 	obs_source_output_video(obs_pw_stream->source, &out);
 
+	for (uint32_t i = 0; i < buffer->n_datas && i < MAX_AV_PLANES; i++)
+		obs_pw_stream->stats.copied_bytes += buffer->datas[i].chunk->size;
+
 done:
 	pw_stream_queue_buffer(obs_pw_stream->stream, b);
 }
@@ -720,7 +1055,7 @@ static void process_video_sync(obs_pipewire_stream *obs_pw_stream)
 	struct pw_buffer *b;
 	bool has_buffer = true;
 
-	b = find_latest_buffer(obs_pw_stream->stream);
+	b = find_latest_buffer(obs_pw_stream);
 	if (!b) {
 		blog(LOG_DEBUG, "[pipewire] Out of buffers!");
 		return;
@@ -734,6 +1069,9 @@ static void process_video_sync(obs_pipewire_stream *obs_pw_stream)
 		return;
 	}
 
+	check_late_buffer(obs_pw_stream, header);
+	obs_pw_stream->stats.frames++;
+
 	obs_enter_graphics();
 
 	// Workaround for kwin behaviour pre 5.27.5
@@ -815,6 +1153,7 @@ static void process_video_sync(obs_pipewire_stream *obs_pw_stream)
 		}
 
 		g_clear_pointer(&obs_pw_stream->texture, gs_texture_destroy);
+		obs_pw_stream->texture_is_shm = false;
 
 		use_modifiers = obs_pw_stream->format.info.raw.modifier != DRM_FORMAT_MOD_INVALID;
 		obs_pw_stream->texture = gs_texture_create_from_dmabuf(obs_pw_stream->format.info.raw.size.width,
@@ -849,11 +1188,29 @@ static void process_video_sync(obs_pipewire_stream *obs_pw_stream)
 			goto read_metadata;
 		}
 
-		g_clear_pointer(&obs_pw_stream->texture, gs_texture_destroy);
-		obs_pw_stream->texture = gs_texture_create(obs_pw_stream->format.info.raw.size.width,
-							   obs_pw_stream->format.info.raw.size.height,
-							   obs_pw_video_format.gs_format, 1,
-							   (const uint8_t **)&buffer->datas[0].data, GS_DYNAMIC);
+		uint32_t width = obs_pw_stream->format.info.raw.size.width;
+		uint32_t height = obs_pw_stream->format.info.raw.size.height;
+		uint32_t stride = buffer->datas[0].chunk->stride;
+
+		if (!stride)
+			stride = width * obs_pw_video_format.bpp;
+
+		/* upload into the same texture as long as the format holds */
+		if (!obs_pw_stream->texture || !obs_pw_stream->texture_is_shm ||
+		    gs_texture_get_width(obs_pw_stream->texture) != width ||
+		    gs_texture_get_height(obs_pw_stream->texture) != height ||
+		    gs_texture_get_color_format(obs_pw_stream->texture) != obs_pw_video_format.gs_format) {
+			g_clear_pointer(&obs_pw_stream->texture, gs_texture_destroy);
+			obs_pw_stream->texture =
+				gs_texture_create(width, height, obs_pw_video_format.gs_format, 1, NULL, GS_DYNAMIC);
+			obs_pw_stream->texture_is_shm = true;
+		}
+
+		if (!obs_pw_stream->texture)
+			goto read_metadata;
+
+		gs_texture_set_image(obs_pw_stream->texture, buffer->datas[0].data, stride, false);
+		obs_pw_stream->stats.copied_bytes += (uint64_t)stride * height;
 	}
 
 	if (obs_pw_video_format.swap_red_blue)
@@ -933,6 +1290,8 @@ static void on_process_cb(void *user_data)
 
 	output_flags = obs_source_get_output_flags(obs_pw_stream->source);
 
+	requeue_released_buffers(obs_pw_stream, 0);
+
 	if (output_flags & OBS_SOURCE_VIDEO) {
 		if (output_flags & OBS_SOURCE_ASYNC)
 			process_video_async(obs_pw_stream);
@@ -941,65 +1300,17 @@ static void on_process_cb(void *user_data)
 	}
 }
 
-static void on_param_changed_cb(void *user_data, uint32_t id, const struct spa_pod *param)
+static void update_buffer_params(obs_pipewire_stream *obs_pw_stream)
 {
-	obs_pipewire_stream *obs_pw_stream = user_data;
 	obs_pipewire *obs_pw = obs_pw_stream->obs_pw;
 	struct spa_pod_builder pod_builder;
 	const struct spa_pod *params[7];
-	const char *format_name;
 	uint32_t n_params = 0;
-	uint32_t buffer_types;
 	uint32_t output_flags;
 	uint8_t params_buffer[1024];
-	int result;
-#if PW_CHECK_VERSION(1, 2, 0)
-	bool supports_explicit_sync = false;
-#endif
-
-	if (!param || id != SPA_PARAM_Format)
-		return;
-
-	result = spa_format_parse(param, &obs_pw_stream->format.media_type, &obs_pw_stream->format.media_subtype);
-	if (result < 0)
-		return;
-
-	if (obs_pw_stream->format.media_type != SPA_MEDIA_TYPE_video ||
-	    obs_pw_stream->format.media_subtype != SPA_MEDIA_SUBTYPE_raw)
-		return;
-
-	spa_format_video_raw_parse(param, &obs_pw_stream->format.info.raw);
 
 	output_flags = obs_source_get_output_flags(obs_pw_stream->source);
 
-	buffer_types = 1 << SPA_DATA_MemPtr;
-	bool has_modifier = spa_pod_find_prop(param, NULL, SPA_FORMAT_VIDEO_modifier) != NULL;
-	if ((has_modifier || check_pw_version(&obs_pw->server_version, 0, 3, 24)) &&
-	    (output_flags & OBS_SOURCE_ASYNC_VIDEO) != OBS_SOURCE_ASYNC_VIDEO) {
-		buffer_types |= 1 << SPA_DATA_DmaBuf;
-#if PW_CHECK_VERSION(1, 2, 0)
-		obs_enter_graphics();
-		supports_explicit_sync = gs_query_sync_capabilities();
-		obs_leave_graphics();
-#endif
-	}
-
-	blog(LOG_INFO, "[pipewire] Negotiated format:");
-
-	format_name = spa_debug_type_find_name(spa_type_video_format, obs_pw_stream->format.info.raw.format);
-	blog(LOG_INFO, "[pipewire]     Format: %d (%s)", obs_pw_stream->format.info.raw.format,
-	     format_name ? format_name : "unknown format");
-
-	if (has_modifier) {
-		blog(LOG_INFO, "[pipewire]     Modifier: 0x%" PRIx64, obs_pw_stream->format.info.raw.modifier);
-	}
-
-	blog(LOG_INFO, "[pipewire]     Size: %dx%d", obs_pw_stream->format.info.raw.size.width,
-	     obs_pw_stream->format.info.raw.size.height);
-
-	blog(LOG_INFO, "[pipewire]     Framerate: %d/%d", obs_pw_stream->format.info.raw.framerate.num,
-	     obs_pw_stream->format.info.raw.framerate.denom);
-
 	/* Video crop */
 	pod_builder = SPA_POD_BUILDER_INIT(params_buffer, sizeof(params_buffer));
 	params[n_params++] = spa_pod_builder_add_object(&pod_builder, SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
@@ -1016,7 +1327,7 @@ static void on_param_changed_cb(void *user_data, uint32_t id, const struct spa_p
 
 	/* Buffer options */
 #if PW_CHECK_VERSION(1, 2, 0)
-	if (supports_explicit_sync) {
+	if (obs_pw_stream->buffers.explicit_sync) {
 		struct spa_pod_frame dmabuf_explicit_sync_frame;
 
 		spa_pod_builder_push_object(&pod_builder, &dmabuf_explicit_sync_frame, SPA_TYPE_OBJECT_ParamBuffers,
@@ -1029,12 +1340,22 @@ static void on_param_changed_cb(void *user_data, uint32_t id, const struct spa_p
 	}
 #endif
 
-	params[n_params++] = spa_pod_builder_add_object(&pod_builder, SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers,
-							SPA_PARAM_BUFFERS_dataType, SPA_POD_Int(buffer_types));
+	/* Async sources hold on to buffers, ask for enough of them */
+	if (output_flags & OBS_SOURCE_ASYNC) {
+		params[n_params++] = spa_pod_builder_add_object(
+			&pod_builder, SPA_TYPE_OBJECT_ParamBuffers, SPA_PARAM_Buffers, SPA_PARAM_BUFFERS_dataType,
+			SPA_POD_Int(obs_pw_stream->buffers.types), SPA_PARAM_BUFFERS_buffers,
+			SPA_POD_CHOICE_RANGE_Int(obs_pw_stream->buffers.target, POOL_MIN_QUEUED + 1,
+						 POOL_MAX_BUFFERS));
+	} else {
+		params[n_params++] = spa_pod_builder_add_object(&pod_builder, SPA_TYPE_OBJECT_ParamBuffers,
+								SPA_PARAM_Buffers, SPA_PARAM_BUFFERS_dataType,
+								SPA_POD_Int(obs_pw_stream->buffers.types));
+	}
 
 	/* Sync timeline */
 #if PW_CHECK_VERSION(1, 2, 0)
-	if (supports_explicit_sync) {
+	if (obs_pw_stream->buffers.explicit_sync) {
 		params[n_params++] = spa_pod_builder_add_object(&pod_builder, SPA_TYPE_OBJECT_ParamMeta, SPA_PARAM_Meta,
 								SPA_PARAM_META_type, SPA_POD_Id(SPA_META_SyncTimeline),
 								SPA_PARAM_META_size,
@@ -1057,11 +1378,115 @@ static void on_param_changed_cb(void *user_data, uint32_t id, const struct spa_p
 								SPA_PARAM_META_size,
 								SPA_POD_Int(sizeof(struct spa_meta_videotransform)));
 	}
+#else
+	UNUSED_PARAMETER(obs_pw);
 #endif
 	pw_stream_update_params(obs_pw_stream->stream, params, n_params);
+}
+
+static void on_param_changed_cb(void *user_data, uint32_t id, const struct spa_pod *param)
+{
+	obs_pipewire_stream *obs_pw_stream = user_data;
+	obs_pipewire *obs_pw = obs_pw_stream->obs_pw;
+	const char *format_name;
+	uint32_t buffer_types;
+	uint32_t output_flags;
+	int result;
+#if PW_CHECK_VERSION(1, 2, 0)
+	bool supports_explicit_sync = false;
+#endif
+
+	if (!param || id != SPA_PARAM_Format)
+		return;
+
+	result = spa_format_parse(param, &obs_pw_stream->format.media_type, &obs_pw_stream->format.media_subtype);
+	if (result < 0)
+		return;
+
+	if (obs_pw_stream->format.media_type != SPA_MEDIA_TYPE_video ||
+	    obs_pw_stream->format.media_subtype != SPA_MEDIA_SUBTYPE_raw)
+		return;
+
+	spa_format_video_raw_parse(param, &obs_pw_stream->format.info.raw);
+
+	output_flags = obs_source_get_output_flags(obs_pw_stream->source);
+
+	/* The buffers are reallocated for the new format, libobs must not
+	 * keep referencing the old ones */
+	if ((output_flags & OBS_SOURCE_ASYNC) && get_held_buffer_count(obs_pw_stream->pool) > 0)
+		obs_source_output_video(obs_pw_stream->source, NULL);
+
+	buffer_types = 1 << SPA_DATA_MemPtr;
+	/* MemFd buffers can be mapped by us and handed to libobs without
+	 * copying */
+	if (output_flags & OBS_SOURCE_ASYNC)
+		buffer_types |= 1 << SPA_DATA_MemFd;
+	bool has_modifier = spa_pod_find_prop(param, NULL, SPA_FORMAT_VIDEO_modifier) != NULL;
+	if ((has_modifier || check_pw_version(&obs_pw->server_version, 0, 3, 24)) &&
+	    (output_flags & OBS_SOURCE_ASYNC_VIDEO) != OBS_SOURCE_ASYNC_VIDEO) {
+		buffer_types |= 1 << SPA_DATA_DmaBuf;
+#if PW_CHECK_VERSION(1, 2, 0)
+		obs_enter_graphics();
+		supports_explicit_sync = gs_query_sync_capabilities();
+		obs_leave_graphics();
+#endif
+	}
+
+	blog(LOG_INFO, "[pipewire] Negotiated format:");
+
+	format_name = spa_debug_type_find_name(spa_type_video_format, obs_pw_stream->format.info.raw.format);
+	blog(LOG_INFO, "[pipewire]     Format: %d (%s)", obs_pw_stream->format.info.raw.format,
+	     format_name ? format_name : "unknown format");
+
+	if (has_modifier) {
+		blog(LOG_INFO, "[pipewire]     Modifier: 0x%" PRIx64, obs_pw_stream->format.info.raw.modifier);
+	}
+
+	blog(LOG_INFO, "[pipewire]     Size: %dx%d", obs_pw_stream->format.info.raw.size.width,
+	     obs_pw_stream->format.info.raw.size.height);
+
+	blog(LOG_INFO, "[pipewire]     Framerate: %d/%d", obs_pw_stream->format.info.raw.framerate.num,
+	     obs_pw_stream->format.info.raw.framerate.denom);
+
+	obs_pw_stream->buffers.types = buffer_types;
+#if PW_CHECK_VERSION(1, 2, 0)
+	obs_pw_stream->buffers.explicit_sync = supports_explicit_sync;
+#endif
+	update_buffer_params(obs_pw_stream);
 	obs_pw_stream->negotiated = true;
 }
 
+static void on_add_buffer_cb(void *user_data, struct pw_buffer *b)
+{
+	obs_pipewire_stream *obs_pw_stream = user_data;
+
+	obs_pw_stream->buffers.count++;
+
+	/* Only async frames are handed to libobs without copying */
+	if (obs_source_get_output_flags(obs_pw_stream->source) & OBS_SOURCE_ASYNC)
+		b->user_data = buffer_map_create(b);
+}
+
+static void on_remove_buffer_cb(void *user_data, struct pw_buffer *b)
+{
+	obs_pipewire_stream *obs_pw_stream = user_data;
+	struct pw_buffer_pool *pool = obs_pw_stream->pool;
+	struct pw_buffer_map *map = b->user_data;
+
+	/* Frames libobs still holds keep our mapping, the buffer itself is
+	 * not queued again */
+	pthread_mutex_lock(&pool->mutex);
+	da_erase_item(pool->requeue, &b);
+	if (map)
+		map->buffer = NULL;
+	pthread_mutex_unlock(&pool->mutex);
+
+	b->user_data = NULL;
+	buffer_map_release(map);
+
+	obs_pw_stream->buffers.count--;
+}
+
 static void on_state_changed_cb(void *user_data, enum pw_stream_state old, enum pw_stream_state state,
 				const char *error)
 {
@@ -1077,6 +1502,8 @@ static const struct pw_stream_events stream_events = {
 	PW_VERSION_STREAM_EVENTS,
 	.state_changed = on_state_changed_cb,
 	.param_changed = on_param_changed_cb,
+	.add_buffer = on_add_buffer_cb,
+	.remove_buffer = on_remove_buffer_cb,
 	.process = on_process_cb,
 };
 
@@ -1208,6 +1635,12 @@ obs_pipewire_stream *obs_pipewire_connect_stream(obs_pipewire *obs_pw, obs_sourc
 	obs_pw_stream->resolution.set = connect_info->video.resolution != NULL;
 	obs_pw_stream->sync.acquire_syncobj_fd = -1;
 	obs_pw_stream->sync.release_syncobj_fd = -1;
+	obs_pw_stream->buffers.target = POOL_DEFAULT_BUFFERS;
+
+	obs_pw_stream->pool = bzalloc(sizeof(struct pw_buffer_pool));
+	obs_pw_stream->pool->refs = 1;
+	pthread_mutex_init_value(&obs_pw_stream->pool->mutex);
+	pthread_mutex_init(&obs_pw_stream->pool->mutex, NULL);
 
 	if (obs_pw_stream->framerate.set)
 		obs_pw_stream->framerate.fraction = *connect_info->video.framerate;
@@ -1224,6 +1657,11 @@ obs_pipewire_stream *obs_pipewire_connect_stream(obs_pipewire *obs_pw, obs_sourc
 		pw_loop_add_event(pw_thread_loop_get_loop(obs_pw->thread_loop), renegotiate_format, obs_pw_stream);
 	blog(LOG_DEBUG, "[pipewire] registered event %p", obs_pw_stream->reneg);
 
+	/* Signal to queue buffers released by libobs */
+	obs_pw_stream->pool->loop = pw_thread_loop_get_loop(obs_pw->thread_loop);
+	obs_pw_stream->pool->requeue_event =
+		pw_loop_add_event(obs_pw_stream->pool->loop, requeue_released_buffers, obs_pw_stream);
+
 	/* Stream */
 	obs_pw_stream->stream = pw_stream_new(obs_pw->core, connect_info->stream_name, connect_info->stream_properties);
 	pw_stream_add_listener(obs_pw_stream->stream, &obs_pw_stream->stream_listener, &stream_events, obs_pw_stream);
@@ -1235,7 +1673,9 @@ obs_pipewire_stream *obs_pipewire_connect_stream(obs_pipewire *obs_pw, obs_sourc
 	obs_get_video_info(&obs_pw_stream->video_info);
 
 	if (!build_format_params(obs_pw_stream, &pod_builder, &params, &n_params)) {
+		pw_loop_destroy_source(obs_pw_stream->pool->loop, obs_pw_stream->pool->requeue_event);
 		pw_thread_loop_unlock(obs_pw->thread_loop);
+		buffer_pool_release(obs_pw_stream->pool);
 		bfree(obs_pw_stream);
 		return NULL;
 	}
@@ -1399,15 +1839,40 @@ void obs_pipewire_stream_set_cursor_visible(obs_pipewire_stream *obs_pw_stream,
 
 void obs_pipewire_stream_destroy(obs_pipewire_stream *obs_pw_stream)
 {
+	struct pw_buffer_pool *pool;
+	struct spa_source *requeue_event;
 	uint32_t output_flags;
 
 	if (!obs_pw_stream)
 		return;
 
+	/* No more buffers are handed out while libobs lets go of the held ones */
+	pw_thread_loop_lock(obs_pw_stream->obs_pw->thread_loop);
+	if (obs_pw_stream->stream)
+		pw_stream_set_active(obs_pw_stream->stream, false);
+	pw_thread_loop_unlock(obs_pw_stream->obs_pw->thread_loop);
+
 	output_flags = obs_source_get_output_flags(obs_pw_stream->source);
 	if (output_flags & OBS_SOURCE_ASYNC_VIDEO)
 		obs_source_output_video(obs_pw_stream->source, NULL);
 
+	blog(LOG_INFO,
+	     "[pipewire] Stream %p: %" PRIu64 " frames, %" PRIu64 " dropped, %" PRIu64 " late, %" PRIu64
+	     " bytes copied, %u buffers",
+	     obs_pw_stream->stream, obs_pw_stream->stats.frames, obs_pw_stream->stats.dropped,
+	     obs_pw_stream->stats.late, obs_pw_stream->stats.copied_bytes, obs_pw_stream->buffers.count);
+
+	/* Buffers libobs still references are not queued again, their
+	 * mappings stay valid until they are released */
+	pool = obs_pw_stream->pool;
+	pthread_mutex_lock(&pool->mutex);
+	for (size_t i = 0; i < pool->held.num; i++)
+		pool->held.array[i]->map->buffer = NULL;
+	da_resize(pool->requeue, 0);
+	requeue_event = pool->requeue_event;
+	pool->requeue_event = NULL;
+	pthread_mutex_unlock(&pool->mutex);
+
 	g_ptr_array_remove(obs_pw_stream->obs_pw->streams, obs_pw_stream);
 
 	obs_enter_graphics();
@@ -1416,11 +1881,14 @@ void obs_pipewire_stream_destroy(obs_pipewire_stream *obs_pw_stream)
 	obs_leave_graphics();
 
 	pw_thread_loop_lock(obs_pw_stream->obs_pw->thread_loop);
+	pw_loop_destroy_source(pool->loop, requeue_event);
 	if (obs_pw_stream->stream)
 		pw_stream_disconnect(obs_pw_stream->stream);
 	g_clear_pointer(&obs_pw_stream->stream, pw_stream_destroy);
 	pw_thread_loop_unlock(obs_pw_stream->obs_pw->thread_loop);
 
+	buffer_pool_release(pool);
+
 	g_clear_fd(&obs_pw_stream->sync.acquire_syncobj_fd, NULL);
 	g_clear_fd(&obs_pw_stream->sync.release_syncobj_fd, NULL);
 
@@ -1428,6 +1896,32 @@ void obs_pipewire_stream_destroy(obs_pipewire_stream *obs_pw_stream)
 	bfree(obs_pw_stream);
 }
 
+void obs_pipewire_stream_get_stats(obs_pipewire_stream *obs_pw_stream, struct obs_pipewire_stream_stats *stats)
+{
+	pw_thread_loop_lock(obs_pw_stream->obs_pw->thread_loop);
+	*stats = obs_pw_stream->stats;
+	stats->buffers = obs_pw_stream->buffers.count;
+	pw_thread_loop_unlock(obs_pw_stream->obs_pw->thread_loop);
+
+	stats->held = (uint32_t)get_held_buffer_count(obs_pw_stream->pool);
+}
+
+/* fills in the outputs of OBS_PIPEWIRE_STATS_PROC, the stream may be NULL */
+void obs_pipewire_stream_stats_to_calldata(obs_pipewire_stream *obs_pw_stream, calldata_t *cd)
+{
+	struct obs_pipewire_stream_stats stats = {0};
+
+	if (obs_pw_stream)
+		obs_pipewire_stream_get_stats(obs_pw_stream, &stats);
+
+	calldata_set_int(cd, "frames", (long long)stats.frames);
+	calldata_set_int(cd, "dropped", (long long)stats.dropped);
+	calldata_set_int(cd, "late", (long long)stats.late);
+	calldata_set_int(cd, "copied_bytes", (long long)stats.copied_bytes);
+	calldata_set_int(cd, "buffers", stats.buffers);
+	calldata_set_int(cd, "held", stats.held);
+}
+
 void obs_pipewire_stream_set_framerate(obs_pipewire_stream *obs_pw_stream, const struct spa_fraction *framerate)
 {
 	obs_pipewire *obs_pw = obs_pw_stream->obs_pw;
@@ -41,6 +41,23 @@ struct obs_pipewire_connect_stream_info {
 	} video;
 };
 
+struct obs_pipewire_stream_stats {
+	uint64_t frames;
+	/* buffers skipped because a newer one was already available */
+	uint64_t dropped;
+	/* buffers processed more than a frame interval after their timestamp */
+	uint64_t late;
+	/* bytes copied into frames or uploaded into textures */
+	uint64_t copied_bytes;
+	uint32_t buffers;
+	/* buffers handed to libobs without copying */
+	uint32_t held;
+};
+
+#define OBS_PIPEWIRE_STATS_PROC                                                                        \
+	"void get_pipewire_stats(out int frames, out int dropped, out int late, out int copied_bytes, " \
+	"out int buffers, out int held)"
+
 obs_pipewire *obs_pipewire_connect_fd(int pipewire_fd, const struct pw_registry_events *registry_events,
 				      void *user_data);
 struct pw_registry *obs_pipewire_get_registry(obs_pipewire *obs_pw);
@@ -58,6 +75,8 @@ void obs_pipewire_stream_video_render(obs_pipewire_stream *obs_pw_stream, gs_eff
 
 void obs_pipewire_stream_set_cursor_visible(obs_pipewire_stream *obs_pw_stream, bool cursor_visible);
 void obs_pipewire_stream_destroy(obs_pipewire_stream *obs_pw_stream);
+void obs_pipewire_stream_get_stats(obs_pipewire_stream *obs_pw_stream, struct obs_pipewire_stream_stats *stats);
+void obs_pipewire_stream_stats_to_calldata(obs_pipewire_stream *obs_pw_stream, calldata_t *cd);
 
 void obs_pipewire_stream_set_framerate(obs_pipewire_stream *obs_pw_stream, const struct spa_fraction *framerate);
 void obs_pipewire_stream_set_resolution(obs_pipewire_stream *obs_pw, const struct spa_rectangle *resolution);
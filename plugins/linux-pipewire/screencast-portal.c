@@ -509,6 +509,13 @@ static const char *screencast_portal_window_capture_get_name(void *data)
 	return obs_module_text("PipeWireWindowCapture");
 }
 
+static void get_pipewire_stats_proc(void *data, calldata_t *cd)
+{
+	struct screencast_portal_capture *capture = data;
+
+	obs_pipewire_stream_stats_to_calldata(capture->obs_pw_stream, cd);
+}
+
 static void *screencast_portal_desktop_capture_create(obs_data_t *settings, obs_source_t *source)
 {
 	struct screencast_portal_capture *capture;
@@ -519,6 +526,9 @@ static void *screencast_portal_desktop_capture_create(obs_data_t *settings, obs_
 	capture->restore_token = bstrdup(obs_data_get_string(settings, "RestoreToken"));
 	capture->source = source;
 
+	proc_handler_add(obs_source_get_proc_handler(source), OBS_PIPEWIRE_STATS_PROC, get_pipewire_stats_proc,
+			 capture);
+
 	init_screencast_capture(capture);
 
 	return capture;
@@ -533,6 +543,9 @@ static void *screencast_portal_window_capture_create(obs_data_t *settings, obs_s
 	capture->restore_token = bstrdup(obs_data_get_string(settings, "RestoreToken"));
 	capture->source = source;
 
+	proc_handler_add(obs_source_get_proc_handler(source), OBS_PIPEWIRE_STATS_PROC, get_pipewire_stats_proc,
+			 capture);
+
 	init_screencast_capture(capture);
 
 	return capture;
@@ -548,6 +561,9 @@ static void *screencast_portal_capture_create(obs_data_t *settings, obs_source_t
 	capture->restore_token = bstrdup(obs_data_get_string(settings, "RestoreToken"));
 	capture->source = source;
 
+	proc_handler_add(obs_source_get_proc_handler(source), OBS_PIPEWIRE_STATS_PROC, get_pipewire_stats_proc,
+			 capture);
+
 	init_screencast_capture(capture);
 
 	return capture;
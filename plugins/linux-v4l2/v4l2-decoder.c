@@ -18,6 +18,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <obs-module.h>
 #include <linux/videodev2.h>
 #include <libavutil/error.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
 
 #include "v4l2-decoder.h"
 
@@ -85,30 +88,14 @@ void v4l2_destroy_decoder(struct v4l2_decoder *decoder)
 	}
 }
 
-int v4l2_decode_frame(struct obs_source_frame *out, uint8_t *data, size_t length, struct v4l2_decoder *decoder)
+static void set_frame_data(struct obs_source_frame *out, const AVFrame *frame, enum AVPixelFormat pix_fmt)
 {
-	int r;
-	decoder->packet->data = data;
-	decoder->packet->size = length;
-	if (avcodec_send_packet(decoder->context, decoder->packet) < 0) {
-		blog(LOG_ERROR, "failed to send frame to codec");
-		return -1;
-	}
-	r = avcodec_receive_frame(decoder->context, decoder->frame);
-	if (r == AVERROR(EAGAIN)) {
-		blog(LOG_DEBUG, "failed to receive frame in this state, try to send new frame to codec");
-		return 0;
-	} else if (r < 0) {
-		blog(LOG_ERROR, "failed to receive frame from codec");
-		return -1;
-	}
-
 	for (uint_fast32_t i = 0; i < MAX_AV_PLANES; ++i) {
-		out->data[i] = decoder->frame->data[i];
-		out->linesize[i] = decoder->frame->linesize[i];
+		out->data[i] = frame->data[i];
+		out->linesize[i] = frame->linesize[i];
 	}
 
-	switch (decoder->context->pix_fmt) {
+	switch (pix_fmt) {
 	case AV_PIX_FMT_GRAY8:
 		out->format = VIDEO_FORMAT_Y800;
 		break;
@@ -127,6 +114,374 @@ int v4l2_decode_frame(struct obs_source_frame *out, uint8_t *data, size_t length
 	default:
 		break;
 	}
+}
+
+int v4l2_decode_frame(struct obs_source_frame *out, uint8_t *data, size_t length, struct v4l2_decoder *decoder)
+{
+	int r;
+	decoder->packet->data = data;
+	decoder->packet->size = length;
+	if (avcodec_send_packet(decoder->context, decoder->packet) < 0) {
+		blog(LOG_ERROR, "failed to send frame to codec");
+		return -1;
+	}
+	r = avcodec_receive_frame(decoder->context, decoder->frame);
+	if (r == AVERROR(EAGAIN)) {
+		blog(LOG_DEBUG, "failed to receive frame in this state, try to send new frame to codec");
+		return 0;
+	} else if (r < 0) {
+		blog(LOG_ERROR, "failed to receive frame from codec");
+		return -1;
+	}
+
+	set_frame_data(out, decoder->frame, decoder->context->pix_fmt);
 
 	return 0;
 }
+
+/* -------------------------------------------------------------------------- */
+/* decode pipeline                                                            */
+
+#define DECODE_THREADS_MAX 4
+
+/* slots beyond one per thread, so capture can run ahead of delivery.  H264
+ * adds slots when these are in use, since every packet has to be decoded */
+#define DECODE_SLOTS_EXTRA 3
+
+enum decode_slot_state {
+	DECODE_SLOT_FREE,
+	DECODE_SLOT_PENDING,
+	DECODE_SLOT_DECODING,
+	DECODE_SLOT_DONE,
+	DECODE_SLOT_OUTPUT,
+};
+
+struct decode_slot {
+	struct v4l2_decode_pipeline *pipeline;
+	enum decode_slot_state state;
+	uint64_t seq;
+
+	DARRAY(uint8_t) packet;
+	uint64_t timestamp;
+	uint64_t submit_time;
+
+	/* keeps the decoded planes alive until the source releases them */
+	AVFrame *frame;
+	struct obs_source_frame out;
+	bool failed;
+};
+
+struct decode_worker {
+	struct v4l2_decode_pipeline *pipeline;
+	struct v4l2_decoder decoder;
+	pthread_t thread;
+};
+
+struct v4l2_decode_pipeline {
+	volatile long refs;
+	obs_source_t *source;
+	struct obs_source_frame frame;
+
+	pthread_mutex_t mutex;
+	os_sem_t *sem;
+	bool stop;
+
+	/* slots are handed to libobs, so they are never moved */
+	DARRAY(struct decode_slot *) slots;
+	bool drop_when_full;
+	uint64_t next_submit;
+	uint64_t next_decode;
+	uint64_t next_output;
+
+	/* serializes delivery so frames are output in order */
+	pthread_mutex_t output_mutex;
+
+	struct v4l2_decode_stats stats;
+
+	struct decode_worker *workers;
+	size_t num_workers;
+};
+
+static void pipeline_release(struct v4l2_decode_pipeline *pipeline)
+{
+	if (os_atomic_dec_long(&pipeline->refs) != 0)
+		return;
+
+	for (size_t i = 0; i < pipeline->slots.num; i++) {
+		struct decode_slot *slot = pipeline->slots.array[i];
+
+		da_free(slot->packet);
+		av_frame_free(&slot->frame);
+		bfree(slot);
+	}
+
+	os_sem_destroy(pipeline->sem);
+	pthread_mutex_destroy(&pipeline->output_mutex);
+	pthread_mutex_destroy(&pipeline->mutex);
+	bfree(pipeline->workers);
+	da_free(pipeline->slots);
+	bfree(pipeline);
+}
+
+static struct decode_slot *add_slot(struct v4l2_decode_pipeline *pipeline)
+{
+	struct decode_slot *slot = bzalloc(sizeof(struct decode_slot));
+
+	slot->pipeline = pipeline;
+	slot->frame = av_frame_alloc();
+	da_push_back(pipeline->slots, &slot);
+	return slot;
+}
+
+/* slots are used in any order, seq keeps frames in capture order */
+static struct decode_slot *find_slot(struct v4l2_decode_pipeline *pipeline, enum decode_slot_state state,
+				     uint64_t seq)
+{
+	for (size_t i = 0; i < pipeline->slots.num; i++) {
+		struct decode_slot *slot = pipeline->slots.array[i];
+
+		if (slot->state == state && (state == DECODE_SLOT_FREE || slot->seq == seq))
+			return slot;
+	}
+
+	return NULL;
+}
+
+static void free_slot(struct decode_slot *slot)
+{
+	av_frame_unref(slot->frame);
+	slot->state = DECODE_SLOT_FREE;
+}
+
+/*
+ * Called by libobs once it no longer needs a decoded frame
+ */
+static void release_slot(void *param)
+{
+	struct decode_slot *slot = param;
+	struct v4l2_decode_pipeline *pipeline = slot->pipeline;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	free_slot(slot);
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	pipeline_release(pipeline);
+}
+
+/*
+ * Output all decoded frames that are next in capture order
+ */
+static void deliver_frames(struct v4l2_decode_pipeline *pipeline)
+{
+	pthread_mutex_lock(&pipeline->output_mutex);
+
+	for (;;) {
+		pthread_mutex_lock(&pipeline->mutex);
+
+		struct decode_slot *slot = find_slot(pipeline, DECODE_SLOT_DONE, pipeline->next_output);
+		if (!slot) {
+			pthread_mutex_unlock(&pipeline->mutex);
+			break;
+		}
+
+		uint64_t latency = os_gettime_ns() - slot->submit_time;
+		bool failed = slot->failed;
+
+		pipeline->next_output++;
+		pipeline->stats.queue_depth--;
+		if (failed) {
+			pipeline->stats.dropped++;
+			free_slot(slot);
+		} else {
+			pipeline->stats.decoded++;
+			pipeline->stats.latency_total_ns += latency;
+			if (latency > pipeline->stats.latency_max_ns)
+				pipeline->stats.latency_max_ns = latency;
+			slot->state = DECODE_SLOT_OUTPUT;
+		}
+
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		if (!failed) {
+			os_atomic_inc_long(&pipeline->refs);
+			obs_source_output_video_ref(pipeline->source, &slot->out, release_slot, slot);
+		}
+	}
+
+	pthread_mutex_unlock(&pipeline->output_mutex);
+}
+
+static void decode_slot(struct decode_worker *worker, struct decode_slot *slot)
+{
+	struct v4l2_decoder *decoder = &worker->decoder;
+
+	slot->out = worker->pipeline->frame;
+	slot->out.timestamp = slot->timestamp;
+
+	/* a frame is only produced if the decoder returned one for this
+	 * packet */
+	slot->failed = v4l2_decode_frame(&slot->out, slot->packet.array, slot->packet.num, decoder) < 0 ||
+		       !decoder->frame->buf[0];
+
+	if (!slot->failed)
+		av_frame_move_ref(slot->frame, decoder->frame);
+}
+
+static void *decode_thread(void *param)
+{
+	struct decode_worker *worker = param;
+	struct v4l2_decode_pipeline *pipeline = worker->pipeline;
+
+	os_set_thread_name("v4l2: decode");
+
+	while (os_sem_wait(pipeline->sem) == 0) {
+		pthread_mutex_lock(&pipeline->mutex);
+
+		if (pipeline->stop) {
+			pthread_mutex_unlock(&pipeline->mutex);
+			break;
+		}
+
+		/* every post is for a pending slot, submitted in order */
+		struct decode_slot *slot = find_slot(pipeline, DECODE_SLOT_PENDING, pipeline->next_decode);
+		pipeline->next_decode++;
+		slot->state = DECODE_SLOT_DECODING;
+
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		decode_slot(worker, slot);
+
+		pthread_mutex_lock(&pipeline->mutex);
+		slot->state = DECODE_SLOT_DONE;
+		pthread_mutex_unlock(&pipeline->mutex);
+
+		deliver_frames(pipeline);
+	}
+
+	return NULL;
+}
+
+static size_t decode_thread_count(int pixfmt)
+{
+	if (pixfmt != V4L2_PIX_FMT_MJPEG)
+		return 1;
+
+	int threads = os_get_logical_cores() / 2;
+	if (threads < 1)
+		threads = 1;
+	if (threads > DECODE_THREADS_MAX)
+		threads = DECODE_THREADS_MAX;
+
+	return (size_t)threads;
+}
+
+struct v4l2_decode_pipeline *v4l2_decode_pipeline_create(int pixfmt, obs_source_t *source,
+							 const struct obs_source_frame *frame)
+{
+	struct v4l2_decode_pipeline *pipeline = bzalloc(sizeof(struct v4l2_decode_pipeline));
+	size_t threads = decode_thread_count(pixfmt);
+
+	pipeline->refs = 1;
+	pipeline->source = source;
+	pipeline->frame = *frame;
+
+	pthread_mutex_init_value(&pipeline->mutex);
+	pthread_mutex_init_value(&pipeline->output_mutex);
+	if (pthread_mutex_init(&pipeline->mutex, NULL) != 0)
+		goto fail_mutex;
+	if (pthread_mutex_init(&pipeline->output_mutex, NULL) != 0)
+		goto fail_output_mutex;
+	if (os_sem_init(&pipeline->sem, 0) != 0)
+		goto fail_sem;
+
+	/* MJPEG frames can be skipped, H264 frames depend on each other */
+	pipeline->drop_when_full = pixfmt == V4L2_PIX_FMT_MJPEG;
+	for (size_t i = 0; i < threads + DECODE_SLOTS_EXTRA; i++)
+		add_slot(pipeline);
+
+	pipeline->workers = bzalloc(threads * sizeof(struct decode_worker));
+	for (size_t i = 0; i < threads; i++) {
+		struct decode_worker *worker = &pipeline->workers[pipeline->num_workers];
+
+		worker->pipeline = pipeline;
+		if (v4l2_init_decoder(&worker->decoder, pixfmt) < 0) {
+			v4l2_destroy_decoder(&worker->decoder);
+			break;
+		}
+		if (pthread_create(&worker->thread, NULL, decode_thread, worker) != 0) {
+			v4l2_destroy_decoder(&worker->decoder);
+			break;
+		}
+
+		pipeline->num_workers++;
+	}
+
+	if (!pipeline->num_workers) {
+		v4l2_decode_pipeline_destroy(pipeline);
+		return NULL;
+	}
+
+	blog(LOG_INFO, "decoding on %zu thread(s)", pipeline->num_workers);
+	return pipeline;
+
+fail_sem:
+	pthread_mutex_destroy(&pipeline->output_mutex);
+fail_output_mutex:
+	pthread_mutex_destroy(&pipeline->mutex);
+fail_mutex:
+	bfree(pipeline);
+	return NULL;
+}
+
+void v4l2_decode_pipeline_destroy(struct v4l2_decode_pipeline *pipeline)
+{
+	if (!pipeline)
+		return;
+
+	pthread_mutex_lock(&pipeline->mutex);
+	pipeline->stop = true;
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	for (size_t i = 0; i < pipeline->num_workers; i++)
+		os_sem_post(pipeline->sem);
+	for (size_t i = 0; i < pipeline->num_workers; i++) {
+		pthread_join(pipeline->workers[i].thread, NULL);
+		v4l2_destroy_decoder(&pipeline->workers[i].decoder);
+	}
+
+	pipeline_release(pipeline);
+}
+
+bool v4l2_decode_pipeline_submit(struct v4l2_decode_pipeline *pipeline, const uint8_t *data, size_t length,
+				 uint64_t timestamp)
+{
+	pthread_mutex_lock(&pipeline->mutex);
+
+	struct decode_slot *slot = find_slot(pipeline, DECODE_SLOT_FREE, 0);
+	if (!slot && pipeline->drop_when_full) {
+		pipeline->stats.dropped++;
+		pthread_mutex_unlock(&pipeline->mutex);
+		return false;
+	}
+	if (!slot)
+		slot = add_slot(pipeline);
+
+	da_copy_array(slot->packet, data, length);
+	slot->timestamp = timestamp;
+	slot->submit_time = os_gettime_ns();
+	slot->seq = pipeline->next_submit++;
+	slot->state = DECODE_SLOT_PENDING;
+	pipeline->stats.queue_depth++;
+
+	pthread_mutex_unlock(&pipeline->mutex);
+
+	os_sem_post(pipeline->sem);
+	return true;
+}
+
+void v4l2_decode_pipeline_get_stats(struct v4l2_decode_pipeline *pipeline, struct v4l2_decode_stats *stats)
+{
+	pthread_mutex_lock(&pipeline->mutex);
+	*stats = pipeline->stats;
+	pthread_mutex_unlock(&pipeline->mutex);
+}
@@ -21,6 +21,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern "C" {
 #endif
 
+#include <obs.h>
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
 #include <libavutil/pixfmt.h>
@@ -63,6 +64,74 @@ void v4l2_destroy_decoder(struct v4l2_decoder *decoder);
  */
 int v4l2_decode_frame(struct obs_source_frame *out, uint8_t *data, size_t length, struct v4l2_decoder *decoder);
 
+/**
+ * Decode pipeline
+ *
+ * Decodes frames on a small pool of threads so the capture thread only has to
+ * copy the packet.  MJPEG frames are decoded in parallel, one frame per
+ * thread, while H264 uses a single thread since frames depend on each other.
+ * MJPEG frames are dropped while all slots are in use, H264 packets are
+ * always queued.
+ * Decoded frames are handed to the source in capture order without a copy.
+ */
+struct v4l2_decode_pipeline;
+
+/**
+ * Decode statistics
+ */
+struct v4l2_decode_stats {
+	/** frames submitted and not yet delivered */
+	uint32_t queue_depth;
+	/** frames delivered to the source */
+	uint64_t decoded;
+	/** MJPEG frames dropped because the pipeline was full, or frames that
+	 * failed to decode */
+	uint64_t dropped;
+	/** time between submitting and delivering frames */
+	uint64_t latency_total_ns;
+	uint64_t latency_max_ns;
+};
+
+/**
+ * Create a decode pipeline.
+ *
+ * @param pixfmt which codec is used
+ * @param source the source decoded frames are output to
+ * @param frame frame data that is not changed by decoding
+ * @return the pipeline or NULL on failure
+ */
+struct v4l2_decode_pipeline *v4l2_decode_pipeline_create(int pixfmt, obs_source_t *source,
+							 const struct obs_source_frame *frame);
+
+/**
+ * Stop the decode threads and free the pipeline.
+ *
+ * Frames still used by the source are freed once the source releases them.
+ *
+ * @param pipeline the pipeline
+ */
+void v4l2_decode_pipeline_destroy(struct v4l2_decode_pipeline *pipeline);
+
+/**
+ * Queue a packet for decoding, the data is copied.
+ *
+ * @param pipeline the pipeline
+ * @param data the codec data
+ * @param length length of the data
+ * @param timestamp timestamp of the frame
+ * @return false if the frame was dropped, which only happens for MJPEG
+ */
+bool v4l2_decode_pipeline_submit(struct v4l2_decode_pipeline *pipeline, const uint8_t *data, size_t length,
+				 uint64_t timestamp);
+
+/**
+ * Get the decode statistics.
+ *
+ * @param pipeline the pipeline
+ * @param stats receives the statistics
+ */
+void v4l2_decode_pipeline_get_stats(struct v4l2_decode_pipeline *pipeline, struct v4l2_decode_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
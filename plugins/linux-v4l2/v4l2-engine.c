@@ -0,0 +1,308 @@
+/*
+Copyright (C) 2026 by agent <agent@local>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/platform.h>
+#include <util/threading.h>
+#include <obs.h>
+
+#include "v4l2-engine.h"
+
+#define blog(level, msg, ...) blog(level, "v4l2-engine: " msg, ##__VA_ARGS__)
+
+#define MAX_EVENTS 16
+
+/* epoll data of the wake eventfd, devices use their id */
+#define WAKE_ID 0
+
+struct v4l2_engine_device {
+	uint64_t id;
+	int fd;
+	bool polled;
+	volatile bool wake;
+
+	uint64_t timeout_ns;
+	uint64_t deadline;
+
+	v4l2_engine_cb callback;
+	void *param;
+};
+
+/* global data */
+static uint_fast32_t engine_refs = 0;
+static pthread_mutex_t engine_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static pthread_t engine_thread;
+static int engine_epoll_fd = -1;
+static int engine_wake_fd = -1;
+static volatile bool engine_stop;
+
+/* held by the capture thread while it calls back into devices */
+static pthread_mutex_t engine_devices_mutex = PTHREAD_MUTEX_INITIALIZER;
+static DARRAY(struct v4l2_engine_device *) engine_devices;
+static uint64_t engine_next_id = WAKE_ID + 1;
+
+static struct v4l2_engine_device *find_device(uint64_t id)
+{
+	for (size_t i = 0; i < engine_devices.num; i++) {
+		if (engine_devices.array[i]->id == id)
+			return engine_devices.array[i];
+	}
+
+	return NULL;
+}
+
+/* call with engine_devices_mutex held */
+static int next_timeout_ms(uint64_t now)
+{
+	uint64_t next = 0;
+
+	for (size_t i = 0; i < engine_devices.num; i++) {
+		struct v4l2_engine_device *device = engine_devices.array[i];
+
+		if (device->polled && device->timeout_ns && (!next || device->deadline < next))
+			next = device->deadline;
+	}
+
+	if (!next)
+		return -1;
+	if (next <= now)
+		return 0;
+	return (int)((next - now + 999999) / 1000000);
+}
+
+static void stop_polling(struct v4l2_engine_device *device)
+{
+	epoll_ctl(engine_epoll_fd, EPOLL_CTL_DEL, device->fd, NULL);
+	device->polled = false;
+}
+
+static void handle_device_event(const struct epoll_event *ev, uint64_t now)
+{
+	struct v4l2_engine_device *device = find_device(ev->data.u64);
+
+	/* removed after epoll_wait returned */
+	if (!device || !device->polled)
+		return;
+
+	if (ev->events & (EPOLLERR | EPOLLHUP)) {
+		stop_polling(device);
+		device->callback(device->param, V4L2_ENGINE_ERROR);
+		return;
+	}
+
+	device->deadline = now + device->timeout_ns;
+	device->callback(device->param, V4L2_ENGINE_READY);
+}
+
+static void handle_wake(void)
+{
+	for (size_t i = 0; i < engine_devices.num; i++) {
+		struct v4l2_engine_device *device = engine_devices.array[i];
+
+		if (os_atomic_set_bool(&device->wake, false))
+			device->callback(device->param, V4L2_ENGINE_WAKE);
+	}
+}
+
+static void handle_timeouts(uint64_t now)
+{
+	for (size_t i = 0; i < engine_devices.num; i++) {
+		struct v4l2_engine_device *device = engine_devices.array[i];
+
+		if (!device->polled || !device->timeout_ns || device->deadline > now)
+			continue;
+
+		device->deadline = now + device->timeout_ns;
+		device->callback(device->param, V4L2_ENGINE_TIMEOUT);
+	}
+}
+
+/**
+ * Capture thread
+ */
+static void *v4l2_engine_thread(void *vptr)
+{
+	UNUSED_PARAMETER(vptr);
+
+	struct epoll_event events[MAX_EVENTS];
+	int timeout;
+
+	os_set_thread_name("v4l2: capture");
+
+	pthread_mutex_lock(&engine_devices_mutex);
+	timeout = next_timeout_ms(os_gettime_ns());
+	pthread_mutex_unlock(&engine_devices_mutex);
+
+	while (!os_atomic_load_bool(&engine_stop)) {
+		int count = epoll_wait(engine_epoll_fd, events, MAX_EVENTS, timeout);
+		bool wake = false;
+
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			blog(LOG_ERROR, "epoll_wait failed: %s", strerror(errno));
+			break;
+		}
+
+		pthread_mutex_lock(&engine_devices_mutex);
+
+		uint64_t now = os_gettime_ns();
+
+		for (int i = 0; i < count; i++) {
+			if (events[i].data.u64 == WAKE_ID) {
+				eventfd_t value;
+				eventfd_read(engine_wake_fd, &value);
+				wake = true;
+			} else {
+				handle_device_event(&events[i], now);
+			}
+		}
+
+		if (wake)
+			handle_wake();
+
+		handle_timeouts(now);
+		timeout = next_timeout_ms(os_gettime_ns());
+
+		pthread_mutex_unlock(&engine_devices_mutex);
+	}
+
+	return NULL;
+}
+
+static bool engine_start(void)
+{
+	struct epoll_event ev = {.events = EPOLLIN, .data.u64 = WAKE_ID};
+
+	engine_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (engine_epoll_fd < 0)
+		goto fail;
+	engine_wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (engine_wake_fd < 0)
+		goto fail;
+	if (epoll_ctl(engine_epoll_fd, EPOLL_CTL_ADD, engine_wake_fd, &ev) < 0)
+		goto fail;
+
+	engine_stop = false;
+	if (pthread_create(&engine_thread, NULL, v4l2_engine_thread, NULL) != 0)
+		goto fail;
+
+	return true;
+
+fail:
+	blog(LOG_ERROR, "Failed to start capture thread: %s", strerror(errno));
+	if (engine_wake_fd >= 0)
+		close(engine_wake_fd);
+	if (engine_epoll_fd >= 0)
+		close(engine_epoll_fd);
+	engine_wake_fd = -1;
+	engine_epoll_fd = -1;
+	return false;
+}
+
+static void engine_shutdown(void)
+{
+	os_atomic_set_bool(&engine_stop, true);
+	eventfd_write(engine_wake_fd, 1);
+	pthread_join(engine_thread, NULL);
+
+	close(engine_wake_fd);
+	close(engine_epoll_fd);
+	engine_wake_fd = -1;
+	engine_epoll_fd = -1;
+	da_free(engine_devices);
+}
+
+struct v4l2_engine_device *v4l2_engine_add(int fd, uint64_t timeout_ns, v4l2_engine_cb callback, void *param)
+{
+	struct v4l2_engine_device *device = NULL;
+
+	pthread_mutex_lock(&engine_mutex);
+
+	if (engine_refs == 0 && !engine_start())
+		goto fail;
+
+	device = bzalloc(sizeof(*device));
+	device->fd = fd;
+	device->timeout_ns = timeout_ns;
+	device->deadline = os_gettime_ns() + timeout_ns;
+	device->callback = callback;
+	device->param = param;
+	device->polled = true;
+
+	pthread_mutex_lock(&engine_devices_mutex);
+
+	device->id = engine_next_id++;
+
+	struct epoll_event ev = {.events = EPOLLIN | EPOLLPRI, .data.u64 = device->id};
+	if (epoll_ctl(engine_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+		pthread_mutex_unlock(&engine_devices_mutex);
+		blog(LOG_ERROR, "Failed to add device to epoll: %s", strerror(errno));
+		bfree(device);
+		device = NULL;
+
+		if (engine_refs == 0)
+			engine_shutdown();
+		goto fail;
+	}
+
+	da_push_back(engine_devices, &device);
+	pthread_mutex_unlock(&engine_devices_mutex);
+
+	/* recompute the epoll timeout with the new device */
+	eventfd_write(engine_wake_fd, 1);
+	engine_refs++;
+
+fail:
+	pthread_mutex_unlock(&engine_mutex);
+	return device;
+}
+
+void v4l2_engine_remove(struct v4l2_engine_device *device)
+{
+	if (!device)
+		return;
+
+	pthread_mutex_lock(&engine_mutex);
+
+	pthread_mutex_lock(&engine_devices_mutex);
+	if (device->polled)
+		stop_polling(device);
+	da_erase_item(engine_devices, &device);
+	pthread_mutex_unlock(&engine_devices_mutex);
+
+	bfree(device);
+
+	if (--engine_refs == 0)
+		engine_shutdown();
+
+	pthread_mutex_unlock(&engine_mutex);
+}
+
+void v4l2_engine_wake(struct v4l2_engine_device *device)
+{
+	os_atomic_set_bool(&device->wake, true);
+	eventfd_write(engine_wake_fd, 1);
+}
@@ -0,0 +1,83 @@
+/*
+Copyright (C) 2026 by agent <agent@local>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Shared capture thread
+ *
+ * All capture devices are multiplexed through a single epoll loop instead of
+ * each source running its own thread.
+ */
+struct v4l2_engine_device;
+
+enum v4l2_engine_event {
+	/** the device has a buffer ready to be dequeued */
+	V4L2_ENGINE_READY,
+	/** v4l2_engine_wake was called for the device */
+	V4L2_ENGINE_WAKE,
+	/** nothing happened on the device within its timeout */
+	V4L2_ENGINE_TIMEOUT,
+	/** the device reported an error, it will not be polled anymore */
+	V4L2_ENGINE_ERROR,
+};
+
+typedef void (*v4l2_engine_cb)(void *param, enum v4l2_engine_event event);
+
+/**
+ * Add a device to the capture thread
+ *
+ * The callback is always called from the capture thread.
+ *
+ * @param fd file descriptor of the device
+ * @param timeout_ns time without frames before V4L2_ENGINE_TIMEOUT is sent,
+ *                   or 0 for no timeout
+ * @param callback callback for device events
+ * @param param user data for the callback
+ *
+ * @return the device handle or NULL on failure
+ */
+struct v4l2_engine_device *v4l2_engine_add(int fd, uint64_t timeout_ns, v4l2_engine_cb callback, void *param);
+
+/**
+ * Remove a device from the capture thread
+ *
+ * Once this returns the callback is no longer running and will not be called
+ * again.  Must not be called from the callback.
+ *
+ * @param device the device handle
+ */
+void v4l2_engine_remove(struct v4l2_engine_device *device);
+
+/**
+ * Send V4L2_ENGINE_WAKE to the device on the capture thread
+ *
+ * Can be called from any thread, including the callback.
+ *
+ * @param device the device handle
+ */
+void v4l2_engine_wake(struct v4l2_engine_device *device);
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,7 +17,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <inttypes.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <linux/dma-buf.h>
 
 #include <util/bmem.h>
 
@@ -25,23 +29,94 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #define blog(level, msg, ...) blog(level, "v4l2-helpers: " msg, ##__VA_ARGS__)
 
-int_fast32_t v4l2_start_capture(int_fast32_t dev, struct v4l2_buffer_data *buf)
+uint32_t v4l2_get_capture_type(int_fast32_t dev)
 {
-	enum v4l2_buf_type type;
+	struct v4l2_capability cap;
+	uint32_t caps;
+
+	if (v4l2_ioctl(dev, VIDIOC_QUERYCAP, &cap) < 0)
+		return V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+#ifndef V4L2_CAP_DEVICE_CAPS
+	caps = cap.capabilities;
+#else
+	caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+#endif
+
+	if (!(caps & V4L2_CAP_VIDEO_CAPTURE) && (caps & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
+		return V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+	return V4L2_BUF_TYPE_VIDEO_CAPTURE;
+}
+
+static inline bool is_mplane(const struct v4l2_buffer_data *buf)
+{
+	return buf->type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+}
+
+static void init_buffer(const struct v4l2_buffer_data *buf, struct v4l2_buffer *out, struct v4l2_plane *planes)
+{
+	memset(out, 0, sizeof(*out));
+	out->type = buf->type;
+	out->memory = V4L2_MEMORY_MMAP;
+
+	if (is_mplane(buf)) {
+		memset(planes, 0, sizeof(struct v4l2_plane) * VIDEO_MAX_PLANES);
+		out->m.planes = planes;
+		out->length = VIDEO_MAX_PLANES;
+	}
+}
+
+int_fast32_t v4l2_queue_buffer(int_fast32_t dev, struct v4l2_buffer_data *buf, uint32_t index)
+{
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
 	struct v4l2_buffer enq;
 
-	memset(&enq, 0, sizeof(enq));
-	enq.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-	enq.memory = V4L2_MEMORY_MMAP;
+	init_buffer(buf, &enq, planes);
+	enq.index = index;
+	if (is_mplane(buf))
+		enq.length = buf->planes;
 
-	for (enq.index = 0; enq.index < buf->count; ++enq.index) {
-		if (v4l2_ioctl(dev, VIDIOC_QBUF, &enq) < 0) {
+	return v4l2_ioctl(dev, VIDIOC_QBUF, &enq);
+}
+
+int_fast32_t v4l2_dequeue_buffer(int_fast32_t dev, struct v4l2_buffer_data *buf, struct v4l2_buffer *out,
+				 struct v4l2_plane *planes)
+{
+	init_buffer(buf, out, planes);
+	return v4l2_ioctl(dev, VIDIOC_DQBUF, out);
+}
+
+void v4l2_sync_buffer(struct v4l2_buffer_data *buf, uint32_t index, bool start)
+{
+#ifdef DMA_BUF_IOCTL_SYNC
+	struct dma_buf_sync sync = {
+		.flags = (start ? DMA_BUF_SYNC_START : DMA_BUF_SYNC_END) | DMA_BUF_SYNC_READ,
+	};
+
+	if (!buf->dmabuf)
+		return;
+
+	for (uint_fast32_t i = 0; i < buf->planes; ++i)
+		ioctl(v4l2_buffer_plane(buf, index, i)->dmabuf_fd, DMA_BUF_IOCTL_SYNC, &sync);
+#else
+	UNUSED_PARAMETER(buf);
+	UNUSED_PARAMETER(index);
+	UNUSED_PARAMETER(start);
+#endif
+}
+
+int_fast32_t v4l2_start_capture(int_fast32_t dev, struct v4l2_buffer_data *buf)
+{
+	enum v4l2_buf_type type;
+
+	for (uint32_t i = 0; i < buf->count; ++i) {
+		if (v4l2_queue_buffer(dev, buf, i) < 0) {
 			blog(LOG_ERROR, "unable to queue buffer");
 			return -1;
 		}
 	}
 
-	type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	type = buf->type;
 	if (v4l2_ioctl(dev, VIDIOC_STREAMON, &type) < 0) {
 		blog(LOG_ERROR, "unable to start stream");
 		return -1;
@@ -50,11 +125,11 @@ int_fast32_t v4l2_start_capture(int_fast32_t dev, struct v4l2_buffer_data *buf)
 	return 0;
 }
 
-int_fast32_t v4l2_stop_capture(int_fast32_t dev)
+int_fast32_t v4l2_stop_capture(int_fast32_t dev, struct v4l2_buffer_data *buf)
 {
 	enum v4l2_buf_type type;
 
-	type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	type = buf->type;
 	if (v4l2_ioctl(dev, VIDIOC_STREAMOFF, &type) < 0) {
 		blog(LOG_ERROR, "unable to stop stream");
 		return -1;
@@ -66,7 +141,7 @@ int_fast32_t v4l2_stop_capture(int_fast32_t dev)
 int_fast32_t v4l2_reset_capture(int_fast32_t dev, struct v4l2_buffer_data *buf)
 {
 	blog(LOG_DEBUG, "attempting to reset capture");
-	if (v4l2_stop_capture(dev) < 0)
+	if (v4l2_stop_capture(dev, buf) < 0)
 		return -1;
 	if (v4l2_start_capture(dev, buf) < 0)
 		return -1;
@@ -77,21 +152,22 @@ int_fast32_t v4l2_reset_capture(int_fast32_t dev, struct v4l2_buffer_data *buf)
 #ifdef _DEBUG
 int_fast32_t v4l2_query_all_buffers(int_fast32_t dev, struct v4l2_buffer_data *buf_data)
 {
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
 	struct v4l2_buffer buf;
 
 	blog(LOG_DEBUG, "attempting to read buffer data for %" PRIuFAST32 " buffers", buf_data->count);
 
 	for (uint_fast32_t i = 0; i < buf_data->count; i++) {
+		init_buffer(buf_data, &buf, planes);
 		buf.index = i;
-		buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		buf.memory = V4L2_MEMORY_MMAP;
 		if (v4l2_ioctl(dev, VIDIOC_QUERYBUF, &buf) < 0) {
 			blog(LOG_DEBUG, "failed to read buffer data for buffer #%" PRIuFAST32, i);
 		} else {
 			blog(LOG_DEBUG,
 			     "query buf #%" PRIuFAST32
 			     " info: ts: %06ld buf id #%d, flags 0x%08X, seq #%d, len %d, used %d",
-			     i, buf.timestamp.tv_usec, buf.index, buf.flags, buf.sequence, buf.length, buf.bytesused);
+			     i, buf.timestamp.tv_usec, buf.index, buf.flags, buf.sequence, buf.length,
+			     is_mplane(buf_data) ? planes[0].bytesused : buf.bytesused);
 		}
 	}
 
@@ -99,14 +175,63 @@ int_fast32_t v4l2_query_all_buffers(int_fast32_t dev, struct v4l2_buffer_data *b
 }
 #endif
 
+/* the dma-buf path maps the exported buffer directly, so it is only usable if
+ * libv4l2 is not converting the format behind our back */
+static bool export_plane(int_fast32_t dev, struct v4l2_buffer_data *buf, uint32_t index, uint_fast32_t plane,
+			 struct v4l2_mmap_info *info)
+{
+	struct v4l2_exportbuffer exp;
+
+	memset(&exp, 0, sizeof(exp));
+	exp.type = buf->type;
+	exp.index = index;
+	exp.plane = plane;
+	exp.flags = O_RDONLY | O_CLOEXEC;
+
+	if (v4l2_ioctl(dev, VIDIOC_EXPBUF, &exp) < 0)
+		return false;
+
+	info->start = mmap(NULL, info->length, PROT_READ, MAP_SHARED, exp.fd, 0);
+	if (info->start == MAP_FAILED) {
+		close(exp.fd);
+		return false;
+	}
+
+	info->dmabuf_fd = exp.fd;
+	return true;
+}
+
+static bool map_plane(int_fast32_t dev, struct v4l2_buffer_data *buf, uint32_t index, uint_fast32_t plane,
+		      uint32_t offset)
+{
+	struct v4l2_mmap_info *info = v4l2_buffer_plane(buf, index, plane);
+
+	if (buf->dmabuf) {
+		if (export_plane(dev, buf, index, plane, info))
+			return true;
+
+		if (index != 0 || plane != 0) {
+			blog(LOG_ERROR, "Failed to export buffer as dma-buf");
+			return false;
+		}
+
+		blog(LOG_INFO, "Device does not support dma-buf export, using mmap");
+		buf->dmabuf = false;
+	}
+
+	info->start = v4l2_mmap(NULL, info->length, PROT_READ | PROT_WRITE, MAP_SHARED, dev, offset);
+	return info->start != MAP_FAILED;
+}
+
 int_fast32_t v4l2_create_mmap(int_fast32_t dev, struct v4l2_buffer_data *buf)
 {
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
 	struct v4l2_requestbuffers req;
 	struct v4l2_buffer map;
 
 	memset(&req, 0, sizeof(req));
-	req.count = 4;
-	req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	req.count = V4L2_CAPTURE_BUFFERS;
+	req.type = buf->type;
 	req.memory = V4L2_MEMORY_MMAP;
 
 	if (v4l2_ioctl(dev, VIDIOC_REQBUFS, &req) < 0) {
@@ -119,26 +244,38 @@ int_fast32_t v4l2_create_mmap(int_fast32_t dev, struct v4l2_buffer_data *buf)
 		return -1;
 	}
 
+	init_buffer(buf, &map, planes);
+	map.index = 0;
+	if (v4l2_ioctl(dev, VIDIOC_QUERYBUF, &map) < 0) {
+		blog(LOG_ERROR, "Failed to query buffer details");
+		return -1;
+	}
+
 	buf->count = req.count;
-	buf->info = bzalloc(req.count * sizeof(struct v4l2_mmap_info));
+	buf->planes = is_mplane(buf) ? map.length : 1;
+	buf->info = bzalloc(req.count * buf->planes * sizeof(struct v4l2_mmap_info));
+	for (uint_fast32_t i = 0; i < req.count * buf->planes; ++i)
+		buf->info[i].dmabuf_fd = -1;
 
-	memset(&map, 0, sizeof(map));
-	map.type = req.type;
-	map.memory = req.memory;
+	for (uint32_t index = 0; index < req.count; ++index) {
+		init_buffer(buf, &map, planes);
+		map.index = index;
 
-	for (map.index = 0; map.index < req.count; ++map.index) {
 		if (v4l2_ioctl(dev, VIDIOC_QUERYBUF, &map) < 0) {
 			blog(LOG_ERROR, "Failed to query buffer details");
 			return -1;
 		}
 
-		buf->info[map.index].length = map.length;
-		buf->info[map.index].start =
-			v4l2_mmap(NULL, map.length, PROT_READ | PROT_WRITE, MAP_SHARED, dev, map.m.offset);
+		for (uint_fast32_t plane = 0; plane < buf->planes; ++plane) {
+			struct v4l2_mmap_info *info = v4l2_buffer_plane(buf, index, plane);
+			uint32_t offset = is_mplane(buf) ? planes[plane].m.mem_offset : map.m.offset;
 
-		if (buf->info[map.index].start == MAP_FAILED) {
-			blog(LOG_ERROR, "mmap for buffer failed");
-			return -1;
+			info->length = is_mplane(buf) ? planes[plane].length : map.length;
+
+			if (!map_plane(dev, buf, index, plane, offset)) {
+				blog(LOG_ERROR, "mmap for buffer failed");
+				return -1;
+			}
 		}
 	}
 
@@ -147,9 +284,18 @@ int_fast32_t v4l2_create_mmap(int_fast32_t dev, struct v4l2_buffer_data *buf)
 
 int_fast32_t v4l2_destroy_mmap(struct v4l2_buffer_data *buf)
 {
-	for (uint_fast32_t i = 0; i < buf->count; ++i) {
-		if (buf->info[i].start != MAP_FAILED && buf->info[i].start != 0)
-			v4l2_munmap(buf->info[i].start, buf->info[i].length);
+	for (uint_fast32_t i = 0; i < buf->count * buf->planes; ++i) {
+		struct v4l2_mmap_info *info = &buf->info[i];
+
+		if (info->start == MAP_FAILED || info->start == 0)
+			continue;
+
+		if (info->dmabuf_fd != -1) {
+			munmap(info->start, info->length);
+			close(info->dmabuf_fd);
+		} else {
+			v4l2_munmap(info->start, info->length);
+		}
 	}
 
 	if (buf->count) {
@@ -189,7 +335,8 @@ int_fast32_t v4l2_get_input_caps(int_fast32_t dev, int input, uint32_t *caps)
 	return 0;
 }
 
-int_fast32_t v4l2_set_format(int_fast32_t dev, int64_t *resolution, int *pixelformat, int *bytesperline)
+int_fast32_t v4l2_set_format(int_fast32_t dev, uint32_t type, int64_t *resolution, int *pixelformat,
+			     int *bytesperline)
 {
 	bool set = false;
 	int width, height;
@@ -199,11 +346,36 @@ int_fast32_t v4l2_set_format(int_fast32_t dev, int64_t *resolution, int *pixelfo
 		return -1;
 
 	/* We need to set the type in order to query the settings */
-	fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	memset(&fmt, 0, sizeof(fmt));
+	fmt.type = type;
 
 	if (v4l2_ioctl(dev, VIDIOC_G_FMT, &fmt) < 0)
 		return -1;
 
+	if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+		struct v4l2_pix_format_mplane *pix = &fmt.fmt.pix_mp;
+
+		if (*resolution != -1) {
+			v4l2_unpack_tuple(&width, &height, *resolution);
+			pix->width = width;
+			pix->height = height;
+			set = true;
+		}
+
+		if (*pixelformat != -1) {
+			pix->pixelformat = *pixelformat;
+			set = true;
+		}
+
+		if (set && (v4l2_ioctl(dev, VIDIOC_S_FMT, &fmt) < 0))
+			return -1;
+
+		*resolution = v4l2_pack_tuple(pix->width, pix->height);
+		*pixelformat = pix->pixelformat;
+		*bytesperline = pix->plane_fmt[0].bytesperline;
+		return 0;
+	}
+
 	if (*resolution != -1) {
 		v4l2_unpack_tuple(&width, &height, *resolution);
 		fmt.fmt.pix.width = width;
@@ -225,7 +397,7 @@ int_fast32_t v4l2_set_format(int_fast32_t dev, int64_t *resolution, int *pixelfo
 	return 0;
 }
 
-int_fast32_t v4l2_set_framerate(int_fast32_t dev, int64_t *framerate)
+int_fast32_t v4l2_set_framerate(int_fast32_t dev, uint32_t type, int64_t *framerate)
 {
 	bool set = false;
 	int num, denom;
@@ -235,7 +407,7 @@ int_fast32_t v4l2_set_framerate(int_fast32_t dev, int64_t *framerate)
 		return -1;
 
 	/* We need to set the type in order to query the stream settings */
-	par.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	par.type = type;
 
 	if (v4l2_ioctl(dev, VIDIOC_G_PARM, &par) < 0)
 		return -1;
@@ -30,6 +30,9 @@ extern "C" {
 
 #define PACK64(a, b) (((uint64_t)a << 32) | ((uint64_t)b & 0xffffffff))
 
+/* enough for the device to keep capturing while a few frames are in use */
+#define V4L2_CAPTURE_BUFFERS 6
+
 /**
  * Data structure for mapped buffers
  */
@@ -38,6 +41,8 @@ struct v4l2_mmap_info {
 	size_t length;
 	/** start address of the mapped buffer */
 	void *start;
+	/** exported dma-buf the buffer is mapped through, or -1 */
+	int dmabuf_fd;
 };
 
 /**
@@ -46,10 +51,25 @@ struct v4l2_mmap_info {
 struct v4l2_buffer_data {
 	/** number of mapped buffers */
 	uint_fast32_t count;
-	/** memory info for mapped buffers */
+	/** number of planes in each buffer */
+	uint_fast32_t planes;
+	/** single or multi-planar capture buffer type */
+	uint32_t type;
+	/** try to export the buffers as dma-bufs and map those */
+	bool dmabuf;
+	/** memory info for mapped buffers, one per plane of each buffer */
 	struct v4l2_mmap_info *info;
 };
 
+/**
+ * Get the mapping of a plane of a buffer
+ */
+static inline struct v4l2_mmap_info *v4l2_buffer_plane(struct v4l2_buffer_data *buf, uint32_t index,
+						       uint_fast32_t plane)
+{
+	return &buf->info[index * buf->planes + plane];
+}
+
 /**
  * Convert v4l2 pixel format to obs video format
  *
@@ -67,10 +87,13 @@ static inline enum video_format v4l2_to_obs_video_format(uint_fast32_t format)
 	case V4L2_PIX_FMT_UYVY:
 		return VIDEO_FORMAT_UYVY;
 	case V4L2_PIX_FMT_NV12:
+	case V4L2_PIX_FMT_NV12M:
 		return VIDEO_FORMAT_NV12;
 	case V4L2_PIX_FMT_YUV420:
+	case V4L2_PIX_FMT_YUV420M:
 		return VIDEO_FORMAT_I420;
 	case V4L2_PIX_FMT_YVU420:
+	case V4L2_PIX_FMT_YVU420M:
 		return VIDEO_FORMAT_I420;
 #ifdef V4L2_PIX_FMT_XBGR32
 	case V4L2_PIX_FMT_XBGR32:
@@ -168,6 +191,16 @@ static void v4l2_unpack_tuple(int32_t *a, int32_t *b, int64_t packed)
 	}
 }
 
+/**
+ * Get the buffer type to capture with.
+ *
+ * @param dev handle for the v4l2 device
+ *
+ * @return V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE if the device only supports the
+ *         multi-planar api, V4L2_BUF_TYPE_VIDEO_CAPTURE otherwise
+ */
+uint32_t v4l2_get_capture_type(int_fast32_t dev);
+
 /**
  * Start the video capture on the device.
  *
@@ -185,10 +218,47 @@ int_fast32_t v4l2_start_capture(int_fast32_t dev, struct v4l2_buffer_data *buf);
  * Stop the video capture on the device.
  *
  * @param dev handle for the v4l2 device
+ * @param buf buffer data
+ *
+ * @return negative on failure
+ */
+int_fast32_t v4l2_stop_capture(int_fast32_t dev, struct v4l2_buffer_data *buf);
+
+/**
+ * Enqueue a buffer.
+ *
+ * @param dev handle for the v4l2 device
+ * @param buf buffer data
+ * @param index index of the buffer
  *
  * @return negative on failure
  */
-int_fast32_t v4l2_stop_capture(int_fast32_t dev);
+int_fast32_t v4l2_queue_buffer(int_fast32_t dev, struct v4l2_buffer_data *buf, uint32_t index);
+
+/**
+ * Dequeue a filled buffer.
+ *
+ * For multi-planar capture the plane info is returned in planes, which must
+ * hold VIDEO_MAX_PLANES entries.
+ *
+ * @param dev handle for the v4l2 device
+ * @param buf buffer data
+ * @param out the dequeued buffer
+ * @param planes the planes of the dequeued buffer
+ *
+ * @return negative on failure, errno is set to EAGAIN if no buffer is ready
+ */
+int_fast32_t v4l2_dequeue_buffer(int_fast32_t dev, struct v4l2_buffer_data *buf, struct v4l2_buffer *out,
+				 struct v4l2_plane *planes);
+
+/**
+ * Begin or end CPU access to a buffer that is mapped through a dma-buf.
+ *
+ * @param buf buffer data
+ * @param index index of the buffer
+ * @param start true before reading the buffer, false when done
+ */
+void v4l2_sync_buffer(struct v4l2_buffer_data *buf, uint32_t index, bool start);
 
 /**
  * Resets video capture on the device.
@@ -220,7 +290,10 @@ int_fast32_t v4l2_query_all_buffers(int_fast32_t dev, struct v4l2_buffer_data *b
 /**
  * Create memory mapping for buffers
  *
- * This tries to map at least 2, preferably 4, buffers to application memory.
+ * This tries to map at least 2, preferably V4L2_CAPTURE_BUFFERS, buffers to
+ * application memory.  buf->type must be set, and if buf->dmabuf is set the
+ * buffers are exported as dma-bufs and mapped through those when the device
+ * supports it; buf->dmabuf is cleared otherwise.
  *
  * @param dev handle for the v4l2 device
  * @param buf buffer data
@@ -268,13 +341,15 @@ int_fast32_t v4l2_get_input_caps(int_fast32_t dev, int input, uint32_t *caps);
  * to the used values.
  *
  * @param dev handle for the v4l2 device
+ * @param type single or multi-planar capture buffer type
  * @param resolution packed value of the resolution or -1 to leave as is
  * @param pixelformat index of the pixelformat or -1 to leave as is
  * @param bytesperline this will be set accordingly on success
  *
  * @return negative on failure
  */
-int_fast32_t v4l2_set_format(int_fast32_t dev, int64_t *resolution, int *pixelformat, int *bytesperline);
+int_fast32_t v4l2_set_format(int_fast32_t dev, uint32_t type, int64_t *resolution, int *pixelformat,
+			     int *bytesperline);
 
 /**
  * Set the framerate on the device.
@@ -282,11 +357,12 @@ int_fast32_t v4l2_set_format(int_fast32_t dev, int64_t *resolution, int *pixelfo
  * If the action succeeds framerate is set to the used value.
  *
  * @param dev handle to the v4l2 device
+ * @param type single or multi-planar capture buffer type
  * @param framerate packed value of the framerate or -1 to leave as is
  *
  * @return negative on failure
  */
-int_fast32_t v4l2_set_framerate(int_fast32_t dev, int64_t *framerate);
+int_fast32_t v4l2_set_framerate(int_fast32_t dev, uint32_t type, int64_t *framerate);
 
 /**
  * Set a video standard on the device.
@@ -24,13 +24,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/ioctl.h>
-#include <sys/select.h>
 
 #include <linux/videodev2.h>
 #include <libv4l2.h>
 
 #include <util/threading.h>
 #include <util/bmem.h>
+#include <util/darray.h>
 #include <util/dstr.h>
 #include <util/platform.h>
 #include <obs-module.h>
@@ -38,6 +38,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "v4l2-controls.h"
 #include "v4l2-helpers.h"
 #include "v4l2-decoder.h"
+#include "v4l2-engine.h"
 
 #define FALLBACK_FRAMERATE 30
 
@@ -79,22 +80,68 @@ struct v4l2_data {
 
 	/* internal data */
 	obs_source_t *source;
-	pthread_t thread;
-	os_event_t *event;
-	struct v4l2_decoder decoder;
+	struct v4l2_session *session;
+	struct v4l2_decode_pipeline *pipeline;
+	pthread_mutex_t pipeline_mutex;
 
 	bool framerate_unchanged;
 	bool resolution_unchanged;
 	int_fast32_t dev;
+	uint32_t capture_type;
 	int width;
 	int height;
 	int linesize;
-	struct v4l2_buffer_data buffers;
 
 	bool auto_reset;
 	int timeout_frames;
 };
 
+/**
+ * A buffer that is handed to libobs without copying
+ */
+struct v4l2_held_buffer {
+	struct v4l2_session *session;
+	uint32_t index;
+	bool held;
+};
+
+/**
+ * Capture state of a running stream
+ *
+ * This outlives the source while libobs still references captured buffers,
+ * the device and its mappings are only released with the last reference.
+ */
+struct v4l2_session {
+	volatile long refs;
+
+	/* only used on the capture thread */
+	struct v4l2_data *data;
+	struct obs_source_frame out;
+	size_t plane_offsets[MAX_AV_PLANES];
+	uint_fast32_t queued;
+	uint64_t first_ts;
+
+	int_fast32_t dev;
+	struct v4l2_buffer_data buffers;
+	struct v4l2_held_buffer *held;
+	struct v4l2_engine_device *device;
+
+	/* buffers released by libobs, waiting to be queued again */
+	pthread_mutex_t mutex;
+	DARRAY(uint32_t) requeue;
+	bool streaming;
+
+	/* statistics */
+	uint64_t frames;
+	uint64_t dropped;
+	uint64_t errors;
+	uint64_t copied;
+	uint64_t latency_count;
+	uint64_t latency_total;
+	uint64_t latency_max;
+	uint32_t last_sequence;
+};
+
 /* forward declarations */
 static void v4l2_init(struct v4l2_data *data);
 static void v4l2_terminate(struct v4l2_data *data);
@@ -111,7 +158,8 @@ static void v4l2_update(void *vptr, obs_data_t *settings);
  *
  * v4l2 uses a continuous memory segment for all planes so we simply compute
  * offsets to add to the start address in order to give obs the correct data
- * pointers for the individual planes.
+ * pointers for the individual planes.  The multi-planar formats are mapped
+ * separately and ignore the offsets if the device uses one buffer per plane.
  *
  */
 static void v4l2_prep_obs_frame(struct v4l2_data *data, struct obs_source_frame *frame, size_t *plane_offsets)
@@ -130,11 +178,13 @@ static void v4l2_prep_obs_frame(struct v4l2_data *data, struct obs_source_frame
 
 	switch (data->pixfmt) {
 	case V4L2_PIX_FMT_NV12:
+	case V4L2_PIX_FMT_NV12M:
 		frame->linesize[0] = data->linesize;
 		frame->linesize[1] = data->linesize;
 		plane_offsets[1] = data->linesize * data->height;
 		break;
 	case V4L2_PIX_FMT_YVU420:
+	case V4L2_PIX_FMT_YVU420M:
 		frame->linesize[0] = data->linesize;
 		frame->linesize[1] = data->linesize / 2;
 		frame->linesize[2] = data->linesize / 2;
@@ -142,6 +192,7 @@ static void v4l2_prep_obs_frame(struct v4l2_data *data, struct obs_source_frame
 		plane_offsets[2] = data->linesize * data->height;
 		break;
 	case V4L2_PIX_FMT_YUV420:
+	case V4L2_PIX_FMT_YUV420M:
 		frame->linesize[0] = data->linesize;
 		frame->linesize[1] = data->linesize / 2;
 		frame->linesize[2] = data->linesize / 2;
@@ -154,135 +205,260 @@ static void v4l2_prep_obs_frame(struct v4l2_data *data, struct obs_source_frame
 	}
 }
 
+static struct v4l2_session *v4l2_session_create(struct v4l2_data *data)
+{
+	struct v4l2_session *session = bzalloc(sizeof(struct v4l2_session));
+
+	session->refs = 1;
+	session->data = data;
+	session->dev = data->dev;
+	session->buffers.type = data->capture_type;
+	pthread_mutex_init_value(&session->mutex);
+	if (pthread_mutex_init(&session->mutex, NULL) != 0) {
+		bfree(session);
+		return NULL;
+	}
+
+	/* the session closes the device, it has to stay open while buffers
+	 * are mapped */
+	data->dev = -1;
+	return session;
+}
+
+static void v4l2_session_release(struct v4l2_session *session)
+{
+	if (os_atomic_dec_long(&session->refs) != 0)
+		return;
+
+	v4l2_destroy_mmap(&session->buffers);
+	if (session->dev != -1)
+		v4l2_close(session->dev);
+
+	da_free(session->requeue);
+	pthread_mutex_destroy(&session->mutex);
+	bfree(session->held);
+	bfree(session);
+}
+
+static void v4l2_session_queue(struct v4l2_session *session, uint32_t index)
+{
+	v4l2_sync_buffer(&session->buffers, index, false);
+
+	if (v4l2_queue_buffer(session->dev, &session->buffers, index) < 0) {
+		blog(LOG_ERROR, "%s: failed to enqueue buffer", session->data->device_id);
+		return;
+	}
+
+	session->queued++;
+}
+
 /*
- * Worker thread to get video data
+ * Called by libobs once it no longer needs a buffer
  */
-static void *v4l2_thread(void *vptr)
+static void v4l2_release_buffer(void *param)
 {
-	V4L2_DATA(vptr);
-	int r;
-	fd_set fds;
-	uint8_t *start;
-	uint64_t frames;
-	uint64_t first_ts;
-	struct timeval tv;
-	struct v4l2_buffer buf;
-	struct obs_source_frame out;
-	size_t plane_offsets[MAX_AV_PLANES];
-	int fps_num, fps_denom;
-	float ffps;
-	uint64_t timeout_usec;
+	struct v4l2_held_buffer *held = param;
+	struct v4l2_session *session = held->session;
 
-	blog(LOG_DEBUG, "%s: new capture thread", data->device_id);
-	os_set_thread_name("v4l2: capture");
+	pthread_mutex_lock(&session->mutex);
+	held->held = false;
+	da_push_back(session->requeue, &held->index);
+	if (session->streaming)
+		v4l2_engine_wake(session->device);
+	pthread_mutex_unlock(&session->mutex);
 
-	/* Get framerate and calculate appropriate select timeout value. */
-	v4l2_unpack_tuple(&fps_num, &fps_denom, data->framerate);
-	ffps = (float)fps_denom / fps_num;
-	blog(LOG_DEBUG, "%s: framerate: %.2f fps", data->device_id, ffps);
-	/* Timeout set to 5 frame periods. */
-	timeout_usec = (1000000 * data->timeout_frames) / ffps;
-	blog(LOG_INFO, "%s: select timeout set to %" PRIu64 " (%dx frame periods)", data->device_id, timeout_usec,
-	     data->timeout_frames);
+	v4l2_session_release(session);
+}
 
-	if (v4l2_start_capture(data->dev, &data->buffers) < 0)
-		goto exit;
+static void v4l2_requeue_buffers(struct v4l2_session *session)
+{
+	pthread_mutex_lock(&session->mutex);
+	for (size_t i = 0; i < session->requeue.num; ++i)
+		v4l2_session_queue(session, session->requeue.array[i]);
+	da_resize(session->requeue, 0);
+	pthread_mutex_unlock(&session->mutex);
+}
 
-	blog(LOG_DEBUG, "%s: new capture started", data->device_id);
+/*
+ * Restart the stream, keeping the buffers libobs still uses dequeued
+ */
+static int_fast32_t v4l2_restart_capture(struct v4l2_session *session)
+{
+	enum v4l2_buf_type type = session->buffers.type;
 
-	frames = 0;
-	first_ts = 0;
-	v4l2_prep_obs_frame(data, &out, plane_offsets);
+	if (v4l2_stop_capture(session->dev, &session->buffers) < 0)
+		return -1;
 
-	blog(LOG_DEBUG, "%s: obs frame prepared", data->device_id);
+	pthread_mutex_lock(&session->mutex);
+	da_resize(session->requeue, 0);
+	session->queued = 0;
+	for (uint32_t i = 0; i < session->buffers.count; ++i) {
+		if (!session->held[i].held)
+			v4l2_session_queue(session, i);
+	}
+	pthread_mutex_unlock(&session->mutex);
 
-	while (os_event_try(data->event) == EAGAIN) {
-		FD_ZERO(&fds);
-		FD_SET(data->dev, &fds);
+	return v4l2_ioctl(session->dev, VIDIOC_STREAMON, &type);
+}
 
-		/* Set timeout timevalue. */
-		tv.tv_sec = 0;
-		tv.tv_usec = timeout_usec;
+static void v4l2_set_frame_planes(struct v4l2_session *session, const struct v4l2_buffer *buf,
+				  const struct v4l2_plane *planes)
+{
+	struct v4l2_data *data = session->data;
+	struct obs_source_frame *out = &session->out;
 
-		r = select(data->dev + 1, &fds, NULL, NULL, &tv);
-		if (r < 0) {
-			if (errno == EINTR)
-				continue;
-			blog(LOG_ERROR, "%s: select failed", data->device_id);
-			break;
-		} else if (r == 0) {
-			blog(LOG_ERROR, "%s: select timed out", data->device_id);
+	if (session->buffers.planes == 1) {
+		uint8_t *start = v4l2_buffer_plane(&session->buffers, buf->index, 0)->start;
 
-#ifdef _DEBUG
-			v4l2_query_all_buffers(data->dev, &data->buffers);
-#endif
+		for (uint_fast32_t i = 0; i < MAX_AV_PLANES; ++i)
+			out->data[i] = start + session->plane_offsets[i];
+		return;
+	}
 
-			if (v4l2_ioctl(data->dev, VIDIOC_LOG_STATUS) < 0) {
-				blog(LOG_ERROR, "%s: failed to log status", data->device_id);
-			}
+	for (uint_fast32_t i = 0; i < MAX_AV_PLANES; ++i) {
+		uint_fast32_t plane = i;
 
-			if (data->auto_reset) {
-				if (v4l2_reset_capture(data->dev, &data->buffers) == 0)
-					blog(LOG_INFO, "%s: stream reset successful", data->device_id);
-				else
-					blog(LOG_ERROR, "%s: failed to reset", data->device_id);
-			}
+		/* obs expects the u plane first */
+		if (data->pixfmt == V4L2_PIX_FMT_YVU420M && (i == 1 || i == 2))
+			plane = 3 - i;
 
+		if (plane >= session->buffers.planes) {
+			out->data[i] = NULL;
 			continue;
 		}
 
-		buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-		buf.memory = V4L2_MEMORY_MMAP;
+		uint8_t *start = v4l2_buffer_plane(&session->buffers, buf->index, plane)->start;
+		out->data[i] = start + planes[plane].data_offset;
+	}
+}
+
+/*
+ * Dequeue a buffer and hand it to obs
+ *
+ * Raw buffers are passed on without a copy as long as enough buffers remain
+ * queued for the device to keep capturing, they are queued again once libobs
+ * releases them.
+ */
+static void v4l2_capture_frame(struct v4l2_session *session)
+{
+	struct v4l2_data *data = session->data;
+	struct obs_source_frame *out = &session->out;
+	struct v4l2_plane planes[VIDEO_MAX_PLANES];
+	struct v4l2_buffer buf;
+	uint32_t bytesused;
+	uint8_t *start;
 
-		if (v4l2_ioctl(data->dev, VIDIOC_DQBUF, &buf) < 0) {
-			if (errno == EAGAIN) {
-				blog(LOG_DEBUG, "%s: ioctl dqbuf eagain", data->device_id);
-				continue;
-			}
-			blog(LOG_ERROR, "%s: failed to dequeue buffer", data->device_id);
-			break;
+	if (v4l2_dequeue_buffer(session->dev, &session->buffers, &buf, planes) < 0) {
+		if (errno == EAGAIN) {
+			blog(LOG_DEBUG, "%s: ioctl dqbuf eagain", data->device_id);
+			return;
 		}
+		blog(LOG_ERROR, "%s: failed to dequeue buffer", data->device_id);
+		return;
+	}
+	session->queued--;
 
-		blog(LOG_DEBUG, "%s: ts: %06ld buf id #%d, flags 0x%08X, seq #%d, len %d, used %d", data->device_id,
-		     buf.timestamp.tv_usec, buf.index, buf.flags, buf.sequence, buf.length, buf.bytesused);
+	bytesused = (session->buffers.type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) ? planes[0].bytesused
+										      : buf.bytesused;
 
-		if (buf.flags & V4L2_BUF_FLAG_ERROR) {
-			blog(LOG_DEBUG, "skipping decoding of buffer with recoverable error-flag set");
-			goto continue_queue_buffer;
-		}
+	blog(LOG_DEBUG, "%s: ts: %06ld buf id #%d, flags 0x%08X, seq #%d, len %d, used %d", data->device_id,
+	     buf.timestamp.tv_usec, buf.index, buf.flags, buf.sequence, buf.length, bytesused);
+
+	if (session->frames && buf.sequence > session->last_sequence + 1)
+		session->dropped += buf.sequence - session->last_sequence - 1;
+	session->last_sequence = buf.sequence;
 
-		out.timestamp = timeval2ns(buf.timestamp);
-		if (!frames)
-			first_ts = out.timestamp;
-		out.timestamp -= first_ts;
+	if (buf.flags & V4L2_BUF_FLAG_ERROR) {
+		blog(LOG_DEBUG, "skipping decoding of buffer with recoverable error-flag set");
+		session->errors++;
+		v4l2_session_queue(session, buf.index);
+		return;
+	}
 
-		start = (uint8_t *)data->buffers.info[buf.index].start;
+	out->timestamp = timeval2ns(buf.timestamp);
 
-		if (data->pixfmt == V4L2_PIX_FMT_MJPEG || data->pixfmt == V4L2_PIX_FMT_H264) {
-			if (v4l2_decode_frame(&out, start, buf.bytesused, &data->decoder) < 0) {
-				blog(LOG_ERROR, "failed to unpack jpeg or h264");
-				break;
-			}
-		} else {
-			for (uint_fast32_t i = 0; i < MAX_AV_PLANES; ++i)
-				out.data[i] = start + plane_offsets[i];
-		}
-		obs_source_output_video(data->source, &out);
+	if ((buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+		uint64_t now = os_gettime_ns();
+		uint64_t latency = now > out->timestamp ? now - out->timestamp : 0;
 
-	continue_queue_buffer:
-		if (v4l2_ioctl(data->dev, VIDIOC_QBUF, &buf) < 0) {
-			blog(LOG_ERROR, "%s: failed to enqueue buffer", data->device_id);
-			break;
-		}
+		session->latency_total += latency;
+		session->latency_count++;
+		if (latency > session->latency_max)
+			session->latency_max = latency;
+	}
+
+	if (!session->frames)
+		session->first_ts = out->timestamp;
+	out->timestamp -= session->first_ts;
+	session->frames++;
+
+	v4l2_sync_buffer(&session->buffers, buf.index, true);
+
+	if (data->pixfmt == V4L2_PIX_FMT_MJPEG || data->pixfmt == V4L2_PIX_FMT_H264) {
+		start = v4l2_buffer_plane(&session->buffers, buf.index, 0)->start;
+		v4l2_decode_pipeline_submit(data->pipeline, start, bytesused, out->timestamp);
 
-		frames++;
+		v4l2_session_queue(session, buf.index);
+		return;
+	}
+
+	v4l2_set_frame_planes(session, &buf, planes);
+
+	/* the device would run dry, copy instead */
+	if (session->queued < 2) {
+		obs_source_output_video(data->source, out);
+		v4l2_session_queue(session, buf.index);
+		session->copied++;
+		return;
 	}
 
-	blog(LOG_INFO, "%s: Stopped capture after %" PRIu64 " frames", data->device_id, frames);
+	struct v4l2_held_buffer *held = &session->held[buf.index];
+
+	pthread_mutex_lock(&session->mutex);
+	held->held = true;
+	pthread_mutex_unlock(&session->mutex);
+
+	os_atomic_inc_long(&session->refs);
+	obs_source_output_video_ref(data->source, out, v4l2_release_buffer, held);
+}
+
+/*
+ * Device events from the capture thread
+ */
+static void v4l2_engine_event(void *param, enum v4l2_engine_event event)
+{
+	struct v4l2_session *session = param;
+	struct v4l2_data *data = session->data;
+
+	switch (event) {
+	case V4L2_ENGINE_READY:
+		v4l2_capture_frame(session);
+		break;
+	case V4L2_ENGINE_WAKE:
+		v4l2_requeue_buffers(session);
+		break;
+	case V4L2_ENGINE_TIMEOUT:
+		blog(LOG_ERROR, "%s: capture timed out", data->device_id);
 
-exit:
-	v4l2_stop_capture(data->dev);
-	return NULL;
+#ifdef _DEBUG
+		v4l2_query_all_buffers(session->dev, &session->buffers);
+#endif
+
+		if (v4l2_ioctl(session->dev, VIDIOC_LOG_STATUS) < 0) {
+			blog(LOG_ERROR, "%s: failed to log status", data->device_id);
+		}
+
+		if (data->auto_reset) {
+			if (v4l2_restart_capture(session) == 0)
+				blog(LOG_INFO, "%s: stream reset successful", data->device_id);
+			else
+				blog(LOG_ERROR, "%s: failed to reset", data->device_id);
+		}
+		break;
+	case V4L2_ENGINE_ERROR:
+		blog(LOG_ERROR, "%s: device error, capture stopped", data->device_id);
+		break;
+	}
 }
 
 static const char *v4l2_getname(void *unused)
@@ -388,7 +564,7 @@ static void v4l2_device_list(obs_property_t *prop, obs_data_t *settings)
 		caps = (video_cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? video_cap.device_caps : video_cap.capabilities;
 #endif
 
-		if (!(caps & V4L2_CAP_VIDEO_CAPTURE)) {
+		if (!(caps & (V4L2_CAP_VIDEO_CAPTURE | V4L2_CAP_VIDEO_CAPTURE_MPLANE))) {
 			blog(LOG_INFO, "%s seems to not support video capture", device.array);
 			v4l2_close(fd);
 			continue;
@@ -445,7 +621,7 @@ static void v4l2_input_list(int_fast32_t dev, obs_property_t *prop)
 static void v4l2_format_list(int dev, obs_property_t *prop)
 {
 	struct v4l2_fmtdesc fmt;
-	fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+	fmt.type = v4l2_get_capture_type(dev);
 	fmt.index = 0;
 	struct dstr buffer;
 	dstr_init(&buffer);
@@ -831,17 +1007,57 @@ static obs_properties_t *v4l2_properties(void *vptr)
 
 static void v4l2_terminate(struct v4l2_data *data)
 {
-	if (data->thread) {
-		os_event_signal(data->event);
-		pthread_join(data->thread, NULL);
-		os_event_destroy(data->event);
-		data->thread = 0;
-	}
+	struct v4l2_session *session = data->session;
 
-	if (data->pixfmt == V4L2_PIX_FMT_MJPEG || data->pixfmt == V4L2_PIX_FMT_H264) {
-		v4l2_destroy_decoder(&data->decoder);
+	if (session) {
+		bool streaming;
+
+		pthread_mutex_lock(&session->mutex);
+		streaming = session->streaming;
+		session->streaming = false;
+		pthread_mutex_unlock(&session->mutex);
+
+		v4l2_engine_remove(session->device);
+		session->device = NULL;
+
+		if (data->pipeline) {
+			struct v4l2_decode_pipeline *pipeline = data->pipeline;
+			struct v4l2_decode_stats stats;
+
+			pthread_mutex_lock(&data->pipeline_mutex);
+			data->pipeline = NULL;
+			pthread_mutex_unlock(&data->pipeline_mutex);
+
+			v4l2_decode_pipeline_get_stats(pipeline, &stats);
+			v4l2_decode_pipeline_destroy(pipeline);
+
+			blog(LOG_INFO,
+			     "%s: Decoded %" PRIu64 " frames (%" PRIu64 " dropped), latency avg %.2f ms, max %.2f ms",
+			     data->device_id, stats.decoded, stats.dropped,
+			     stats.decoded ? (double)stats.latency_total_ns / stats.decoded / 1000000.0 : 0.0,
+			     (double)stats.latency_max_ns / 1000000.0);
+		}
+
+		if (streaming) {
+			v4l2_stop_capture(session->dev, &session->buffers);
+
+			double latency_avg = 0.0;
+			if (session->latency_count)
+				latency_avg = (double)session->latency_total / session->latency_count / 1000000.0;
+			blog(LOG_INFO,
+			     "%s: Stopped capture after %" PRIu64 " frames (%" PRIu64 " dropped, %" PRIu64
+			     " errors, %" PRIu64 " copied), latency avg %.2f ms, max %.2f ms",
+			     data->device_id, session->frames, session->dropped, session->errors, session->copied,
+			     latency_avg, (double)session->latency_max / 1000000.0);
+
+			/* drop the frames libobs still holds so the buffers
+			 * and the device are released */
+			obs_source_output_video(data->source, NULL);
+		}
+
+		v4l2_session_release(session);
+		data->session = NULL;
 	}
-	v4l2_destroy_mmap(&data->buffers);
 
 	if (data->dev != -1) {
 		v4l2_close(data->dev);
@@ -857,6 +1073,7 @@ static void v4l2_destroy(void *vptr)
 		return;
 
 	v4l2_terminate(data);
+	pthread_mutex_destroy(&data->pipeline_mutex);
 
 	if (data->device_id)
 		bfree(data->device_id);
@@ -873,6 +1090,24 @@ static void v4l2_destroy(void *vptr)
 	bfree(data);
 }
 
+/*
+ * Check if libv4l2 converts the format from another one
+ */
+static bool v4l2_format_emulated(int_fast32_t dev, uint32_t type, int pixfmt)
+{
+	struct v4l2_fmtdesc fmt;
+	fmt.type = type;
+	fmt.index = 0;
+
+	while (v4l2_ioctl(dev, VIDIOC_ENUM_FMT, &fmt) == 0) {
+		if (fmt.pixelformat == (uint32_t)pixfmt)
+			return (fmt.flags & V4L2_FMT_FLAG_EMULATED) != 0;
+		fmt.index++;
+	}
+
+	return false;
+}
+
 /**
  * Initialize the v4l2 device
  *
@@ -881,12 +1116,14 @@ static void v4l2_destroy(void *vptr)
  * - sets pixelformat and requested resolution
  * - sets the requested framerate
  * - maps the buffers
- * - starts the capture thread
+ * - adds the device to the capture thread
  */
 static void v4l2_init(struct v4l2_data *data)
 {
+	struct v4l2_session *session;
 	uint32_t input_caps;
 	int fps_num, fps_denom;
+	uint64_t timeout_ns;
 
 	blog(LOG_INFO, "Start capture from %s", data->device_id);
 	data->dev = v4l2_open(data->device_id, O_RDWR | O_NONBLOCK);
@@ -926,7 +1163,8 @@ static void v4l2_init(struct v4l2_data *data)
 	}
 
 	/* set pixel format and resolution */
-	if (v4l2_set_format(data->dev, &data->resolution, &data->pixfmt, &data->linesize) < 0) {
+	data->capture_type = v4l2_get_capture_type(data->dev);
+	if (v4l2_set_format(data->dev, data->capture_type, &data->resolution, &data->pixfmt, &data->linesize) < 0) {
 		blog(LOG_ERROR, "Unable to set format");
 		goto fail;
 	}
@@ -941,7 +1179,7 @@ static void v4l2_init(struct v4l2_data *data)
 	blog(LOG_INFO, "Linesize: %d Bytes", data->linesize);
 
 	/* set framerate */
-	if (v4l2_set_framerate(data->dev, &data->framerate) < 0) {
+	if (v4l2_set_framerate(data->dev, data->capture_type, &data->framerate) < 0) {
 		blog(LOG_ERROR, "Unable to set framerate");
 		goto fail;
 	}
@@ -953,22 +1191,52 @@ static void v4l2_init(struct v4l2_data *data)
 	blog(LOG_INFO, "Framerate: %.2f fps", (float)fps_denom / fps_num);
 
 	/* map buffers */
-	if (v4l2_create_mmap(data->dev, &data->buffers) < 0) {
+	data->session = session = v4l2_session_create(data);
+	if (!session)
+		goto fail;
+
+	session->buffers.dmabuf = !v4l2_format_emulated(session->dev, data->capture_type, data->pixfmt);
+	if (v4l2_create_mmap(session->dev, &session->buffers) < 0) {
 		blog(LOG_ERROR, "Failed to map buffers");
 		goto fail;
 	}
+	blog(LOG_INFO, "Buffers: %" PRIuFAST32 " with %" PRIuFAST32 " plane(s)%s", session->buffers.count,
+	     session->buffers.planes, session->buffers.dmabuf ? ", dma-buf" : "");
+
+	session->held = bzalloc(session->buffers.count * sizeof(struct v4l2_held_buffer));
+	for (uint32_t i = 0; i < session->buffers.count; ++i) {
+		session->held[i].session = session;
+		session->held[i].index = i;
+	}
+
+	/* start capturing on the capture thread */
+	v4l2_prep_obs_frame(data, &session->out, session->plane_offsets);
 
 	if (data->pixfmt == V4L2_PIX_FMT_MJPEG || data->pixfmt == V4L2_PIX_FMT_H264) {
-		if (v4l2_init_decoder(&data->decoder, data->pixfmt) < 0) {
+		struct v4l2_decode_pipeline *pipeline =
+			v4l2_decode_pipeline_create(data->pixfmt, data->source, &session->out);
+		if (!pipeline) {
 			blog(LOG_ERROR, "Failed to initialize decoder");
 			goto fail;
 		}
+
+		pthread_mutex_lock(&data->pipeline_mutex);
+		data->pipeline = pipeline;
+		pthread_mutex_unlock(&data->pipeline_mutex);
 	}
 
-	/* start the capture thread */
-	if (os_event_init(&data->event, OS_EVENT_TYPE_MANUAL) != 0)
+	if (v4l2_start_capture(session->dev, &session->buffers) < 0)
 		goto fail;
-	if (pthread_create(&data->thread, NULL, v4l2_thread, data) != 0)
+	session->queued = session->buffers.count;
+	session->streaming = true;
+
+	/* Timeout set to timeout_frames frame periods. */
+	timeout_ns = (uint64_t)data->timeout_frames * 1000000000ULL * fps_num / fps_denom;
+	blog(LOG_INFO, "%s: timeout set to %" PRIu64 " ns (%dx frame periods)", data->device_id, timeout_ns,
+	     data->timeout_frames);
+
+	session->device = v4l2_engine_add(session->dev, timeout_ns, v4l2_engine_event, session);
+	if (!session->device)
 		goto fail;
 	return;
 fail:
@@ -1064,6 +1332,27 @@ static void v4l2_update(void *vptr, obs_data_t *settings)
 		v4l2_init(data);
 }
 
+/*
+ * Decode statistics of mjpeg and h264 sources, latencies are in milliseconds
+ */
+static void v4l2_get_decode_stats(void *vptr, calldata_t *cd)
+{
+	V4L2_DATA(vptr);
+	struct v4l2_decode_stats stats = {0};
+
+	pthread_mutex_lock(&data->pipeline_mutex);
+	if (data->pipeline)
+		v4l2_decode_pipeline_get_stats(data->pipeline, &stats);
+	pthread_mutex_unlock(&data->pipeline_mutex);
+
+	calldata_set_int(cd, "queue_depth", stats.queue_depth);
+	calldata_set_float(cd, "latency_avg",
+			   stats.decoded ? (double)stats.latency_total_ns / stats.decoded / 1000000.0 : 0.0);
+	calldata_set_float(cd, "latency_max", (double)stats.latency_max_ns / 1000000.0);
+	calldata_set_int(cd, "decoded", (long long)stats.decoded);
+	calldata_set_int(cd, "dropped", (long long)stats.dropped);
+}
+
 static void *v4l2_create(obs_data_t *settings, obs_source_t *source)
 {
 	struct v4l2_data *data = bzalloc(sizeof(struct v4l2_data));
@@ -1071,6 +1360,17 @@ static void *v4l2_create(obs_data_t *settings, obs_source_t *source)
 	data->source = source;
 	data->resolution_unchanged = false;
 	data->framerate_unchanged = false;
+	pthread_mutex_init_value(&data->pipeline_mutex);
+	if (pthread_mutex_init(&data->pipeline_mutex, NULL) != 0) {
+		bfree(data);
+		return NULL;
+	}
+
+	proc_handler_t *ph = obs_source_get_proc_handler(source);
+	proc_handler_add(ph,
+			 "void get_decode_stats(out int queue_depth, out float latency_avg, out float latency_max, "
+			 "out int decoded, out int dropped)",
+			 v4l2_get_decode_stats, data);
 
 	/* Bitch about build problems ... */
 #ifndef V4L2_CAP_DEVICE_CAPS
@@ -1098,7 +1398,7 @@ static void *v4l2_create(obs_data_t *settings, obs_source_t *source)
 struct obs_source_info v4l2_input = {
 	.id = "v4l2_input",
 	.type = OBS_SOURCE_TYPE_INPUT,
-	.output_flags = OBS_SOURCE_ASYNC_VIDEO | OBS_SOURCE_DO_NOT_DUPLICATE,
+	.output_flags = OBS_SOURCE_ASYNC_VIDEO | OBS_SOURCE_DO_NOT_DUPLICATE | OBS_SOURCE_PARALLEL_CREATE,
 	.get_name = v4l2_getname,
 	.create = v4l2_create,
 	.destroy = v4l2_destroy,
@@ -3,19 +3,63 @@
 #include <obs-module.h>
 #include <util/dstr.h>
 #include <util/platform.h>
+#include <util/threading.h>
+#include <util/util_uint64.h>
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <dirent.h>
+#include <inttypes.h>
 #include <errno.h>
 #include <string.h>
 
+/* frames waiting for the device, the oldest is dropped when full */
+#define VCAM_QUEUE_FRAMES 3
+/* buffers requested from the device in streaming mode */
+#define VCAM_DEVICE_BUFFERS 4
+
+struct virtualcam_frame {
+	uint8_t *data;
+	uint64_t timestamp;
+};
+
+struct virtualcam_buffer {
+	void *start;
+	size_t length;
+	bool queued;
+};
+
 struct virtualcam_data {
 	obs_output_t *output;
 	int device;
+	uint32_t width;
 	uint32_t frame_size;
+	uint64_t frame_interval;
 	bool use_caps_workaround;
+
+	/* streaming i/o, write() is used if the device does not support it */
+	bool streaming;
+	struct virtualcam_buffer buffers[VCAM_DEVICE_BUFFERS];
+	uint32_t num_buffers;
+	bool device_error;
+
+	pthread_t thread;
+	bool thread_active;
+	os_event_t *event;
+	volatile bool stop;
+
+	pthread_mutex_t mutex;
+	struct virtualcam_frame queue[VCAM_QUEUE_FRAMES];
+	size_t queue_start;
+	size_t queue_size;
+	uint8_t *write_data;
+
+	uint64_t frames;
+	uint64_t dropped;
+	uint64_t late;
 };
 
 static const char *virtualcam_name(void *unused)
@@ -31,6 +75,7 @@ static void virtualcam_destroy(void *data)
 	if (vcam->device >= 0)
 		close(vcam->device);
 
+	pthread_mutex_destroy(&vcam->mutex);
 	bfree(data);
 }
 
@@ -138,10 +183,277 @@ static void *virtualcam_create(obs_data_t *settings, obs_output_t *output)
 	vcam->output = output;
 	vcam->device = -1;
 
+	pthread_mutex_init_value(&vcam->mutex);
+	if (pthread_mutex_init(&vcam->mutex, NULL) != 0) {
+		bfree(vcam);
+		return NULL;
+	}
+
 	UNUSED_PARAMETER(settings);
 	return vcam;
 }
 
+static void free_frames(struct virtualcam_data *vcam)
+{
+	for (size_t i = 0; i < VCAM_QUEUE_FRAMES; i++) {
+		bfree(vcam->queue[i].data);
+		vcam->queue[i].data = NULL;
+	}
+	bfree(vcam->write_data);
+	vcam->write_data = NULL;
+	vcam->queue_start = 0;
+	vcam->queue_size = 0;
+}
+
+static void alloc_frames(struct virtualcam_data *vcam)
+{
+	for (size_t i = 0; i < VCAM_QUEUE_FRAMES; i++)
+		vcam->queue[i].data = bmalloc(vcam->frame_size);
+	vcam->write_data = bmalloc(vcam->frame_size);
+	vcam->frames = 0;
+	vcam->dropped = 0;
+	vcam->late = 0;
+}
+
+static void unmap_buffers(struct virtualcam_data *vcam)
+{
+	for (uint32_t i = 0; i < vcam->num_buffers; i++)
+		munmap(vcam->buffers[i].start, vcam->buffers[i].length);
+	vcam->num_buffers = 0;
+}
+
+/*
+ * Request and map output buffers for streaming i/o
+ */
+static bool map_buffers(struct virtualcam_data *vcam)
+{
+	struct v4l2_requestbuffers req = {0};
+
+	req.count = VCAM_DEVICE_BUFFERS;
+	req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	req.memory = V4L2_MEMORY_MMAP;
+
+	if (ioctl(vcam->device, VIDIOC_REQBUFS, &req) < 0 || req.count < 2)
+		return false;
+	if (req.count > VCAM_DEVICE_BUFFERS)
+		req.count = VCAM_DEVICE_BUFFERS;
+
+	for (uint32_t i = 0; i < req.count; i++) {
+		struct v4l2_buffer buf = {0};
+		struct virtualcam_buffer *buffer = &vcam->buffers[i];
+
+		buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+		buf.memory = V4L2_MEMORY_MMAP;
+		buf.index = i;
+
+		if (ioctl(vcam->device, VIDIOC_QUERYBUF, &buf) < 0 || buf.length < vcam->frame_size)
+			goto fail;
+
+		buffer->length = buf.length;
+		buffer->start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, vcam->device, buf.m.offset);
+		if (buffer->start == MAP_FAILED)
+			goto fail;
+
+		buffer->queued = false;
+		vcam->num_buffers++;
+	}
+
+	return true;
+
+fail:
+	unmap_buffers(vcam);
+	req.count = 0;
+	ioctl(vcam->device, VIDIOC_REQBUFS, &req);
+	return false;
+}
+
+/* poll() and DQBUF return at once while the device is in an error state, so
+ * wait out a frame interval instead of retrying in a loop */
+static void device_error_backoff(struct virtualcam_data *vcam)
+{
+	if (!vcam->device_error)
+		blog(LOG_WARNING, "Virtual camera device is not returning buffers, retrying");
+	vcam->device_error = true;
+
+	os_sleep_ms((uint32_t)(vcam->frame_interval / 1000000) + 1);
+}
+
+/*
+ * Find a buffer that is not queued, dequeuing one once the consumer is done
+ * with it.  Returns -1 if none became available within the timeout.
+ */
+static int get_free_buffer(struct virtualcam_data *vcam)
+{
+	for (uint32_t i = 0; i < vcam->num_buffers; i++) {
+		if (!vcam->buffers[i].queued)
+			return (int)i;
+	}
+
+	struct pollfd pfd = {.fd = vcam->device, .events = POLLOUT};
+	int ret = poll(&pfd, 1, 100);
+	if (ret == 0 || (ret < 0 && errno == EINTR))
+		return -1;
+
+	if (ret > 0 && !(pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+		struct v4l2_buffer buf = {0};
+		buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+		buf.memory = V4L2_MEMORY_MMAP;
+
+		if (ioctl(vcam->device, VIDIOC_DQBUF, &buf) == 0) {
+			if (buf.index < vcam->num_buffers) {
+				vcam->buffers[buf.index].queued = false;
+				vcam->device_error = false;
+				return (int)buf.index;
+			}
+		} else if (errno == EAGAIN || errno == EINTR) {
+			return -1;
+		}
+	}
+
+	device_error_backoff(vcam);
+	return -1;
+}
+
+static bool queue_buffer(struct virtualcam_data *vcam, int index, const uint8_t *data, uint64_t timestamp)
+{
+	struct v4l2_buffer buf = {0};
+
+	memcpy(vcam->buffers[index].start, data, vcam->frame_size);
+
+	buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+	buf.memory = V4L2_MEMORY_MMAP;
+	buf.index = index;
+	buf.bytesused = vcam->frame_size;
+	buf.field = V4L2_FIELD_NONE;
+	buf.timestamp.tv_sec = timestamp / 1000000000;
+	buf.timestamp.tv_usec = (timestamp % 1000000000) / 1000;
+
+	if (ioctl(vcam->device, VIDIOC_QBUF, &buf) < 0)
+		return false;
+
+	vcam->buffers[index].queued = true;
+	return true;
+}
+
+static void write_frame(struct virtualcam_data *vcam, const uint8_t *data)
+{
+	uint32_t frame_size = vcam->frame_size;
+	while (frame_size > 0) {
+		ssize_t written = write(vcam->device, data, vcam->frame_size);
+		if (written == -1)
+			break;
+		frame_size -= written;
+	}
+}
+
+/* takes the oldest queued frame, swapping its storage with write_data */
+static bool pop_frame(struct virtualcam_data *vcam, uint64_t *timestamp)
+{
+	bool success = false;
+
+	pthread_mutex_lock(&vcam->mutex);
+	if (vcam->queue_size) {
+		struct virtualcam_frame *frame = &vcam->queue[vcam->queue_start];
+		uint8_t *data = frame->data;
+
+		frame->data = vcam->write_data;
+		vcam->write_data = data;
+		*timestamp = frame->timestamp;
+
+		vcam->queue_start = (vcam->queue_start + 1) % VCAM_QUEUE_FRAMES;
+		vcam->queue_size--;
+		success = true;
+	}
+	pthread_mutex_unlock(&vcam->mutex);
+
+	return success;
+}
+
+static bool frame_pending(struct virtualcam_data *vcam)
+{
+	pthread_mutex_lock(&vcam->mutex);
+	bool pending = vcam->queue_size > 0;
+	pthread_mutex_unlock(&vcam->mutex);
+
+	return pending;
+}
+
+static void *virtualcam_thread(void *data)
+{
+	struct virtualcam_data *vcam = (struct virtualcam_data *)data;
+	uint64_t timestamp;
+
+	os_set_thread_name("v4l2: virtualcam");
+
+	while (os_event_wait(vcam->event) == 0 && !os_atomic_load_bool(&vcam->stop)) {
+		while (frame_pending(vcam) && !os_atomic_load_bool(&vcam->stop)) {
+			int index = -1;
+
+			/* wait for a buffer before taking the frame, so the
+			 * newest frame is the one written once the consumer
+			 * catches up; the oldest ones are dropped meanwhile */
+			if (vcam->streaming) {
+				index = get_free_buffer(vcam);
+				if (index < 0)
+					continue;
+			}
+
+			if (!pop_frame(vcam, &timestamp))
+				break;
+
+			if (vcam->streaming) {
+				if (!queue_buffer(vcam, index, vcam->write_data, timestamp)) {
+					blog(LOG_WARNING, "Failed to queue virtual camera frame (%s)", strerror(errno));
+					continue;
+				}
+			} else {
+				write_frame(vcam, vcam->write_data);
+			}
+
+			if (os_gettime_ns() - timestamp > vcam->frame_interval)
+				vcam->late++;
+			vcam->frames++;
+		}
+	}
+
+	return NULL;
+}
+
+static bool start_thread(struct virtualcam_data *vcam)
+{
+	alloc_frames(vcam);
+	vcam->stop = false;
+	vcam->device_error = false;
+
+	if (os_event_init(&vcam->event, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail;
+	if (pthread_create(&vcam->thread, NULL, virtualcam_thread, vcam) != 0) {
+		os_event_destroy(vcam->event);
+		goto fail;
+	}
+
+	vcam->thread_active = true;
+	return true;
+
+fail:
+	free_frames(vcam);
+	return false;
+}
+
+static void stop_thread(struct virtualcam_data *vcam)
+{
+	if (!vcam->thread_active)
+		return;
+
+	os_atomic_set_bool(&vcam->stop, true);
+	os_event_signal(vcam->event);
+	pthread_join(vcam->thread, NULL);
+	os_event_destroy(vcam->event);
+	vcam->thread_active = false;
+
+	free_frames(vcam);
+}
+
 static bool try_connect(void *data, const char *device)
 {
 	static bool use_caps_workaround = false;
@@ -153,6 +465,7 @@ static bool try_connect(void *data, const char *device)
 	uint32_t width = obs_output_get_width(vcam->output);
 	uint32_t height = obs_output_get_height(vcam->output);
 
+	vcam->width = width;
 	vcam->frame_size = width * height * 2;
 
 	vcam->device = open(device, O_RDWR);
@@ -173,6 +486,7 @@ static bool try_connect(void *data, const char *device)
 
 	struct obs_video_info ovi;
 	obs_get_video_info(&ovi);
+	vcam->frame_interval = util_mul_div64(1000000000ULL, ovi.fps_den, ovi.fps_num);
 
 	memset(&parm, 0, sizeof(parm));
 	parm.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
@@ -212,11 +526,27 @@ static bool try_connect(void *data, const char *device)
 		goto fail_close_device;
 	}
 
-	blog(LOG_INFO, "Virtual camera started");
+	/* streaming i/o lets the device take frames without blocking in
+	 * write(), v4l2loopback 0.12.x-0.13.x is already streaming for writes */
+	vcam->streaming = !vcam->use_caps_workaround && map_buffers(vcam);
+	if (vcam->streaming && ioctl(vcam->device, VIDIOC_STREAMON, &format.type) < 0) {
+		blog(LOG_ERROR, "Failed to start streaming on '%s' (%s)", device, strerror(errno));
+		goto fail_unmap;
+	}
+
+	if (!start_thread(vcam))
+		goto fail_stream_off;
+
+	blog(LOG_INFO, "Virtual camera started (%s)", vcam->streaming ? "streaming" : "write");
 	obs_output_begin_data_capture(vcam->output, 0);
 
 	return true;
 
+fail_stream_off:
+	if (vcam->streaming)
+		ioctl(vcam->device, VIDIOC_STREAMOFF, &format.type);
+fail_unmap:
+	unmap_buffers(vcam);
 fail_close_device:
 	close(vcam->device);
 	vcam->device = -1;
@@ -287,30 +617,55 @@ static void virtualcam_stop(void *data, uint64_t ts)
 {
 	struct virtualcam_data *vcam = (struct virtualcam_data *)data;
 	obs_output_end_data_capture(vcam->output);
+	stop_thread(vcam);
 
 	uint32_t buf_type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
 
-	if (vcam->use_caps_workaround && ioctl(vcam->device, VIDIOC_STREAMOFF, &buf_type) < 0) {
+	if ((vcam->use_caps_workaround || vcam->streaming) && ioctl(vcam->device, VIDIOC_STREAMOFF, &buf_type) < 0) {
 		blog(LOG_WARNING, "Failed to stop streaming on video device %d (%s)", vcam->device, strerror(errno));
 	}
+	unmap_buffers(vcam);
 
 	close(vcam->device);
 	vcam->device = -1;
-	blog(LOG_INFO, "Virtual camera stopped");
+	blog(LOG_INFO, "Virtual camera stopped after %" PRIu64 " frames (%" PRIu64 " dropped, %" PRIu64 " late)",
+	     vcam->frames, vcam->dropped, vcam->late);
 
 	UNUSED_PARAMETER(ts);
 }
 
+/*
+ * Queues the frame for the output thread, so a slow consumer never blocks
+ * the video thread
+ */
 static void virtual_video(void *param, struct video_data *frame)
 {
 	struct virtualcam_data *vcam = (struct virtualcam_data *)param;
-	uint32_t frame_size = vcam->frame_size;
-	while (frame_size > 0) {
-		ssize_t written = write(vcam->device, frame->data[0], vcam->frame_size);
-		if (written == -1)
-			break;
-		frame_size -= written;
+	uint32_t linesize = vcam->width * 2;
+	uint32_t height = vcam->frame_size / linesize;
+
+	pthread_mutex_lock(&vcam->mutex);
+
+	if (vcam->queue_size == VCAM_QUEUE_FRAMES) {
+		vcam->queue_start = (vcam->queue_start + 1) % VCAM_QUEUE_FRAMES;
+		vcam->queue_size--;
+		vcam->dropped++;
 	}
+
+	struct virtualcam_frame *out = &vcam->queue[(vcam->queue_start + vcam->queue_size) % VCAM_QUEUE_FRAMES];
+
+	if (frame->linesize[0] == linesize) {
+		memcpy(out->data, frame->data[0], vcam->frame_size);
+	} else {
+		for (uint32_t y = 0; y < height; y++)
+			memcpy(out->data + y * linesize, frame->data[0] + y * frame->linesize[0], linesize);
+	}
+	out->timestamp = frame->timestamp;
+	vcam->queue_size++;
+
+	pthread_mutex_unlock(&vcam->mutex);
+
+	os_event_signal(vcam->event);
 }
 
 struct obs_output_info virtualcam_info = {
@@ -46,6 +46,7 @@ struct ffmpeg_source {
 	bool is_local_file;
 	bool is_hw_decoding;
 	bool full_decode;
+	bool cache_compressed;
 	bool is_clear_on_media_end;
 	bool restart_on_activate;
 	bool close_when_inactive;
@@ -53,6 +54,7 @@ struct ffmpeg_source {
 	bool is_stinger;
 	bool is_track_matte;
 	bool log_changes;
+	bool shared_decode;
 
 	pthread_t reconnect_thread;
 	pthread_mutex_t reconnect_mutex;
@@ -102,6 +104,7 @@ static bool is_local_file_modified(obs_properties_t *props, obs_property_t *prop
 	obs_property_t *seekable = obs_properties_get(props, "seekable");
 	obs_property_t *speed = obs_properties_get(props, "speed_percent");
 	obs_property_t *reconnect_delay_sec = obs_properties_get(props, "reconnect_delay_sec");
+	obs_property_t *shared_decode = obs_properties_get(props, "shared_decode");
 	obs_property_set_visible(input, !enabled);
 	obs_property_set_visible(input_format, !enabled);
 	obs_property_set_visible(buffering, !enabled);
@@ -110,6 +113,7 @@ static bool is_local_file_modified(obs_properties_t *props, obs_property_t *prop
 	obs_property_set_visible(speed, enabled);
 	obs_property_set_visible(seekable, !enabled);
 	obs_property_set_visible(reconnect_delay_sec, !enabled);
+	obs_property_set_visible(shared_decode, enabled);
 
 	return true;
 }
@@ -195,6 +199,9 @@ static obs_properties_t *ffmpeg_source_getproperties(void *data)
 
 	obs_property_set_long_description(prop, obs_module_text("CloseFileWhenInactive.ToolTip"));
 
+	prop = obs_properties_add_bool(props, "shared_decode", obs_module_text("SharedDecode"));
+	obs_property_set_long_description(prop, obs_module_text("SharedDecode.ToolTip"));
+
 	prop = obs_properties_add_int_slider(props, "speed_percent", obs_module_text("SpeedPercentage"), 1, 200, 1);
 	obs_property_int_set_suffix(prop, "%");
 
@@ -230,11 +237,14 @@ static void dump_source_info(struct ffmpeg_source *s, const char *input, const c
 		"\trestart_on_activate:     %s\n"
 		"\tclose_when_inactive:     %s\n"
 		"\tfull_decode:             %s\n"
+		"\tcache_compressed:        %s\n"
+		"\tshared_decode:           %s\n"
 		"\tffmpeg_options:          %s",
 		input ? input : "(null)", input_format ? input_format : "(null)", s->speed_percent,
 		s->is_looping ? "yes" : "no", s->is_linear_alpha ? "yes" : "no", s->is_hw_decoding ? "yes" : "no",
 		s->is_clear_on_media_end ? "yes" : "no", s->restart_on_activate ? "yes" : "no",
-		s->close_when_inactive ? "yes" : "no", s->full_decode ? "yes" : "no", s->ffmpeg_options);
+		s->close_when_inactive ? "yes" : "no", s->full_decode ? "yes" : "no",
+		s->cache_compressed ? "yes" : "no", s->shared_decode ? "yes" : "no", s->ffmpeg_options);
 }
 
 static void get_frame(void *opaque, struct obs_source_frame *f)
@@ -243,6 +253,12 @@ static void get_frame(void *opaque, struct obs_source_frame *f)
 	obs_source_output_video(s->source, f);
 }
 
+static void get_frame_ref(void *opaque, struct obs_source_frame *f, obs_source_frame_release_t release, void *param)
+{
+	struct ffmpeg_source *s = opaque;
+	obs_source_output_video_ref(s->source, f, release, param);
+}
+
 static void preload_frame(void *opaque, struct obs_source_frame *f)
 {
 	struct ffmpeg_source *s = opaque;
@@ -293,6 +309,7 @@ static void ffmpeg_source_open(struct ffmpeg_source *s)
 		struct mp_media_info info = {
 			.opaque = s,
 			.v_cb = get_frame,
+			.v_ref_cb = get_frame_ref,
 			.v_preload_cb = preload_frame,
 			.v_seek_cb = seek_frame,
 			.a_cb = get_audio,
@@ -309,6 +326,8 @@ static void ffmpeg_source_open(struct ffmpeg_source *s)
 			.reconnecting = s->reconnecting,
 			.request_preload = s->is_stinger,
 			.full_decode = s->full_decode,
+			.compressed_cache = s->cache_compressed,
+			.shared = s->shared_decode,
 		};
 
 		s->media = media_playback_create(&info);
@@ -396,7 +415,9 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	bool is_local_file = obs_data_get_bool(settings, "is_local_file");
 	bool is_stinger = obs_data_get_bool(settings, "is_stinger");
 	bool is_track_matte = obs_data_get_bool(settings, "is_track_matte");
-	bool should_restart_media = (is_local_file != s->is_local_file) || (is_stinger != s->is_stinger);
+	bool shared_decode = obs_data_get_bool(settings, "shared_decode");
+	bool should_restart_media = (is_local_file != s->is_local_file) || (is_stinger != s->is_stinger) ||
+				    (shared_decode != s->shared_decode);
 
 	const char *input;
 	const char *input_format;
@@ -456,6 +477,7 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	s->input_format = input_format ? bstrdup(input_format) : NULL;
 	s->is_hw_decoding = is_hw_decoding;
 	s->full_decode = obs_data_get_bool(settings, "full_decode");
+	s->cache_compressed = obs_data_get_bool(settings, "cache_compressed");
 	s->is_clear_on_media_end = obs_data_get_bool(settings, "clear_on_media_end");
 	s->restart_on_activate = !astrcmpi_n(input, RIST_PROTO, sizeof(RIST_PROTO) - 1)
 					 ? false
@@ -471,6 +493,7 @@ static void ffmpeg_source_update(void *data, obs_data_t *settings)
 	s->is_stinger = is_stinger;
 	s->is_track_matte = is_track_matte;
 	s->log_changes = obs_data_get_bool(settings, "log_changes");
+	s->shared_decode = shared_decode;
 
 	if (s->speed_percent < 1 || s->speed_percent > 200)
 		s->speed_percent = 100;
@@ -67,6 +67,7 @@ static enum gs_color_space cut_video_get_color_space(void *data, size_t count,
 struct obs_source_info cut_transition = {
 	.id = "cut_transition",
 	.type = OBS_SOURCE_TYPE_TRANSITION,
+	.output_flags = OBS_SOURCE_CONTENT_TRACKED,
 	.get_name = cut_get_name,
 	.create = cut_create,
 	.destroy = cut_destroy,
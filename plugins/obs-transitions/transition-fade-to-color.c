@@ -201,6 +201,7 @@ static enum gs_color_space fade_to_color_video_get_color_space(void *data, size_
 struct obs_source_info fade_to_color_transition = {
 	.id = "fade_to_color_transition",
 	.type = OBS_SOURCE_TYPE_TRANSITION,
+	.output_flags = OBS_SOURCE_CONTENT_TRACKED,
 	.get_name = fade_to_color_get_name,
 	.create = fade_to_color_create,
 	.destroy = fade_to_color_destroy,
@@ -139,6 +139,7 @@ static enum gs_color_space fade_video_get_color_space(void *data, size_t count,
 struct obs_source_info fade_transition = {
 	.id = "fade_transition",
 	.type = OBS_SOURCE_TYPE_TRANSITION,
+	.output_flags = OBS_SOURCE_CONTENT_TRACKED,
 	.get_name = fade_get_name,
 	.create = fade_create,
 	.destroy = fade_destroy,
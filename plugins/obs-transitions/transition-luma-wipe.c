@@ -218,6 +218,7 @@ static enum gs_color_space luma_wipe_video_get_color_space(void *data, size_t co
 struct obs_source_info luma_wipe_transition = {
 	.id = "wipe_transition",
 	.type = OBS_SOURCE_TYPE_TRANSITION,
+	.output_flags = OBS_SOURCE_CONTENT_TRACKED,
 	.get_name = luma_wipe_get_name,
 	.create = luma_wipe_create,
 	.destroy = luma_wipe_destroy,
@@ -160,6 +160,7 @@ static enum gs_color_space slide_video_get_color_space(void *data, size_t count,
 struct obs_source_info slide_transition = {
 	.id = "slide_transition",
 	.type = OBS_SOURCE_TYPE_TRANSITION,
+	.output_flags = OBS_SOURCE_CONTENT_TRACKED,
 	.get_name = slide_get_name,
 	.create = slide_create,
 	.destroy = slide_destroy,
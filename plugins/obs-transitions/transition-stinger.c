@@ -70,12 +70,14 @@ static void stinger_update(void *data, obs_data_t *settings)
 	const char *path = obs_data_get_string(settings, "path");
 	bool hw_decode = obs_data_get_bool(settings, "hw_decode");
 	bool preload = obs_data_get_bool(settings, "preload");
+	bool preload_compressed = obs_data_get_bool(settings, "preload_compressed");
 
 	obs_data_t *media_settings = obs_data_create();
 	obs_data_set_string(media_settings, "local_file", path);
 	obs_data_set_bool(media_settings, "hw_decode", hw_decode);
 	obs_data_set_bool(media_settings, "looping", false);
 	obs_data_set_bool(media_settings, "full_decode", preload);
+	obs_data_set_bool(media_settings, "cache_compressed", preload_compressed);
 	obs_data_set_bool(media_settings, "is_stinger", true);
 	obs_data_set_bool(media_settings, "is_track_matte", s->track_matte_enabled);
 
@@ -640,6 +642,17 @@ static bool transition_point_type_modified(obs_properties_t *ppts, obs_property_
 	return true;
 }
 
+static bool preload_modified(obs_properties_t *ppts, obs_property_t *p, obs_data_t *s)
+{
+	bool preload = obs_data_get_bool(s, "preload");
+	obs_property_t *prop_compressed = obs_properties_get(ppts, "preload_compressed");
+
+	obs_property_set_visible(prop_compressed, preload);
+
+	UNUSED_PARAMETER(p);
+	return true;
+}
+
 static bool track_matte_layout_modified(obs_properties_t *ppts, obs_property_t *p, obs_data_t *s)
 {
 	int matte_layout = (int)obs_data_get_int(s, "track_matte_layout");
@@ -692,6 +705,10 @@ static obs_properties_t *stinger_properties(void *data)
 	obs_properties_add_bool(ppts, "hw_decode", obs_module_text("HardwareDecode"));
 	p = obs_properties_add_bool(ppts, "preload", obs_module_text("PreloadVideoToRam"));
 	obs_property_set_long_description(p, obs_module_text("PreloadVideoToRam.Description"));
+	obs_property_set_modified_callback(p, preload_modified);
+
+	p = obs_properties_add_bool(ppts, "preload_compressed", obs_module_text("PreloadCompressed"));
+	obs_property_set_long_description(p, obs_module_text("PreloadCompressed.Description"));
 
 	obs_properties_add_int(ppts, "transition_point", obs_module_text("TransitionPoint"), 0, 120000, 1);
 
@@ -156,6 +156,7 @@ static enum gs_color_space swipe_video_get_color_space(void *data, size_t count,
 struct obs_source_info swipe_transition = {
 	.id = "swipe_transition",
 	.type = OBS_SOURCE_TYPE_TRANSITION,
+	.output_flags = OBS_SOURCE_CONTENT_TRACKED,
 	.get_name = swipe_get_name,
 	.create = swipe_create,
 	.destroy = swipe_destroy,
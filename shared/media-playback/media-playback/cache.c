@@ -14,12 +14,20 @@
  * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  */
 
+#include <inttypes.h>
+#include <sys/stat.h>
+
 #include <media-io/audio-io.h>
 #include <util/platform.h>
+#include <util/dstr.h>
+#include <util/uthash.h>
 
 #include "media-playback.h"
 #include "cache.h"
 #include "media.h"
+#include "closest-format.h"
+
+#include <libavutil/imgutils.h>
 
 extern bool mp_media_init2(mp_media_t *m);
 extern bool mp_media_prepare_frames(mp_media_t *m);
@@ -32,8 +40,344 @@ static bool mp_cache_reset(mp_cache_t *c);
 
 static int64_t base_sys_ts = 0;
 
-#define v_eof(c) (c->cur_v_idx == c->video_frames.num)
-#define a_eof(c) (c->cur_a_idx == c->audio_segments.num)
+/* ------------------------------------------------------------------------- */
+/* clips and files shared between caches                                     */
+
+#define DEFAULT_CACHE_BUDGET (2048ULL * 1024ULL * 1024ULL)
+
+struct mp_cache_clip {
+	char *key;
+	long refs;
+	bool registered;
+	UT_hash_handle hh;
+
+	os_event_t *decoded;
+	bool valid;
+	/* the decoding cache was freed before it finished */
+	bool abandoned;
+
+	bool has_video;
+	bool has_audio;
+	int64_t start_time;
+	int64_t media_duration;
+	int64_t final_v_duration;
+	int64_t final_a_duration;
+
+	DARRAY(struct obs_source_frame) video_frames;
+	DARRAY(struct obs_source_audio) audio_segments;
+
+	/* estimated until decoding has finished */
+	uint64_t mem_usage;
+	uint64_t decoded_size;
+};
+
+struct mp_cache_file {
+	char *path;
+	long refs;
+	UT_hash_handle hh;
+
+	uint8_t *data;
+	size_t size;
+};
+
+static pthread_mutex_t cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct mp_cache_clip *clips = NULL;
+static struct mp_cache_file *files = NULL;
+static uint64_t decoded_bytes = 0;
+static uint64_t compressed_bytes = 0;
+static uint64_t cache_budget = DEFAULT_CACHE_BUDGET;
+static uint64_t cache_hits = 0;
+static uint64_t cache_misses = 0;
+
+static inline uint64_t mb(uint64_t bytes)
+{
+	return bytes / (1024 * 1024);
+}
+
+/* the modification time and size keep a file that was replaced on disk from
+ * reusing the frames decoded from the old one */
+static bool make_clip_key(struct dstr *key, const struct mp_media_info *info)
+{
+	struct stat stats;
+
+	if (!info->path || os_stat(info->path, &stats) != 0)
+		return false;
+
+	dstr_printf(key, "%s|%lld|%lld|%d|%d|%d|%s", info->path, (long long)stats.st_mtime,
+		    (long long)stats.st_size, (int)info->force_range, info->is_linear_alpha, info->hardware_decoding,
+		    info->ffmpeg_options ? info->ffmpeg_options : "");
+	return true;
+}
+
+/* only an estimate, as the decoded frame count and sizes are not known
+ * until the whole file has been decoded */
+static uint64_t estimate_decoded_size(mp_media_t *m)
+{
+	double seconds = m->fmt->duration > 0 ? (double)m->fmt->duration / AV_TIME_BASE : 0.0;
+	uint64_t size = 0;
+
+	if (m->has_video) {
+		AVStream *stream = m->v.stream;
+		AVCodecParameters *par = stream->codecpar;
+		int64_t frames = stream->nb_frames;
+
+		if (frames <= 0)
+			frames = (int64_t)(seconds * av_q2d(stream->avg_frame_rate));
+
+		int frame_size = av_image_get_buffer_size(closest_format(par->format), par->width, par->height, 1);
+		if (frame_size > 0 && frames > 0)
+			size += (uint64_t)frame_size * (uint64_t)frames;
+	}
+
+	if (m->has_audio) {
+		AVCodecParameters *par = m->a.stream->codecpar;
+		size += (uint64_t)(seconds * par->sample_rate) * par->ch_layout.nb_channels * sizeof(float);
+	}
+
+	return size;
+}
+
+/* returns an existing clip, or registers a new one that the caller must
+ * decode.  returns NULL if a new clip would not fit in the budget */
+static struct mp_cache_clip *clip_acquire(char *key, mp_media_t *m, bool *owner)
+{
+	struct mp_cache_clip *clip = NULL;
+
+	*owner = false;
+
+	pthread_mutex_lock(&cache_mutex);
+	HASH_FIND_STR(clips, key, clip);
+	if (clip) {
+		clip->refs++;
+		cache_hits++;
+		pthread_mutex_unlock(&cache_mutex);
+		bfree(key);
+		return clip;
+	}
+
+	if (!m) {
+		pthread_mutex_unlock(&cache_mutex);
+		return NULL;
+	}
+
+	uint64_t estimate = estimate_decoded_size(m);
+	if (decoded_bytes + compressed_bytes + estimate > cache_budget) {
+		pthread_mutex_unlock(&cache_mutex);
+		blog(LOG_INFO,
+		     "MP: Decoding '%s' would need ~%" PRIu64 " MB, "
+		     "which exceeds the cache budget (%" PRIu64 " of %" PRIu64 " MB used)",
+		     m->path, mb(estimate), mb(decoded_bytes + compressed_bytes), mb(cache_budget));
+		bfree(key);
+		return NULL;
+	}
+
+	clip = bzalloc(sizeof(*clip));
+	os_event_init(&clip->decoded, OS_EVENT_TYPE_MANUAL);
+	clip->key = key;
+	clip->refs = 1;
+	clip->registered = true;
+	clip->has_video = m->has_video;
+	clip->has_audio = m->has_audio;
+	clip->media_duration = m->fmt->duration;
+	clip->mem_usage = estimate;
+	HASH_ADD_KEYPTR(hh, clips, clip->key, strlen(clip->key), clip);
+
+	decoded_bytes += estimate;
+	cache_misses++;
+	pthread_mutex_unlock(&cache_mutex);
+
+	*owner = true;
+	return clip;
+}
+
+static void clip_free(struct mp_cache_clip *clip)
+{
+	for (size_t i = 0; i < clip->video_frames.num; i++)
+		obs_source_frame_free(&clip->video_frames.array[i]);
+	for (size_t i = 0; i < clip->audio_segments.num; i++)
+		bfree((void *)clip->audio_segments.array[i].data[0]);
+
+	da_free(clip->video_frames);
+	da_free(clip->audio_segments);
+	os_event_destroy(clip->decoded);
+	bfree(clip->key);
+	bfree(clip);
+}
+
+static void clip_release(struct mp_cache_clip *clip)
+{
+	bool destroy;
+
+	if (!clip)
+		return;
+
+	pthread_mutex_lock(&cache_mutex);
+	destroy = --clip->refs == 0;
+	if (destroy) {
+		if (clip->registered)
+			HASH_DELETE(hh, clips, clip);
+		decoded_bytes -= clip->mem_usage;
+	}
+	pthread_mutex_unlock(&cache_mutex);
+
+	if (destroy)
+		clip_free(clip);
+}
+
+/* called by the decoding cache once the clip is complete, or failed */
+static void clip_finish(struct mp_cache_clip *clip, bool valid, bool abandoned)
+{
+	uint64_t total;
+
+	pthread_mutex_lock(&cache_mutex);
+	decoded_bytes -= clip->mem_usage;
+	clip->mem_usage = valid ? clip->decoded_size : 0;
+	decoded_bytes += clip->mem_usage;
+	total = decoded_bytes + compressed_bytes;
+
+	/* failed clips may be retried by the next source to use the file */
+	if (!valid && clip->registered) {
+		HASH_DELETE(hh, clips, clip);
+		clip->registered = false;
+	}
+	pthread_mutex_unlock(&cache_mutex);
+
+	clip->valid = valid;
+	clip->abandoned = abandoned;
+	os_event_signal(clip->decoded);
+
+	if (valid)
+		blog(LOG_INFO, "MP: Cached %zu frames (%" PRIu64 " MB), %" PRIu64 " of %" PRIu64 " MB in use",
+		     clip->video_frames.num, mb(clip->mem_usage), mb(total), mb(cache_budget));
+}
+
+struct mp_cache_file *mp_cache_file_acquire(const char *path)
+{
+	struct mp_cache_file *file = NULL;
+	int64_t size;
+	FILE *f;
+
+	pthread_mutex_lock(&cache_mutex);
+	HASH_FIND_STR(files, path, file);
+	if (file) {
+		file->refs++;
+		cache_hits++;
+	}
+	pthread_mutex_unlock(&cache_mutex);
+
+	if (file)
+		return file;
+
+	f = os_fopen(path, "rb");
+	if (!f)
+		return NULL;
+
+	size = os_fgetsize(f);
+
+	pthread_mutex_lock(&cache_mutex);
+	bool fits = size > 0 && decoded_bytes + compressed_bytes + (uint64_t)size <= cache_budget;
+	pthread_mutex_unlock(&cache_mutex);
+
+	if (!fits) {
+		blog(LOG_INFO, "MP: '%s' does not fit in the cache budget, reading it from disk", path);
+		fclose(f);
+		return NULL;
+	}
+
+	file = bzalloc(sizeof(*file));
+	file->data = bmalloc((size_t)size);
+	file->size = fread(file->data, 1, (size_t)size, f);
+	fclose(f);
+
+	if (file->size != (size_t)size) {
+		blog(LOG_WARNING, "MP: Failed to read '%s' into memory", path);
+		bfree(file->data);
+		bfree(file);
+		return NULL;
+	}
+
+	struct mp_cache_file *existing = NULL;
+
+	pthread_mutex_lock(&cache_mutex);
+	HASH_FIND_STR(files, path, existing);
+	if (existing) {
+		existing->refs++;
+		cache_hits++;
+	} else {
+		file->path = bstrdup(path);
+		file->refs = 1;
+		HASH_ADD_KEYPTR(hh, files, file->path, strlen(file->path), file);
+		compressed_bytes += file->size;
+		cache_misses++;
+	}
+	pthread_mutex_unlock(&cache_mutex);
+
+	/* another source read it at the same time */
+	if (existing) {
+		bfree(file->data);
+		bfree(file);
+		return existing;
+	}
+
+	return file;
+}
+
+void mp_cache_file_release(struct mp_cache_file *file)
+{
+	bool destroy;
+
+	if (!file)
+		return;
+
+	pthread_mutex_lock(&cache_mutex);
+	destroy = --file->refs == 0;
+	if (destroy) {
+		HASH_DELETE(hh, files, file);
+		compressed_bytes -= file->size;
+	}
+	pthread_mutex_unlock(&cache_mutex);
+
+	if (destroy) {
+		bfree(file->data);
+		bfree(file->path);
+		bfree(file);
+	}
+}
+
+const uint8_t *mp_cache_file_data(const struct mp_cache_file *file)
+{
+	return file->data;
+}
+
+size_t mp_cache_file_size(const struct mp_cache_file *file)
+{
+	return file->size;
+}
+
+void mp_cache_set_budget(uint64_t bytes)
+{
+	pthread_mutex_lock(&cache_mutex);
+	cache_budget = bytes;
+	pthread_mutex_unlock(&cache_mutex);
+}
+
+void mp_cache_get_stats(struct mp_cache_stats *stats)
+{
+	pthread_mutex_lock(&cache_mutex);
+	stats->decoded_clips = HASH_CNT(hh, clips);
+	stats->decoded_bytes = decoded_bytes;
+	stats->compressed_files = HASH_CNT(hh, files);
+	stats->compressed_bytes = compressed_bytes;
+	stats->budget = cache_budget;
+	stats->hits = cache_hits;
+	stats->misses = cache_misses;
+	pthread_mutex_unlock(&cache_mutex);
+}
+
+/* ------------------------------------------------------------------------- */
+
+#define v_eof(c) (c->cur_v_idx == c->clip->video_frames.num)
+#define a_eof(c) (c->cur_a_idx == c->clip->audio_segments.num)
 
 static inline int64_t mp_cache_get_next_min_pts(mp_cache_t *c)
 {
@@ -110,7 +454,7 @@ static bool mp_cache_eof(mp_cache_t *c)
 	return true;
 }
 
-bool mp_cache_decode(mp_cache_t *c)
+bool mp_cache_decode(mp_cache_t *c, bool *killed)
 {
 	mp_media_t *m = &c->m;
 	bool success = false;
@@ -120,6 +464,13 @@ bool mp_cache_decode(mp_cache_t *c)
 	mp_media_reset(m);
 
 	while (!mp_media_eof(m)) {
+		pthread_mutex_lock(&c->mutex);
+		*killed = c->kill;
+		pthread_mutex_unlock(&c->mutex);
+
+		if (*killed)
+			goto fail;
+
 		if (m->has_video)
 			mp_media_next_video(m, false);
 		if (m->has_audio)
@@ -131,21 +482,87 @@ bool mp_cache_decode(mp_cache_t *c)
 
 	success = true;
 
-	c->start_time = c->m.fmt->start_time;
-	if (c->start_time == AV_NOPTS_VALUE)
-		c->start_time = 0;
+	c->clip->start_time = c->m.fmt->start_time;
+	if (c->clip->start_time == AV_NOPTS_VALUE)
+		c->clip->start_time = 0;
 
 fail:
 	mp_media_free(m);
+	clip_finish(c->clip, success, *killed);
 	return success;
 }
 
+/* takes over a clip whose decoding cache was freed before finishing it,
+ * either by waiting on another cache that took it over or by decoding it */
+static bool mp_cache_reacquire(mp_cache_t *c)
+{
+	struct mp_cache_clip *clip;
+	struct dstr key = {0};
+	bool owner = false;
+
+	if (!make_clip_key(&key, &c->decode_info)) {
+		dstr_free(&key);
+		return false;
+	}
+
+	clip = clip_acquire(key.array, NULL, &owner);
+	if (!clip) {
+		if (!mp_media_init(&c->m, &c->decode_info)) {
+			dstr_free(&key);
+			return false;
+		}
+		if (!mp_media_init2(&c->m)) {
+			dstr_free(&key);
+			mp_media_free(&c->m);
+			return false;
+		}
+
+		clip = clip_acquire(key.array, &c->m, &owner);
+		if (!clip) {
+			mp_media_free(&c->m);
+			return false;
+		}
+
+		if (!owner)
+			mp_media_free(&c->m);
+	}
+
+	pthread_mutex_lock(&c->mutex);
+	clip_release(c->clip);
+	c->clip = clip;
+	c->decoder_owner = owner;
+	pthread_mutex_unlock(&c->mutex);
+
+	return true;
+}
+
+/* wait for the cache that owns the clip to finish decoding it */
+static bool mp_cache_wait_decoded(mp_cache_t *c, bool *killed)
+{
+	for (;;) {
+		int ret = os_event_timedwait(c->clip->decoded, 100);
+		if (ret == 0)
+			break;
+		if (ret != ETIMEDOUT)
+			return false;
+
+		pthread_mutex_lock(&c->mutex);
+		*killed = c->kill;
+		pthread_mutex_unlock(&c->mutex);
+
+		if (*killed)
+			return false;
+	}
+
+	return c->clip->valid;
+}
+
 static void seek_to(mp_cache_t *c, int64_t pos)
 {
 	size_t new_v_idx = 0;
 	size_t new_a_idx = 0;
 
-	if (pos > c->media_duration) {
+	if (pos > c->clip->media_duration) {
 		blog(LOG_WARNING, "MP: Invalid seek position");
 		return;
 	}
@@ -153,8 +570,8 @@ static void seek_to(mp_cache_t *c, int64_t pos)
 	if (c->has_video) {
 		struct obs_source_frame *v;
 
-		for (size_t i = 0; i < c->video_frames.num; i++) {
-			v = &c->video_frames.array[i];
+		for (size_t i = 0; i < c->clip->video_frames.num; i++) {
+			v = &c->clip->video_frames.array[i];
 			new_v_idx = i;
 			if ((int64_t)v->timestamp >= pos) {
 				break;
@@ -162,17 +579,17 @@ static void seek_to(mp_cache_t *c, int64_t pos)
 		}
 
 		size_t next_idx = new_v_idx + 1;
-		if (next_idx == c->video_frames.num) {
-			c->next_v_ts = (int64_t)v->timestamp + c->final_v_duration;
+		if (next_idx == c->clip->video_frames.num) {
+			c->next_v_ts = (int64_t)v->timestamp + c->clip->final_v_duration;
 		} else {
-			struct obs_source_frame *next = &c->video_frames.array[next_idx];
+			struct obs_source_frame *next = &c->clip->video_frames.array[next_idx];
 			c->next_v_ts = (int64_t)next->timestamp;
 		}
 	}
 	if (c->has_audio) {
 		struct obs_source_audio *a;
-		for (size_t i = 0; i < c->audio_segments.num; i++) {
-			a = &c->audio_segments.array[i];
+		for (size_t i = 0; i < c->clip->audio_segments.num; i++) {
+			a = &c->clip->audio_segments.array[i];
 			new_a_idx = i;
 			if ((int64_t)a->timestamp >= pos) {
 				break;
@@ -180,10 +597,10 @@ static void seek_to(mp_cache_t *c, int64_t pos)
 		}
 
 		size_t next_idx = new_a_idx + 1;
-		if (next_idx == c->audio_segments.num) {
-			c->next_a_ts = (int64_t)a->timestamp + c->final_a_duration;
+		if (next_idx == c->clip->audio_segments.num) {
+			c->next_a_ts = (int64_t)a->timestamp + c->clip->final_a_duration;
 		} else {
-			struct obs_source_audio *next = &c->audio_segments.array[next_idx];
+			struct obs_source_audio *next = &c->clip->audio_segments.array[next_idx];
 			c->next_a_ts = (int64_t)next->timestamp;
 		}
 	}
@@ -208,11 +625,11 @@ static inline bool mp_media_can_play_audio(mp_cache_t *c)
 static inline void calc_next_v_ts(mp_cache_t *c, struct obs_source_frame *frame)
 {
 	int64_t offset;
-	if (c->next_v_idx < c->video_frames.num) {
-		struct obs_source_frame *next = &c->video_frames.array[c->next_v_idx];
+	if (c->next_v_idx < c->clip->video_frames.num) {
+		struct obs_source_frame *next = &c->clip->video_frames.array[c->next_v_idx];
 		offset = (int64_t)(next->timestamp - frame->timestamp);
 	} else {
-		offset = c->final_v_duration;
+		offset = c->clip->final_v_duration;
 	}
 
 	c->next_v_ts += offset;
@@ -221,11 +638,11 @@ static inline void calc_next_v_ts(mp_cache_t *c, struct obs_source_frame *frame)
 static inline void calc_next_a_ts(mp_cache_t *c, struct obs_source_audio *audio)
 {
 	int64_t offset;
-	if (c->next_a_idx < c->audio_segments.num) {
-		struct obs_source_audio *next = &c->audio_segments.array[c->next_a_idx];
+	if (c->next_a_idx < c->clip->audio_segments.num) {
+		struct obs_source_audio *next = &c->clip->audio_segments.array[c->next_a_idx];
 		offset = (int64_t)(next->timestamp - audio->timestamp);
 	} else {
-		offset = c->final_a_duration;
+		offset = c->clip->final_a_duration;
 	}
 
 	c->next_a_ts += offset;
@@ -234,13 +651,13 @@ static inline void calc_next_a_ts(mp_cache_t *c, struct obs_source_audio *audio)
 static void mp_cache_next_video(mp_cache_t *c, bool preload)
 {
 	/* eof check */
-	if (c->next_v_idx == c->video_frames.num) {
+	if (c->next_v_idx == c->clip->video_frames.num) {
 		if (mp_media_can_play_video(c))
 			c->cur_v_idx = c->next_v_idx;
 		return;
 	}
 
-	struct obs_source_frame *frame = &c->video_frames.array[c->next_v_idx];
+	struct obs_source_frame *frame = &c->clip->video_frames.array[c->next_v_idx];
 	struct obs_source_frame dup = *frame;
 
 	dup.timestamp = c->base_ts + dup.timestamp - c->start_ts + c->play_sys_ts - base_sys_ts;
@@ -268,7 +685,7 @@ static void mp_cache_next_video(mp_cache_t *c, bool preload)
 static void mp_cache_next_audio(mp_cache_t *c)
 {
 	/* eof check */
-	if (c->next_a_idx == c->audio_segments.num) {
+	if (c->next_a_idx == c->clip->audio_segments.num) {
 		if (mp_media_can_play_audio(c))
 			c->cur_a_idx = c->next_a_idx;
 		return;
@@ -277,7 +694,7 @@ static void mp_cache_next_audio(mp_cache_t *c)
 	if (!mp_media_can_play_audio(c))
 		return;
 
-	struct obs_source_audio *audio = &c->audio_segments.array[c->next_a_idx];
+	struct obs_source_audio *audio = &c->clip->audio_segments.array[c->next_a_idx];
 	struct obs_source_audio dup = *audio;
 
 	dup.timestamp = c->base_ts + dup.timestamp - c->start_ts + c->play_sys_ts - base_sys_ts;
@@ -297,7 +714,7 @@ static bool mp_cache_reset(mp_cache_t *c)
 
 	int64_t next_ts = mp_cache_get_base_pts(c);
 	int64_t offset = next_ts - c->next_pts_ns;
-	int64_t start_time = c->start_time;
+	int64_t start_time = c->clip->start_time;
 
 	c->eof = false;
 	c->base_ts += next_ts;
@@ -312,14 +729,14 @@ static bool mp_cache_reset(mp_cache_t *c)
 	pthread_mutex_unlock(&c->mutex);
 
 	if (c->has_video) {
-		size_t next_idx = c->video_frames.num > 1 ? 1 : 0;
+		size_t next_idx = c->clip->video_frames.num > 1 ? 1 : 0;
 		c->cur_v_idx = c->next_v_idx = 0;
-		c->next_v_ts = c->video_frames.array[next_idx].timestamp;
+		c->next_v_ts = c->clip->video_frames.array[next_idx].timestamp;
 	}
 	if (c->has_audio) {
-		size_t next_idx = c->audio_segments.num > 1 ? 1 : 0;
+		size_t next_idx = c->clip->audio_segments.num > 1 ? 1 : 0;
 		c->cur_a_idx = c->next_a_idx = 0;
-		c->next_a_ts = c->audio_segments.array[next_idx].timestamp;
+		c->next_a_ts = c->clip->audio_segments.array[next_idx].timestamp;
 	}
 
 	if (active) {
@@ -369,8 +786,24 @@ static inline bool mp_cache_thread(mp_cache_t *c)
 {
 	os_set_thread_name("mp_cache_thread");
 
-	if (!mp_cache_decode(c)) {
-		return false;
+	for (;;) {
+		bool killed = false;
+
+		if (c->decoder_owner) {
+			if (!mp_cache_decode(c, &killed))
+				return killed;
+			break;
+		}
+
+		if (mp_cache_wait_decoded(c, &killed))
+			break;
+		if (killed)
+			return true;
+
+		/* the cache decoding the clip was freed, so this one takes
+		 * over instead of never getting any frames */
+		if (!c->clip->abandoned || !mp_cache_reacquire(c))
+			return false;
 	}
 
 	for (;;) {
@@ -433,7 +866,7 @@ static inline bool mp_cache_thread(mp_cache_t *c)
 			continue;
 
 		if (preload_frame)
-			c->v_preload_cb(c->opaque, &c->video_frames.array[0]);
+			c->v_preload_cb(c->opaque, &c->clip->video_frames.array[0]);
 
 		/* frames are ready */
 		if (is_active && !timeout) {
@@ -465,6 +898,21 @@ static void *mp_cache_thread_start(void *opaque)
 	return NULL;
 }
 
+static uint32_t plane_height(enum video_format format, size_t plane, uint32_t height)
+{
+	switch (format) {
+	case VIDEO_FORMAT_I420:
+	case VIDEO_FORMAT_NV12:
+	case VIDEO_FORMAT_I40A:
+	case VIDEO_FORMAT_I010:
+	case VIDEO_FORMAT_P010:
+		/* alpha plane of I40A is full height */
+		return (plane == 0 || plane == 3) ? height : (height + 1) / 2;
+	default:
+		return height;
+	}
+}
+
 static void fill_video(void *data, struct obs_source_frame *frame)
 {
 	mp_cache_t *c = data;
@@ -475,9 +923,12 @@ static void fill_video(void *data, struct obs_source_frame *frame)
 
 	dup.timestamp = frame->timestamp;
 
-	c->final_v_duration = c->m.v.last_duration;
+	for (size_t i = 0; i < MAX_AV_PLANES && dup.data[i]; i++)
+		c->clip->decoded_size += (uint64_t)dup.linesize[i] * plane_height(dup.format, i, dup.height);
 
-	da_push_back(c->video_frames, &dup);
+	c->clip->final_v_duration = c->m.v.last_duration;
+
+	da_push_back(c->clip->video_frames, &dup);
 }
 
 static void fill_audio(void *data, struct obs_source_audio *audio)
@@ -504,9 +955,10 @@ static void fill_audio(void *data, struct obs_source_audio *audio)
 		memcpy((uint8_t *)dup.data[0], audio->data[0], size);
 	}
 
-	c->final_a_duration = c->m.a.last_duration;
+	c->clip->decoded_size += get_total_audio_size(dup.format, dup.speakers, dup.frames);
+	c->clip->final_a_duration = c->m.a.last_duration;
 
-	da_push_back(c->audio_segments, &dup);
+	da_push_back(c->clip->audio_segments, &dup);
 }
 
 static inline bool mp_cache_init_internal(mp_cache_t *c, const struct mp_media_info *info)
@@ -522,6 +974,8 @@ static inline bool mp_cache_init_internal(mp_cache_t *c, const struct mp_media_i
 
 	c->path = info->path ? bstrdup(info->path) : NULL;
 	c->format_name = info->format ? bstrdup(info->format) : NULL;
+	c->decode_info.path = c->path;
+	c->decode_info.format = c->format_name;
 
 	if (pthread_create(&c->thread, NULL, mp_cache_thread_start, c) != 0) {
 		blog(LOG_WARNING, "MP: Could not create media thread");
@@ -543,20 +997,48 @@ bool mp_cache_init(mp_cache_t *c, const struct mp_media_info *info)
 	info2.v_seek_cb = NULL;
 	info2.stop_cb = NULL;
 	info2.full_decode = true;
+	info2.compressed_cache = false;
 
 	mp_media_t *m = &c->m;
+	struct dstr key = {0};
+	bool owner = false;
 
 	pthread_mutex_init_value(&c->mutex);
 
-	if (!mp_media_init(m, &info2)) {
+	if (!make_clip_key(&key, info)) {
+		dstr_free(&key);
 		mp_cache_free(c);
 		return false;
 	}
-	if (!mp_media_init2(m)) {
-		mp_cache_free(c);
-		return false;
+
+	/* no need to open the file if another source already has the clip */
+	c->clip = clip_acquire(key.array, NULL, &owner);
+	if (!c->clip) {
+		if (!mp_media_init(m, &info2)) {
+			dstr_free(&key);
+			mp_cache_free(c);
+			return false;
+		}
+		if (!mp_media_init2(m)) {
+			dstr_free(&key);
+			mp_cache_free(c);
+			return false;
+		}
+
+		c->clip = clip_acquire(key.array, m, &owner);
+		if (!c->clip) {
+			mp_cache_free(c);
+			c->over_budget = true;
+			return false;
+		}
+
+		if (!owner)
+			mp_media_free(m);
 	}
 
+	c->decoder_owner = owner;
+	c->decode_info = info2;
+
 	c->opaque = info->opaque;
 	c->v_cb = info->v_cb;
 	c->a_cb = info->a_cb;
@@ -566,10 +1048,9 @@ bool mp_cache_init(mp_cache_t *c, const struct mp_media_info *info)
 	c->v_preload_cb = info->v_preload_cb;
 	c->request_preload = info->request_preload;
 	c->speed = info->speed;
-	c->media_duration = m->fmt->duration;
 
-	c->has_video = m->has_video;
-	c->has_audio = m->has_audio;
+	c->has_video = c->clip->has_video;
+	c->has_audio = c->clip->has_audio;
 
 	if (!base_sys_ts)
 		base_sys_ts = (int64_t)os_gettime_ns();
@@ -605,16 +1086,12 @@ void mp_cache_free(mp_cache_t *c)
 	if (c->m.fmt)
 		mp_media_free(&c->m);
 
-	for (size_t i = 0; i < c->video_frames.num; i++) {
-		struct obs_source_frame *f = &c->video_frames.array[i];
-		obs_source_frame_free(f);
-	}
-	for (size_t i = 0; i < c->audio_segments.num; i++) {
-		struct obs_source_audio *a = &c->audio_segments.array[i];
-		bfree((void *)a->data[0]);
-	}
-	da_free(c->video_frames);
-	da_free(c->audio_segments);
+	/* the decoding thread never ran, so nobody else would signal the
+	 * sources waiting on the clip */
+	if (c->clip && c->decoder_owner && os_event_try(c->clip->decoded) == EAGAIN)
+		clip_finish(c->clip, false, true);
+
+	clip_release(c->clip);
 
 	bfree(c->path);
 	bfree(c->format_name);
@@ -692,10 +1169,24 @@ void mp_cache_seek(mp_cache_t *c, int64_t pos)
 
 int64_t mp_cache_get_frames(mp_cache_t *c)
 {
-	return c->video_frames.num;
+	int64_t frames = 0;
+
+	/* the frame array is only complete once the clip has been decoded */
+	pthread_mutex_lock(&c->mutex);
+	if (os_event_try(c->clip->decoded) == 0 && c->clip->valid)
+		frames = (int64_t)c->clip->video_frames.num;
+	pthread_mutex_unlock(&c->mutex);
+
+	return frames;
 }
 
 int64_t mp_cache_get_duration(mp_cache_t *c)
 {
-	return c->media_duration;
+	int64_t duration;
+
+	pthread_mutex_lock(&c->mutex);
+	duration = c->clip->media_duration;
+	pthread_mutex_unlock(&c->mutex);
+
+	return duration;
 }
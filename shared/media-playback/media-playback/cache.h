@@ -22,6 +22,8 @@
 
 #include "media.h"
 
+struct mp_cache_clip;
+
 struct mp_cache {
 	mp_video_cb v_preload_cb;
 	mp_video_cb v_seek_cb;
@@ -51,8 +53,14 @@ struct mp_cache {
 	bool thread_valid;
 	pthread_t thread;
 
-	DARRAY(struct obs_source_frame) video_frames;
-	DARRAY(struct obs_source_audio) audio_segments;
+	/* decoded frames, shared by every cache playing the same clip.  only
+	 * the cache that registered the clip decodes it */
+	struct mp_cache_clip *clip;
+	bool decoder_owner;
+	bool over_budget;
+
+	/* used to decode the clip if its decoding cache is freed first */
+	struct mp_media_info decode_info;
 
 	size_t cur_v_idx;
 	size_t cur_a_idx;
@@ -61,9 +69,6 @@ struct mp_cache {
 	int64_t next_v_ts;
 	int64_t next_a_ts;
 
-	int64_t final_v_duration;
-	int64_t final_a_duration;
-
 	int64_t play_sys_ts;
 	int64_t next_pts_ns;
 	uint64_t next_ns;
@@ -76,8 +81,6 @@ struct mp_cache {
 	bool seek_next_ts;
 	bool eof;
 	int64_t seek_pos;
-	int64_t start_time;
-	int64_t media_duration;
 
 	mp_media_t m;
 };
@@ -95,3 +98,12 @@ extern int64_t mp_cache_get_current_time(mp_cache_t *c);
 extern void mp_cache_seek(mp_cache_t *c, int64_t pos);
 extern int64_t mp_cache_get_frames(mp_cache_t *c);
 extern int64_t mp_cache_get_duration(mp_cache_t *c);
+
+/* whole files kept compressed in memory, shared by path */
+extern struct mp_cache_file *mp_cache_file_acquire(const char *path);
+extern void mp_cache_file_release(struct mp_cache_file *file);
+extern const uint8_t *mp_cache_file_data(const struct mp_cache_file *file);
+extern size_t mp_cache_file_size(const struct mp_cache_file *file);
+
+extern void mp_cache_set_budget(uint64_t bytes);
+extern void mp_cache_get_stats(struct mp_cache_stats *stats);
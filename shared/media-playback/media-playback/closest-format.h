@@ -38,7 +38,6 @@ static enum AVPixelFormat closest_format(enum AVPixelFormat fmt)
 		return AV_PIX_FMT_YUV444P;
 
 	case AV_PIX_FMT_YUV422P:
-	case AV_PIX_FMT_YUVJ422P:
 	case AV_PIX_FMT_YUV422P16LE:
 	case AV_PIX_FMT_YUV422P16BE:
 	case AV_PIX_FMT_YUV422P10BE:
@@ -66,7 +65,6 @@ static enum AVPixelFormat closest_format(enum AVPixelFormat fmt)
 	case AV_PIX_FMT_YUV420P:
 	case AV_PIX_FMT_YUV410P:
 	case AV_PIX_FMT_YUV411P:
-	case AV_PIX_FMT_YUVJ420P:
 	case AV_PIX_FMT_UYYVYY411:
 		return AV_PIX_FMT_YUV420P;
 
@@ -104,9 +102,17 @@ static enum AVPixelFormat closest_format(enum AVPixelFormat fmt)
 	case AV_PIX_FMT_P010LE:
 		return AV_PIX_FMT_P010LE;
 
+	/* same layouts as their yuv counterparts, passed through as full
+	 * range so they don't need to be converted */
+	case AV_PIX_FMT_YUVJ420P:
+	case AV_PIX_FMT_YUVJ422P:
+	case AV_PIX_FMT_YUVJ444P:
+		return fmt;
+
 	case AV_PIX_FMT_RGBA:
 	case AV_PIX_FMT_BGRA:
 	case AV_PIX_FMT_BGR0:
+	case AV_PIX_FMT_BGR24:
 		return fmt;
 
 	default:
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/threading.h>
+
+#include "frame-pool.h"
+
+struct mp_pooled_frame {
+	AVFrame *frame;
+	mp_frame_pool_t *pool;
+};
+
+struct mp_frame_pool {
+	pthread_mutex_t mutex;
+	DARRAY(struct mp_pooled_frame *) free_frames;
+
+	volatile long refs;
+	volatile long outstanding;
+	long max_outstanding;
+};
+
+mp_frame_pool_t *mp_frame_pool_create(long max_outstanding)
+{
+	mp_frame_pool_t *pool = bzalloc(sizeof(*pool));
+
+	if (!pool)
+		return NULL;
+	if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
+		bfree(pool);
+		return NULL;
+	}
+
+	pool->refs = 1;
+	pool->max_outstanding = max_outstanding;
+	return pool;
+}
+
+static void mp_frame_pool_free(mp_frame_pool_t *pool)
+{
+	for (size_t i = 0; i < pool->free_frames.num; i++) {
+		struct mp_pooled_frame *pf = pool->free_frames.array[i];
+		av_frame_free(&pf->frame);
+		bfree(pf);
+	}
+
+	da_free(pool->free_frames);
+	pthread_mutex_destroy(&pool->mutex);
+	bfree(pool);
+}
+
+static inline void mp_frame_pool_release(mp_frame_pool_t *pool)
+{
+	if (os_atomic_dec_long(&pool->refs) == 0)
+		mp_frame_pool_free(pool);
+}
+
+void mp_frame_pool_destroy(mp_frame_pool_t *pool)
+{
+	if (pool)
+		mp_frame_pool_release(pool);
+}
+
+struct mp_pooled_frame *mp_frame_pool_ref(mp_frame_pool_t *pool, const AVFrame *src)
+{
+	struct mp_pooled_frame *pf = NULL;
+
+	if (!pool || !src->buf[0])
+		return NULL;
+	if (os_atomic_load_long(&pool->outstanding) >= pool->max_outstanding)
+		return NULL;
+
+	pthread_mutex_lock(&pool->mutex);
+	if (pool->free_frames.num) {
+		pf = da_end(pool->free_frames)[0];
+		da_pop_back(pool->free_frames);
+	}
+	pthread_mutex_unlock(&pool->mutex);
+
+	if (!pf) {
+		pf = bzalloc(sizeof(*pf));
+		if (!pf)
+			return NULL;
+
+		pf->frame = av_frame_alloc();
+		if (!pf->frame) {
+			bfree(pf);
+			return NULL;
+		}
+
+		pf->pool = pool;
+	}
+
+	if (av_frame_ref(pf->frame, src) < 0) {
+		pthread_mutex_lock(&pool->mutex);
+		da_push_back(pool->free_frames, &pf);
+		pthread_mutex_unlock(&pool->mutex);
+		return NULL;
+	}
+
+	os_atomic_inc_long(&pool->refs);
+	os_atomic_inc_long(&pool->outstanding);
+	return pf;
+}
+
+void mp_pooled_frame_release(void *param)
+{
+	struct mp_pooled_frame *pf = param;
+	mp_frame_pool_t *pool = pf->pool;
+
+	av_frame_unref(pf->frame);
+
+	pthread_mutex_lock(&pool->mutex);
+	da_push_back(pool->free_frames, &pf);
+	pthread_mutex_unlock(&pool->mutex);
+
+	os_atomic_dec_long(&pool->outstanding);
+	mp_frame_pool_release(pool);
+}
+
+long mp_frame_pool_outstanding(mp_frame_pool_t *pool)
+{
+	return pool ? os_atomic_load_long(&pool->outstanding) : 0;
+}
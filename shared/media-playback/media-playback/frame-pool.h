@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include <util/c99defs.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable : 4244)
+#pragma warning(disable : 4204)
+#endif
+
+#include <libavutil/frame.h>
+
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+
+/*
+ * Pool of AVFrame references handed to libobs in place of copies.  Each
+ * pooled frame keeps the decoder's buffers alive until libobs releases it,
+ * and the frame shells are recycled instead of being reallocated.  The pool
+ * is reference counted by its owner and by every outstanding frame, so
+ * frames may be released after the media object is gone.
+ */
+
+struct mp_frame_pool;
+typedef struct mp_frame_pool mp_frame_pool_t;
+
+struct mp_pooled_frame;
+
+extern mp_frame_pool_t *mp_frame_pool_create(long max_outstanding);
+extern void mp_frame_pool_destroy(mp_frame_pool_t *pool);
+
+/* returns NULL if the frame is not refcounted or too many frames are
+ * outstanding, in which case the caller should copy */
+extern struct mp_pooled_frame *mp_frame_pool_ref(mp_frame_pool_t *pool, const AVFrame *src);
+
+/* obs_source_frame_release_t compatible */
+extern void mp_pooled_frame_release(void *param);
+
+extern long mp_frame_pool_outstanding(mp_frame_pool_t *pool);
+
+#ifdef __cplusplus
+}
+#endif
@@ -17,6 +17,7 @@
 #include "media-playback.h"
 #include "media.h"
 #include "cache.h"
+#include "shared.h"
 
 struct media_playback {
 	bool is_cached;
@@ -24,15 +25,48 @@ struct media_playback {
 		mp_media_t media;
 		mp_cache_t cache;
 	};
+
+	/* set when attached to a shared decoding session, in which case
+	 * the union above is unused */
+	mp_shared_client_t *shared;
 };
 
 media_playback_t *media_playback_create(const struct mp_media_info *info)
 {
 	media_playback_t *mp = bzalloc(sizeof(*mp));
-	mp->is_cached = info->is_local_file && info->full_decode;
 
-	if ((mp->is_cached && !mp_cache_init(&mp->cache, info)) ||
-	    (!mp->is_cached && !mp_media_init(&mp->media, info))) {
+	if (info->shared && mp_shared_supported(info)) {
+		mp->shared = mp_shared_client_create(info);
+		if (!mp->shared) {
+			bfree(mp);
+			return NULL;
+		}
+		return mp;
+	}
+
+	bool full_cache = info->is_local_file && info->full_decode;
+	struct mp_media_info media_info = *info;
+
+	if (full_cache && !info->compressed_cache) {
+		mp->is_cached = true;
+		if (mp_cache_init(&mp->cache, info))
+			return mp;
+
+		if (!mp->cache.over_budget) {
+			bfree(mp);
+			return NULL;
+		}
+
+		/* too large to keep decoded, keep the file in memory and
+		 * decode it during playback instead */
+		mp->is_cached = false;
+		blog(LOG_INFO, "MP: Keeping '%s' compressed in memory instead", info->path);
+	}
+
+	media_info.full_decode = false;
+	media_info.compressed_cache = full_cache;
+
+	if (!mp_media_init(&mp->media, &media_info)) {
 		bfree(mp);
 		return NULL;
 	}
@@ -45,7 +79,9 @@ void media_playback_destroy(media_playback_t *mp)
 	if (!mp)
 		return;
 
-	if (mp->is_cached)
+	if (mp->shared)
+		mp_shared_client_destroy(mp->shared);
+	else if (mp->is_cached)
 		mp_cache_free(&mp->cache);
 	else
 		mp_media_free(&mp->media);
@@ -57,7 +93,9 @@ void media_playback_play(media_playback_t *mp, bool looping, bool reconnecting)
 	if (!mp)
 		return;
 
-	if (mp->is_cached)
+	if (mp->shared)
+		mp_shared_client_play(mp->shared, looping);
+	else if (mp->is_cached)
 		mp_cache_play(&mp->cache, looping);
 	else
 		mp_media_play(&mp->media, looping, reconnecting);
@@ -68,7 +106,9 @@ void media_playback_play_pause(media_playback_t *mp, bool pause)
 	if (!mp)
 		return;
 
-	if (mp->is_cached)
+	if (mp->shared)
+		mp_shared_client_play_pause(mp->shared, pause);
+	else if (mp->is_cached)
 		mp_cache_play_pause(&mp->cache, pause);
 	else
 		mp_media_play_pause(&mp->media, pause);
@@ -79,7 +119,9 @@ void media_playback_stop(media_playback_t *mp)
 	if (!mp)
 		return;
 
-	if (mp->is_cached)
+	if (mp->shared)
+		mp_shared_client_stop(mp->shared);
+	else if (mp->is_cached)
 		mp_cache_stop(&mp->cache);
 	else
 		mp_media_stop(&mp->media);
@@ -87,6 +129,9 @@ void media_playback_stop(media_playback_t *mp)
 
 void media_playback_set_looping(media_playback_t *mp, bool looping)
 {
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		mp->cache.looping = looping;
 	else
@@ -95,6 +140,9 @@ void media_playback_set_looping(media_playback_t *mp, bool looping)
 
 void media_playback_set_is_linear_alpha(media_playback_t *mp, bool is_linear_alpha)
 {
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		mp->cache.m.is_linear_alpha = is_linear_alpha;
 	else
@@ -106,6 +154,9 @@ void media_playback_preload_frame(media_playback_t *mp)
 	if (!mp)
 		return;
 
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		mp_cache_preload_frame(&mp->cache);
 	else
@@ -117,6 +168,9 @@ int64_t media_playback_get_current_time(media_playback_t *mp)
 	if (!mp)
 		return 0;
 
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		return mp_cache_get_current_time(&mp->cache);
 	else
@@ -125,6 +179,9 @@ int64_t media_playback_get_current_time(media_playback_t *mp)
 
 void media_playback_seek(media_playback_t *mp, int64_t pos)
 {
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		mp_cache_seek(&mp->cache, pos);
 	else
@@ -136,6 +193,9 @@ int64_t media_playback_get_frames(media_playback_t *mp)
 	if (!mp)
 		return 0;
 
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		return mp_cache_get_frames(&mp->cache);
 	else
@@ -147,6 +207,9 @@ int64_t media_playback_get_duration(media_playback_t *mp)
 	if (!mp)
 		return 0;
 
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		return mp_cache_get_duration(&mp->cache);
 	else
@@ -158,6 +221,9 @@ bool media_playback_has_video(media_playback_t *mp)
 	if (!mp)
 		return false;
 
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		return mp->cache.has_video;
 	else
@@ -169,8 +235,26 @@ bool media_playback_has_audio(media_playback_t *mp)
 	if (!mp)
 		return false;
 
+	if (mp->shared)
+		mp = mp_shared_client_media(mp->shared);
+
 	if (mp->is_cached)
 		return mp->cache.has_audio;
 	else
 		return mp->media.has_audio;
 }
+
+size_t media_playback_shared_session_count(void)
+{
+	return mp_shared_session_count();
+}
+
+void media_playback_set_cache_budget(uint64_t bytes)
+{
+	mp_cache_set_budget(bytes);
+}
+
+void media_playback_get_cache_stats(struct mp_cache_stats *stats)
+{
+	mp_cache_get_stats(stats);
+}
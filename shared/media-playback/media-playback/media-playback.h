@@ -22,6 +22,8 @@ struct media_playback;
 typedef struct media_playback media_playback_t;
 
 typedef void (*mp_video_cb)(void *opaque, struct obs_source_frame *frame);
+typedef void (*mp_video_ref_cb)(void *opaque, struct obs_source_frame *frame, obs_source_frame_release_t release,
+				void *param);
 typedef void (*mp_audio_cb)(void *opaque, struct obs_source_audio *audio);
 typedef void (*mp_stop_cb)(void *opaque);
 
@@ -29,6 +31,7 @@ struct mp_media_info {
 	void *opaque;
 
 	mp_video_cb v_cb;
+	mp_video_ref_cb v_ref_cb; /* optional, receives frames without a copy */
 	mp_video_cb v_preload_cb;
 	mp_video_cb v_seek_cb;
 	mp_audio_cb a_cb;
@@ -46,6 +49,8 @@ struct mp_media_info {
 	bool reconnecting;
 	bool request_preload;
 	bool full_decode;
+	bool compressed_cache; /* with full_decode, keep the file instead of decoded frames */
+	bool shared; /* attach to a decoder shared with matching sources */
 };
 
 extern media_playback_t *media_playback_create(const struct mp_media_info *info);
@@ -63,3 +68,18 @@ extern int64_t media_playback_get_frames(media_playback_t *mp);
 extern int64_t media_playback_get_duration(media_playback_t *mp);
 extern bool media_playback_has_video(media_playback_t *mp);
 extern bool media_playback_has_audio(media_playback_t *mp);
+extern size_t media_playback_shared_session_count(void);
+
+struct mp_cache_stats {
+	uint64_t decoded_clips;
+	uint64_t decoded_bytes;
+	uint64_t compressed_files;
+	uint64_t compressed_bytes;
+	uint64_t budget;
+	uint64_t hits;
+	uint64_t misses;
+};
+
+/* memory budget shared by every fully cached clip and file */
+extern void media_playback_set_cache_budget(uint64_t bytes);
+extern void media_playback_get_cache_stats(struct mp_cache_stats *stats);
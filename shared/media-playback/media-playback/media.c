@@ -20,6 +20,7 @@
 
 #include "media-playback.h"
 #include "media.h"
+#include "cache.h"
 #include "closest-format.h"
 
 #include <libavdevice/avdevice.h>
@@ -27,20 +28,27 @@
 
 static int64_t base_sys_ts = 0;
 
+/* decoded frames that may be referenced by libobs at once before falling
+ * back to copying */
+#define MAX_POOLED_FRAMES 8
+
 static inline enum video_format convert_pixel_format(int f)
 {
 	switch (f) {
 	case AV_PIX_FMT_NONE:
 		return VIDEO_FORMAT_NONE;
 	case AV_PIX_FMT_YUV420P:
+	case AV_PIX_FMT_YUVJ420P:
 		return VIDEO_FORMAT_I420;
 	case AV_PIX_FMT_YUYV422:
 		return VIDEO_FORMAT_YUY2;
 	case AV_PIX_FMT_YUV422P:
+	case AV_PIX_FMT_YUVJ422P:
 		return VIDEO_FORMAT_I422;
 	case AV_PIX_FMT_YUV422P10LE:
 		return VIDEO_FORMAT_I210;
 	case AV_PIX_FMT_YUV444P:
+	case AV_PIX_FMT_YUVJ444P:
 		return VIDEO_FORMAT_I444;
 	case AV_PIX_FMT_YUV444P12LE:
 		return VIDEO_FORMAT_I412;
@@ -66,6 +74,8 @@ static inline enum video_format convert_pixel_format(int f)
 		return VIDEO_FORMAT_YA2L;
 	case AV_PIX_FMT_BGR0:
 		return VIDEO_FORMAT_BGRX;
+	case AV_PIX_FMT_BGR24:
+		return VIDEO_FORMAT_BGR3;
 	case AV_PIX_FMT_P010LE:
 		return VIDEO_FORMAT_P010;
 	default:;
@@ -143,8 +153,18 @@ static inline enum video_colorspace convert_color_space(enum AVColorSpace s, enu
 	}
 }
 
-static inline enum video_range_type convert_color_range(enum AVColorRange r)
+static inline enum video_range_type convert_color_range(enum AVColorRange r, int format)
 {
+	/* the deprecated yuvj formats imply full range */
+	switch (format) {
+	case AV_PIX_FMT_YUVJ420P:
+	case AV_PIX_FMT_YUVJ422P:
+	case AV_PIX_FMT_YUVJ444P:
+		return VIDEO_RANGE_FULL;
+	default:
+		break;
+	}
+
 	return r == AVCOL_RANGE_JPEG ? VIDEO_RANGE_FULL : VIDEO_RANGE_DEFAULT;
 }
 
@@ -426,7 +446,8 @@ void mp_media_next_video(mp_media_t *m, bool preload)
 
 	new_format = convert_pixel_format(m->scale_format);
 	new_space = convert_color_space(f->colorspace, f->color_trc, f->color_primaries);
-	new_range = m->force_range == VIDEO_RANGE_DEFAULT ? convert_color_range(f->color_range) : m->force_range;
+	new_range = m->force_range == VIDEO_RANGE_DEFAULT ? convert_color_range(f->color_range, f->format)
+							  : m->force_range;
 
 	if (new_format != frame->format || new_space != m->cur_space || new_range != m->cur_range) {
 		bool success;
@@ -491,7 +512,13 @@ void mp_media_next_video(mp_media_t *m, bool preload)
 			m->v_preload_cb(m->opaque, frame);
 		}
 	} else {
-		m->v_cb(m->opaque, frame);
+		/* hand the decoder's buffers to libobs directly when no
+		 * conversion was needed */
+		struct mp_pooled_frame *pf = m->swscale ? NULL : mp_frame_pool_ref(m->frame_pool, f);
+		if (pf)
+			m->v_ref_cb(m->opaque, frame, mp_pooled_frame_release, pf);
+		else
+			m->v_cb(m->opaque, frame);
 	}
 }
 
@@ -656,6 +683,52 @@ static int interrupt_callback(void *data)
 	return stop;
 }
 
+#define FILE_IO_BUFFER_SIZE 32768
+
+static int file_data_read(void *opaque, uint8_t *buf, int buf_size)
+{
+	mp_media_t *m = opaque;
+	int64_t size = (int64_t)mp_cache_file_size(m->file_data);
+
+	if (m->file_pos >= size)
+		return AVERROR_EOF;
+	if (buf_size > size - m->file_pos)
+		buf_size = (int)(size - m->file_pos);
+
+	memcpy(buf, mp_cache_file_data(m->file_data) + m->file_pos, buf_size);
+	m->file_pos += buf_size;
+	return buf_size;
+}
+
+static int64_t file_data_seek(void *opaque, int64_t offset, int whence)
+{
+	mp_media_t *m = opaque;
+	int64_t size = (int64_t)mp_cache_file_size(m->file_data);
+	int64_t pos;
+
+	switch (whence & ~AVSEEK_FORCE) {
+	case AVSEEK_SIZE:
+		return size;
+	case SEEK_SET:
+		pos = offset;
+		break;
+	case SEEK_CUR:
+		pos = m->file_pos + offset;
+		break;
+	case SEEK_END:
+		pos = size + offset;
+		break;
+	default:
+		return -1;
+	}
+
+	if (pos < 0 || pos > size)
+		return -1;
+
+	m->file_pos = pos;
+	return pos;
+}
+
 #define RIST_PROTO "rist"
 
 static bool init_avformat(mp_media_t *m)
@@ -686,6 +759,13 @@ static bool init_avformat(mp_media_t *m)
 	if (m->buffering == 0) {
 		m->fmt->flags |= AVFMT_FLAG_NOBUFFER;
 	}
+	if (m->file_data) {
+		uint8_t *buf = av_malloc(FILE_IO_BUFFER_SIZE);
+		m->file_pos = 0;
+		m->file_io = avio_alloc_context(buf, FILE_IO_BUFFER_SIZE, 0, m, file_data_read, NULL, file_data_seek);
+		m->fmt->pb = m->file_io;
+		m->fmt->flags |= AVFMT_FLAG_CUSTOM_IO;
+	}
 	if (!m->is_local_file) {
 		av_dict_set(&opts, "stimeout", "30000000", 0);
 		m->fmt->interrupt_callback.callback = interrupt_callback;
@@ -878,6 +958,7 @@ bool mp_media_init(mp_media_t *media, const struct mp_media_info *info)
 	pthread_mutex_init_value(&media->mutex);
 	media->opaque = info->opaque;
 	media->v_cb = info->v_cb;
+	media->v_ref_cb = info->v_ref_cb;
 	media->a_cb = info->a_cb;
 	media->stop_cb = info->stop_cb;
 	media->ffmpeg_options = info->ffmpeg_options;
@@ -891,6 +972,13 @@ bool mp_media_init(mp_media_t *media, const struct mp_media_info *info)
 	media->is_local_file = info->is_local_file;
 	da_init(media->packet_pool);
 
+	if (media->v_ref_cb)
+		media->frame_pool = mp_frame_pool_create(MAX_POOLED_FRAMES);
+
+	/* falls back to reading from disk if the file can't be kept */
+	if (info->compressed_cache && info->is_local_file && info->path && *info->path)
+		media->file_data = mp_cache_file_acquire(info->path);
+
 	if (!info->is_local_file || media->speed < 1 || media->speed > 200)
 		media->speed = 100;
 
@@ -936,7 +1024,13 @@ void mp_media_free(mp_media_t *media)
 	for (size_t i = 0; i < media->packet_pool.num; i++)
 		av_packet_free(&media->packet_pool.array[i]);
 	da_free(media->packet_pool);
+	mp_frame_pool_destroy(media->frame_pool);
 	avformat_close_input(&media->fmt);
+	if (media->file_io) {
+		av_freep(&media->file_io->buffer);
+		avio_context_free(&media->file_io);
+	}
+	mp_cache_file_release(media->file_data);
 	pthread_mutex_destroy(&media->mutex);
 	os_sem_destroy(media->sem);
 	sws_freeContext(media->swscale);
@@ -18,6 +18,7 @@
 
 #include <obs.h>
 #include "decode.h"
+#include "frame-pool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,16 +39,26 @@ extern "C" {
 #pragma warning(pop)
 #endif
 
+struct mp_cache_file;
+
 struct mp_media {
 	AVFormatContext *fmt;
 
+	/* set when playing a file kept in memory */
+	struct mp_cache_file *file_data;
+	AVIOContext *file_io;
+	int64_t file_pos;
+
 	mp_video_cb v_preload_cb;
 	mp_video_cb v_seek_cb;
 	mp_stop_cb stop_cb;
 	mp_video_cb v_cb;
+	mp_video_ref_cb v_ref_cb;
 	mp_audio_cb a_cb;
 	void *opaque;
 
+	mp_frame_pool_t *frame_pool;
+
 	char *path;
 	char *format_name;
 	char *ffmpeg_options;
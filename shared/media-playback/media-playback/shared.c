@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#include <util/bmem.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/threading.h>
+#include <util/uthash.h>
+
+#include "shared.h"
+
+struct mp_shared_session {
+	char *key;
+	char *ffmpeg_options;
+	media_playback_t *media;
+
+	pthread_mutex_t mutex;
+	DARRAY(mp_shared_client_t *) clients;
+	size_t playing_clients;
+	bool running;
+	bool paused;
+	bool looping;
+
+	/* set when the session is stopped by its clients.  the decoder reports
+	 * that stop asynchronously, possibly after the session was restarted,
+	 * so that report is ignored. */
+	bool stop_pending;
+
+	/* held while stop callbacks run, keeps clients from being destroyed */
+	pthread_mutex_t stop_mutex;
+
+	/* protected by sessions_mutex */
+	long refs;
+	UT_hash_handle hh;
+};
+
+struct mp_shared_client {
+	struct mp_shared_session *session;
+
+	void *opaque;
+	mp_video_cb v_cb;
+	mp_video_ref_cb v_ref_cb;
+	mp_video_cb v_preload_cb;
+	mp_video_cb v_seek_cb;
+	mp_audio_cb a_cb;
+	mp_stop_cb stop_cb;
+
+	/* protected by session->mutex */
+	bool playing;
+	long generation;
+};
+
+struct stopped_client {
+	mp_shared_client_t *client;
+	long generation;
+};
+
+struct shared_frame_ref {
+	volatile long refs;
+	obs_source_frame_release_t release;
+	void *param;
+};
+
+static pthread_mutex_t sessions_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct mp_shared_session *sessions = NULL;
+
+/* ------------------------------------------------------------------------- */
+
+static void shared_frame_release(void *param)
+{
+	struct shared_frame_ref *ref = param;
+
+	if (os_atomic_dec_long(&ref->refs) == 0) {
+		ref->release(ref->param);
+		bfree(ref);
+	}
+}
+
+static void shared_video(void *opaque, struct obs_source_frame *frame)
+{
+	struct mp_shared_session *s = opaque;
+
+	pthread_mutex_lock(&s->mutex);
+	for (size_t i = 0; i < s->clients.num; i++) {
+		mp_shared_client_t *c = s->clients.array[i];
+		if (c->playing)
+			c->v_cb(c->opaque, frame);
+	}
+	pthread_mutex_unlock(&s->mutex);
+}
+
+static void shared_video_ref(void *opaque, struct obs_source_frame *frame, obs_source_frame_release_t release,
+			     void *param)
+{
+	struct mp_shared_session *s = opaque;
+	struct shared_frame_ref *ref;
+
+	pthread_mutex_lock(&s->mutex);
+
+	if (!s->playing_clients) {
+		pthread_mutex_unlock(&s->mutex);
+		release(param);
+		return;
+	}
+
+	ref = bmalloc(sizeof(*ref));
+	ref->refs = (long)s->playing_clients;
+	ref->release = release;
+	ref->param = param;
+
+	for (size_t i = 0; i < s->clients.num; i++) {
+		mp_shared_client_t *c = s->clients.array[i];
+		if (!c->playing)
+			continue;
+
+		if (c->v_ref_cb) {
+			c->v_ref_cb(c->opaque, frame, shared_frame_release, ref);
+		} else {
+			c->v_cb(c->opaque, frame);
+			shared_frame_release(ref);
+		}
+	}
+
+	pthread_mutex_unlock(&s->mutex);
+}
+
+static void shared_preload(void *opaque, struct obs_source_frame *frame)
+{
+	struct mp_shared_session *s = opaque;
+
+	pthread_mutex_lock(&s->mutex);
+	for (size_t i = 0; i < s->clients.num; i++) {
+		mp_shared_client_t *c = s->clients.array[i];
+		if (c->v_preload_cb)
+			c->v_preload_cb(c->opaque, frame);
+	}
+	pthread_mutex_unlock(&s->mutex);
+}
+
+static void shared_seek(void *opaque, struct obs_source_frame *frame)
+{
+	struct mp_shared_session *s = opaque;
+
+	pthread_mutex_lock(&s->mutex);
+	for (size_t i = 0; i < s->clients.num; i++) {
+		mp_shared_client_t *c = s->clients.array[i];
+		if (c->v_seek_cb)
+			c->v_seek_cb(c->opaque, frame);
+	}
+	pthread_mutex_unlock(&s->mutex);
+}
+
+static void shared_audio(void *opaque, struct obs_source_audio *audio)
+{
+	struct mp_shared_session *s = opaque;
+
+	pthread_mutex_lock(&s->mutex);
+	for (size_t i = 0; i < s->clients.num; i++) {
+		mp_shared_client_t *c = s->clients.array[i];
+		if (c->playing)
+			c->a_cb(c->opaque, audio);
+	}
+	pthread_mutex_unlock(&s->mutex);
+}
+
+static inline void client_start(struct mp_shared_session *s, mp_shared_client_t *c)
+{
+	c->playing = true;
+	c->generation++;
+	s->playing_clients++;
+}
+
+static void shared_stopped(void *opaque)
+{
+	struct mp_shared_session *s = opaque;
+	DARRAY(struct stopped_client) stopped;
+
+	da_init(stopped);
+
+	pthread_mutex_lock(&s->stop_mutex);
+	pthread_mutex_lock(&s->mutex);
+
+	if (s->stop_pending || !s->running) {
+		s->stop_pending = false;
+		pthread_mutex_unlock(&s->mutex);
+		pthread_mutex_unlock(&s->stop_mutex);
+		return;
+	}
+
+	s->running = false;
+	s->paused = false;
+	s->playing_clients = 0;
+
+	for (size_t i = 0; i < s->clients.num; i++) {
+		mp_shared_client_t *c = s->clients.array[i];
+		if (!c->playing)
+			continue;
+
+		c->playing = false;
+		if (c->stop_cb) {
+			struct stopped_client *sc = da_push_back_new(stopped);
+			sc->client = c;
+			sc->generation = c->generation;
+		}
+	}
+	pthread_mutex_unlock(&s->mutex);
+
+	/* stop callbacks may start the client again, which locks the session,
+	 * so they are called without holding it.  clients that were restarted
+	 * in the meantime are skipped. */
+	for (size_t i = 0; i < stopped.num; i++) {
+		mp_shared_client_t *c = stopped.array[i].client;
+		bool stale;
+
+		pthread_mutex_lock(&s->mutex);
+		stale = c->playing || c->generation != stopped.array[i].generation;
+		pthread_mutex_unlock(&s->mutex);
+
+		if (!stale)
+			c->stop_cb(c->opaque);
+	}
+
+	pthread_mutex_unlock(&s->stop_mutex);
+	da_free(stopped);
+}
+
+/* ------------------------------------------------------------------------- */
+
+bool mp_shared_supported(const struct mp_media_info *info)
+{
+	/* network streams reconnect per source, and stingers control their
+	 * own preloading, so neither can share a decoder */
+	return info->is_local_file && !info->request_preload && info->path && *info->path;
+}
+
+static void make_key(struct dstr *key, const struct mp_media_info *info)
+{
+	dstr_printf(key, "%s|%d|%d|%d|%d|%d|%d|%d|%s", info->path, info->buffering, info->speed,
+		    (int)info->force_range, info->is_linear_alpha, info->hardware_decoding, info->full_decode,
+		    info->compressed_cache, info->ffmpeg_options ? info->ffmpeg_options : "");
+}
+
+static struct mp_shared_session *session_create(const struct mp_media_info *info, char *key)
+{
+	struct mp_shared_session *s = bzalloc(sizeof(*s));
+	struct mp_media_info session_info = *info;
+
+	if (pthread_mutex_init(&s->mutex, NULL) != 0) {
+		bfree(s);
+		return NULL;
+	}
+	if (pthread_mutex_init(&s->stop_mutex, NULL) != 0) {
+		pthread_mutex_destroy(&s->mutex);
+		bfree(s);
+		return NULL;
+	}
+
+	/* the media object keeps a pointer to the options, which may outlive
+	 * the client that created the session */
+	s->ffmpeg_options = info->ffmpeg_options ? bstrdup(info->ffmpeg_options) : NULL;
+
+	session_info.opaque = s;
+	session_info.ffmpeg_options = s->ffmpeg_options;
+	session_info.v_cb = shared_video;
+	session_info.v_ref_cb = shared_video_ref;
+	session_info.v_preload_cb = shared_preload;
+	session_info.v_seek_cb = shared_seek;
+	session_info.a_cb = shared_audio;
+	session_info.stop_cb = shared_stopped;
+	session_info.shared = false;
+
+	s->media = media_playback_create(&session_info);
+	if (!s->media) {
+		pthread_mutex_destroy(&s->stop_mutex);
+		pthread_mutex_destroy(&s->mutex);
+		bfree(s->ffmpeg_options);
+		bfree(s);
+		return NULL;
+	}
+
+	s->key = key;
+	s->refs = 1;
+	HASH_ADD_KEYPTR(hh, sessions, s->key, strlen(s->key), s);
+
+	blog(LOG_DEBUG, "MP: Created shared decoding session for '%s'", info->path);
+	return s;
+}
+
+static void session_destroy(struct mp_shared_session *s)
+{
+	media_playback_destroy(s->media);
+	da_free(s->clients);
+	pthread_mutex_destroy(&s->stop_mutex);
+	pthread_mutex_destroy(&s->mutex);
+	bfree(s->ffmpeg_options);
+	bfree(s->key);
+	bfree(s);
+}
+
+mp_shared_client_t *mp_shared_client_create(const struct mp_media_info *info)
+{
+	struct mp_shared_session *s = NULL;
+	struct dstr key = {0};
+
+	make_key(&key, info);
+
+	pthread_mutex_lock(&sessions_mutex);
+	HASH_FIND_STR(sessions, key.array, s);
+	if (s) {
+		s->refs++;
+		dstr_free(&key);
+	} else {
+		s = session_create(info, key.array);
+		if (!s)
+			dstr_free(&key);
+	}
+	pthread_mutex_unlock(&sessions_mutex);
+
+	if (!s)
+		return NULL;
+
+	mp_shared_client_t *c = bzalloc(sizeof(*c));
+	c->session = s;
+	c->opaque = info->opaque;
+	c->v_cb = info->v_cb;
+	c->v_ref_cb = info->v_ref_cb;
+	c->v_preload_cb = info->v_preload_cb;
+	c->v_seek_cb = info->v_seek_cb;
+	c->a_cb = info->a_cb;
+	c->stop_cb = info->stop_cb;
+
+	pthread_mutex_lock(&s->mutex);
+	da_push_back(s->clients, &c);
+	pthread_mutex_unlock(&s->mutex);
+
+	return c;
+}
+
+void mp_shared_client_destroy(mp_shared_client_t *c)
+{
+	if (!c)
+		return;
+
+	struct mp_shared_session *s = c->session;
+	bool destroy = false;
+
+	mp_shared_client_stop(c);
+
+	pthread_mutex_lock(&s->stop_mutex);
+	pthread_mutex_lock(&s->mutex);
+	da_erase_item(s->clients, &c);
+	pthread_mutex_unlock(&s->mutex);
+	pthread_mutex_unlock(&s->stop_mutex);
+
+	pthread_mutex_lock(&sessions_mutex);
+	if (--s->refs == 0) {
+		HASH_DELETE(hh, sessions, s);
+		destroy = true;
+	}
+	pthread_mutex_unlock(&sessions_mutex);
+
+	/* joins the decoder thread, so must not hold either lock */
+	if (destroy)
+		session_destroy(s);
+
+	bfree(c);
+}
+
+void mp_shared_client_play(mp_shared_client_t *c, bool looping)
+{
+	struct mp_shared_session *s = c->session;
+
+	pthread_mutex_lock(&s->mutex);
+	if (!c->playing)
+		client_start(s, c);
+
+	s->looping = looping;
+	media_playback_set_looping(s->media, looping);
+
+	/* joining a session that is already playing does not restart it for
+	 * everyone else */
+	if (!s->running) {
+		s->running = true;
+		s->paused = false;
+		media_playback_play(s->media, looping, false);
+	} else if (s->paused) {
+		s->paused = false;
+		media_playback_play_pause(s->media, false);
+	}
+	pthread_mutex_unlock(&s->mutex);
+}
+
+void mp_shared_client_play_pause(mp_shared_client_t *c, bool pause)
+{
+	struct mp_shared_session *s = c->session;
+
+	pthread_mutex_lock(&s->mutex);
+	if (c->playing == !pause) {
+		pthread_mutex_unlock(&s->mutex);
+		return;
+	}
+
+	if (pause) {
+		c->playing = false;
+		s->playing_clients--;
+	} else {
+		client_start(s, c);
+	}
+
+	/* the session only pauses once every client has paused */
+	bool pause_session = s->playing_clients == 0;
+
+	if (!s->running && !pause) {
+		s->running = true;
+		s->paused = false;
+		media_playback_play(s->media, s->looping, false);
+	} else if (s->running && s->paused != pause_session) {
+		s->paused = pause_session;
+		media_playback_play_pause(s->media, pause_session);
+	}
+	pthread_mutex_unlock(&s->mutex);
+}
+
+void mp_shared_client_stop(mp_shared_client_t *c)
+{
+	struct mp_shared_session *s = c->session;
+
+	pthread_mutex_lock(&s->mutex);
+	if (c->playing) {
+		c->playing = false;
+		s->playing_clients--;
+	}
+
+	if (s->running && !s->playing_clients) {
+		s->running = false;
+		s->paused = false;
+		s->stop_pending = true;
+		media_playback_stop(s->media);
+	}
+	pthread_mutex_unlock(&s->mutex);
+}
+
+media_playback_t *mp_shared_client_media(mp_shared_client_t *c)
+{
+	return c->session->media;
+}
+
+size_t mp_shared_session_count(void)
+{
+	size_t count;
+
+	pthread_mutex_lock(&sessions_mutex);
+	count = HASH_CNT(hh, sessions);
+	pthread_mutex_unlock(&sessions_mutex);
+
+	return count;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 agent <agent@local>
+ *
+ * Permission to use, copy, modify, and distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#pragma once
+
+#include "media-playback.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Shared decoding sessions.
+ *
+ *   Clients created with matching paths and decode settings attach to a
+ * single decoder, and every decoded frame is handed to each client.  Frames
+ * passed by reference are refcounted across all clients, so the decoder's
+ * buffers are released once the last source is done with them.
+ *
+ *   The session plays while at least one client is playing.  Seeking and
+ * looping apply to the whole session.
+ */
+
+struct mp_shared_client;
+typedef struct mp_shared_client mp_shared_client_t;
+
+extern bool mp_shared_supported(const struct mp_media_info *info);
+
+extern mp_shared_client_t *mp_shared_client_create(const struct mp_media_info *info);
+extern void mp_shared_client_destroy(mp_shared_client_t *c);
+
+extern void mp_shared_client_play(mp_shared_client_t *c, bool looping);
+extern void mp_shared_client_play_pause(mp_shared_client_t *c, bool pause);
+extern void mp_shared_client_stop(mp_shared_client_t *c);
+
+/* the underlying session, for queries and session-wide operations */
+extern media_playback_t *mp_shared_client_media(mp_shared_client_t *c);
+
+extern size_t mp_shared_session_count(void);
+
+#ifdef __cplusplus
+}
+#endif
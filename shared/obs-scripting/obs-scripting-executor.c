@@ -0,0 +1,617 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#include <obs.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/threading.h>
+
+#include <inttypes.h>
+
+#include "obs-scripting-executor.h"
+#include "obs-scripting-callback.h"
+
+/* timer wheel granularity and size, covering 256 ms per revolution */
+#define WHEEL_RESOLUTION_NS 1000000ULL
+#define WHEEL_SLOTS 256
+
+/* how long the executor sleeps when there is nothing to do */
+#define IDLE_WAIT_MS 100
+
+/* calls taking longer than this are counted as overruns */
+#define CALL_BUDGET_NS 10000000ULL
+
+/* calls still running after this are reported by the watchdog */
+#define WATCHDOG_INTERVAL_MS 250
+#define WATCHDOG_LIMIT_NS 1000000000ULL
+
+struct script_timer {
+	struct script_timer *next;
+
+	struct script_callback *cb;
+	script_executor_cb func;
+
+	uint64_t interval;
+	uint64_t deadline;
+};
+
+struct script_tick {
+	struct script_callback *cb;
+	script_executor_cb func;
+};
+
+struct script_time {
+	obs_script_t *script;
+	uint64_t calls;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t overruns;
+};
+
+struct script_executor {
+	char *name;
+	script_executor_tick_cb tick;
+	void *param;
+
+	pthread_t thread;
+	pthread_t watchdog_thread;
+	os_event_t *wake;
+	os_event_t *stop;
+
+	/* filled by the graphics thread */
+	pthread_mutex_t pending_mutex;
+	float pending_seconds;
+	bool pending_tick;
+	struct script_timer *pending_timers;
+	DARRAY(struct script_tick) pending_ticks;
+	DARRAY(obs_script_t *) pending_removed;
+
+	/* owned by the executor thread */
+	struct script_timer *wheel[WHEEL_SLOTS];
+	uint64_t wheel_pos;
+	size_t timer_count;
+	uint64_t next_deadline;
+	DARRAY(struct script_tick) ticks;
+
+	/* accounting, shared with the watchdog */
+	pthread_mutex_t time_mutex;
+	DARRAY(struct script_time) times;
+	obs_script_t *cur_script;
+	uint64_t cur_start;
+	bool cur_reported;
+};
+
+/* ------------------------------------------------------------------------- */
+/* accounting                                                                */
+
+static const char *script_name(obs_script_t *script)
+{
+	const char *file = obs_script_get_file(script);
+	return file ? file : "(unknown)";
+}
+
+static struct script_time *find_script_time(struct script_executor *e, obs_script_t *script)
+{
+	for (size_t i = 0; i < e->times.num; i++) {
+		if (e->times.array[i].script == script)
+			return &e->times.array[i];
+	}
+
+	return NULL;
+}
+
+static void log_script_time(struct script_executor *e, struct script_time *st)
+{
+	if (!st->calls)
+		return;
+
+	blog(LOG_INFO,
+	     "[Scripting] %s script '%s': %" PRIu64 " calls, %.3f ms total, "
+	     "%.3f ms max, %" PRIu64 " over budget",
+	     e->name, script_name(st->script), st->calls, (double)st->total_ns / 1000000.0,
+	     (double)st->max_ns / 1000000.0, st->overruns);
+}
+
+static void begin_call_locked(struct script_executor *e, obs_script_t *script)
+{
+	if (!find_script_time(e, script)) {
+		struct script_time *st = da_push_back_new(e->times);
+		st->script = script;
+	}
+
+	e->cur_script = script;
+	e->cur_start = os_gettime_ns();
+	e->cur_reported = false;
+}
+
+void script_executor_begin_call(struct script_executor *e, obs_script_t *script)
+{
+	pthread_mutex_lock(&e->time_mutex);
+	begin_call_locked(e, script);
+	pthread_mutex_unlock(&e->time_mutex);
+}
+
+/* the removed flag is set before the script is removed from the executor, so
+ * checking it under the lock keeps unloaded scripts out of the accounting */
+static bool begin_callback(struct script_executor *e, struct script_callback *cb)
+{
+	bool removed;
+
+	pthread_mutex_lock(&e->time_mutex);
+	removed = script_callback_removed(cb);
+	if (!removed)
+		begin_call_locked(e, cb->script);
+	pthread_mutex_unlock(&e->time_mutex);
+
+	return !removed;
+}
+
+/* scripts are only dereferenced with the lock held, as they are removed with
+ * it held before they are freed */
+void script_executor_end_call(struct script_executor *e)
+{
+	uint64_t end = os_gettime_ns();
+
+	pthread_mutex_lock(&e->time_mutex);
+	struct script_time *st = e->cur_script ? find_script_time(e, e->cur_script) : NULL;
+	uint64_t duration = end - e->cur_start;
+	e->cur_script = NULL;
+
+	if (st) {
+		st->calls++;
+		st->total_ns += duration;
+		if (duration > st->max_ns)
+			st->max_ns = duration;
+
+		if (duration > CALL_BUDGET_NS) {
+			uint64_t overruns = ++st->overruns;
+
+			if (overruns == 1 || overruns % 100 == 0)
+				blog(LOG_WARNING,
+				     "[Scripting] %s script '%s' took %.3f ms (over budget %" PRIu64 " times)",
+				     e->name, script_name(st->script), (double)duration / 1000000.0, overruns);
+		}
+	}
+	pthread_mutex_unlock(&e->time_mutex);
+}
+
+void script_executor_remove_script(struct script_executor *e, obs_script_t *script)
+{
+	if (!e)
+		return;
+
+	pthread_mutex_lock(&e->time_mutex);
+	for (size_t i = 0; i < e->times.num; i++) {
+		struct script_time *st = &e->times.array[i];
+		if (st->script == script) {
+			log_script_time(e, st);
+			da_erase(e->times, i);
+			break;
+		}
+	}
+	if (e->cur_script == script)
+		e->cur_script = NULL;
+	pthread_mutex_unlock(&e->time_mutex);
+
+	/* timers and ticks already on the executor thread are dropped there */
+	pthread_mutex_lock(&e->pending_mutex);
+	struct script_timer **p_timer = &e->pending_timers;
+	while (*p_timer) {
+		struct script_timer *timer = *p_timer;
+
+		if (timer->cb->script == script) {
+			*p_timer = timer->next;
+			bfree(timer);
+		} else {
+			p_timer = &timer->next;
+		}
+	}
+
+	for (size_t i = e->pending_ticks.num; i > 0; i--) {
+		if (e->pending_ticks.array[i - 1].cb->script == script)
+			da_erase(e->pending_ticks, i - 1);
+	}
+
+	da_push_back(e->pending_removed, &script);
+	pthread_mutex_unlock(&e->pending_mutex);
+}
+
+static void *watchdog_thread(void *data)
+{
+	struct script_executor *e = data;
+	struct dstr name = {0};
+
+	dstr_printf(&name, "scripting: %s watchdog", e->name);
+	os_set_thread_name(name.array);
+	dstr_free(&name);
+
+	while (os_event_timedwait(e->stop, WATCHDOG_INTERVAL_MS) == ETIMEDOUT) {
+		pthread_mutex_lock(&e->time_mutex);
+		if (e->cur_script && !e->cur_reported) {
+			uint64_t elapsed = os_gettime_ns() - e->cur_start;
+
+			if (elapsed > WATCHDOG_LIMIT_NS) {
+				blog(LOG_WARNING, "[Scripting] %s script '%s' has been running for %" PRIu64 " ms",
+				     e->name, script_name(e->cur_script), elapsed / 1000000);
+				e->cur_reported = true;
+			}
+		}
+		pthread_mutex_unlock(&e->time_mutex);
+	}
+
+	return NULL;
+}
+
+/* ------------------------------------------------------------------------- */
+/* timer wheel                                                               */
+
+static void wheel_insert(struct script_executor *e, struct script_timer *timer)
+{
+	uint64_t slot_pos = timer->deadline / WHEEL_RESOLUTION_NS;
+
+	/* never insert into a slot that has already been processed */
+	if (slot_pos <= e->wheel_pos)
+		slot_pos = e->wheel_pos + 1;
+
+	struct script_timer **slot = &e->wheel[slot_pos % WHEEL_SLOTS];
+	timer->next = *slot;
+	*slot = timer;
+
+	if (timer->deadline < e->next_deadline)
+		e->next_deadline = timer->deadline;
+}
+
+static bool call_timer(struct script_executor *e, struct script_timer *timer)
+{
+	bool keep;
+
+	if (!begin_callback(e, timer->cb))
+		return false;
+
+	keep = timer->func(timer->cb, 0.0f);
+	script_executor_end_call(e);
+
+	return keep;
+}
+
+static void process_slot(struct script_executor *e, size_t idx, uint64_t now)
+{
+	struct script_timer *timer = e->wheel[idx];
+	e->wheel[idx] = NULL;
+
+	while (timer) {
+		struct script_timer *next = timer->next;
+
+		if (timer->deadline > now) {
+			/* due on a later revolution */
+			wheel_insert(e, timer);
+
+		} else if (call_timer(e, timer)) {
+			timer->deadline += timer->interval;
+
+			/* skip intervals that were missed entirely rather than
+			 * calling the timer repeatedly to catch up */
+			if (timer->deadline <= now)
+				timer->deadline = now + timer->interval;
+
+			wheel_insert(e, timer);
+
+		} else {
+			e->timer_count--;
+			bfree(timer);
+		}
+
+		timer = next;
+	}
+}
+
+static void process_timers(struct script_executor *e, uint64_t now)
+{
+	uint64_t now_pos = now / WHEEL_RESOLUTION_NS;
+	uint64_t count = now_pos - e->wheel_pos;
+
+	if (count > WHEEL_SLOTS)
+		count = WHEEL_SLOTS;
+
+	/* recalculated while reinserting */
+	e->next_deadline = UINT64_MAX;
+
+	for (uint64_t i = count; i > 0; i--) {
+		uint64_t pos = now_pos - i + 1;
+		e->wheel_pos = pos;
+		process_slot(e, (size_t)(pos % WHEEL_SLOTS), now);
+	}
+
+	e->wheel_pos = now_pos;
+
+	/* slots that weren't visited still hold timers; find the next one
+	 * due so the executor knows how long it can sleep */
+	if (count < WHEEL_SLOTS && e->timer_count) {
+		for (size_t i = 0; i < WHEEL_SLOTS; i++) {
+			for (struct script_timer *t = e->wheel[i]; t; t = t->next) {
+				if (t->deadline < e->next_deadline)
+					e->next_deadline = t->deadline;
+			}
+		}
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+static bool script_removed(const obs_script_t *const *removed, size_t count, const obs_script_t *script)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (removed[i] == script)
+			return true;
+	}
+
+	return false;
+}
+
+/* drops the timers and ticks of unloaded scripts, before any timers that were
+ * added later by a new script at the same address are inserted */
+static void drop_removed(struct script_executor *e, const obs_script_t *const *removed, size_t count)
+{
+	for (size_t i = 0; i < WHEEL_SLOTS; i++) {
+		struct script_timer **p_timer = &e->wheel[i];
+
+		while (*p_timer) {
+			struct script_timer *timer = *p_timer;
+
+			if (script_removed(removed, count, timer->cb->script)) {
+				*p_timer = timer->next;
+				e->timer_count--;
+				bfree(timer);
+			} else {
+				p_timer = &timer->next;
+			}
+		}
+	}
+
+	for (size_t i = e->ticks.num; i > 0; i--) {
+		if (script_removed(removed, count, e->ticks.array[i - 1].cb->script))
+			da_erase(e->ticks, i - 1);
+	}
+}
+
+static void take_pending(struct script_executor *e, float *seconds, bool *tick)
+{
+	struct script_timer *timers;
+	uint64_t now = os_gettime_ns();
+
+	pthread_mutex_lock(&e->pending_mutex);
+	if (e->pending_removed.num) {
+		drop_removed(e, (const obs_script_t *const *)e->pending_removed.array, e->pending_removed.num);
+		da_resize(e->pending_removed, 0);
+	}
+
+	*seconds = e->pending_seconds;
+	*tick = e->pending_tick;
+	e->pending_seconds = 0.0f;
+	e->pending_tick = false;
+
+	timers = e->pending_timers;
+	e->pending_timers = NULL;
+
+	da_push_back_da(e->ticks, e->pending_ticks);
+	da_resize(e->pending_ticks, 0);
+	pthread_mutex_unlock(&e->pending_mutex);
+
+	while (timers) {
+		struct script_timer *next = timers->next;
+		timers->deadline = now + timers->interval;
+		wheel_insert(e, timers);
+		e->timer_count++;
+		timers = next;
+	}
+}
+
+static void call_ticks(struct script_executor *e, float seconds)
+{
+	if (e->tick)
+		e->tick(e->param, seconds);
+
+	for (size_t i = e->ticks.num; i > 0; i--) {
+		struct script_tick *tick = &e->ticks.array[i - 1];
+		bool keep;
+
+		keep = begin_callback(e, tick->cb);
+		if (keep) {
+			keep = tick->func(tick->cb, seconds);
+			script_executor_end_call(e);
+		}
+
+		if (!keep)
+			da_erase(e->ticks, i - 1);
+	}
+}
+
+static void *executor_thread(void *data)
+{
+	struct script_executor *e = data;
+	struct dstr name = {0};
+
+	dstr_printf(&name, "scripting: %s", e->name);
+	os_set_thread_name(name.array);
+	dstr_free(&name);
+
+	e->wheel_pos = os_gettime_ns() / WHEEL_RESOLUTION_NS;
+	e->next_deadline = UINT64_MAX;
+
+	for (;;) {
+		uint64_t now = os_gettime_ns();
+		unsigned long wait_ms = IDLE_WAIT_MS;
+		float seconds;
+		bool tick;
+
+		if (e->next_deadline != UINT64_MAX) {
+			uint64_t until = e->next_deadline > now ? e->next_deadline - now : 0;
+
+			/* rounded up to at least the wheel resolution, so a
+			 * deadline less than a millisecond away is waited for
+			 * instead of spun on */
+			if (until < (uint64_t)IDLE_WAIT_MS * 1000000ULL)
+				wait_ms = (unsigned long)((until + 999999ULL) / 1000000ULL);
+			if (!wait_ms)
+				wait_ms = 1;
+		}
+
+		os_event_timedwait(e->wake, wait_ms);
+		if (os_event_try(e->stop) == 0)
+			break;
+
+		take_pending(e, &seconds, &tick);
+
+		if (tick)
+			call_ticks(e, seconds);
+
+		process_timers(e, os_gettime_ns());
+	}
+
+	return NULL;
+}
+
+/* called on the graphics thread */
+static void executor_frame_tick(void *param, float seconds)
+{
+	struct script_executor *e = param;
+
+	pthread_mutex_lock(&e->pending_mutex);
+	e->pending_seconds += seconds;
+	e->pending_tick = true;
+	pthread_mutex_unlock(&e->pending_mutex);
+
+	os_event_signal(e->wake);
+}
+
+struct script_executor *script_executor_create(const char *name, script_executor_tick_cb tick, void *param)
+{
+	struct script_executor *e = bzalloc(sizeof(*e));
+	e->name = bstrdup(name);
+	e->tick = tick;
+	e->param = param;
+
+	if (pthread_mutex_init(&e->pending_mutex, NULL) != 0)
+		goto fail_pending_mutex;
+	if (pthread_mutex_init(&e->time_mutex, NULL) != 0)
+		goto fail_time_mutex;
+	if (os_event_init(&e->wake, OS_EVENT_TYPE_AUTO) != 0)
+		goto fail_wake;
+	if (os_event_init(&e->stop, OS_EVENT_TYPE_MANUAL) != 0)
+		goto fail_stop;
+	if (pthread_create(&e->thread, NULL, executor_thread, e) != 0)
+		goto fail_thread;
+	if (pthread_create(&e->watchdog_thread, NULL, watchdog_thread, e) != 0)
+		goto fail_watchdog;
+
+	obs_add_tick_callback(executor_frame_tick, e);
+	return e;
+
+fail_watchdog:
+	os_event_signal(e->stop);
+	os_event_signal(e->wake);
+	pthread_join(e->thread, NULL);
+fail_thread:
+	os_event_destroy(e->stop);
+fail_stop:
+	os_event_destroy(e->wake);
+fail_wake:
+	pthread_mutex_destroy(&e->time_mutex);
+fail_time_mutex:
+	pthread_mutex_destroy(&e->pending_mutex);
+fail_pending_mutex:
+	blog(LOG_WARNING, "[Scripting] Failed to create %s executor", name);
+	bfree(e->name);
+	bfree(e);
+	return NULL;
+}
+
+void script_executor_destroy(struct script_executor *e)
+{
+	if (!e)
+		return;
+
+	obs_remove_tick_callback(executor_frame_tick, e);
+
+	os_event_signal(e->stop);
+	os_event_signal(e->wake);
+	pthread_join(e->thread, NULL);
+	pthread_join(e->watchdog_thread, NULL);
+
+	for (size_t i = 0; i < e->times.num; i++)
+		log_script_time(e, &e->times.array[i]);
+
+	for (size_t i = 0; i < WHEEL_SLOTS; i++) {
+		struct script_timer *timer = e->wheel[i];
+		while (timer) {
+			struct script_timer *next = timer->next;
+			bfree(timer);
+			timer = next;
+		}
+	}
+
+	struct script_timer *timer = e->pending_timers;
+	while (timer) {
+		struct script_timer *next = timer->next;
+		bfree(timer);
+		timer = next;
+	}
+
+	da_free(e->ticks);
+	da_free(e->pending_ticks);
+	da_free(e->pending_removed);
+	da_free(e->times);
+	os_event_destroy(e->wake);
+	os_event_destroy(e->stop);
+	pthread_mutex_destroy(&e->time_mutex);
+	pthread_mutex_destroy(&e->pending_mutex);
+	bfree(e->name);
+	bfree(e);
+}
+
+void script_executor_add_tick(struct script_executor *e, struct script_callback *cb, script_executor_cb func)
+{
+	struct script_tick tick = {cb, func};
+
+	if (!e)
+		return;
+
+	pthread_mutex_lock(&e->pending_mutex);
+	da_push_back(e->pending_ticks, &tick);
+	pthread_mutex_unlock(&e->pending_mutex);
+}
+
+void script_executor_add_timer(struct script_executor *e, struct script_callback *cb, uint32_t ms,
+			       script_executor_cb func)
+{
+	if (!e)
+		return;
+
+	struct script_timer *timer = bzalloc(sizeof(*timer));
+	timer->cb = cb;
+	timer->func = func;
+	/* a zero interval would spin the executor thread */
+	timer->interval = (uint64_t)(ms ? ms : 1) * 1000000ULL;
+
+	pthread_mutex_lock(&e->pending_mutex);
+	timer->next = e->pending_timers;
+	e->pending_timers = timer;
+	pthread_mutex_unlock(&e->pending_mutex);
+
+	os_event_signal(e->wake);
+}
@@ -0,0 +1,58 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+#pragma once
+
+#include "obs-scripting-internal.h"
+
+/*
+ * Script executor.
+ *
+ *   Each scripting runtime gets its own thread that runs script ticks and
+ * timers, so a slow script (or GIL contention) never delays rendering.  The
+ * graphics thread only signals the executor once per frame.  Timers are kept
+ * in a timer wheel on the executor thread.
+ *
+ *   Time spent in each script is accounted, and scripts that exceed their
+ * per-call budget are logged, including calls that are still running.
+ */
+
+struct script_executor;
+
+struct script_callback;
+
+typedef void (*script_executor_tick_cb)(void *param, float seconds);
+
+/* called with the script_callback it was added with, return false once it
+ * should no longer be called.  removed callbacks are not called */
+typedef bool (*script_executor_cb)(void *cb, float seconds);
+
+extern struct script_executor *script_executor_create(const char *name, script_executor_tick_cb tick, void *param);
+extern void script_executor_destroy(struct script_executor *e);
+
+/* may be called from any thread, including from within callbacks */
+extern void script_executor_add_tick(struct script_executor *e, struct script_callback *cb, script_executor_cb func);
+extern void script_executor_add_timer(struct script_executor *e, struct script_callback *cb, uint32_t ms,
+				      script_executor_cb func);
+
+/* accounts time spent in a script during the runtime's tick */
+extern void script_executor_begin_call(struct script_executor *e, obs_script_t *script);
+extern void script_executor_end_call(struct script_executor *e);
+
+/* logs and discards the time accounted to a script being unloaded, and drops
+ * its ticks and timers.  call after marking its callbacks as removed */
+extern void script_executor_remove_script(struct script_executor *e, obs_script_t *script);
@@ -16,6 +16,7 @@
 ******************************************************************************/
 
 #include "obs-scripting-lua.h"
+#include "obs-scripting-executor.h"
 #include <util/platform.h>
 #include <util/base.h>
 #include <util/dstr.h>
@@ -57,6 +58,7 @@ static char *startup_script = NULL;
 
 static pthread_mutex_t tick_mutex;
 static struct obs_lua_script *first_tick_script = NULL;
+static struct script_executor *lua_executor = NULL;
 
 pthread_mutex_t lua_source_def_mutex;
 
@@ -237,44 +239,6 @@ THREAD_LOCAL struct obs_lua_script *current_lua_script = NULL;
 
 /* -------------------------------------------- */
 
-struct lua_obs_timer {
-	struct lua_obs_timer *next;
-	struct lua_obs_timer **p_prev_next;
-
-	uint64_t last_ts;
-	uint64_t interval;
-};
-
-static pthread_mutex_t timer_mutex;
-static struct lua_obs_timer *first_timer = NULL;
-
-static inline void lua_obs_timer_init(struct lua_obs_timer *timer)
-{
-	pthread_mutex_lock(&timer_mutex);
-
-	struct lua_obs_timer *next = first_timer;
-	timer->next = next;
-	timer->p_prev_next = &first_timer;
-	if (next)
-		next->p_prev_next = &timer->next;
-	first_timer = timer;
-
-	pthread_mutex_unlock(&timer_mutex);
-}
-
-static inline void lua_obs_timer_remove(struct lua_obs_timer *timer)
-{
-	struct lua_obs_timer *next = timer->next;
-	if (next)
-		next->p_prev_next = timer->p_prev_next;
-	*timer->p_prev_next = timer->next;
-}
-
-static inline struct lua_obs_callback *lua_obs_timer_cb(struct lua_obs_timer *timer)
-{
-	return &((struct lua_obs_callback *)timer)[-1];
-}
-
 static int timer_remove(lua_State *script)
 {
 	if (!is_function(script, 1))
@@ -298,11 +262,17 @@ static void timer_call(struct script_callback *p_cb)
 	unlock_callback();
 }
 
-static void defer_timer_init(void *p_cb)
+static bool lua_timer(void *p_cb, float seconds)
 {
 	struct lua_obs_callback *cb = p_cb;
-	struct lua_obs_timer *timer = lua_obs_callback_extra_data(cb);
-	lua_obs_timer_init(timer);
+
+	if (script_callback_removed(&cb->base))
+		return false;
+
+	timer_call(&cb->base);
+
+	UNUSED_PARAMETER(seconds);
+	return true;
 }
 
 static int timer_add(lua_State *script)
@@ -313,13 +283,8 @@ static int timer_add(lua_State *script)
 	if (!ms)
 		return 0;
 
-	struct lua_obs_callback *cb = add_lua_obs_callback_extra(script, 1, sizeof(struct lua_obs_timer));
-	struct lua_obs_timer *timer = lua_obs_callback_extra_data(cb);
-
-	timer->interval = (uint64_t)ms * 1000000ULL;
-	timer->last_ts = obs_get_video_frame_time();
-
-	defer_call_post(defer_timer_init, cb);
+	struct lua_obs_callback *cb = add_lua_obs_callback(script, 1);
+	script_executor_add_timer(lua_executor, &cb->base, (uint32_t)ms, lua_timer);
 	return 0;
 }
 
@@ -372,15 +337,13 @@ static int obs_lua_add_main_render_callback(lua_State *script)
 
 /* -------------------------------------------- */
 
-static void obs_lua_tick_callback(void *priv, float seconds)
+static bool obs_lua_tick_callback(void *priv, float seconds)
 {
 	struct lua_obs_callback *cb = priv;
 	lua_State *script = cb->script;
 
-	if (script_callback_removed(&cb->base)) {
-		obs_remove_tick_callback(obs_lua_tick_callback, cb);
-		return;
-	}
+	if (script_callback_removed(&cb->base))
+		return false;
 
 	lock_callback();
 
@@ -388,6 +351,7 @@ static void obs_lua_tick_callback(void *priv, float seconds)
 	call_func(obs_lua_tick_callback, 1, 0);
 
 	unlock_callback();
+	return true;
 }
 
 static int obs_lua_remove_tick_callback(lua_State *script)
@@ -401,18 +365,13 @@ static int obs_lua_remove_tick_callback(lua_State *script)
 	return 0;
 }
 
-static void defer_add_tick(void *cb)
-{
-	obs_add_tick_callback(obs_lua_tick_callback, cb);
-}
-
 static int obs_lua_add_tick_callback(lua_State *script)
 {
 	if (!verify_args1(script, is_function))
 		return 0;
 
 	struct lua_obs_callback *cb = add_lua_obs_callback(script, 1);
-	defer_call_post(defer_add_tick, cb);
+	script_executor_add_tick(lua_executor, &cb->base, obs_lua_tick_callback);
 	return 0;
 }
 
@@ -1039,8 +998,6 @@ static void add_hook_functions(lua_State *script)
 static void lua_tick(void *param, float seconds)
 {
 	struct obs_lua_script *data;
-	struct lua_obs_timer *timer;
-	uint64_t ts = obs_get_video_frame_time();
 
 	/* --------------------------------- */
 	/* process script_tick calls         */
@@ -1052,10 +1009,12 @@ static void lua_tick(void *param, float seconds)
 		current_lua_script = data;
 
 		pthread_mutex_lock(&data->mutex);
+		script_executor_begin_call(lua_executor, &data->base);
 
 		lua_pushnumber(script, (double)seconds);
 		call_func_(script, data->tick, 1, 0, "tick", __FUNCTION__);
 
+		script_executor_end_call(lua_executor);
 		pthread_mutex_unlock(&data->mutex);
 
 		data = data->next_tick;
@@ -1063,30 +1022,6 @@ static void lua_tick(void *param, float seconds)
 	current_lua_script = NULL;
 	pthread_mutex_unlock(&tick_mutex);
 
-	/* --------------------------------- */
-	/* process timers                    */
-
-	pthread_mutex_lock(&timer_mutex);
-	timer = first_timer;
-	while (timer) {
-		struct lua_obs_timer *next = timer->next;
-		struct lua_obs_callback *cb = lua_obs_timer_cb(timer);
-
-		if (script_callback_removed(&cb->base)) {
-			lua_obs_timer_remove(timer);
-		} else {
-			uint64_t elapsed = ts - timer->last_ts;
-
-			if (elapsed >= timer->interval) {
-				timer_call(&cb->base);
-				timer->last_ts += timer->interval;
-			}
-		}
-
-		timer = next;
-	}
-	pthread_mutex_unlock(&timer_mutex);
-
 	UNUSED_PARAMETER(param);
 }
 
@@ -1192,6 +1127,8 @@ void obs_lua_script_unload(obs_script_t *s)
 		data->next_tick = NULL;
 	}
 
+	script_executor_remove_script(lua_executor, s);
+
 	/* ---------------------------- */
 	/* call script_unload           */
 
@@ -1318,7 +1255,6 @@ void obs_lua_load(void)
 	struct dstr tmp = {0};
 
 	pthread_mutex_init(&tick_mutex, NULL);
-	pthread_mutex_init_recursive(&timer_mutex);
 	pthread_mutex_init(&lua_source_def_mutex, NULL);
 
 	/* ---------------------------------------------- */
@@ -1364,15 +1300,15 @@ void obs_lua_load(void)
 	dstr_free(&package_cpath);
 	startup_script = tmp.array;
 
-	obs_add_tick_callback(lua_tick, NULL);
+	lua_executor = script_executor_create("lua", lua_tick, NULL);
 }
 
 void obs_lua_unload(void)
 {
-	obs_remove_tick_callback(lua_tick, NULL);
+	script_executor_destroy(lua_executor);
+	lua_executor = NULL;
 
 	bfree(startup_script);
 	pthread_mutex_destroy(&tick_mutex);
-	pthread_mutex_destroy(&timer_mutex);
 	pthread_mutex_destroy(&lua_source_def_mutex);
 }
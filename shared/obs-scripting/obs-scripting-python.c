@@ -17,6 +17,7 @@
 ******************************************************************************/
 
 #include "obs-scripting-python.h"
+#include "obs-scripting-executor.h"
 #include <util/base.h>
 #include <util/platform.h>
 #include <util/darray.h>
@@ -57,6 +58,7 @@ static bool mutexes_loaded = false;
 
 static pthread_mutex_t tick_mutex;
 static struct obs_python_script *first_tick_script = NULL;
+static struct script_executor *python_executor = NULL;
 
 static PyObject *py_obspython = NULL;
 struct obs_python_script *cur_python_script = NULL;
@@ -362,44 +364,6 @@ fail:
 
 /* -------------------------------------------- */
 
-struct python_obs_timer {
-	struct python_obs_timer *next;
-	struct python_obs_timer **p_prev_next;
-
-	uint64_t last_ts;
-	uint64_t interval;
-};
-
-static pthread_mutex_t timer_mutex;
-static struct python_obs_timer *first_timer = NULL;
-
-static inline void python_obs_timer_init(struct python_obs_timer *timer)
-{
-	pthread_mutex_lock(&timer_mutex);
-
-	struct python_obs_timer *next = first_timer;
-	timer->next = next;
-	timer->p_prev_next = &first_timer;
-	if (next)
-		next->p_prev_next = &timer->next;
-	first_timer = timer;
-
-	pthread_mutex_unlock(&timer_mutex);
-}
-
-static inline void python_obs_timer_remove(struct python_obs_timer *timer)
-{
-	struct python_obs_timer *next = timer->next;
-	if (next)
-		next->p_prev_next = timer->p_prev_next;
-	*timer->p_prev_next = timer->next;
-}
-
-static inline struct python_obs_callback *python_obs_timer_cb(struct python_obs_timer *timer)
-{
-	return &((struct python_obs_callback *)timer)[-1];
-}
-
 static PyObject *timer_remove(PyObject *self, PyObject *args)
 {
 	struct obs_python_script *script = cur_python_script;
@@ -430,11 +394,17 @@ static void timer_call(struct script_callback *p_cb)
 	unlock_callback();
 }
 
-static void defer_timer_init(void *p_cb)
+static bool python_timer(void *p_cb, float seconds)
 {
 	struct python_obs_callback *cb = p_cb;
-	struct python_obs_timer *timer = python_obs_callback_extra_data(cb);
-	python_obs_timer_init(timer);
+
+	if (script_callback_removed(&cb->base))
+		return false;
+
+	timer_call(&cb->base);
+
+	UNUSED_PARAMETER(seconds);
+	return true;
 }
 
 static PyObject *timer_add(PyObject *self, PyObject *args)
@@ -448,26 +418,19 @@ static PyObject *timer_add(PyObject *self, PyObject *args)
 	if (!parse_args(args, "Oi", &py_cb, &ms))
 		return python_none();
 
-	struct python_obs_callback *cb = add_python_obs_callback_extra(script, py_cb, sizeof(struct python_obs_timer));
-	struct python_obs_timer *timer = python_obs_callback_extra_data(cb);
-
-	timer->interval = (uint64_t)ms * 1000000ULL;
-	timer->last_ts = obs_get_video_frame_time();
-
-	defer_call_post(defer_timer_init, cb);
+	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
+	script_executor_add_timer(python_executor, &cb->base, (uint32_t)ms, python_timer);
 	return python_none();
 }
 
 /* -------------------------------------------- */
 
-static void obs_python_tick_callback(void *priv, float seconds)
+static bool obs_python_tick_callback(void *priv, float seconds)
 {
 	struct python_obs_callback *cb = priv;
 
-	if (script_callback_removed(&cb->base)) {
-		obs_remove_tick_callback(obs_python_tick_callback, cb);
-		return;
-	}
+	if (script_callback_removed(&cb->base))
+		return false;
 
 	lock_callback(cb);
 
@@ -478,6 +441,7 @@ static void obs_python_tick_callback(void *priv, float seconds)
 	Py_XDECREF(args);
 
 	unlock_callback();
+	return true;
 }
 
 static PyObject *obs_python_remove_tick_callback(PyObject *self, PyObject *args)
@@ -521,7 +485,7 @@ static PyObject *obs_python_add_tick_callback(PyObject *self, PyObject *args)
 		return python_none();
 
 	struct python_obs_callback *cb = add_python_obs_callback(script, py_cb);
-	obs_add_tick_callback(obs_python_tick_callback, cb);
+	script_executor_add_tick(python_executor, &cb->base, obs_python_tick_callback);
 	return python_none();
 }
 
@@ -1339,6 +1303,8 @@ void obs_python_script_unload(obs_script_t *s)
 		data->next_tick = NULL;
 	}
 
+	script_executor_remove_script(python_executor, s);
+
 	relock_python();
 
 	Py_XDECREF(data->tick);
@@ -1484,7 +1450,6 @@ static void python_tick(void *param, float seconds)
 	 */
 	struct obs_python_script *busy_script = NULL;
 	bool valid;
-	uint64_t ts = obs_get_video_frame_time();
 
 	pthread_mutex_lock(&tick_mutex);
 	valid = !!first_tick_script;
@@ -1507,9 +1472,11 @@ static void python_tick(void *param, float seconds)
 		while (data) {
 			cur_python_script = data;
 
+			script_executor_begin_call(python_executor, &data->base);
 			PyObject *py_ret = PyObject_CallObject(data->tick, args);
 			Py_XDECREF(py_ret);
 			py_error();
+			script_executor_end_call(python_executor);
 
 			data = data->next_tick;
 		}
@@ -1527,33 +1494,6 @@ static void python_tick(void *param, float seconds)
 		unlock_python();
 	}
 
-	/* --------------------------------- */
-	/* process timers                    */
-
-	pthread_mutex_lock(&timer_mutex);
-	struct python_obs_timer *timer = first_timer;
-	while (timer) {
-		struct python_obs_timer *next = timer->next;
-		struct python_obs_callback *cb = python_obs_timer_cb(timer);
-
-		if (script_callback_removed(&cb->base)) {
-			python_obs_timer_remove(timer);
-		} else {
-			uint64_t elapsed = ts - timer->last_ts;
-
-			if (elapsed >= timer->interval) {
-				lock_python();
-				timer_call(&cb->base);
-				unlock_python();
-
-				timer->last_ts += timer->interval;
-			}
-		}
-
-		timer = next;
-	}
-	pthread_mutex_unlock(&timer_mutex);
-
 	UNUSED_PARAMETER(param);
 }
 
@@ -1585,7 +1525,6 @@ void obs_python_load(void)
 	da_init(python_paths);
 
 	pthread_mutex_init(&tick_mutex, NULL);
-	pthread_mutex_init_recursive(&timer_mutex);
 
 	mutexes_loaded = true;
 }
@@ -1733,17 +1672,20 @@ out:
 	python_loaded_at_all = success;
 
 	if (python_loaded)
-		obs_add_tick_callback(python_tick, NULL);
+		python_executor = script_executor_create("python", python_tick, NULL);
 
 	return python_loaded;
 }
 
 void obs_python_unload(void)
 {
-	if (mutexes_loaded) {
+	/* stops all script ticks and timers, so must happen before the
+	 * interpreter is finalized */
+	script_executor_destroy(python_executor);
+	python_executor = NULL;
+
+	if (mutexes_loaded)
 		pthread_mutex_destroy(&tick_mutex);
-		pthread_mutex_destroy(&timer_mutex);
-	}
 
 	if (!python_loaded_at_all)
 		return;
@@ -1757,8 +1699,6 @@ void obs_python_unload(void)
 
 	/* ---------------------- */
 
-	obs_remove_tick_callback(python_tick, NULL);
-
 	for (size_t i = 0; i < python_paths.num; i++)
 		bfree(python_paths.array[i]);
 	da_free(python_paths);
@@ -0,0 +1,1294 @@
+/******************************************************************************
+    Copyright (C) 2026 by agent <agent@local>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+******************************************************************************/
+
+/*
+ * Headless libobs benchmark.
+ *
+ *   obs-benchmark <description.json> [results.json]
+ *
+ * Builds the scenes, filters, encoders and outputs described by the JSON
+ * file, runs the video pipeline for a fixed number of frames without any
+ * frontend, and writes per-phase timings gathered from the libobs profiler
+ * as JSON (to stdout unless a results file is given).  If the description
+ * has a "lookups" object, scene item lookups are also timed on a scene with
+ * that many items.  A "resampler" object compares swresample with the
+ * polyphase resampler for throughput and SNR, and an "audio_contention"
+ * object times obs_source_output_audio from several threads while the audio
+ * thread mixes.  See example.json for the description format.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include <obs.h>
+#include <media-io/audio-resampler.h>
+#include <util/base.h>
+#include <util/darray.h>
+#include <util/dstr.h>
+#include <util/platform.h>
+#include <util/profiler.h>
+#include <util/threading.h>
+
+#ifdef _WIN32
+#define DEFAULT_GRAPHICS_MODULE "libobs-d3d11"
+#else
+#define DEFAULT_GRAPHICS_MODULE "libobs-opengl"
+#endif
+
+#define OUTPUT_STOP_TIMEOUT_MS 5000
+
+/* ------------------------------------------------------------------------- */
+/* phases                                                                    */
+
+/* profiler entries that make up each reported phase; names ending in '('
+ * match any entry with that prefix.  entries are matched wherever they
+ * appear in the profiler tree, so a phase covers every mix and encoder. */
+struct phase_def {
+	const char *name;
+	const char *entries[4];
+};
+
+static const struct phase_def phase_defs[] = {
+	{"frame", {"obs_graphics_thread(", NULL}},
+	{"tick", {"tick_sources", NULL}},
+	{"render", {"render_main_texture", "render_output_texture", NULL}},
+	{"sprite_batch", {"render_sprite_batch", NULL}},
+	{"convert", {"render_convert_texture", NULL}},
+	{"download", {"stage_output_texture", "download_frame", "output_video_data", NULL}},
+	{"encode", {"do_encode", NULL}},
+	{"output", {"send_packet", NULL}},
+};
+
+#define NUM_PHASES (sizeof(phase_defs) / sizeof(phase_defs[0]))
+
+struct phase {
+	profiler_time_entries_t times;
+};
+
+static bool phase_matches(const struct phase_def *def, const char *name)
+{
+	for (size_t i = 0; i < 4 && def->entries[i]; i++) {
+		const char *entry = def->entries[i];
+		size_t len = strlen(entry);
+
+		if (entry[len - 1] == '(') {
+			if (strncmp(name, entry, len) == 0)
+				return true;
+		} else if (strcmp(name, entry) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void phase_add_time(struct phase *phase, uint64_t time_delta, int64_t count)
+{
+	for (size_t i = 0; i < phase->times.num; i++) {
+		profiler_time_entry_t *entry = &phase->times.array[i];
+		if (entry->time_delta == time_delta) {
+			entry->count = (uint64_t)((int64_t)entry->count + count);
+			return;
+		}
+	}
+
+	if (count > 0) {
+		profiler_time_entry_t *entry = da_push_back_new(phase->times);
+		entry->time_delta = time_delta;
+		entry->count = (uint64_t)count;
+	}
+}
+
+struct collect_data {
+	struct phase *phases;
+	int64_t sign;
+};
+
+static bool collect_entry(void *param, profiler_snapshot_entry_t *entry)
+{
+	struct collect_data *data = param;
+	const char *name = profiler_snapshot_entry_name(entry);
+
+	for (size_t i = 0; i < NUM_PHASES; i++) {
+		if (!phase_matches(&phase_defs[i], name))
+			continue;
+
+		profiler_time_entries_t *times = profiler_snapshot_entry_times(entry);
+		for (size_t j = 0; j < times->num; j++)
+			phase_add_time(&data->phases[i], times->array[j].time_delta,
+				       data->sign * (int64_t)times->array[j].count);
+	}
+
+	profiler_snapshot_enumerate_children(entry, collect_entry, param);
+	return true;
+}
+
+/* adds (sign > 0) or removes (sign < 0) everything recorded in a snapshot,
+ * which lets the warmup frames be subtracted out of the final totals */
+static void collect_snapshot(struct phase *phases, int64_t sign)
+{
+	struct collect_data data = {phases, sign};
+	profiler_snapshot_t *snap = profile_snapshot_create();
+
+	profiler_snapshot_enumerate_roots(snap, collect_entry, &data);
+	profile_snapshot_free(snap);
+}
+
+static int compare_time_entries(const void *a, const void *b)
+{
+	const profiler_time_entry_t *first = a;
+	const profiler_time_entry_t *second = b;
+
+	if (first->time_delta == second->time_delta)
+		return 0;
+	return first->time_delta < second->time_delta ? -1 : 1;
+}
+
+static uint64_t percentile(const profiler_time_entries_t *times, uint64_t calls, double pct)
+{
+	uint64_t target = (uint64_t)((double)calls * pct);
+	uint64_t accum = 0;
+
+	for (size_t i = 0; i < times->num; i++) {
+		accum += times->array[i].count;
+		if (accum > target)
+			return times->array[i].time_delta;
+	}
+
+	return times->num ? times->array[times->num - 1].time_delta : 0;
+}
+
+static obs_data_t *phase_results(struct phase *phase, uint32_t frames)
+{
+	obs_data_t *result = obs_data_create();
+	uint64_t calls = 0;
+	uint64_t total = 0;
+
+	if (phase->times.num)
+		qsort(phase->times.array, phase->times.num, sizeof(profiler_time_entry_t), compare_time_entries);
+
+	for (size_t i = 0; i < phase->times.num; i++) {
+		calls += phase->times.array[i].count;
+		total += phase->times.array[i].time_delta * phase->times.array[i].count;
+	}
+
+	/* profiler times are in microseconds */
+	obs_data_set_int(result, "calls", (long long)calls);
+	obs_data_set_double(result, "total_ms", (double)total / 1000.0);
+	obs_data_set_double(result, "mean_ms", calls ? (double)total / (double)calls / 1000.0 : 0.0);
+	obs_data_set_double(result, "per_frame_ms", frames ? (double)total / (double)frames / 1000.0 : 0.0);
+	obs_data_set_double(result, "median_ms", (double)percentile(&phase->times, calls, 0.5) / 1000.0);
+	obs_data_set_double(result, "p99_ms", (double)percentile(&phase->times, calls, 0.99) / 1000.0);
+	obs_data_set_double(result, "max_ms", (double)percentile(&phase->times, calls, 1.0) / 1000.0);
+	return result;
+}
+
+/* ------------------------------------------------------------------------- */
+/* scene construction                                                        */
+
+struct benchmark {
+	obs_data_t *desc;
+
+	DARRAY(obs_scene_t *) scenes;
+	DARRAY(obs_source_t *) sources;
+	DARRAY(obs_encoder_t *) encoders;
+	DARRAY(obs_output_t *) outputs;
+
+	size_t num_items;
+	size_t num_filters;
+};
+
+static const struct {
+	const char *name;
+	enum video_format format;
+} video_formats[] = {
+	{"NV12", VIDEO_FORMAT_NV12}, {"I420", VIDEO_FORMAT_I420}, {"I444", VIDEO_FORMAT_I444},
+	{"RGBA", VIDEO_FORMAT_RGBA}, {"BGRA", VIDEO_FORMAT_BGRA}, {"BGRX", VIDEO_FORMAT_BGRX},
+	{"P010", VIDEO_FORMAT_P010}, {"I010", VIDEO_FORMAT_I010},
+};
+
+static enum video_format get_video_format(const char *name)
+{
+	for (size_t i = 0; i < sizeof(video_formats) / sizeof(video_formats[0]); i++) {
+		if (astrcmpi(name, video_formats[i].name) == 0)
+			return video_formats[i].format;
+	}
+
+	blog(LOG_WARNING, "Unknown video format '%s', using NV12", name);
+	return VIDEO_FORMAT_NV12;
+}
+
+static bool reset_video(obs_data_t *video)
+{
+	struct obs_video_info ovi = {0};
+
+	obs_data_set_default_string(video, "graphics_module", DEFAULT_GRAPHICS_MODULE);
+	obs_data_set_default_int(video, "base_width", 1920);
+	obs_data_set_default_int(video, "base_height", 1080);
+	obs_data_set_default_int(video, "fps_num", 60);
+	obs_data_set_default_int(video, "fps_den", 1);
+	obs_data_set_default_string(video, "format", "NV12");
+	obs_data_set_default_bool(video, "gpu_conversion", true);
+
+	ovi.graphics_module = obs_data_get_string(video, "graphics_module");
+	ovi.base_width = (uint32_t)obs_data_get_int(video, "base_width");
+	ovi.base_height = (uint32_t)obs_data_get_int(video, "base_height");
+	ovi.output_width = (uint32_t)obs_data_get_int(video, "output_width");
+	ovi.output_height = (uint32_t)obs_data_get_int(video, "output_height");
+	ovi.fps_num = (uint32_t)obs_data_get_int(video, "fps_num");
+	ovi.fps_den = (uint32_t)obs_data_get_int(video, "fps_den");
+	ovi.output_format = get_video_format(obs_data_get_string(video, "format"));
+	ovi.gpu_conversion = obs_data_get_bool(video, "gpu_conversion");
+	ovi.colorspace = VIDEO_CS_709;
+	ovi.range = VIDEO_RANGE_PARTIAL;
+	ovi.scale_type = OBS_SCALE_BICUBIC;
+
+	if (!ovi.output_width || !ovi.output_height) {
+		ovi.output_width = ovi.base_width;
+		ovi.output_height = ovi.base_height;
+	}
+
+	int ret = obs_reset_video(&ovi);
+	if (ret != OBS_VIDEO_SUCCESS) {
+		blog(LOG_ERROR, "obs_reset_video failed (%d) with graphics module '%s'", ret, ovi.graphics_module);
+		return false;
+	}
+
+	return true;
+}
+
+static bool reset_audio(obs_data_t *audio)
+{
+	struct obs_audio_info oai = {0};
+
+	obs_data_set_default_int(audio, "samples_per_sec", 48000);
+
+	oai.samples_per_sec = (uint32_t)obs_data_get_int(audio, "samples_per_sec");
+	oai.speakers = SPEAKERS_STEREO;
+
+	if (!obs_reset_audio(&oai)) {
+		blog(LOG_ERROR, "obs_reset_audio failed");
+		return false;
+	}
+
+	return true;
+}
+
+static void add_filters(struct benchmark *bench, obs_source_t *source, obs_data_array_t *filters)
+{
+	size_t count = obs_data_array_count(filters);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *desc = obs_data_array_item(filters, i);
+		obs_data_t *settings = obs_data_get_obj(desc, "settings");
+		const char *id = obs_data_get_string(desc, "id");
+		struct dstr name = {0};
+
+		dstr_printf(&name, "%s filter %zu", obs_source_get_name(source), i);
+
+		obs_source_t *filter = obs_source_create_private(id, name.array, settings);
+		if (filter) {
+			obs_source_filter_add(source, filter);
+			obs_source_release(filter);
+			bench->num_filters++;
+		} else {
+			blog(LOG_WARNING, "Failed to create filter '%s'", id);
+		}
+
+		dstr_free(&name);
+		obs_data_release(settings);
+		obs_data_release(desc);
+	}
+}
+
+static void add_sources(struct benchmark *bench, obs_scene_t *scene, obs_data_array_t *sources)
+{
+	size_t count = obs_data_array_count(sources);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *desc = obs_data_array_item(sources, i);
+		obs_data_t *settings = obs_data_get_obj(desc, "settings");
+		obs_data_array_t *filters = obs_data_get_array(desc, "filters");
+		const char *id = obs_data_get_string(desc, "id");
+
+		obs_data_set_default_int(desc, "count", 1);
+		long long instances = obs_data_get_int(desc, "count");
+
+		for (long long j = 0; j < instances; j++) {
+			struct dstr name = {0};
+			dstr_printf(&name, "%s %s %zu.%lld", obs_source_get_name(obs_scene_get_source(scene)), id, i,
+				    j);
+
+			obs_source_t *source = obs_source_create(id, name.array, settings, NULL);
+			dstr_free(&name);
+
+			if (!source) {
+				blog(LOG_WARNING, "Failed to create source '%s'", id);
+				break;
+			}
+
+			add_filters(bench, source, filters);
+
+			/* spread the items out so they do not all overlap */
+			obs_sceneitem_t *item = obs_scene_add(scene, source);
+			struct vec2 pos;
+			vec2_set(&pos, (float)((j * 37) % 1600), (float)((j * 53) % 900));
+			obs_sceneitem_set_pos(item, &pos);
+
+			da_push_back(bench->sources, &source);
+			bench->num_items++;
+		}
+
+		obs_data_array_release(filters);
+		obs_data_release(settings);
+		obs_data_release(desc);
+	}
+}
+
+static obs_scene_t *find_scene(struct benchmark *bench, const char *name)
+{
+	for (size_t i = 0; i < bench->scenes.num; i++) {
+		obs_source_t *source = obs_scene_get_source(bench->scenes.array[i]);
+		if (strcmp(obs_source_get_name(source), name) == 0)
+			return bench->scenes.array[i];
+	}
+
+	return NULL;
+}
+
+/* scenes may only nest scenes declared before them, which also rules out
+ * cycles */
+static bool create_scenes(struct benchmark *bench)
+{
+	obs_data_array_t *scenes = obs_data_get_array(bench->desc, "scenes");
+	size_t count = obs_data_array_count(scenes);
+
+	for (size_t i = 0; i < count; i++) {
+		obs_data_t *desc = obs_data_array_item(scenes, i);
+		obs_data_array_t *sources = obs_data_get_array(desc, "sources");
+		obs_data_array_t *filters = obs_data_get_array(desc, "filters");
+		obs_data_array_t *nested = obs_data_get_array(desc, "scenes");
+		const char *name = obs_data_get_string(desc, "name");
+		struct dstr default_name = {0};
+
+		if (!*name) {
+			dstr_printf(&default_name, "scene %zu", i);
+			name = default_name.array;
+		}
+
+		obs_scene_t *scene = obs_scene_create_private(name);
+		da_push_back(bench->scenes, &scene);
+
+		add_sources(bench, scene, sources);
+		add_filters(bench, obs_scene_get_source(scene), filters);
+
+		for (size_t j = 0; j < obs_data_array_count(nested); j++) {
+			obs_data_t *item = obs_data_array_item(nested, j);
+			const char *nested_name = obs_data_get_string(item, "name");
+			obs_scene_t *child = find_scene(bench, nested_name);
+
+			if (child && child != scene) {
+				obs_scene_add(scene, obs_scene_get_source(child));
+				bench->num_items++;
+			} else {
+				blog(LOG_WARNING, "Scene '%s' cannot nest unknown scene '%s'", name, nested_name);
+			}
+
+			obs_data_release(item);
+		}
+
+		dstr_free(&default_name);
+		obs_data_array_release(nested);
+		obs_data_array_release(filters);
+		obs_data_array_release(sources);
+		obs_data_release(desc);
+	}
+
+	obs_data_array_release(scenes);
+
+	if (!bench->scenes.num) {
+		blog(LOG_ERROR, "The description does not contain any scenes");
+		return false;
+	}
+
+	const char *program = obs_data_get_string(bench->desc, "program");
+	obs_scene_t *program_scene = *program ? find_scene(bench, program) : bench->scenes.array[bench->scenes.num - 1];
+	if (!program_scene) {
+		blog(LOG_ERROR, "Program scene '%s' does not exist", program);
+		return false;
+	}
+
+	obs_set_output_source(0, obs_scene_get_source(program_scene));
+	return true;
+}
+
+static obs_encoder_t *create_encoder(struct benchmark *bench, obs_data_t *desc, bool video, size_t idx)
+{
+	obs_data_t *settings = obs_data_get_obj(desc, "settings");
+	const char *id = obs_data_get_string(desc, "id");
+	obs_encoder_t *encoder;
+	struct dstr name = {0};
+
+	dstr_printf(&name, "benchmark %s encoder %zu", video ? "video" : "audio", idx);
+
+	if (video) {
+		encoder = obs_video_encoder_create(id, name.array, settings, NULL);
+		if (encoder)
+			obs_encoder_set_video(encoder, obs_get_video());
+	} else {
+		encoder = obs_audio_encoder_create(id, name.array, settings, 0, NULL);
+		if (encoder)
+			obs_encoder_set_audio(encoder, obs_get_audio());
+	}
+
+	if (encoder)
+		da_push_back(bench->encoders, &encoder);
+	else
+		blog(LOG_ERROR, "Failed to create %s encoder '%s'", video ? "video" : "audio", id);
+
+	dstr_free(&name);
+	obs_data_release(settings);
+	return encoder;
+}
+
+/* every output gets its own encoders so that each one adds a full encode
+ * to the per-frame cost */
+static bool start_outputs(struct benchmark *bench)
+{
+	obs_data_t *outputs = obs_data_get_obj(bench->desc, "outputs");
+	obs_data_t *video_desc;
+	obs_data_t *audio_desc;
+	bool success = true;
+
+	if (!outputs)
+		return true;
+
+	video_desc = obs_data_get_obj(outputs, "video_encoder");
+	audio_desc = obs_data_get_obj(outputs, "audio_encoder");
+
+	obs_data_set_default_string(video_desc, "id", "obs_x264");
+	obs_data_set_default_string(audio_desc, "id", "ffmpeg_aac");
+
+	size_t count = (size_t)obs_data_get_int(outputs, "count");
+
+	for (size_t i = 0; i < count; i++) {
+		obs_encoder_t *venc = create_encoder(bench, video_desc, true, i);
+		obs_encoder_t *aenc = create_encoder(bench, audio_desc, false, i);
+		struct dstr name = {0};
+
+		if (!venc || !aenc) {
+			success = false;
+			break;
+		}
+
+		dstr_printf(&name, "benchmark output %zu", i);
+		obs_output_t *output = obs_output_create("null_output", name.array, NULL, NULL);
+		dstr_free(&name);
+
+		if (!output) {
+			blog(LOG_ERROR, "Failed to create null output (is obs-outputs loaded?)");
+			success = false;
+			break;
+		}
+
+		da_push_back(bench->outputs, &output);
+
+		obs_output_set_video_encoder(output, venc);
+		obs_output_set_audio_encoder(output, aenc, 0);
+
+		if (!obs_output_start(output)) {
+			blog(LOG_ERROR, "Failed to start output %zu: %s", i, obs_output_get_last_error(output));
+			success = false;
+			break;
+		}
+	}
+
+	obs_data_release(audio_desc);
+	obs_data_release(video_desc);
+	obs_data_release(outputs);
+	return success;
+}
+
+static void stop_outputs(struct benchmark *bench)
+{
+	for (size_t i = 0; i < bench->outputs.num; i++)
+		obs_output_stop(bench->outputs.array[i]);
+
+	for (size_t i = 0; i < bench->outputs.num; i++) {
+		obs_output_t *output = bench->outputs.array[i];
+
+		for (int ms = 0; obs_output_active(output) && ms < OUTPUT_STOP_TIMEOUT_MS; ms += 10)
+			os_sleep_ms(10);
+		if (obs_output_active(output))
+			obs_output_force_stop(output);
+	}
+}
+
+static void benchmark_free(struct benchmark *bench)
+{
+	obs_set_output_source(0, NULL);
+
+	for (size_t i = 0; i < bench->outputs.num; i++)
+		obs_output_release(bench->outputs.array[i]);
+	for (size_t i = 0; i < bench->encoders.num; i++)
+		obs_encoder_release(bench->encoders.array[i]);
+	for (size_t i = 0; i < bench->sources.num; i++)
+		obs_source_release(bench->sources.array[i]);
+	for (size_t i = 0; i < bench->scenes.num; i++)
+		obs_scene_release(bench->scenes.array[i]);
+
+	da_free(bench->outputs);
+	da_free(bench->encoders);
+	da_free(bench->sources);
+	da_free(bench->scenes);
+}
+
+/* ------------------------------------------------------------------------- */
+/* scene lookups                                                             */
+
+struct lookup_target {
+	obs_source_t *source;
+	char *name;
+	char *uuid;
+	int64_t id;
+};
+
+static inline struct lookup_target *pick_target(struct lookup_target *targets, size_t count, size_t n)
+{
+	/* stride through the items so lookups do not favor the list head */
+	return &targets[(n * 7919) % count];
+}
+
+enum lookup_kind {
+	LOOKUP_NAME,
+	LOOKUP_NAME_RECURSIVE,
+	LOOKUP_UUID,
+	LOOKUP_ID,
+	LOOKUP_MISSING,
+};
+
+/* returns the average time of one lookup in nanoseconds */
+static double time_lookups(obs_scene_t *scene, struct lookup_target *targets, size_t count, size_t iterations,
+			   enum lookup_kind kind)
+{
+	size_t hits = 0;
+	uint64_t start = os_gettime_ns();
+
+	for (size_t n = 0; n < iterations; n++) {
+		struct lookup_target *target = pick_target(targets, count, n);
+		obs_sceneitem_t *item = NULL;
+
+		switch (kind) {
+		case LOOKUP_NAME:
+			item = obs_scene_find_source(scene, target->name);
+			break;
+		case LOOKUP_NAME_RECURSIVE:
+			item = obs_scene_find_source_recursive(scene, target->name);
+			break;
+		case LOOKUP_UUID:
+			item = obs_scene_find_source_by_uuid(scene, target->uuid);
+			break;
+		case LOOKUP_ID:
+			item = obs_scene_find_sceneitem_by_id(scene, target->id);
+			break;
+		case LOOKUP_MISSING:
+			item = obs_scene_find_source_recursive(scene, "missing lookup item");
+			break;
+		}
+
+		if (item)
+			hits++;
+	}
+
+	uint64_t elapsed = os_gettime_ns() - start;
+
+	if (kind != LOOKUP_MISSING && hits != iterations)
+		blog(LOG_WARNING, "Scene lookups: %zu of %zu lookups failed", iterations - hits, iterations);
+
+	return (double)elapsed / (double)iterations;
+}
+
+static obs_data_t *run_lookup_benchmark(obs_data_t *desc)
+{
+	obs_data_t *lookups = obs_data_get_obj(desc, "lookups");
+	if (!lookups)
+		return NULL;
+
+	obs_data_set_default_int(lookups, "items", 2000);
+	obs_data_set_default_int(lookups, "groups", 4);
+	obs_data_set_default_int(lookups, "iterations", 100000);
+
+	size_t count = (size_t)obs_data_get_int(lookups, "items");
+	size_t num_groups = (size_t)obs_data_get_int(lookups, "groups");
+	size_t iterations = (size_t)obs_data_get_int(lookups, "iterations");
+	obs_data_release(lookups);
+
+	if (!count || !iterations)
+		return NULL;
+
+	struct lookup_target *targets = bzalloc(sizeof(*targets) * count);
+	obs_scene_t *scene = obs_scene_create_private("lookup benchmark");
+	DARRAY(obs_sceneitem_t *) groups;
+	da_init(groups);
+
+	for (size_t i = 0; i < count; i++) {
+		struct dstr name = {0};
+		dstr_printf(&name, "lookup item %zu", i);
+
+		obs_scene_t *child = obs_scene_create_private(name.array);
+		targets[i].source = obs_source_get_ref(obs_scene_get_source(child));
+		targets[i].name = bstrdup(name.array);
+		targets[i].uuid = bstrdup(obs_source_get_uuid(targets[i].source));
+		obs_scene_release(child);
+		dstr_free(&name);
+	}
+
+	uint64_t start = os_gettime_ns();
+	for (size_t i = 0; i < count; i++)
+		targets[i].id = obs_sceneitem_get_id(obs_scene_add(scene, targets[i].source));
+	double add_ns = (double)(os_gettime_ns() - start) / (double)count;
+
+	/* move the second half of the items into groups, which makes the
+	 * recursive lookups walk the list */
+	for (size_t i = 0; i < num_groups; i++) {
+		struct dstr name = {0};
+		dstr_printf(&name, "lookup group %zu", i);
+		obs_sceneitem_t *group = obs_scene_add_group2(scene, name.array, false);
+		da_push_back(groups, &group);
+		dstr_free(&name);
+	}
+	for (size_t i = count / 2; groups.num && i < count; i++) {
+		obs_sceneitem_t *item = obs_scene_find_sceneitem_by_id(scene, targets[i].id);
+		obs_sceneitem_group_add_item(groups.array[i % groups.num], item);
+	}
+
+	size_t top = groups.num ? count / 2 : count;
+
+	double find_ns = time_lookups(scene, targets, top, iterations, LOOKUP_NAME);
+	double find_recursive_ns = time_lookups(scene, targets, count, iterations, LOOKUP_NAME_RECURSIVE);
+	double find_uuid_ns = time_lookups(scene, targets, top, iterations, LOOKUP_UUID);
+	double find_id_ns = time_lookups(scene, targets, top, iterations, LOOKUP_ID);
+	double find_missing_ns = time_lookups(scene, targets, count, iterations, LOOKUP_MISSING);
+
+	start = os_gettime_ns();
+	for (size_t i = 0; i < top; i++)
+		obs_sceneitem_remove(obs_scene_find_sceneitem_by_id(scene, targets[i].id));
+	double remove_ns = (double)(os_gettime_ns() - start) / (double)top;
+
+	obs_data_t *results = obs_data_create();
+	obs_data_set_int(results, "items", (long long)count);
+	obs_data_set_int(results, "groups", (long long)groups.num);
+	obs_data_set_int(results, "iterations", (long long)iterations);
+	obs_data_set_double(results, "add_ns", add_ns);
+	obs_data_set_double(results, "find_source_ns", find_ns);
+	obs_data_set_double(results, "find_source_recursive_ns", find_recursive_ns);
+	obs_data_set_double(results, "find_source_by_uuid_ns", find_uuid_ns);
+	obs_data_set_double(results, "find_sceneitem_by_id_ns", find_id_ns);
+	obs_data_set_double(results, "find_missing_ns", find_missing_ns);
+	obs_data_set_double(results, "remove_ns", remove_ns);
+
+	obs_scene_release(scene);
+	for (size_t i = 0; i < count; i++) {
+		obs_source_release(targets[i].source);
+		bfree(targets[i].name);
+		bfree(targets[i].uuid);
+	}
+	bfree(targets);
+	da_free(groups);
+	return results;
+}
+
+/* ------------------------------------------------------------------------- */
+/* resampling                                                                */
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+static const double snr_freqs[] = {100.0, 1000.0, 5000.0, 10000.0, 15000.0, 20000.0};
+
+#define NUM_SNR_FREQS (sizeof(snr_freqs) / sizeof(snr_freqs[0]))
+
+struct resample_run {
+	DARRAY(float) output;
+	uint64_t elapsed_ns;
+};
+
+/* feeds planar float input through the resampler in packets, keeping the
+ * first output channel */
+static bool run_resampler(audio_resampler_t *rs, float *const planes[], size_t channels, size_t frames,
+			  size_t packet_frames, struct resample_run *run)
+{
+	const uint8_t *input[MAX_AV_PLANES] = {0};
+	uint64_t start = os_gettime_ns();
+
+	for (size_t pos = 0; pos < frames; pos += packet_frames) {
+		uint32_t in_frames = (uint32_t)(frames - pos < packet_frames ? frames - pos : packet_frames);
+		uint8_t *output[MAX_AV_PLANES];
+		uint32_t out_frames;
+		uint64_t ts_offset;
+
+		for (size_t c = 0; c < channels; c++)
+			input[c] = (const uint8_t *)(planes[c] + pos);
+
+		if (!audio_resampler_resample(rs, output, &out_frames, &ts_offset, input, in_frames))
+			return false;
+
+		da_push_back_array(run->output, (const float *)output[0], out_frames);
+	}
+
+	run->elapsed_ns = os_gettime_ns() - start;
+	return true;
+}
+
+/* least squares fit of a sine at the test frequency; everything the fit
+ * doesn't explain counts as noise.  the edges are skipped so the filter
+ * delay doesn't matter. */
+static double measure_snr(const float *samples, size_t count, double freq, uint32_t rate)
+{
+	double w = 2.0 * M_PI * freq / (double)rate;
+	double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+	size_t begin = count / 10;
+	size_t end = count - count / 10;
+
+	for (size_t i = begin; i < end; i++) {
+		double s = sin(w * (double)i);
+		double c = cos(w * (double)i);
+		ss += s * s;
+		cc += c * c;
+		sc += s * c;
+		ys += samples[i] * s;
+		yc += samples[i] * c;
+	}
+
+	double det = ss * cc - sc * sc;
+	double a = (ys * cc - yc * sc) / det;
+	double b = (yc * ss - ys * sc) / det;
+	double signal = 0.0, noise = 0.0;
+
+	for (size_t i = begin; i < end; i++) {
+		double fit = a * sin(w * (double)i) + b * cos(w * (double)i);
+		double diff = samples[i] - fit;
+		signal += fit * fit;
+		noise += diff * diff;
+	}
+
+	return noise > 0.0 ? 10.0 * log10(signal / noise) : 200.0;
+}
+
+static obs_data_t *benchmark_resampler_type(enum audio_resampler_type type, const struct resample_info *dst,
+					    const struct resample_info *src, size_t seconds, size_t packet_frames)
+{
+	size_t channels = get_audio_channels(src->speakers);
+	size_t frames = (size_t)src->samples_per_sec * seconds;
+	float *planes[MAX_AUDIO_CHANNELS] = {0};
+	struct resample_run run = {0};
+	obs_data_t *results = NULL;
+	audio_resampler_t *rs = NULL;
+
+	for (size_t c = 0; c < channels; c++)
+		planes[c] = bmalloc(sizeof(float) * frames);
+
+	/* throughput on a tone sweeping through the audible range */
+	for (size_t i = 0; i < frames; i++) {
+		double t = (double)i / (double)src->samples_per_sec;
+		float val = (float)(0.5 * sin(2.0 * M_PI * (50.0 + 500.0 * t) * t));
+		for (size_t c = 0; c < channels; c++)
+			planes[c][i] = val;
+	}
+
+	rs = audio_resampler_create_type(type, dst, src);
+	if (!rs || audio_resampler_get_type(rs) != type)
+		goto fail;
+	if (!run_resampler(rs, planes, channels, frames, packet_frames, &run))
+		goto fail;
+
+	double audio_ns = (double)seconds * 1000000000.0;
+
+	results = obs_data_create();
+	obs_data_set_double(results, "realtime_factor", audio_ns / (double)run.elapsed_ns);
+	obs_data_set_double(results, "ns_per_frame", (double)run.elapsed_ns / (double)frames);
+
+	obs_data_array_t *snr = obs_data_array_create();
+	double min_snr = 200.0;
+	uint32_t min_rate = src->samples_per_sec < dst->samples_per_sec ? src->samples_per_sec : dst->samples_per_sec;
+
+	for (size_t f = 0; f < NUM_SNR_FREQS; f++) {
+		double freq = snr_freqs[f];
+
+		/* only frequencies both rates can carry */
+		if (freq >= (double)min_rate * 0.45)
+			continue;
+
+		for (size_t i = 0; i < frames; i++) {
+			float val = (float)(0.5 * sin(2.0 * M_PI * freq * (double)i / (double)src->samples_per_sec));
+			for (size_t c = 0; c < channels; c++)
+				planes[c][i] = val;
+		}
+
+		audio_resampler_destroy(rs);
+		rs = audio_resampler_create_type(type, dst, src);
+		da_resize(run.output, 0);
+		if (!rs || !run_resampler(rs, planes, channels, frames, packet_frames, &run))
+			break;
+
+		double val = measure_snr(run.output.array, run.output.num, freq, dst->samples_per_sec);
+		if (val < min_snr)
+			min_snr = val;
+
+		obs_data_t *item = obs_data_create();
+		obs_data_set_double(item, "freq", freq);
+		obs_data_set_double(item, "snr_db", val);
+		obs_data_array_push_back(snr, item);
+		obs_data_release(item);
+	}
+
+	obs_data_set_array(results, "snr", snr);
+	obs_data_set_double(results, "min_snr_db", min_snr);
+	obs_data_array_release(snr);
+
+fail:
+	if (!results)
+		blog(LOG_WARNING, "Resampler benchmark: resampler type %d failed for this conversion", (int)type);
+
+	audio_resampler_destroy(rs);
+	da_free(run.output);
+	for (size_t c = 0; c < channels; c++)
+		bfree(planes[c]);
+	return results;
+}
+
+static obs_data_t *run_resampler_benchmark(obs_data_t *desc)
+{
+	obs_data_t *resampler = obs_data_get_obj(desc, "resampler");
+	if (!resampler)
+		return NULL;
+
+	obs_data_set_default_int(resampler, "input_rate", 44100);
+	obs_data_set_default_int(resampler, "output_rate", 48000);
+	obs_data_set_default_int(resampler, "channels", 2);
+	obs_data_set_default_int(resampler, "seconds", 30);
+	obs_data_set_default_int(resampler, "packet_frames", 1024);
+
+	struct resample_info src = {
+		.samples_per_sec = (uint32_t)obs_data_get_int(resampler, "input_rate"),
+		.format = AUDIO_FORMAT_FLOAT_PLANAR,
+		.speakers = (enum speaker_layout)obs_data_get_int(resampler, "channels"),
+	};
+	struct resample_info dst = src;
+	dst.samples_per_sec = (uint32_t)obs_data_get_int(resampler, "output_rate");
+
+	size_t seconds = (size_t)obs_data_get_int(resampler, "seconds");
+	size_t packet_frames = (size_t)obs_data_get_int(resampler, "packet_frames");
+	obs_data_release(resampler);
+
+	if (!src.samples_per_sec || !dst.samples_per_sec || !seconds || !packet_frames)
+		return NULL;
+	/* speaker layouts are numbered by channel count, apart from 7 */
+	if (!get_audio_channels(src.speakers))
+		return NULL;
+
+	obs_data_t *results = obs_data_create();
+	obs_data_set_int(results, "input_rate", src.samples_per_sec);
+	obs_data_set_int(results, "output_rate", dst.samples_per_sec);
+	obs_data_set_int(results, "channels", get_audio_channels(src.speakers));
+
+	obs_data_t *swr = benchmark_resampler_type(AUDIO_RESAMPLER_SWRESAMPLE, &dst, &src, seconds, packet_frames);
+	obs_data_t *polyphase = benchmark_resampler_type(AUDIO_RESAMPLER_POLYPHASE, &dst, &src, seconds, packet_frames);
+	if (swr)
+		obs_data_set_obj(results, "swresample", swr);
+	if (polyphase)
+		obs_data_set_obj(results, "polyphase", polyphase);
+	obs_data_release(swr);
+	obs_data_release(polyphase);
+	return results;
+}
+
+/* ------------------------------------------------------------------------- */
+/* audio contention                                                          */
+
+static const char *contention_source_name(void *type_data)
+{
+	UNUSED_PARAMETER(type_data);
+	return "Benchmark Audio";
+}
+
+static void *contention_source_create(obs_data_t *settings, obs_source_t *source)
+{
+	UNUSED_PARAMETER(settings);
+	return source;
+}
+
+static void contention_source_destroy(void *data)
+{
+	UNUSED_PARAMETER(data);
+}
+
+static struct obs_source_info contention_source_info = {
+	.id = "benchmark_audio_source",
+	.type = OBS_SOURCE_TYPE_INPUT,
+	.output_flags = OBS_SOURCE_AUDIO,
+	.get_name = contention_source_name,
+	.create = contention_source_create,
+	.destroy = contention_source_destroy,
+};
+
+struct contention_producer {
+	pthread_t thread;
+	obs_source_t *source;
+	volatile bool *stop;
+	uint32_t frames;
+	uint32_t sample_rate;
+	uint64_t calls;
+	uint64_t total_ns;
+	uint64_t max_ns;
+};
+
+static void *contention_producer_thread(void *param)
+{
+	struct contention_producer *producer = param;
+	float *plane = bzalloc(sizeof(float) * producer->frames);
+	uint64_t interval = util_mul_div64(producer->frames, 1000000000ULL, producer->sample_rate);
+	uint64_t ts = os_gettime_ns();
+
+	struct obs_source_audio audio = {
+		.data = {(const uint8_t *)plane, (const uint8_t *)plane},
+		.frames = producer->frames,
+		.speakers = SPEAKERS_STEREO,
+		.format = AUDIO_FORMAT_FLOAT_PLANAR,
+		.samples_per_sec = producer->sample_rate,
+	};
+
+	/* output in real time so that the audio thread keeps up and the calls
+	 * compete with mixing rather than with full buffers */
+	while (!os_atomic_load_bool(producer->stop)) {
+		audio.timestamp = ts;
+
+		uint64_t start = os_gettime_ns();
+		obs_source_output_audio(producer->source, &audio);
+		uint64_t elapsed = os_gettime_ns() - start;
+
+		producer->calls++;
+		producer->total_ns += elapsed;
+		if (elapsed > producer->max_ns)
+			producer->max_ns = elapsed;
+
+		ts += interval;
+		os_sleepto_ns(ts);
+	}
+
+	bfree(plane);
+	return NULL;
+}
+
+static obs_data_t *run_contention_benchmark(obs_data_t *desc)
+{
+	obs_data_t *contention = obs_data_get_obj(desc, "audio_contention");
+	if (!contention)
+		return NULL;
+
+	obs_data_set_default_int(contention, "sources", 8);
+	obs_data_set_default_int(contention, "packet_frames", 64);
+	obs_data_set_default_int(contention, "seconds", 10);
+
+	size_t count = (size_t)obs_data_get_int(contention, "sources");
+	uint32_t frames = (uint32_t)obs_data_get_int(contention, "packet_frames");
+	uint32_t seconds = (uint32_t)obs_data_get_int(contention, "seconds");
+	obs_data_release(contention);
+
+	struct obs_audio_info oai;
+	if (!count || !frames || !seconds || !obs_get_audio_info(&oai))
+		return NULL;
+
+	obs_register_source(&contention_source_info);
+
+	struct contention_producer *producers = bzalloc(sizeof(*producers) * count);
+	obs_scene_t *scene = obs_scene_create_private("audio contention");
+	volatile bool stop = false;
+
+	for (size_t i = 0; i < count; i++) {
+		struct dstr name = {0};
+		dstr_printf(&name, "contention source %zu", i);
+		producers[i].source = obs_source_create_private(contention_source_info.id, name.array, NULL);
+		producers[i].stop = &stop;
+		producers[i].frames = frames;
+		producers[i].sample_rate = oai.samples_per_sec;
+		obs_scene_add(scene, producers[i].source);
+		dstr_free(&name);
+	}
+
+	obs_set_output_source(1, obs_scene_get_source(scene));
+
+	size_t started = 0;
+	for (; started < count; started++) {
+		if (pthread_create(&producers[started].thread, NULL, contention_producer_thread,
+				   &producers[started]) != 0)
+			break;
+	}
+
+	os_sleep_ms(seconds * 1000);
+	os_atomic_set_bool(&stop, true);
+
+	uint64_t calls = 0;
+	uint64_t total_ns = 0;
+	uint64_t max_ns = 0;
+
+	for (size_t i = 0; i < started; i++) {
+		pthread_join(producers[i].thread, NULL);
+		calls += producers[i].calls;
+		total_ns += producers[i].total_ns;
+		if (producers[i].max_ns > max_ns)
+			max_ns = producers[i].max_ns;
+	}
+
+	obs_set_output_source(1, NULL);
+
+	obs_data_t *results = obs_data_create();
+	obs_data_set_int(results, "sources", (long long)started);
+	obs_data_set_int(results, "packet_frames", frames);
+	obs_data_set_int(results, "calls", (long long)calls);
+	obs_data_set_double(results, "output_audio_avg_ns", calls ? (double)total_ns / (double)calls : 0.0);
+	obs_data_set_int(results, "output_audio_max_ns", (long long)max_ns);
+
+	obs_scene_release(scene);
+	for (size_t i = 0; i < count; i++)
+		obs_source_release(producers[i].source);
+	bfree(producers);
+	return results;
+}
+
+/* ------------------------------------------------------------------------- */
+/* main                                                                      */
+
+static void wait_for_frames(uint32_t frames)
+{
+	uint32_t start = obs_get_total_frames();
+
+	while (obs_get_total_frames() - start < frames)
+		os_sleep_ms(5);
+}
+
+static uint64_t get_draw_calls(void)
+{
+	obs_enter_graphics();
+	uint64_t draw_calls = gs_get_draw_calls();
+	obs_leave_graphics();
+	return draw_calls;
+}
+
+static obs_data_t *run_benchmark(struct benchmark *bench)
+{
+	struct phase phases[NUM_PHASES] = {0};
+	obs_data_t *results = obs_data_create();
+	obs_data_t *phase_data = obs_data_create();
+
+	obs_data_set_default_int(bench->desc, "frames", 600);
+	obs_data_set_default_int(bench->desc, "warmup_frames", 60);
+
+	uint32_t frames = (uint32_t)obs_data_get_int(bench->desc, "frames");
+	uint32_t warmup = (uint32_t)obs_data_get_int(bench->desc, "warmup_frames");
+
+	wait_for_frames(warmup);
+
+	collect_snapshot(phases, -1);
+	uint64_t draw_calls = get_draw_calls();
+	uint32_t lagged = obs_get_lagged_frames();
+	uint64_t start = os_gettime_ns();
+
+	wait_for_frames(frames);
+
+	uint64_t elapsed = os_gettime_ns() - start;
+	lagged = obs_get_lagged_frames() - lagged;
+	draw_calls = get_draw_calls() - draw_calls;
+	collect_snapshot(phases, 1);
+
+	for (size_t i = 0; i < NUM_PHASES; i++) {
+		obs_data_t *result = phase_results(&phases[i], frames);
+		obs_data_set_obj(phase_data, phase_defs[i].name, result);
+		obs_data_release(result);
+		da_free(phases[i].times);
+	}
+
+	struct obs_video_info ovi;
+	obs_get_video_info(&ovi);
+
+	struct gs_texture_pool_stats pool;
+	obs_enter_graphics();
+	gs_texture_pool_get_stats(&pool);
+	obs_leave_graphics();
+
+	obs_data_t *pool_data = obs_data_create();
+	obs_data_set_int(pool_data, "acquired", (long long)pool.acquired);
+	obs_data_set_int(pool_data, "reused", (long long)pool.reused);
+	obs_data_set_int(pool_data, "reclaimed", (long long)pool.reclaimed);
+	obs_data_set_int(pool_data, "created", (long long)pool.created);
+	obs_data_set_int(pool_data, "textures", pool.textures);
+	obs_data_set_int(pool_data, "bytes", (long long)pool.bytes);
+
+	obs_data_set_string(results, "graphics_module", ovi.graphics_module);
+	obs_data_set_int(results, "base_width", ovi.base_width);
+	obs_data_set_int(results, "base_height", ovi.base_height);
+	obs_data_set_int(results, "output_width", ovi.output_width);
+	obs_data_set_int(results, "output_height", ovi.output_height);
+	obs_data_set_double(results, "fps", (double)ovi.fps_num / (double)ovi.fps_den);
+	obs_data_set_int(results, "scenes", (long long)bench->scenes.num);
+	obs_data_set_int(results, "sources", (long long)bench->sources.num);
+	obs_data_set_int(results, "scene_items", (long long)bench->num_items);
+	obs_data_set_int(results, "filters", (long long)bench->num_filters);
+	obs_data_set_int(results, "outputs", (long long)bench->outputs.num);
+	obs_data_set_int(results, "frames", frames);
+	obs_data_set_int(results, "lagged_frames", lagged);
+	obs_data_set_double(results, "draw_calls_per_frame", frames ? (double)draw_calls / (double)frames : 0.0);
+	obs_data_set_double(results, "elapsed_ms", (double)elapsed / 1000000.0);
+	obs_data_set_obj(results, "phases", phase_data);
+	obs_data_set_obj(results, "texture_pool", pool_data);
+
+	struct audio_output_latency latency;
+	audio_output_get_latency(obs_get_audio(), &latency);
+
+	obs_data_t *latency_data = obs_data_create();
+	obs_data_set_bool(latency_data, "external_clock", latency.external_clock);
+	obs_data_set_double(latency_data, "output_avg_ms",
+			    latency.ticks ? (double)latency.total_output_ns / (double)latency.ticks / 1000000.0 : 0.0);
+	obs_data_set_double(latency_data, "output_max_ms", (double)latency.max_output_ns / 1000000.0);
+	obs_data_set_double(latency_data, "mix_max_ms", (double)latency.max_mix_ns / 1000000.0);
+	obs_data_set_double(latency_data, "late_max_ms", (double)latency.max_late_ns / 1000000.0);
+	obs_data_set_obj(results, "audio_latency", latency_data);
+
+	obs_data_release(latency_data);
+	obs_data_release(pool_data);
+	obs_data_release(phase_data);
+	return results;
+}
+
+static void add_module_paths(obs_data_t *desc)
+{
+	obs_data_array_t *paths = obs_data_get_array(desc, "module_paths");
+
+	for (size_t i = 0; i < obs_data_array_count(paths); i++) {
+		obs_data_t *path = obs_data_array_item(paths, i);
+		obs_add_module_path(obs_data_get_string(path, "bin"), obs_data_get_string(path, "data"));
+		obs_data_release(path);
+	}
+
+	obs_data_array_release(paths);
+}
+
+static void do_log(int log_level, const char *msg, va_list args, void *param)
+{
+	/* stdout is reserved for the results */
+	if (log_level <= LOG_INFO) {
+		vfprintf(stderr, msg, args);
+		fputc('\n', stderr);
+	}
+
+	UNUSED_PARAMETER(param);
+}
+
+int main(int argc, char *argv[])
+{
+	struct benchmark bench = {0};
+	obs_data_t *results = NULL;
+	int ret = 1;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <description.json> [results.json]\n", argv[0]);
+		return 1;
+	}
+
+	base_set_log_handler(do_log, NULL);
+
+	bench.desc = obs_data_create_from_json_file(argv[1]);
+	if (!bench.desc) {
+		blog(LOG_ERROR, "Failed to load benchmark description '%s'", argv[1]);
+		return 1;
+	}
+
+	profiler_name_store_t *store = profiler_name_store_create();
+	profiler_start();
+
+	if (!obs_startup("en-US", NULL, store)) {
+		blog(LOG_ERROR, "Failed to start libobs");
+		goto free_profiler;
+	}
+
+	obs_data_t *video = obs_data_get_obj(bench.desc, "video");
+	obs_data_t *audio = obs_data_get_obj(bench.desc, "audio");
+	if (!video)
+		video = obs_data_create();
+	if (!audio)
+		audio = obs_data_create();
+
+	bool reset = reset_audio(audio) && reset_video(video);
+	obs_data_release(audio);
+	obs_data_release(video);
+	if (!reset)
+		goto shutdown;
+
+	add_module_paths(bench.desc);
+	obs_load_all_modules();
+	obs_post_load_modules();
+
+	if (!create_scenes(&bench) || !start_outputs(&bench))
+		goto stop;
+
+	results = run_benchmark(&bench);
+
+	obs_data_t *lookups = run_lookup_benchmark(bench.desc);
+	if (lookups) {
+		obs_data_set_obj(results, "lookups", lookups);
+		obs_data_release(lookups);
+	}
+
+	obs_data_t *resampler = run_resampler_benchmark(bench.desc);
+	if (resampler) {
+		obs_data_set_obj(results, "resampler", resampler);
+		obs_data_release(resampler);
+	}
+
+	obs_data_t *contention = run_contention_benchmark(bench.desc);
+	if (contention) {
+		obs_data_set_obj(results, "audio_contention", contention);
+		obs_data_release(contention);
+	}
+
+	if (argc > 2) {
+		if (obs_data_save_json_pretty_safe(results, argv[2], "tmp", NULL))
+			ret = 0;
+		else
+			blog(LOG_ERROR, "Failed to write results to '%s'", argv[2]);
+	} else {
+		printf("%s", obs_data_get_json_pretty(results));
+		ret = 0;
+	}
+
+	obs_data_release(results);
+
+stop:
+	stop_outputs(&bench);
+	benchmark_free(&bench);
+shutdown:
+	obs_shutdown();
+free_profiler:
+	profiler_stop();
+	profiler_free();
+	profiler_name_store_free(store);
+	obs_data_release(bench.desc);
+	return ret;
+}
@@ -0,0 +1,240 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <limits.h>
+
+#include <obs-audio-queue.h>
+
+#define CHANNELS 2
+#define SAMPLE_RATE 48000
+
+static int queue_setup(void **state)
+{
+	struct audio_queue *queue = bzalloc(sizeof(struct audio_queue));
+
+	audio_queue_init(queue);
+	*state = queue;
+	return 0;
+}
+
+static int queue_teardown(void **state)
+{
+	struct audio_queue *queue = *state;
+
+	audio_queue_free(queue);
+	bfree(queue);
+	return 0;
+}
+
+/* each channel counts up from where the previous segment stopped, so lost,
+ * repeated or misplaced frames all show up */
+static float sample_value(uint64_t frame, size_t ch)
+{
+	return (float)(frame % 1000000) + (float)ch * 0.25f;
+}
+
+static bool push_frames(struct audio_queue *queue, uint64_t first_frame, uint32_t frames, bool push_back)
+{
+	bool pushed;
+	float *planes[CHANNELS];
+	struct audio_data in = {.frames = frames, .timestamp = first_frame * 1000};
+
+	for (size_t ch = 0; ch < CHANNELS; ch++) {
+		planes[ch] = bmalloc(frames * sizeof(float));
+		for (uint32_t i = 0; i < frames; i++)
+			planes[ch][i] = sample_value(first_frame + i, ch);
+		in.data[ch] = (uint8_t *)planes[ch];
+	}
+
+	pushed = audio_queue_push(queue, &in, CHANNELS, SAMPLE_RATE, push_back);
+
+	for (size_t ch = 0; ch < CHANNELS; ch++)
+		bfree(planes[ch]);
+	return pushed;
+}
+
+/* reads everything queued and returns the number of frames */
+static uint64_t check_frames(struct audio_queue *queue, uint64_t first_frame)
+{
+	struct audio_queue_reader reader;
+	struct audio_segment seg;
+	struct audio_data in;
+	uint64_t frame = first_frame;
+
+	audio_queue_begin_read(queue, &reader);
+
+	while (audio_queue_read(queue, &reader, CHANNELS, &seg, &in)) {
+		assert_false(seg.reset);
+		assert_int_equal(in.frames, seg.frames);
+
+		for (size_t ch = 0; ch < CHANNELS; ch++) {
+			const float *data = (const float *)in.data[ch];
+
+			for (uint32_t i = 0; i < in.frames; i++)
+				assert_true(data[i] == sample_value(frame + i, ch));
+		}
+
+		frame += in.frames;
+	}
+
+	audio_queue_end_read(queue, &reader);
+	return frame - first_frame;
+}
+
+static void frames_survive_wraparound(void **state)
+{
+	struct audio_queue *queue = *state;
+	uint64_t frame = 0;
+
+	/* segment sizes that do not divide the queue size, so segments
+	 * regularly straddle its end */
+	for (int i = 0; i < 200; i++) {
+		uint32_t frames = 1000 + (uint32_t)(i % 7) * 77;
+
+		push_frames(queue, frame, frames, false);
+		push_frames(queue, frame + frames, frames, true);
+		assert_int_equal(check_frames(queue, frame), frames * 2);
+		frame += frames * 2;
+	}
+
+	assert_true(frame > AUDIO_QUEUE_FRAMES * 16);
+	assert_int_equal(queue->dropped_frames, 0);
+}
+
+static void counters_wrap_around(void **state)
+{
+	struct audio_queue *queue = *state;
+	uint64_t frame = 0;
+
+	struct audio_queue_ring *ring = queue->write;
+
+	ring->segments_written = ring->segments_read = LONG_MAX - 2;
+	ring->frames_written = ring->frames_read = LONG_MAX - 1500;
+
+	for (int i = 0; i < 8; i++) {
+		push_frames(queue, frame, 1024, false);
+		assert_int_equal(check_frames(queue, frame), 1024);
+		frame += 1024;
+	}
+
+	assert_true(queue->write == ring);
+	assert_true(ring->segments_written < 0);
+	assert_true(ring->frames_written < 0);
+	assert_int_equal(queue->dropped_frames, 0);
+}
+
+static void large_output_is_split(void **state)
+{
+	struct audio_queue *queue = *state;
+	struct audio_queue_reader reader;
+	struct audio_segment seg;
+	struct audio_data in;
+	uint32_t frames = AUDIO_QUEUE_FRAMES / 2 + 100;
+	uint32_t offset = 0;
+
+	push_frames(queue, 0, frames, false);
+	audio_queue_begin_read(queue, &reader);
+
+	while (audio_queue_read(queue, &reader, CHANNELS, &seg, &in)) {
+		assert_true(seg.frames <= AUDIO_QUEUE_FRAMES / 4);
+		assert_int_equal(seg.push_back, offset > 0);
+		assert_int_equal(seg.timestamp, util_mul_div64(offset, 1000000000ULL, SAMPLE_RATE));
+		offset += seg.frames;
+	}
+
+	audio_queue_end_read(queue, &reader);
+	assert_int_equal(offset, frames);
+}
+
+static void full_queue_grows(void **state)
+{
+	struct audio_queue *queue = *state;
+	struct audio_queue_ring *first = queue->write;
+	const uint32_t frames = AUDIO_QUEUE_SEGMENT_FRAMES;
+	uint64_t frame = 0;
+
+	/* more than the initial ring holds, while nothing is being read */
+	for (int i = 0; i < 13; i++) {
+		assert_true(push_frames(queue, frame, frames, i > 0));
+		frame += frames;
+	}
+
+	assert_true(queue->write != first);
+	assert_true(queue->read == first);
+	assert_int_equal(queue->dropped_frames, 0);
+
+	/* the reader follows into the new rings and frees the old ones */
+	assert_int_equal(check_frames(queue, 0), frame);
+	assert_true(queue->read == queue->write);
+	assert_int_equal(queue->read->frames, AUDIO_QUEUE_FRAMES * 4);
+
+	assert_true(push_frames(queue, 0, frames, false));
+	assert_int_equal(check_frames(queue, 0), frames);
+}
+
+static void full_queue_drops_frames(void **state)
+{
+	struct audio_queue *queue = *state;
+	const uint32_t frames = AUDIO_QUEUE_SEGMENT_FRAMES;
+	uint64_t frame = 0;
+
+	/* only drops once the largest ring is full */
+	while (push_frames(queue, frame, frames, frame > 0))
+		frame += frames;
+
+	assert_int_equal(queue->write->frames, AUDIO_QUEUE_MAX_FRAMES);
+	assert_true(frame >= AUDIO_QUEUE_MAX_FRAMES);
+	assert_int_equal(queue->dropped_frames, frames);
+
+	/* reading frees the space again */
+	assert_int_equal(check_frames(queue, 0), frame);
+	assert_true(push_frames(queue, 0, frames, false));
+	assert_int_equal(queue->dropped_frames, frames);
+	assert_int_equal(check_frames(queue, 0), frames);
+}
+
+static void reset_survives_growth(void **state)
+{
+	struct audio_queue *queue = *state;
+	struct audio_queue_reader reader;
+	struct audio_segment seg;
+	struct audio_data in;
+	struct audio_queue_ring *first = queue->write;
+
+	/* the last segment of a ring is kept for a reset, the next push grows it */
+	for (uint64_t i = 0; i < AUDIO_QUEUE_SEGMENTS; i++)
+		assert_true(push_frames(queue, i, 1, false));
+	assert_true(queue->write != first);
+
+	assert_true(audio_queue_push_reset(queue, 1234));
+	assert_int_equal(queue->dropped_frames, 0);
+
+	audio_queue_begin_read(queue, &reader);
+	for (uint64_t i = 0; i < AUDIO_QUEUE_SEGMENTS; i++) {
+		assert_true(audio_queue_read(queue, &reader, CHANNELS, &seg, &in));
+		assert_false(seg.reset);
+		assert_true(((const float *)in.data[0])[0] == sample_value(i, 0));
+	}
+
+	assert_true(audio_queue_read(queue, &reader, CHANNELS, &seg, &in));
+	assert_true(seg.reset);
+	assert_int_equal(seg.timestamp, 1234);
+	assert_false(audio_queue_read(queue, &reader, CHANNELS, &seg, &in));
+	audio_queue_end_read(queue, &reader);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_setup_teardown(frames_survive_wraparound, queue_setup, queue_teardown),
+		cmocka_unit_test_setup_teardown(counters_wrap_around, queue_setup, queue_teardown),
+		cmocka_unit_test_setup_teardown(large_output_is_split, queue_setup, queue_teardown),
+		cmocka_unit_test_setup_teardown(full_queue_grows, queue_setup, queue_teardown),
+		cmocka_unit_test_setup_teardown(full_queue_drops_frames, queue_setup, queue_teardown),
+		cmocka_unit_test_setup_teardown(reset_survives_growth, queue_setup, queue_teardown),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
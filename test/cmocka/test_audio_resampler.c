@@ -0,0 +1,105 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <math.h>
+#include <string.h>
+
+#include <media-io/audio-resampler.h>
+#include <util/bmem.h>
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932384626433832795
+#endif
+
+#define TONE_HZ 1000.0
+#define AMPLITUDE 0.5
+#define CHUNK_FRAMES 480
+#define INPUT_FRAMES 9600
+
+/* the first outputs are filtered against the silence before the input */
+#define SETTLE_FRAMES 128
+
+static float *resample_sine(uint32_t in_rate, uint32_t out_rate, size_t *out_count)
+{
+	struct resample_info src = {in_rate, AUDIO_FORMAT_FLOAT_PLANAR, SPEAKERS_MONO};
+	struct resample_info dst = {out_rate, AUDIO_FORMAT_FLOAT_PLANAR, SPEAKERS_MONO};
+	audio_resampler_t *rs = audio_resampler_create_type(AUDIO_RESAMPLER_POLYPHASE, &dst, &src);
+	float *output = bzalloc(sizeof(float) * ((size_t)INPUT_FRAMES * out_rate / in_rate + CHUNK_FRAMES));
+	float chunk[CHUNK_FRAMES];
+	size_t count = 0;
+
+	assert_non_null(rs);
+	assert_int_equal(audio_resampler_get_type(rs), AUDIO_RESAMPLER_POLYPHASE);
+
+	for (uint32_t start = 0; start < INPUT_FRAMES; start += CHUNK_FRAMES) {
+		const uint8_t *input[MAX_AV_PLANES] = {(const uint8_t *)chunk};
+		uint8_t *resampled[MAX_AV_PLANES] = {0};
+		uint32_t frames = 0;
+		uint64_t ts_offset = 0;
+
+		for (uint32_t i = 0; i < CHUNK_FRAMES; i++)
+			chunk[i] = (float)(AMPLITUDE * sin(2.0 * M_PI * TONE_HZ * (start + i) / in_rate));
+
+		assert_true(audio_resampler_resample(rs, resampled, &frames, &ts_offset, input, CHUNK_FRAMES));
+		memcpy(output + count, resampled[0], sizeof(float) * frames);
+		count += frames;
+	}
+
+	audio_resampler_destroy(rs);
+	*out_count = count;
+	return output;
+}
+
+/* output n lines up with input time n * in_rate / out_rate */
+static void check_against_reference(uint32_t in_rate, uint32_t out_rate)
+{
+	size_t count;
+	float *output = resample_sine(in_rate, out_rate, &count);
+
+	/* only the filter's lookahead is still held back */
+	assert_true(count > (size_t)INPUT_FRAMES * out_rate / in_rate - CHUNK_FRAMES);
+
+	for (size_t n = SETTLE_FRAMES; n < count; n++) {
+		double expected = AMPLITUDE * sin(2.0 * M_PI * TONE_HZ * (double)n / out_rate);
+		assert_true(fabs(output[n] - expected) < 1e-4);
+	}
+
+	bfree(output);
+}
+
+static void upsample_matches_reference(void **state)
+{
+	UNUSED_PARAMETER(state);
+	check_against_reference(44100, 48000);
+}
+
+static void downsample_matches_reference(void **state)
+{
+	UNUSED_PARAMETER(state);
+	check_against_reference(48000, 44100);
+}
+
+static void equal_rates_use_swresample(void **state)
+{
+	UNUSED_PARAMETER(state);
+	struct resample_info src = {48000, AUDIO_FORMAT_FLOAT_PLANAR, SPEAKERS_STEREO};
+	struct resample_info dst = {48000, AUDIO_FORMAT_16BIT, SPEAKERS_STEREO};
+	audio_resampler_t *rs = audio_resampler_create_type(AUDIO_RESAMPLER_POLYPHASE, &dst, &src);
+
+	assert_non_null(rs);
+	assert_int_equal(audio_resampler_get_type(rs), AUDIO_RESAMPLER_SWRESAMPLE);
+	audio_resampler_destroy(rs);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(upsample_matches_reference),
+		cmocka_unit_test(downsample_matches_reference),
+		cmocka_unit_test(equal_rates_use_swresample),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
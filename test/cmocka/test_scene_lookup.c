@@ -0,0 +1,194 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <obs.h>
+
+static const char *test_input_get_name(void *type_data)
+{
+	UNUSED_PARAMETER(type_data);
+	return "Test Input";
+}
+
+static void *test_input_create(obs_data_t *settings, obs_source_t *source)
+{
+	UNUSED_PARAMETER(settings);
+	return source;
+}
+
+static void test_input_destroy(void *data)
+{
+	UNUSED_PARAMETER(data);
+}
+
+static struct obs_source_info test_input = {
+	.id = "test_input",
+	.type = OBS_SOURCE_TYPE_INPUT,
+	.get_name = test_input_get_name,
+	.create = test_input_create,
+	.destroy = test_input_destroy,
+};
+
+/* scenes only need the main canvas created by obs_startup, nothing is
+ * rendered so video is never reset */
+static int obs_setup(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	if (!obs_startup("en-US", NULL, NULL))
+		return -1;
+
+	obs_register_source(&test_input);
+	return 0;
+}
+
+static int obs_teardown(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	obs_shutdown();
+	return 0;
+}
+
+static obs_sceneitem_t *add_input(obs_scene_t *scene, const char *name)
+{
+	obs_source_t *source = obs_source_create_private("test_input", name, NULL);
+	obs_sceneitem_t *item = obs_scene_add(scene, source);
+
+	obs_source_release(source);
+	return item;
+}
+
+static void find_by_name(void **state)
+{
+	UNUSED_PARAMETER(state);
+	obs_scene_t *scene = obs_scene_create_private("lookup scene");
+
+	obs_sceneitem_t *a = add_input(scene, "input a");
+	obs_sceneitem_t *b = add_input(scene, "input b");
+	obs_sceneitem_t *c = add_input(scene, "input c");
+
+	assert_ptr_equal(obs_scene_find_source(scene, "input a"), a);
+	assert_ptr_equal(obs_scene_find_source(scene, "input b"), b);
+	assert_ptr_equal(obs_scene_find_source(scene, "input c"), c);
+	assert_null(obs_scene_find_source(scene, "input d"));
+
+	obs_sceneitem_remove(b);
+	assert_null(obs_scene_find_source(scene, "input b"));
+	assert_ptr_equal(obs_scene_find_source(scene, "input c"), c);
+
+	obs_scene_release(scene);
+}
+
+static void find_by_uuid(void **state)
+{
+	UNUSED_PARAMETER(state);
+	obs_scene_t *scene = obs_scene_create_private("lookup scene");
+
+	obs_sceneitem_t *a = add_input(scene, "input a");
+	obs_sceneitem_t *b = add_input(scene, "input b");
+	char *uuid_b = bstrdup(obs_source_get_uuid(obs_sceneitem_get_source(b)));
+
+	assert_ptr_equal(obs_scene_find_source_by_uuid(scene, obs_source_get_uuid(obs_sceneitem_get_source(a))), a);
+	assert_ptr_equal(obs_scene_find_source_by_uuid(scene, uuid_b), b);
+	assert_null(obs_scene_find_source_by_uuid(scene, "00000000-0000-0000-0000-000000000000"));
+
+	obs_sceneitem_remove(b);
+	assert_null(obs_scene_find_source_by_uuid(scene, uuid_b));
+
+	bfree(uuid_b);
+	obs_scene_release(scene);
+}
+
+static void find_by_id(void **state)
+{
+	UNUSED_PARAMETER(state);
+	obs_scene_t *scene = obs_scene_create_private("lookup scene");
+
+	obs_sceneitem_t *a = add_input(scene, "input a");
+	obs_sceneitem_t *b = add_input(scene, "input b");
+	int64_t id_a = obs_sceneitem_get_id(a);
+	int64_t id_b = obs_sceneitem_get_id(b);
+
+	assert_int_not_equal(id_a, id_b);
+	assert_ptr_equal(obs_scene_find_sceneitem_by_id(scene, id_a), a);
+	assert_ptr_equal(obs_scene_find_sceneitem_by_id(scene, id_b), b);
+
+	obs_sceneitem_remove(a);
+	assert_null(obs_scene_find_sceneitem_by_id(scene, id_a));
+	assert_ptr_equal(obs_scene_find_sceneitem_by_id(scene, id_b), b);
+
+	obs_scene_release(scene);
+}
+
+static void find_after_rename(void **state)
+{
+	UNUSED_PARAMETER(state);
+	obs_scene_t *scene = obs_scene_create_private("lookup scene");
+
+	obs_sceneitem_t *a = add_input(scene, "input a");
+	obs_source_set_name(obs_sceneitem_get_source(a), "renamed input");
+
+	assert_null(obs_scene_find_source(scene, "input a"));
+	assert_ptr_equal(obs_scene_find_source(scene, "renamed input"), a);
+
+	obs_scene_release(scene);
+}
+
+static void shared_source_finds_first_item(void **state)
+{
+	UNUSED_PARAMETER(state);
+	obs_scene_t *scene = obs_scene_create_private("lookup scene");
+
+	obs_sceneitem_t *first = add_input(scene, "input a");
+	obs_source_t *source = obs_sceneitem_get_source(first);
+	obs_sceneitem_t *second = obs_scene_add(scene, source);
+	char *uuid = bstrdup(obs_source_get_uuid(source));
+
+	/* lookups return the first item in list order */
+	assert_ptr_equal(obs_scene_find_source(scene, "input a"), first);
+	assert_ptr_equal(obs_scene_find_source_by_uuid(scene, uuid), first);
+
+	obs_sceneitem_remove(first);
+	assert_ptr_equal(obs_scene_find_source(scene, "input a"), second);
+	assert_ptr_equal(obs_scene_find_source_by_uuid(scene, uuid), second);
+
+	bfree(uuid);
+	obs_scene_release(scene);
+}
+
+static void find_in_group(void **state)
+{
+	UNUSED_PARAMETER(state);
+	obs_scene_t *scene = obs_scene_create_private("lookup scene");
+
+	obs_sceneitem_t *item = add_input(scene, "input a");
+	int64_t id = obs_sceneitem_get_id(item);
+	const char *uuid = obs_source_get_uuid(obs_sceneitem_get_source(item));
+	obs_sceneitem_t *group = obs_scene_add_group2(scene, "lookup group", false);
+
+	obs_sceneitem_group_add_item(group, item);
+	item = obs_scene_find_source_recursive(scene, "input a");
+
+	assert_non_null(item);
+	assert_null(obs_scene_find_source(scene, "input a"));
+	assert_ptr_equal(obs_scene_find_source_by_uuid_recursive(scene, uuid), item);
+	assert_null(obs_scene_find_sceneitem_by_id(scene, id));
+
+	obs_scene_release(scene);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(find_by_name),
+		cmocka_unit_test(find_by_uuid),
+		cmocka_unit_test(find_by_id),
+		cmocka_unit_test(find_after_rename),
+		cmocka_unit_test(shared_source_finds_first_item),
+		cmocka_unit_test(find_in_group),
+	};
+
+	return cmocka_run_group_tests(tests, obs_setup, obs_teardown);
+}
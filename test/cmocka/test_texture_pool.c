@@ -0,0 +1,221 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include <graphics/graphics.h>
+#include <graphics/graphics-internal.h>
+
+/* runs on the software renderer, so no GPU is needed */
+static int graphics_setup(void **state)
+{
+	graphics_t *graphics = NULL;
+
+	if (gs_create(&graphics, SOFTWARE_RENDERER_MODULE, 0) != GS_SUCCESS)
+		return -1;
+
+	gs_enter_context(graphics);
+	*state = graphics;
+	return 0;
+}
+
+static int graphics_teardown(void **state)
+{
+	graphics_t *graphics = *state;
+
+	gs_leave_context();
+	gs_destroy(graphics);
+	return 0;
+}
+
+static int pool_teardown(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	gs_texture_pool_trim();
+	return 0;
+}
+
+static void released_texture_is_reused(void **state)
+{
+	UNUSED_PARAMETER(state);
+	struct gs_texture_pool_stats before, after;
+
+	gs_texture_pool_get_stats(&before);
+
+	gs_texture_t *tex = gs_texture_pool_acquire(64, 32, GS_RGBA);
+	assert_non_null(tex);
+	gs_texture_pool_release(tex);
+
+	gs_texture_t *again = gs_texture_pool_acquire(64, 32, GS_RGBA);
+	assert_ptr_equal(again, tex);
+	gs_texture_pool_release(again);
+
+	gs_texture_pool_get_stats(&after);
+	assert_int_equal(after.created - before.created, 1);
+	assert_int_equal(after.reused - before.reused, 1);
+	assert_int_equal(after.in_use, 0);
+}
+
+static void acquired_textures_are_not_shared(void **state)
+{
+	UNUSED_PARAMETER(state);
+
+	gs_texture_t *a = gs_texture_pool_acquire(64, 32, GS_RGBA);
+	gs_texture_t *b = gs_texture_pool_acquire(64, 32, GS_RGBA);
+	gs_texture_t *c = gs_texture_pool_acquire(32, 64, GS_RGBA);
+	gs_texture_t *d = gs_texture_pool_acquire(64, 32, GS_R8);
+
+	assert_non_null(a);
+	assert_non_null(b);
+	assert_non_null(c);
+	assert_non_null(d);
+	assert_ptr_not_equal(a, b);
+	assert_ptr_not_equal(a, c);
+	assert_ptr_not_equal(a, d);
+
+	gs_texture_pool_release(a);
+	gs_texture_pool_release(b);
+	gs_texture_pool_release(c);
+	gs_texture_pool_release(d);
+}
+
+static void trim_frees_released_textures(void **state)
+{
+	UNUSED_PARAMETER(state);
+	struct gs_texture_pool_stats stats;
+
+	gs_texture_t *held = gs_texture_pool_acquire(16, 16, GS_RGBA);
+	gs_texture_t *tex = gs_texture_pool_acquire(16, 16, GS_RGBA);
+	gs_texture_pool_release(tex);
+
+	gs_texture_pool_trim();
+
+	gs_texture_pool_get_stats(&stats);
+	assert_int_equal(stats.textures, 1);
+	assert_int_equal(stats.in_use, 1);
+
+	gs_texture_pool_release(held);
+}
+
+static void texrender_reclaims_its_target(void **state)
+{
+	UNUSED_PARAMETER(state);
+	struct gs_texture_pool_stats before, after;
+	gs_texrender_t *texrender = gs_texrender_create_pooled(GS_RGBA, GS_ZS_NONE);
+
+	gs_texture_pool_get_stats(&before);
+
+	assert_true(gs_texrender_begin(texrender, 64, 64));
+	gs_texrender_end(texrender);
+	gs_texture_t *target = gs_texrender_get_texture(texrender);
+	assert_non_null(target);
+
+	gs_texrender_release(texrender);
+	assert_null(gs_texrender_get_texture(texrender));
+
+	/* nobody took the target, so its contents are still valid and it
+	 * does not need to be rendered again */
+	assert_false(gs_texrender_begin(texrender, 64, 64));
+	assert_ptr_equal(gs_texrender_get_texture(texrender), target);
+
+	gs_texture_pool_get_stats(&after);
+	assert_int_equal(after.reclaimed - before.reclaimed, 1);
+
+	gs_texrender_destroy(texrender);
+
+	gs_texture_pool_get_stats(&after);
+	assert_int_equal(after.in_use, 0);
+}
+
+static void texrender_target_taken_by_another(void **state)
+{
+	UNUSED_PARAMETER(state);
+	gs_texrender_t *texrender = gs_texrender_create_pooled(GS_RGBA, GS_ZS_NONE);
+
+	assert_true(gs_texrender_begin(texrender, 64, 64));
+	gs_texrender_end(texrender);
+	gs_texture_t *target = gs_texrender_get_texture(texrender);
+	gs_texrender_release(texrender);
+
+	gs_texture_t *other = gs_texture_pool_acquire(64, 64, GS_RGBA);
+	assert_ptr_equal(other, target);
+
+	/* the contents were lost, so it has to render to a new target */
+	assert_true(gs_texrender_begin(texrender, 64, 64));
+	gs_texrender_end(texrender);
+	assert_ptr_not_equal(gs_texrender_get_texture(texrender), other);
+
+	gs_texture_pool_release(other);
+	gs_texrender_destroy(texrender);
+}
+
+static void texrender_reset_keeps_target(void **state)
+{
+	graphics_t *graphics = *state;
+	struct gs_texture_pool_stats stats;
+	gs_texrender_t *texrender = gs_texrender_create_pooled(GS_RGBA, GS_ZS_NONE);
+
+	assert_true(gs_texrender_begin(texrender, 64, 64));
+	gs_texrender_end(texrender);
+	gs_texture_t *target = gs_texrender_get_texture(texrender);
+
+	/* sources reset their texrenders while ticking */
+	gs_leave_context();
+	gs_texrender_reset(texrender);
+	gs_enter_context(graphics);
+	gs_texrender_reset(texrender);
+
+	/* the target is still held and is rendered to again */
+	gs_texture_pool_get_stats(&stats);
+	assert_int_equal(stats.in_use, 1);
+	assert_ptr_equal(gs_texrender_get_texture(texrender), target);
+
+	assert_true(gs_texrender_begin(texrender, 64, 64));
+	gs_texrender_end(texrender);
+	assert_ptr_equal(gs_texrender_get_texture(texrender), target);
+
+	gs_texrender_release(texrender);
+	gs_texture_pool_get_stats(&stats);
+	assert_int_equal(stats.in_use, 0);
+
+	gs_texrender_destroy(texrender);
+}
+
+static void texrender_without_pool(void **state)
+{
+	UNUSED_PARAMETER(state);
+	struct gs_texture_pool_stats before, after;
+	gs_texrender_t *texrender = gs_texrender_create(GS_RGBA, GS_ZS_NONE);
+
+	gs_texture_pool_get_stats(&before);
+
+	assert_true(gs_texrender_begin(texrender, 64, 64));
+	gs_texrender_end(texrender);
+	gs_texture_t *target = gs_texrender_get_texture(texrender);
+	assert_non_null(target);
+
+	/* texrenders created through the public API never touch the pool */
+	gs_texrender_reset(texrender);
+	assert_ptr_equal(gs_texrender_get_texture(texrender), target);
+
+	gs_texture_pool_get_stats(&after);
+	assert_int_equal(after.acquired, before.acquired);
+
+	gs_texrender_destroy(texrender);
+}
+
+int main()
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test_teardown(released_texture_is_reused, pool_teardown),
+		cmocka_unit_test_teardown(acquired_textures_are_not_shared, pool_teardown),
+		cmocka_unit_test_teardown(trim_frees_released_textures, pool_teardown),
+		cmocka_unit_test_teardown(texrender_reclaims_its_target, pool_teardown),
+		cmocka_unit_test_teardown(texrender_target_taken_by_another, pool_teardown),
+		cmocka_unit_test_teardown(texrender_reset_keeps_target, pool_teardown),
+		cmocka_unit_test_teardown(texrender_without_pool, pool_teardown),
+	};
+
+	return cmocka_run_group_tests(tests, graphics_setup, graphics_teardown);
+}